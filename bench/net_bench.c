@@ -0,0 +1,574 @@
+/**
+ * @file net_bench.c
+ * @brief Network performance benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The benchmark runs a server task and a client on the same TCP/IP stack,
+ * typically over the loopback interface. It measures TCP bulk throughput,
+ * UDP packet rate, TCP connection setup rate and request/response latency,
+ * and reports the high-water mark of the memory pool
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NET_BENCH_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "bench/net_bench.h"
+#include "bench/net_bench_misc.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (NET_BENCH_SUPPORT == ENABLED)
+
+
+/**
+ * @brief Initialize settings with default values
+ * @param[out] settings Structure that contains benchmark settings
+ **/
+
+void netBenchGetDefaultSettings(NetBenchSettings *settings)
+{
+   //Default task parameters
+   settings->task = OS_TASK_DEFAULT_PARAMS;
+   settings->task.stackSize = NET_BENCH_STACK_SIZE;
+   settings->task.priority = NET_BENCH_PRIORITY;
+
+   //The benchmark is not bound to any interface
+   settings->interface = NULL;
+
+#if (IPV4_SUPPORT == ENABLED)
+   //The client connects to the loopback address
+   settings->serverIpAddr.length = sizeof(Ipv4Addr);
+   settings->serverIpAddr.ipv4Addr = IPV4_LOOPBACK_ADDR;
+#else
+   //The server IP address must be specified by the user
+   settings->serverIpAddr = IP_ADDR_ANY;
+#endif
+
+   //Benchmark port number
+   settings->port = NET_BENCH_PORT;
+   //Duration of the throughput tests
+   settings->duration = 5000;
+   //Payload size of the UDP datagrams
+   settings->udpPayloadSize = 64;
+   //Number of connections for the setup rate test
+   settings->connectionCount = 100;
+   //Number of transactions for the latency test
+   settings->transactionCount = NET_BENCH_MAX_LATENCY_SAMPLES;
+   //Size of requests and responses
+   settings->transactionSize = 64;
+}
+
+
+/**
+ * @brief Initialize benchmark context
+ * @param[in] context Pointer to the benchmark context
+ * @param[in] settings Benchmark specific settings
+ * @return Error code
+ **/
+
+error_t netBenchInit(NetBenchContext *context,
+   const NetBenchSettings *settings)
+{
+   error_t error;
+
+   //Debug message
+   TRACE_INFO("Initializing benchmark...\r\n");
+
+   //Ensure the parameters are valid
+   if(context == NULL || settings == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Check settings
+   if(settings->udpPayloadSize == 0 ||
+      settings->udpPayloadSize > NET_BENCH_BUFFER_SIZE ||
+      settings->transactionSize == 0 ||
+      settings->transactionSize > NET_BENCH_BUFFER_SIZE)
+   {
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //Clear benchmark context
+   osMemset(context, 0, sizeof(NetBenchContext));
+
+   //Initialize task parameters
+   context->taskParams = settings->task;
+   context->taskId = OS_INVALID_TASK_ID;
+
+   //Save user settings
+   context->settings = *settings;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Create an event object to poll the state of sockets
+   if(!osCreateEvent(&context->event))
+   {
+      //Failed to create event
+      error = ERROR_OUT_OF_RESOURCES;
+   }
+
+   //Any error to report?
+   if(error)
+   {
+      //Clean up side effects
+      netBenchDeinit(context);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Start benchmark server
+ * @param[in] context Pointer to the benchmark context
+ * @return Error code
+ **/
+
+error_t netBenchStart(NetBenchContext *context)
+{
+   error_t error;
+
+   //Make sure the benchmark context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Debug message
+   TRACE_INFO("Starting benchmark server...\r\n");
+
+   //Make sure the benchmark server is not already running
+   if(context->running)
+      return ERROR_ALREADY_RUNNING;
+
+   //Start of exception handling block
+   do
+   {
+      //Open a TCP socket
+      context->tcpSocket = socketOpen(SOCKET_TYPE_STREAM, SOCKET_IP_PROTO_TCP);
+      //Failed to open socket?
+      if(context->tcpSocket == NULL)
+      {
+         //Report an error
+         error = ERROR_OPEN_FAILED;
+         break;
+      }
+
+      //Force the socket to operate in non-blocking mode
+      error = socketSetTimeout(context->tcpSocket, 0);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Associate the socket with the relevant interface
+      error = socketSetInterface(context->tcpSocket,
+         context->settings.interface);
+      //Any error to report?
+      if(error)
+         break;
+
+      //The server listens for TCP connection requests on the benchmark port
+      error = socketBind(context->tcpSocket, &IP_ADDR_ANY,
+         context->settings.port);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Place socket in listening state
+      error = socketListen(context->tcpSocket, 0);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Open a UDP socket
+      context->udpSocket = socketOpen(SOCKET_TYPE_DGRAM, SOCKET_IP_PROTO_UDP);
+      //Failed to open socket?
+      if(context->udpSocket == NULL)
+      {
+         //Report an error
+         error = ERROR_OPEN_FAILED;
+         break;
+      }
+
+      //Force the socket to operate in non-blocking mode
+      error = socketSetTimeout(context->udpSocket, 0);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Associate the socket with the relevant interface
+      error = socketSetInterface(context->udpSocket,
+         context->settings.interface);
+      //Any error to report?
+      if(error)
+         break;
+
+      //The server listens for UDP datagrams on the benchmark port
+      error = socketBind(context->udpSocket, &IP_ADDR_ANY,
+         context->settings.port);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Start the benchmark server
+      context->stop = FALSE;
+      context->running = TRUE;
+
+      //Create a task
+      context->taskId = osCreateTask("Benchmark", (OsTaskCode) netBenchTask,
+         context, &context->taskParams);
+
+      //Failed to create task?
+      if(context->taskId == OS_INVALID_TASK_ID)
+      {
+         //Report an error
+         error = ERROR_OUT_OF_RESOURCES;
+         break;
+      }
+
+      //End of exception handling block
+   } while(0);
+
+   //Any error to report?
+   if(error)
+   {
+      //Clean up side effects
+      context->running = FALSE;
+
+      //Close listening TCP socket
+      socketClose(context->tcpSocket);
+      context->tcpSocket = NULL;
+
+      //Close UDP socket
+      socketClose(context->udpSocket);
+      context->udpSocket = NULL;
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Stop benchmark server
+ * @param[in] context Pointer to the benchmark context
+ * @return Error code
+ **/
+
+error_t netBenchStop(NetBenchContext *context)
+{
+   //Make sure the benchmark context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Debug message
+   TRACE_INFO("Stopping benchmark server...\r\n");
+
+   //Check whether the benchmark server is running
+   if(context->running)
+   {
+      //Stop the benchmark server
+      context->stop = TRUE;
+      //Send a signal to the task to abort any blocking operation
+      osSetEvent(&context->event);
+
+      //Wait for the task to terminate
+      while(context->running)
+      {
+         osDelayTask(1);
+      }
+
+      //Close the current TCP connection
+      netBenchCloseConnection(context);
+
+      //Close listening TCP socket
+      socketClose(context->tcpSocket);
+      context->tcpSocket = NULL;
+
+      //Close UDP socket
+      socketClose(context->udpSocket);
+      context->udpSocket = NULL;
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Run the benchmark suite
+ *
+ * The benchmark server must have been started beforehand. The tests are
+ * executed sequentially from the context of the calling task
+ *
+ * @param[in] context Pointer to the benchmark context
+ * @param[out] results Benchmark results
+ * @return Error code
+ **/
+
+error_t netBenchRun(NetBenchContext *context, NetBenchResults *results)
+{
+   error_t error;
+
+   //Check parameters
+   if(context == NULL || results == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Make sure the benchmark server is running
+   if(!context->running)
+      return ERROR_WRONG_STATE;
+
+   //Clear results
+   osMemset(results, 0, sizeof(NetBenchResults));
+
+#if (NET_LOCK_PROFILING_SUPPORT == ENABLED)
+   //Only report the contention observed during the run
+   netLockResetProfiles();
+#endif
+
+   //Debug message
+   TRACE_INFO("Running benchmark...\r\n");
+
+   //Start of exception handling block
+   do
+   {
+      //Measure TCP bulk throughput
+      error = netBenchTestTcpThroughput(context, results);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Measure UDP packet rate
+      error = netBenchTestUdpRate(context, results);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Measure TCP connection setup rate
+      error = netBenchTestConnectionRate(context, results);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Measure request/response latency
+      error = netBenchTestLatency(context, results);
+      //Any error to report?
+      if(error)
+         break;
+
+      //End of exception handling block
+   } while(0);
+
+   //Retrieve the high-water mark of the memory pool
+   memPoolGetStats(&results->memPoolCurrentUsage, &results->memPoolMaxUsage,
+      &results->memPoolSize);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Format benchmark results as a JSON object
+ * @param[in] results Benchmark results
+ * @param[out] buffer Output buffer where to store the JSON string
+ * @param[in] size Size of the output buffer
+ * @return Length of the resulting string
+ **/
+
+size_t netBenchFormatResults(const NetBenchResults *results, char_t *buffer,
+   size_t size)
+{
+   int_t n;
+
+   //Check parameters
+   if(results == NULL || buffer == NULL || size == 0)
+      return 0;
+
+   //Format results as a single-line JSON object
+   n = osSnprintf(buffer, size,
+      "{\"tcp\":{\"kbytes\":%" PRIu32 ",\"throughput_kbps\":%" PRIu32 ","
+      "\"segments\":%" PRIu32 ",\"rx_segments\":%" PRIu32 ","
+      "\"rx_segment_cost\":%" PRIu32 ",\"tx_segments\":%" PRIu32 ","
+      "\"tx_segment_cost\":%" PRIu32 ","
+      "\"segment_cost_unit\":\"" NET_STATS_COST_UNIT "\"},"
+      "\"udp\":{\"tx_packets\":%" PRIu32 ",\"rx_packets\":%" PRIu32 ","
+      "\"tx_pps\":%" PRIu32 ",\"rx_pps\":%" PRIu32 "},"
+      "\"connect\":{\"count\":%" PRIu32 ",\"rate_cps\":%" PRIu32 "},"
+      "\"latency_us\":{\"count\":%" PRIu32 ",\"min\":%" PRIu32 ","
+      "\"p50\":%" PRIu32 ",\"p90\":%" PRIu32 ",\"p99\":%" PRIu32 ","
+      "\"max\":%" PRIu32 "},"
+      "\"mem_pool\":{\"current\":%u,\"max\":%u,\"size\":%u}}",
+      results->tcpKbytes, results->tcpThroughput,
+      results->tcpSegments, results->tcpRxSegments,
+      results->tcpRxSegmentCost, results->tcpTxSegments,
+      results->tcpTxSegmentCost,
+      results->udpTxPackets, results->udpRxPackets,
+      results->udpTxRate, results->udpRxRate,
+      results->connections, results->connectionRate,
+      results->transactions, results->latencyMin,
+      results->latencyP50, results->latencyP90, results->latencyP99,
+      results->latencyMax,
+      results->memPoolCurrentUsage, results->memPoolMaxUsage,
+      results->memPoolSize);
+
+#if (NET_LOCK_PROFILING_SUPPORT == ENABLED)
+   //Append the lock contention report collected during the run
+   if(n > 0 && ((size_t) n + 12) < size)
+   {
+      //Reopen the JSON object
+      n--;
+      osStrcpy(buffer + n, ",\"locks\":");
+      n += 9;
+
+      //Leave room for the closing brace
+      n += netLockFormatReport(buffer + n, size - n - 1);
+      osStrcpy(buffer + n, "}");
+      n++;
+   }
+#endif
+
+   //Check whether the output has been truncated
+   if(n < 0 || (size_t) n >= size)
+   {
+      n = size - 1;
+   }
+
+   //Return the length of the resulting string
+   return n;
+}
+
+
+/**
+ * @brief Benchmark server task
+ * @param[in] context Pointer to the benchmark context
+ **/
+
+void netBenchTask(NetBenchContext *context)
+{
+   error_t error;
+   uint_t i;
+   SocketEventDesc eventDesc[3];
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+   //Task prologue
+   osEnterTask();
+
+   //Process events
+   while(1)
+   {
+#endif
+      //Clear event descriptor set
+      osMemset(eventDesc, 0, sizeof(eventDesc));
+
+      //The server listens for TCP connection requests
+      eventDesc[0].socket = context->tcpSocket;
+      eventDesc[0].eventMask = SOCKET_EVENT_RX_READY;
+
+      //The server listens for UDP datagrams
+      eventDesc[1].socket = context->udpSocket;
+      eventDesc[1].eventMask = SOCKET_EVENT_RX_READY;
+
+      //Number of sockets to poll
+      i = 2;
+
+      //Any connection in progress?
+      if(context->connSocket != NULL)
+      {
+         eventDesc[i].socket = context->connSocket;
+         eventDesc[i++].eventMask = SOCKET_EVENT_RX_READY;
+      }
+
+      //Wait for one of the set of sockets to become ready to perform I/O
+      error = socketPoll(eventDesc, i, &context->event,
+         NET_BENCH_TICK_INTERVAL);
+
+      //Check status code
+      if(error == NO_ERROR || error == ERROR_TIMEOUT ||
+         error == ERROR_WAIT_CANCELED)
+      {
+         //Stop request?
+         if(context->stop)
+         {
+            //Stop benchmark server operation
+            context->running = FALSE;
+            //Task epilogue
+            osExitTask();
+            //Kill ourselves
+            osDeleteTask(OS_SELF_TASK_ID);
+         }
+
+         //Any data received on the current connection?
+         if(i > 2 && eventDesc[2].eventFlags != 0)
+         {
+            //Process incoming data
+            netBenchProcessConnection(context);
+         }
+
+         //Any TCP connection request received?
+         if(eventDesc[0].eventFlags != 0)
+         {
+            //Accept TCP connection request
+            netBenchAcceptConnection(context);
+         }
+
+         //Any UDP datagram received?
+         if(eventDesc[1].eventFlags != 0)
+         {
+            //Process incoming UDP datagrams
+            netBenchProcessDatagram(context);
+         }
+      }
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+   }
+#endif
+}
+
+
+/**
+ * @brief Release benchmark context
+ * @param[in] context Pointer to the benchmark context
+ **/
+
+void netBenchDeinit(NetBenchContext *context)
+{
+   //Make sure the benchmark context is valid
+   if(context != NULL)
+   {
+      //Free previously allocated resources
+      osDeleteEvent(&context->event);
+
+      //Clear benchmark context
+      osMemset(context, 0, sizeof(NetBenchContext));
+   }
+}
+
+#endif
@@ -0,0 +1,214 @@
+/**
+ * @file net_bench.h
+ * @brief Network performance benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _NET_BENCH_H
+#define _NET_BENCH_H
+
+//Dependencies
+#include "core/net.h"
+#include "core/socket.h"
+
+//Network benchmark support
+#ifndef NET_BENCH_SUPPORT
+   #define NET_BENCH_SUPPORT DISABLED
+#elif (NET_BENCH_SUPPORT != ENABLED && NET_BENCH_SUPPORT != DISABLED)
+   #error NET_BENCH_SUPPORT parameter is not valid
+#endif
+
+//Stack size required to run the benchmark server
+#ifndef NET_BENCH_STACK_SIZE
+   #define NET_BENCH_STACK_SIZE 750
+#elif (NET_BENCH_STACK_SIZE < 1)
+   #error NET_BENCH_STACK_SIZE parameter is not valid
+#endif
+
+//Priority at which the benchmark server should run
+#ifndef NET_BENCH_PRIORITY
+   #define NET_BENCH_PRIORITY OS_TASK_PRIORITY_NORMAL
+#endif
+
+//Size of the buffer for input/output operations
+#ifndef NET_BENCH_BUFFER_SIZE
+   #define NET_BENCH_BUFFER_SIZE 4096
+#elif (NET_BENCH_BUFFER_SIZE < 64)
+   #error NET_BENCH_BUFFER_SIZE parameter is not valid
+#endif
+
+//Maximum number of latency samples
+#ifndef NET_BENCH_MAX_LATENCY_SAMPLES
+   #define NET_BENCH_MAX_LATENCY_SAMPLES 1000
+#elif (NET_BENCH_MAX_LATENCY_SAMPLES < 1)
+   #error NET_BENCH_MAX_LATENCY_SAMPLES parameter is not valid
+#endif
+
+//Benchmark server tick interval
+#ifndef NET_BENCH_TICK_INTERVAL
+   #define NET_BENCH_TICK_INTERVAL 100
+#elif (NET_BENCH_TICK_INTERVAL < 10)
+   #error NET_BENCH_TICK_INTERVAL parameter is not valid
+#endif
+
+//Timeout for blocking operations
+#ifndef NET_BENCH_TIMEOUT
+   #define NET_BENCH_TIMEOUT 5000
+#elif (NET_BENCH_TIMEOUT < 100)
+   #error NET_BENCH_TIMEOUT parameter is not valid
+#endif
+
+//Host runner (provides a main function that benchmarks the loopback
+//interface and prints the results)
+#ifndef NET_BENCH_HOST_RUNNER
+   #define NET_BENCH_HOST_RUNNER DISABLED
+#elif (NET_BENCH_HOST_RUNNER != ENABLED && NET_BENCH_HOST_RUNNER != DISABLED)
+   #error NET_BENCH_HOST_RUNNER parameter is not valid
+#endif
+
+//High-resolution time source, in microseconds
+#ifndef NET_BENCH_GET_TIME_US
+   #define NET_BENCH_GET_TIME_US() netGetTimeUs()
+#endif
+
+//Default benchmark port number
+#define NET_BENCH_PORT 5201
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Benchmark connection modes
+ **/
+
+typedef enum
+{
+   NET_BENCH_MODE_NONE = 0,
+   NET_BENCH_MODE_SINK = 'S', ///<Received data is discarded
+   NET_BENCH_MODE_ECHO = 'E'  ///<Received data is sent back to the client
+} NetBenchMode;
+
+
+/**
+ * @brief Benchmark settings
+ **/
+
+typedef struct
+{
+   OsTaskParameters task;   ///<Task parameters
+   NetInterface *interface; ///<Underlying network interface
+   IpAddr serverIpAddr;     ///<IP address the client connects to
+   uint16_t port;           ///<Benchmark server port number
+   systime_t duration;      ///<Duration of the throughput tests
+   size_t udpPayloadSize;   ///<Payload size of the UDP datagrams
+   uint_t connectionCount;  ///<Number of connections for the setup rate test
+   uint_t transactionCount; ///<Number of transactions for the latency test
+   size_t transactionSize;  ///<Size of requests and responses
+} NetBenchSettings;
+
+
+/**
+ * @brief Benchmark results
+ **/
+
+typedef struct
+{
+   uint32_t tcpKbytes;          ///<Amount of data sent over TCP, in kilobytes
+   uint32_t tcpThroughput;      ///<TCP bulk throughput, in kbit/s
+   uint32_t tcpSegments;        ///<Number of full-sized TCP segments sent
+   uint32_t tcpRxSegments;      ///<Number of TCP segments processed by the receive path
+   uint32_t tcpRxSegmentCost;   ///<Average cost of tcpProcessSegment, in NET_STATS_COST_UNIT
+   uint32_t tcpTxSegments;      ///<Number of TCP segments built by the transmit path
+   uint32_t tcpTxSegmentCost;   ///<Average cost of tcpSendSegment, in NET_STATS_COST_UNIT
+   uint32_t udpTxPackets;       ///<Number of UDP datagrams sent
+   uint32_t udpRxPackets;       ///<Number of UDP datagrams received
+   uint32_t udpTxRate;          ///<UDP transmit rate, in packets/s
+   uint32_t udpRxRate;          ///<UDP receive rate, in packets/s
+   uint32_t connections;        ///<Number of connections established
+   uint32_t connectionRate;     ///<Connection setup rate, in connections/s
+   uint32_t transactions;       ///<Number of completed transactions
+   uint32_t latencyMin;         ///<Minimum round-trip latency, in microseconds
+   uint32_t latencyP50;         ///<Median round-trip latency, in microseconds
+   uint32_t latencyP90;         ///<90th percentile latency, in microseconds
+   uint32_t latencyP99;         ///<99th percentile latency, in microseconds
+   uint32_t latencyMax;         ///<Maximum round-trip latency, in microseconds
+   uint_t memPoolCurrentUsage;  ///<Number of memory pool buffers in use
+   uint_t memPoolMaxUsage;      ///<High-water mark of the memory pool
+   uint_t memPoolSize;          ///<Total number of memory pool buffers
+} NetBenchResults;
+
+
+/**
+ * @brief Benchmark context
+ **/
+
+typedef struct
+{
+   NetBenchSettings settings;                       ///<User settings
+   bool_t running;                                  ///<Operational state of the benchmark server
+   bool_t stop;                                     ///<Stop request
+   OsEvent event;                                   ///<Event object used to poll the sockets
+   OsTaskParameters taskParams;                     ///<Task parameters
+   OsTaskId taskId;                                 ///<Task identifier
+   Socket *tcpSocket;                               ///<Listening TCP socket
+   Socket *udpSocket;                               ///<UDP socket
+   Socket *connSocket;                              ///<Server side of the current TCP connection
+   NetBenchMode connMode;                           ///<Mode of the current TCP connection
+   uint32_t udpRxPackets;                           ///<Number of UDP datagrams received by the server
+   uint8_t serverBuffer[NET_BENCH_BUFFER_SIZE];     ///<Memory buffer used by the server
+   uint8_t clientBuffer[NET_BENCH_BUFFER_SIZE];     ///<Memory buffer used by the client
+   uint32_t samples[NET_BENCH_MAX_LATENCY_SAMPLES]; ///<Latency samples
+} NetBenchContext;
+
+
+//Benchmark related functions
+void netBenchGetDefaultSettings(NetBenchSettings *settings);
+
+error_t netBenchInit(NetBenchContext *context,
+   const NetBenchSettings *settings);
+
+error_t netBenchStart(NetBenchContext *context);
+error_t netBenchStop(NetBenchContext *context);
+
+error_t netBenchRun(NetBenchContext *context, NetBenchResults *results);
+
+size_t netBenchFormatResults(const NetBenchResults *results, char_t *buffer,
+   size_t size);
+
+void netBenchTask(NetBenchContext *context);
+
+void netBenchDeinit(NetBenchContext *context);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
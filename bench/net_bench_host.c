@@ -0,0 +1,152 @@
+/**
+ * @file net_bench_host.c
+ * @brief Host runner for the network benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * Minimal program that benchmarks the loopback interface on a host (for
+ * instance with the POSIX or Windows port of the RTOS abstraction layer).
+ * The TCP/IP stack is configured with a single loopback interface and the
+ * results are printed on the standard output as a JSON object. The file
+ * is only compiled when NET_BENCH_HOST_RUNNER is enabled
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NET_BENCH_TRACE_LEVEL
+
+//Dependencies
+#include <stdio.h>
+#include "core/net.h"
+#include "drivers/loopback/loopback_driver.h"
+#include "bench/net_bench.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (NET_BENCH_SUPPORT == ENABLED && NET_BENCH_HOST_RUNNER == ENABLED)
+
+//Benchmark context
+static NetBenchContext netBenchContext;
+//Buffer that holds the JSON results
+static char_t netBenchOutput[2048];
+
+
+/**
+ * @brief Host runner entry point
+ * @return Exit status
+ **/
+
+int main(void)
+{
+   error_t error;
+   NetInterface *interface;
+   NetBenchSettings settings;
+   NetBenchResults results;
+
+   //Initialize TCP/IP stack
+   error = netInit();
+   //Any error to report?
+   if(error)
+   {
+      fprintf(stderr, "Failed to initialize TCP/IP stack!\n");
+      return 1;
+   }
+
+   //Configure the first network interface as a loopback interface
+   interface = &netInterface[0];
+   netSetInterfaceName(interface, "lo");
+   netSetDriver(interface, &loopbackDriver);
+
+   //Initialize network interface
+   error = netConfigInterface(interface);
+   //Any error to report?
+   if(error)
+   {
+      fprintf(stderr, "Failed to configure interface %s!\n", interface->name);
+      return 1;
+   }
+
+#if (IPV4_SUPPORT == ENABLED)
+   //Assign the IPv4 loopback address
+   ipv4SetHostAddr(interface, IPV4_LOOPBACK_ADDR);
+   ipv4SetSubnetMask(interface, IPV4_ADDR(255, 0, 0, 0));
+#endif
+
+#if (IPV6_SUPPORT == ENABLED)
+   //Assign the IPv6 loopback address
+   ipv6SetLinkLocalAddr(interface, &IPV6_LOOPBACK_ADDR);
+#endif
+
+   //Get default settings
+   netBenchGetDefaultSettings(&settings);
+   //Bind the benchmark to the loopback interface
+   settings.interface = interface;
+
+   //Initialize benchmark
+   error = netBenchInit(&netBenchContext, &settings);
+
+   //Check status code
+   if(!error)
+   {
+      //Start benchmark server
+      error = netBenchStart(&netBenchContext);
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Run the client side of the benchmark
+      error = netBenchRun(&netBenchContext, &results);
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Print the results
+      netBenchFormatResults(&results, netBenchOutput, sizeof(netBenchOutput));
+      printf("%s\n", netBenchOutput);
+   }
+   else
+   {
+      //Debug message
+      fprintf(stderr, "Benchmark failed (error %d)!\n", error);
+   }
+
+   //Stop benchmark server
+   netBenchStop(&netBenchContext);
+   //Release resources
+   netBenchDeinit(&netBenchContext);
+
+   //Stop the loopback interface and release its queue
+   netStopInterface(interface);
+   loopbackDriverDeinit(interface);
+
+   //Return exit status
+   return error ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,608 @@
+/**
+ * @file net_bench_misc.c
+ * @brief Helper functions for network benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NET_BENCH_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "bench/net_bench.h"
+#include "bench/net_bench_misc.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (NET_BENCH_SUPPORT == ENABLED)
+
+
+/**
+ * @brief Accept connection request
+ * @param[in] context Pointer to the benchmark context
+ **/
+
+void netBenchAcceptConnection(NetBenchContext *context)
+{
+   Socket *socket;
+   IpAddr clientIpAddr;
+   uint16_t clientPort;
+
+   //Accept incoming connection
+   socket = socketAccept(context->tcpSocket, &clientIpAddr, &clientPort);
+
+   //Make sure the socket handle is valid
+   if(socket != NULL)
+   {
+      //The client runs the tests sequentially, so any previous connection
+      //is stale
+      netBenchCloseConnection(context);
+
+      //Received data is processed only when the socket is ready, so that
+      //blocking operations are limited to the echo of requests
+      socketSetTimeout(socket, NET_BENCH_TIMEOUT);
+
+      //Save socket handle
+      context->connSocket = socket;
+      //The mode is selected by the first byte sent by the client
+      context->connMode = NET_BENCH_MODE_NONE;
+   }
+}
+
+
+/**
+ * @brief Process incoming data on the current connection
+ * @param[in] context Pointer to the benchmark context
+ **/
+
+void netBenchProcessConnection(NetBenchContext *context)
+{
+   error_t error;
+   size_t n;
+   size_t offset;
+
+   //Receive as much data as possible without blocking
+   error = socketReceive(context->connSocket, context->serverBuffer,
+      NET_BENCH_BUFFER_SIZE, &n, SOCKET_FLAG_DONT_WAIT);
+
+   //Check status code
+   if(error == NO_ERROR)
+   {
+      //Point to the first byte of the data
+      offset = 0;
+
+      //Mode not yet selected?
+      if(context->connMode == NET_BENCH_MODE_NONE && n > 0)
+      {
+         //The first byte specifies the mode of the connection
+         context->connMode = (NetBenchMode) context->serverBuffer[0];
+         offset++;
+      }
+
+      //Echo mode?
+      if(context->connMode == NET_BENCH_MODE_ECHO && n > offset)
+      {
+         //Send the data back to the client immediately
+         error = socketSend(context->connSocket, context->serverBuffer + offset,
+            n - offset, NULL, SOCKET_FLAG_NO_DELAY);
+
+         //Failed to send data?
+         if(error)
+         {
+            //Close the connection
+            netBenchCloseConnection(context);
+         }
+      }
+      else
+      {
+         //Received data is discarded
+      }
+   }
+   else if(error == ERROR_END_OF_STREAM || error == ERROR_CONNECTION_RESET ||
+      error == ERROR_NOT_CONNECTED)
+   {
+      //The client has closed its side of the connection
+      netBenchCloseConnection(context);
+   }
+   else
+   {
+      //Just for sanity
+   }
+}
+
+
+/**
+ * @brief Close the current connection
+ * @param[in] context Pointer to the benchmark context
+ **/
+
+void netBenchCloseConnection(NetBenchContext *context)
+{
+   //Any connection in progress?
+   if(context->connSocket != NULL)
+   {
+      //Gracefully close the connection, so that the client does not have
+      //to wait for a retransmission of its FIN
+      socketShutdown(context->connSocket, SOCKET_SD_BOTH);
+      socketClose(context->connSocket);
+
+      //Mark the connection as closed
+      context->connSocket = NULL;
+      context->connMode = NET_BENCH_MODE_NONE;
+   }
+}
+
+
+/**
+ * @brief Process incoming UDP datagrams
+ * @param[in] context Pointer to the benchmark context
+ **/
+
+void netBenchProcessDatagram(NetBenchContext *context)
+{
+   error_t error;
+   size_t n;
+
+   //Drain the receive queue of the UDP socket
+   do
+   {
+      //Receive a datagram (non-blocking)
+      error = socketReceive(context->udpSocket, context->serverBuffer,
+         NET_BENCH_BUFFER_SIZE, &n, 0);
+
+      //Datagram successfully received?
+      if(!error)
+      {
+         context->udpRxPackets++;
+      }
+
+      //Loop until the queue is empty
+   } while(!error);
+}
+
+
+/**
+ * @brief Measure TCP bulk throughput
+ * @param[in] context Pointer to the benchmark context
+ * @param[in,out] results Benchmark results
+ * @return Error code
+ **/
+
+error_t netBenchTestTcpThroughput(NetBenchContext *context,
+   NetBenchResults *results)
+{
+   error_t error;
+   size_t n;
+   uint64_t total;
+#if (NET_STATS_SUPPORT == ENABLED)
+   NetHistogram rxCost;
+   NetHistogram txCost;
+#endif
+   systime_t time;
+   systime_t startTime;
+   size_t smss;
+   Socket *socket;
+
+   //Debug message
+   TRACE_INFO("Benchmark: TCP bulk throughput...\r\n");
+
+   //Connect to the benchmark server
+   socket = netBenchConnect(context, NET_BENCH_MODE_SINK);
+   //Failed to connect?
+   if(socket == NULL)
+      return ERROR_CONNECTION_FAILED;
+
+   //Fill the buffer with a test pattern
+   for(n = 0; n < NET_BENCH_BUFFER_SIZE; n++)
+   {
+      context->clientBuffer[n] = (uint8_t) n;
+   }
+
+   //Retrieve the sender maximum segment size negotiated for the connection
+   smss = MAX(socket->smss, 1);
+
+#if (NET_STATS_SUPPORT == ENABLED)
+   //Reset the per-segment cost histograms (they are updated by the TCP/IP
+   //stack while holding the mutex)
+   osAcquireMutex(&netMutex);
+   netHistogramReset(&netContext.statsHistograms[NET_STATS_TCP_RX_COST]);
+   netHistogramReset(&netContext.statsHistograms[NET_STATS_TCP_TX_COST]);
+   osReleaseMutex(&netMutex);
+#endif
+
+   //Initialize variables
+   total = 0;
+   startTime = osGetSystemTime();
+
+   //Send data as fast as possible for the specified duration
+   do
+   {
+      //Send a full buffer
+      n = 0;
+      error = socketSend(socket, context->clientBuffer, NET_BENCH_BUFFER_SIZE,
+         &n, 0);
+
+      //Update the number of bytes sent
+      total += n;
+
+      //Get current time
+      time = osGetSystemTime();
+
+      //Loop until the test is complete
+   } while(!error && (time - startTime) < context->settings.duration);
+
+   //The measurement includes the delivery of the last bytes
+   if(!error)
+   {
+      error = socketShutdown(socket, SOCKET_SD_BOTH);
+   }
+
+   //Get current time
+   time = osGetSystemTime() - startTime;
+
+#if (NET_STATS_SUPPORT == ENABLED)
+   //Both ends of the connection run on the same stack, so the histograms
+   //cover data segments as well as acknowledgments. The acknowledgments
+   //generated by the receive path are accounted for by the transmit path
+   netStatsGetHistogram(NULL, NET_STATS_TCP_RX_COST, &rxCost);
+   netStatsGetHistogram(NULL, NET_STATS_TCP_TX_COST, &txCost);
+#endif
+
+   //Close socket
+   socketClose(socket);
+
+   //Check status code
+   if(!error)
+   {
+      //Save results
+      results->tcpKbytes = (uint32_t) (total / 1024);
+      results->tcpThroughput = (uint32_t) ((total * 8) / MAX(time, 1));
+      results->tcpSegments = (uint32_t) (total / smss);
+#if (NET_STATS_SUPPORT == ENABLED)
+      results->tcpRxSegments = rxCost.count;
+      results->tcpRxSegmentCost = (uint32_t) (rxCost.sum / MAX(rxCost.count, 1));
+      results->tcpTxSegments = txCost.count;
+      results->tcpTxSegmentCost = (uint32_t) (txCost.sum / MAX(txCost.count, 1));
+#endif
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Measure UDP packet rate
+ * @param[in] context Pointer to the benchmark context
+ * @param[in,out] results Benchmark results
+ * @return Error code
+ **/
+
+error_t netBenchTestUdpRate(NetBenchContext *context,
+   NetBenchResults *results)
+{
+   error_t error;
+   uint32_t count;
+   systime_t time;
+   systime_t startTime;
+   Socket *socket;
+
+   //Debug message
+   TRACE_INFO("Benchmark: UDP packet rate...\r\n");
+
+   //Open a UDP socket
+   socket = socketOpen(SOCKET_TYPE_DGRAM, SOCKET_IP_PROTO_UDP);
+   //Failed to open socket?
+   if(socket == NULL)
+      return ERROR_OPEN_FAILED;
+
+   //Associate the socket with the relevant interface
+   socketSetInterface(socket, context->settings.interface);
+
+   //Fill the payload with a test pattern
+   osMemset(context->clientBuffer, 0x55, context->settings.udpPayloadSize);
+
+   //Initialize variables
+   count = 0;
+   context->udpRxPackets = 0;
+   startTime = osGetSystemTime();
+
+   //Send datagrams as fast as possible for the specified duration
+   do
+   {
+      //Send a datagram
+      error = socketSendTo(socket, &context->settings.serverIpAddr,
+         context->settings.port, context->clientBuffer,
+         context->settings.udpPayloadSize, NULL, 0);
+
+      //Datagram successfully sent?
+      if(!error)
+      {
+         count++;
+      }
+
+      //Get current time
+      time = osGetSystemTime() - startTime;
+
+      //Loop until the test is complete
+   } while(time < context->settings.duration);
+
+   //Give the server a chance to process the last datagrams
+   osDelayTask(2 * NET_BENCH_TICK_INTERVAL);
+
+   //Close socket
+   socketClose(socket);
+
+   //Save results
+   results->udpTxPackets = count;
+   results->udpRxPackets = context->udpRxPackets;
+   results->udpTxRate = (uint32_t) (((uint64_t) count * 1000) / MAX(time, 1));
+   results->udpRxRate = (uint32_t) (((uint64_t) results->udpRxPackets * 1000) /
+      MAX(time, 1));
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Measure TCP connection setup rate
+ * @param[in] context Pointer to the benchmark context
+ * @param[in,out] results Benchmark results
+ * @return Error code
+ **/
+
+error_t netBenchTestConnectionRate(NetBenchContext *context,
+   NetBenchResults *results)
+{
+   error_t error;
+   uint_t i;
+   systime_t time;
+   systime_t startTime;
+   Socket *socket;
+
+   //Debug message
+   TRACE_INFO("Benchmark: TCP connection rate...\r\n");
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Start of the measurement
+   startTime = osGetSystemTime();
+
+   //Open and close connections sequentially
+   for(i = 0; i < context->settings.connectionCount; i++)
+   {
+      //Connect to the benchmark server
+      socket = netBenchConnect(context, NET_BENCH_MODE_NONE);
+
+      //Failed to connect?
+      if(socket == NULL)
+      {
+         error = ERROR_CONNECTION_FAILED;
+         break;
+      }
+
+      //Each cycle includes the teardown of the connection
+      socketShutdown(socket, SOCKET_SD_BOTH);
+      socketClose(socket);
+   }
+
+   //End of the measurement
+   time = osGetSystemTime() - startTime;
+
+   //Save results
+   results->connections = i;
+   results->connectionRate = (uint32_t) (((uint64_t) i * 1000) /
+      MAX(time, 1));
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Measure request/response latency
+ * @param[in] context Pointer to the benchmark context
+ * @param[in,out] results Benchmark results
+ * @return Error code
+ **/
+
+error_t netBenchTestLatency(NetBenchContext *context,
+   NetBenchResults *results)
+{
+   error_t error;
+   uint_t i;
+   uint_t count;
+   uint64_t time;
+   Socket *socket;
+
+   //Debug message
+   TRACE_INFO("Benchmark: request/response latency...\r\n");
+
+   //Connect to the benchmark server
+   socket = netBenchConnect(context, NET_BENCH_MODE_ECHO);
+   //Failed to connect?
+   if(socket == NULL)
+      return ERROR_CONNECTION_FAILED;
+
+   //Limit the number of samples
+   count = MIN(context->settings.transactionCount,
+      NET_BENCH_MAX_LATENCY_SAMPLES);
+
+   //Fill the request with a test pattern
+   osMemset(context->clientBuffer, 0xAA, context->settings.transactionSize);
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Perform transactions sequentially
+   for(i = 0; i < count && !error; i++)
+   {
+      //Start of the transaction
+      time = NET_BENCH_GET_TIME_US();
+
+      //Send request
+      error = socketSend(socket, context->clientBuffer,
+         context->settings.transactionSize, NULL, SOCKET_FLAG_NO_DELAY);
+
+      //Check status code
+      if(!error)
+      {
+         //Wait for the whole response
+         error = socketReceive(socket, context->clientBuffer,
+            context->settings.transactionSize, NULL, SOCKET_FLAG_WAIT_ALL);
+      }
+
+      //Check status code
+      if(!error)
+      {
+         //Save the round-trip time
+         context->samples[i] = (uint32_t) (NET_BENCH_GET_TIME_US() - time);
+      }
+   }
+
+   //Close the connection
+   socketShutdown(socket, SOCKET_SD_BOTH);
+   socketClose(socket);
+
+   //Number of completed transactions
+   count = error ? i - 1 : i;
+
+   //Any sample collected?
+   if(count > 0)
+   {
+      //Sort samples in ascending order
+      netBenchSortSamples(context->samples, count);
+
+      //Save results
+      results->transactions = count;
+      results->latencyMin = context->samples[0];
+      results->latencyP50 = context->samples[(count - 1) * 50 / 100];
+      results->latencyP90 = context->samples[(count - 1) * 90 / 100];
+      results->latencyP99 = context->samples[(count - 1) * 99 / 100];
+      results->latencyMax = context->samples[count - 1];
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Establish a connection with the benchmark server
+ * @param[in] context Pointer to the benchmark context
+ * @param[in] mode Mode of the connection
+ * @return Socket handle or NULL if the connection failed
+ **/
+
+Socket *netBenchConnect(NetBenchContext *context, NetBenchMode mode)
+{
+   error_t error;
+   uint8_t c;
+   Socket *socket;
+
+   //Open a TCP socket
+   socket = socketOpen(SOCKET_TYPE_STREAM, SOCKET_IP_PROTO_TCP);
+   //Failed to open socket?
+   if(socket == NULL)
+      return NULL;
+
+   //Start of exception handling block
+   do
+   {
+      //Set timeout
+      error = socketSetTimeout(socket, NET_BENCH_TIMEOUT);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Associate the socket with the relevant interface
+      error = socketSetInterface(socket, context->settings.interface);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Connect to the benchmark server
+      error = socketConnect(socket, &context->settings.serverIpAddr,
+         context->settings.port);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Select the mode of the connection
+      if(mode != NET_BENCH_MODE_NONE)
+      {
+         c = (uint8_t) mode;
+         error = socketSend(socket, &c, sizeof(c), NULL, SOCKET_FLAG_NO_DELAY);
+      }
+
+      //End of exception handling block
+   } while(0);
+
+   //Any error to report?
+   if(error)
+   {
+      //Clean up side effects
+      socketClose(socket);
+      socket = NULL;
+   }
+
+   //Return socket handle
+   return socket;
+}
+
+
+/**
+ * @brief Sort latency samples in ascending order
+ * @param[in,out] samples Array of samples
+ * @param[in] count Number of samples
+ **/
+
+void netBenchSortSamples(uint32_t *samples, uint_t count)
+{
+   uint_t i;
+   uint_t j;
+   uint32_t value;
+
+   //Insertion sort (the number of samples is small)
+   for(i = 1; i < count; i++)
+   {
+      value = samples[i];
+
+      //Shift the larger samples to the right
+      for(j = i; j > 0 && samples[j - 1] > value; j--)
+      {
+         samples[j] = samples[j - 1];
+      }
+
+      //Insert the current sample
+      samples[j] = value;
+   }
+}
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @file net_bench_misc.h
+ * @brief Helper functions for network benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _NET_BENCH_MISC_H
+#define _NET_BENCH_MISC_H
+
+//Dependencies
+#include "core/net.h"
+#include "bench/net_bench.h"
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Benchmark related functions
+void netBenchAcceptConnection(NetBenchContext *context);
+void netBenchProcessConnection(NetBenchContext *context);
+void netBenchCloseConnection(NetBenchContext *context);
+void netBenchProcessDatagram(NetBenchContext *context);
+
+error_t netBenchTestTcpThroughput(NetBenchContext *context,
+   NetBenchResults *results);
+
+error_t netBenchTestUdpRate(NetBenchContext *context,
+   NetBenchResults *results);
+
+error_t netBenchTestConnectionRate(NetBenchContext *context,
+   NetBenchResults *results);
+
+error_t netBenchTestLatency(NetBenchContext *context,
+   NetBenchResults *results);
+
+Socket *netBenchConnect(NetBenchContext *context, NetBenchMode mode);
+void netBenchSortSamples(uint32_t *samples, uint_t count);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
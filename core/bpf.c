@@ -0,0 +1,520 @@
+/**
+ * @file bpf.c
+ * @brief Packet filter virtual machine (classic BPF)
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL RAW_SOCKET_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "core/bpf.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (BPF_SUPPORT == ENABLED)
+
+
+/**
+ * @brief Validate a filter program
+ *
+ * Only forward jumps exist and the last instruction must be a return, so a
+ * program that passes this check always terminates within its own length
+ *
+ * @param[in] program Filter instructions
+ * @param[in] length Number of instructions
+ * @return Error code
+ **/
+
+error_t bpfCheckProgram(const BpfInsn *program, uint_t length)
+{
+   uint_t i;
+   uint_t n;
+   bool_t valid;
+   const BpfInsn *insn;
+
+   //Check parameters
+   if(program == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Check the length of the program
+   if(length == 0 || length > BPF_MAX_INSNS)
+      return ERROR_INVALID_LENGTH;
+
+   //Check each instruction in turn
+   for(i = 0; i < length; i++)
+   {
+      //Point to the current instruction
+      insn = &program[i];
+      //Number of instructions that follow the current one
+      n = length - i - 1;
+
+      //Check instruction
+      switch(insn->code)
+      {
+      //Immediate and length loads, register transfers
+      case BPF_LD | BPF_W | BPF_IMM:
+      case BPF_LD | BPF_W | BPF_LEN:
+      case BPF_LD | BPF_W | BPF_ABS:
+      case BPF_LD | BPF_H | BPF_ABS:
+      case BPF_LD | BPF_B | BPF_ABS:
+      case BPF_LD | BPF_W | BPF_IND:
+      case BPF_LD | BPF_H | BPF_IND:
+      case BPF_LD | BPF_B | BPF_IND:
+      case BPF_LDX | BPF_W | BPF_IMM:
+      case BPF_LDX | BPF_W | BPF_LEN:
+      case BPF_LDX | BPF_B | BPF_MSH:
+      case BPF_MISC | BPF_TAX:
+      case BPF_MISC | BPF_TXA:
+      case BPF_RET | BPF_K:
+      case BPF_RET | BPF_A:
+         valid = TRUE;
+         break;
+
+      //Scratch memory accesses
+      case BPF_LD | BPF_W | BPF_MEM:
+      case BPF_LDX | BPF_W | BPF_MEM:
+      case BPF_ST:
+      case BPF_STX:
+         valid = (insn->k < BPF_MEMWORDS) ? TRUE : FALSE;
+         break;
+
+      //ALU operations
+      case BPF_ALU | BPF_ADD | BPF_K:
+      case BPF_ALU | BPF_ADD | BPF_X:
+      case BPF_ALU | BPF_SUB | BPF_K:
+      case BPF_ALU | BPF_SUB | BPF_X:
+      case BPF_ALU | BPF_MUL | BPF_K:
+      case BPF_ALU | BPF_MUL | BPF_X:
+      case BPF_ALU | BPF_DIV | BPF_X:
+      case BPF_ALU | BPF_MOD | BPF_X:
+      case BPF_ALU | BPF_OR | BPF_K:
+      case BPF_ALU | BPF_OR | BPF_X:
+      case BPF_ALU | BPF_AND | BPF_K:
+      case BPF_ALU | BPF_AND | BPF_X:
+      case BPF_ALU | BPF_XOR | BPF_K:
+      case BPF_ALU | BPF_XOR | BPF_X:
+      case BPF_ALU | BPF_LSH | BPF_X:
+      case BPF_ALU | BPF_RSH | BPF_X:
+      case BPF_ALU | BPF_NEG:
+         valid = TRUE;
+         break;
+
+      //Division by a constant
+      case BPF_ALU | BPF_DIV | BPF_K:
+      case BPF_ALU | BPF_MOD | BPF_K:
+         valid = (insn->k != 0) ? TRUE : FALSE;
+         break;
+
+      //Shift by a constant
+      case BPF_ALU | BPF_LSH | BPF_K:
+      case BPF_ALU | BPF_RSH | BPF_K:
+         valid = (insn->k < 32) ? TRUE : FALSE;
+         break;
+
+      //Unconditional jump
+      case BPF_JMP | BPF_JA:
+         valid = (insn->k < n) ? TRUE : FALSE;
+         break;
+
+      //Conditional jumps
+      case BPF_JMP | BPF_JEQ | BPF_K:
+      case BPF_JMP | BPF_JEQ | BPF_X:
+      case BPF_JMP | BPF_JGT | BPF_K:
+      case BPF_JMP | BPF_JGT | BPF_X:
+      case BPF_JMP | BPF_JGE | BPF_K:
+      case BPF_JMP | BPF_JGE | BPF_X:
+      case BPF_JMP | BPF_JSET | BPF_K:
+      case BPF_JMP | BPF_JSET | BPF_X:
+         valid = (insn->jt < n && insn->jf < n) ? TRUE : FALSE;
+         break;
+
+      //Unknown opcode
+      default:
+         valid = FALSE;
+         break;
+      }
+
+      //Invalid instruction?
+      if(!valid)
+      {
+         //Debug message
+         TRACE_WARNING("BPF: invalid instruction %u (code 0x%04" PRIX16 ")\r\n",
+            i, insn->code);
+         //Reject the program
+         return ERROR_INVALID_SYNTAX;
+      }
+   }
+
+   //The program must end with a return instruction
+   if(BPF_CLASS(program[length - 1].code) != BPF_RET)
+      return ERROR_INVALID_SYNTAX;
+
+   //The program is valid
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Run a filter program against a packet
+ * @param[in] program Filter instructions (previously validated)
+ * @param[in] interface Network interface where the packet was received
+ * @param[in] buffer Multi-part buffer containing the packet
+ * @param[in] offset Offset to the first byte of the packet
+ * @param[in] length Length of the packet, in bytes
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @return Number of bytes to capture (0 means the packet is rejected)
+ **/
+
+size_t bpfRunProgram(const BpfInsn *program, NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, size_t length,
+   const NetRxAncillary *ancillary)
+{
+   uint_t pc;
+   uint32_t a;
+   uint32_t x;
+   uint32_t v;
+   uint32_t mem[BPF_MEMWORDS];
+   const BpfInsn *insn;
+
+   //Initialize registers
+   a = 0;
+   x = 0;
+   osMemset(mem, 0, sizeof(mem));
+
+   //The program has been validated, so it always reaches a return instruction
+   for(pc = 0; ; pc++)
+   {
+      //Point to the current instruction
+      insn = &program[pc];
+
+      //Execute instruction
+      switch(insn->code)
+      {
+      //Load word, half-word or byte at a fixed offset
+      case BPF_LD | BPF_W | BPF_ABS:
+      case BPF_LD | BPF_H | BPF_ABS:
+      case BPF_LD | BPF_B | BPF_ABS:
+         //Ancillary data or packet data?
+         if(insn->k >= (uint32_t) SKF_AD_OFF)
+         {
+            if(!bpfLoadAncillary(interface, ancillary,
+               insn->k - (uint32_t) SKF_AD_OFF, &a))
+            {
+               return 0;
+            }
+         }
+         else
+         {
+            //Out-of-bounds accesses reject the packet
+            if(!bpfLoad(buffer, offset, length, insn->k,
+               4 >> (BPF_SIZE(insn->code) >> 3), &a))
+            {
+               return 0;
+            }
+         }
+         break;
+
+      //Load word, half-word or byte at an offset relative to X
+      case BPF_LD | BPF_W | BPF_IND:
+      case BPF_LD | BPF_H | BPF_IND:
+      case BPF_LD | BPF_B | BPF_IND:
+         //Out-of-bounds accesses reject the packet
+         if(!bpfLoad(buffer, offset, length, x + insn->k,
+            4 >> (BPF_SIZE(insn->code) >> 3), &a))
+         {
+            return 0;
+         }
+         break;
+
+      //Load packet length
+      case BPF_LD | BPF_W | BPF_LEN:
+         a = (uint32_t) length;
+         break;
+      case BPF_LDX | BPF_W | BPF_LEN:
+         x = (uint32_t) length;
+         break;
+
+      //Load immediate value
+      case BPF_LD | BPF_W | BPF_IMM:
+         a = insn->k;
+         break;
+      case BPF_LDX | BPF_W | BPF_IMM:
+         x = insn->k;
+         break;
+
+      //Load from scratch memory
+      case BPF_LD | BPF_W | BPF_MEM:
+         a = mem[insn->k];
+         break;
+      case BPF_LDX | BPF_W | BPF_MEM:
+         x = mem[insn->k];
+         break;
+
+      //Load IPv4 header length
+      case BPF_LDX | BPF_B | BPF_MSH:
+         //Out-of-bounds accesses reject the packet
+         if(!bpfLoad(buffer, offset, length, insn->k, 1, &v))
+            return 0;
+
+         //The IHL field is expressed in 32-bit words
+         x = (v & 0x0F) << 2;
+         break;
+
+      //Store to scratch memory
+      case BPF_ST:
+         mem[insn->k] = a;
+         break;
+      case BPF_STX:
+         mem[insn->k] = x;
+         break;
+
+      //ALU operations
+      case BPF_ALU | BPF_ADD | BPF_K:
+         a += insn->k;
+         break;
+      case BPF_ALU | BPF_ADD | BPF_X:
+         a += x;
+         break;
+      case BPF_ALU | BPF_SUB | BPF_K:
+         a -= insn->k;
+         break;
+      case BPF_ALU | BPF_SUB | BPF_X:
+         a -= x;
+         break;
+      case BPF_ALU | BPF_MUL | BPF_K:
+         a *= insn->k;
+         break;
+      case BPF_ALU | BPF_MUL | BPF_X:
+         a *= x;
+         break;
+      case BPF_ALU | BPF_DIV | BPF_K:
+         a /= insn->k;
+         break;
+      case BPF_ALU | BPF_DIV | BPF_X:
+         //Division by zero rejects the packet
+         if(x == 0)
+            return 0;
+         a /= x;
+         break;
+      case BPF_ALU | BPF_MOD | BPF_K:
+         a %= insn->k;
+         break;
+      case BPF_ALU | BPF_MOD | BPF_X:
+         //Division by zero rejects the packet
+         if(x == 0)
+            return 0;
+         a %= x;
+         break;
+      case BPF_ALU | BPF_OR | BPF_K:
+         a |= insn->k;
+         break;
+      case BPF_ALU | BPF_OR | BPF_X:
+         a |= x;
+         break;
+      case BPF_ALU | BPF_AND | BPF_K:
+         a &= insn->k;
+         break;
+      case BPF_ALU | BPF_AND | BPF_X:
+         a &= x;
+         break;
+      case BPF_ALU | BPF_XOR | BPF_K:
+         a ^= insn->k;
+         break;
+      case BPF_ALU | BPF_XOR | BPF_X:
+         a ^= x;
+         break;
+      case BPF_ALU | BPF_LSH | BPF_K:
+         a <<= insn->k;
+         break;
+      case BPF_ALU | BPF_LSH | BPF_X:
+         a = (x < 32) ? (a << x) : 0;
+         break;
+      case BPF_ALU | BPF_RSH | BPF_K:
+         a >>= insn->k;
+         break;
+      case BPF_ALU | BPF_RSH | BPF_X:
+         a = (x < 32) ? (a >> x) : 0;
+         break;
+      case BPF_ALU | BPF_NEG:
+         a = (uint32_t) -(int32_t) a;
+         break;
+
+      //Jumps
+      case BPF_JMP | BPF_JA:
+         pc += insn->k;
+         break;
+      case BPF_JMP | BPF_JEQ | BPF_K:
+         pc += (a == insn->k) ? insn->jt : insn->jf;
+         break;
+      case BPF_JMP | BPF_JEQ | BPF_X:
+         pc += (a == x) ? insn->jt : insn->jf;
+         break;
+      case BPF_JMP | BPF_JGT | BPF_K:
+         pc += (a > insn->k) ? insn->jt : insn->jf;
+         break;
+      case BPF_JMP | BPF_JGT | BPF_X:
+         pc += (a > x) ? insn->jt : insn->jf;
+         break;
+      case BPF_JMP | BPF_JGE | BPF_K:
+         pc += (a >= insn->k) ? insn->jt : insn->jf;
+         break;
+      case BPF_JMP | BPF_JGE | BPF_X:
+         pc += (a >= x) ? insn->jt : insn->jf;
+         break;
+      case BPF_JMP | BPF_JSET | BPF_K:
+         pc += ((a & insn->k) != 0) ? insn->jt : insn->jf;
+         break;
+      case BPF_JMP | BPF_JSET | BPF_X:
+         pc += ((a & x) != 0) ? insn->jt : insn->jf;
+         break;
+
+      //Register transfers
+      case BPF_MISC | BPF_TAX:
+         x = a;
+         break;
+      case BPF_MISC | BPF_TXA:
+         a = x;
+         break;
+
+      //Return
+      case BPF_RET | BPF_K:
+         return insn->k;
+      case BPF_RET | BPF_A:
+         return a;
+
+      //Unknown opcode
+      default:
+         //This should never occur as the program has been validated
+         return 0;
+      }
+   }
+}
+
+
+/**
+ * @brief Load a big-endian value from the packet
+ * @param[in] buffer Multi-part buffer containing the packet
+ * @param[in] offset Offset to the first byte of the packet
+ * @param[in] length Length of the packet, in bytes
+ * @param[in] k Offset of the value within the packet
+ * @param[in] size Size of the value (1, 2 or 4 bytes)
+ * @param[out] value Value read from the packet
+ * @return TRUE if the value lies within the packet, else FALSE
+ **/
+
+bool_t bpfLoad(const NetBuffer *buffer, size_t offset, size_t length,
+   uint32_t k, uint_t size, uint32_t *value)
+{
+   uint8_t temp[4];
+
+   //Out-of-bounds access?
+   if(k > length || size > (length - k))
+      return FALSE;
+
+   //The value may straddle two chunks
+   netBufferRead(temp, buffer, offset + k, size);
+
+   //Convert the value to host byte order
+   if(size == 4)
+   {
+      *value = LOAD32BE(temp);
+   }
+   else if(size == 2)
+   {
+      *value = LOAD16BE(temp);
+   }
+   else
+   {
+      *value = temp[0];
+   }
+
+   //Successful processing
+   return TRUE;
+}
+
+
+/**
+ * @brief Load ancillary data
+ * @param[in] interface Network interface where the packet was received
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @param[in] k Offset of the ancillary data, relative to SKF_AD_OFF
+ * @param[out] value Ancillary data
+ * @return TRUE if the ancillary data is available, else FALSE
+ **/
+
+bool_t bpfLoadAncillary(NetInterface *interface,
+   const NetRxAncillary *ancillary, uint32_t k, uint32_t *value)
+{
+   bool_t valid;
+
+   //Initialize flag
+   valid = TRUE;
+
+   //Check the requested ancillary data
+   if(k == SKF_AD_IFINDEX)
+   {
+      //Index of the interface where the packet was received
+      *value = interface->index;
+   }
+#if (ETH_SUPPORT == ENABLED)
+   else if(k == SKF_AD_PROTOCOL)
+   {
+      //Value of the EtherType field
+      *value = ancillary->ethType;
+   }
+   else if(k == SKF_AD_PKTTYPE)
+   {
+      //Check the destination MAC address
+      if(macCompAddr(&ancillary->destMacAddr, &MAC_BROADCAST_ADDR))
+      {
+         *value = BPF_PKTTYPE_BROADCAST;
+      }
+      else if(macIsMulticastAddr(&ancillary->destMacAddr))
+      {
+         *value = BPF_PKTTYPE_MULTICAST;
+      }
+      else
+      {
+         *value = BPF_PKTTYPE_HOST;
+      }
+   }
+#endif
+   else
+   {
+      //Unknown ancillary data
+      valid = FALSE;
+   }
+
+   //Return TRUE if the ancillary data is available
+   return valid;
+}
+
+#endif
@@ -0,0 +1,161 @@
+/**
+ * @file bpf.h
+ * @brief Packet filter virtual machine (classic BPF)
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _BPF_H
+#define _BPF_H
+
+//Dependencies
+#include "core/net.h"
+
+//Packet filter support
+#ifndef BPF_SUPPORT
+   #define BPF_SUPPORT DISABLED
+#elif (BPF_SUPPORT != ENABLED && BPF_SUPPORT != DISABLED)
+   #error BPF_SUPPORT parameter is not valid
+#endif
+
+//Maximum number of instructions in a filter program
+#ifndef BPF_MAX_INSNS
+   #define BPF_MAX_INSNS 64
+#elif (BPF_MAX_INSNS < 1 || BPF_MAX_INSNS > 4096)
+   #error BPF_MAX_INSNS parameter is not valid
+#endif
+
+//Size of the scratch memory, in words
+#define BPF_MEMWORDS 16
+
+//Instruction classes
+#define BPF_CLASS(code) ((code) & 0x07)
+#define BPF_LD   0x00
+#define BPF_LDX  0x01
+#define BPF_ST   0x02
+#define BPF_STX  0x03
+#define BPF_ALU  0x04
+#define BPF_JMP  0x05
+#define BPF_RET  0x06
+#define BPF_MISC 0x07
+
+//Load/store sizes
+#define BPF_SIZE(code) ((code) & 0x18)
+#define BPF_W 0x00
+#define BPF_H 0x08
+#define BPF_B 0x10
+
+//Load/store addressing modes
+#define BPF_MODE(code) ((code) & 0xE0)
+#define BPF_IMM 0x00
+#define BPF_ABS 0x20
+#define BPF_IND 0x40
+#define BPF_MEM 0x60
+#define BPF_LEN 0x80
+#define BPF_MSH 0xA0
+
+//ALU and jump operations
+#define BPF_OP(code) ((code) & 0xF0)
+#define BPF_ADD  0x00
+#define BPF_SUB  0x10
+#define BPF_MUL  0x20
+#define BPF_DIV  0x30
+#define BPF_OR   0x40
+#define BPF_AND  0x50
+#define BPF_LSH  0x60
+#define BPF_RSH  0x70
+#define BPF_NEG  0x80
+#define BPF_MOD  0x90
+#define BPF_XOR  0xA0
+#define BPF_JA   0x00
+#define BPF_JEQ  0x10
+#define BPF_JGT  0x20
+#define BPF_JGE  0x30
+#define BPF_JSET 0x40
+
+//Operand source
+#define BPF_SRC(code) ((code) & 0x08)
+#define BPF_K 0x00
+#define BPF_X 0x08
+
+//Return value source
+#define BPF_RVAL(code) ((code) & 0x18)
+#define BPF_A 0x10
+
+//Miscellaneous operations
+#define BPF_MISCOP(code) ((code) & 0xF8)
+#define BPF_TAX 0x00
+#define BPF_TXA 0x80
+
+//Ancillary data accessible through absolute loads
+#define SKF_AD_OFF      (-0x1000)
+#define SKF_AD_PROTOCOL 0
+#define SKF_AD_PKTTYPE  4
+#define SKF_AD_IFINDEX  8
+
+//Packet types reported by SKF_AD_PKTTYPE
+#define BPF_PKTTYPE_HOST      0
+#define BPF_PKTTYPE_BROADCAST 1
+#define BPF_PKTTYPE_MULTICAST 2
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Filter instruction
+ **/
+
+typedef struct
+{
+   uint16_t code; ///<Opcode
+   uint8_t jt;    ///<Jump offset if the condition is true
+   uint8_t jf;    ///<Jump offset if the condition is false
+   uint32_t k;    ///<Generic field
+} BpfInsn;
+
+
+//Packet filter related functions
+error_t bpfCheckProgram(const BpfInsn *program, uint_t length);
+
+size_t bpfRunProgram(const BpfInsn *program, NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, size_t length,
+   const NetRxAncillary *ancillary);
+
+bool_t bpfLoad(const NetBuffer *buffer, size_t offset, size_t length,
+   uint32_t k, uint_t size, uint32_t *value);
+
+bool_t bpfLoadAncillary(NetInterface *interface,
+   const NetRxAncillary *ancillary, uint32_t k, uint32_t *value);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -52,6 +52,11 @@ const struct in6_addr in6addr_any =
 const struct in6_addr in6addr_loopback =
    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01}};
 
+#if (BSD_SOCKET_MAX_EPOLL_INSTANCES > 0 && NET_MULTI_INSTANCE_SUPPORT == DISABLED)
+//BSD socket layer state (epoll instances)
+static BsdSocketContext bsdSocketContext;
+#endif
+
 
 /**
  * @brief Create a socket that is bound to a specific transport service provider
@@ -112,13 +117,13 @@ int_t bind(int_t s, const struct sockaddr *addr, socklen_t addrlen)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Check the length of the address
    if(addrlen < (socklen_t) sizeof(SOCKADDR))
@@ -209,13 +214,13 @@ int_t connect(int_t s, const struct sockaddr *addr, socklen_t addrlen)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Check the length of the address
    if(addrlen < (socklen_t) sizeof(SOCKADDR))
@@ -325,13 +330,13 @@ int_t listen(int_t s, int_t backlog)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Place the socket in the listening state
    error = socketListen(sock, backlog);
@@ -365,13 +370,13 @@ int_t accept(int_t s, struct sockaddr *addr, socklen_t *addrlen)
    Socket *newSock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Permit an incoming connection attempt on a socket
    newSock = socketAccept(sock, &ipAddr, &port);
@@ -464,13 +469,13 @@ int_t send(int_t s, const void *data, size_t length, int_t flags)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //The flags parameter can be used to influence the behavior of the function
    socketFlags = 0;
@@ -543,13 +548,13 @@ int_t sendto(int_t s, const void *data, size_t length, int_t flags,
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //The flags parameter can be used to influence the behavior of the function
    socketFlags = 0;
@@ -664,211 +669,94 @@ int_t sendmsg(int_t s, struct msghdr *msg, int_t flags)
    uint_t socketFlags;
    Socket *sock;
    SocketMsg message;
-   SOCKADDR *addr;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
-   //Check parameters
-   if(msg == NULL || msg->msg_iov == NULL || msg->msg_iovlen != 1)
+   //Convert the message header to a message descriptor
+   error = socketParseMsgHeader(msg, &message);
+
+   //Invalid message header?
+   if(error)
    {
-      socketSetErrnoCode(sock, EINVAL);
+      socketTranslateErrorCode(sock, error);
       return SOCKET_ERROR;
    }
 
-   //Point to the message to be transmitted
-   message = SOCKET_DEFAULT_MSG;
-   message.data = msg->msg_iov[0].iov_base;
-   message.length = msg->msg_iov[0].iov_len;
+   //The flags parameter can be used to influence the behavior of the function
+   socketFlags = 0;
 
-   //Check the length of the address
-   if(msg->msg_namelen < (socklen_t) sizeof(SOCKADDR))
+   //The MSG_DONTROUTE flag specifies that the data should not be subject
+   //to routing
+   if((flags & MSG_DONTROUTE) != 0)
    {
-      //Report an error
-      socketSetErrnoCode(sock, EINVAL);
-      return SOCKET_ERROR;
+      socketFlags |= SOCKET_FLAG_DONT_ROUTE;
    }
 
-   //Point to the destination address
-   addr = (SOCKADDR *) msg->msg_name;
-
-#if (IPV4_SUPPORT == ENABLED)
-   //IPv4 address?
-   if(addr->sa_family == AF_INET &&
-      msg->msg_namelen >= (socklen_t) sizeof(SOCKADDR_IN))
+   //The TCP_NODELAY option disables the Nagle algorithm for TCP sockets
+   if((sock->options & SOCKET_OPTION_TCP_NO_DELAY) != 0)
    {
-      //Point to the IPv4 address information
-      SOCKADDR_IN *sa = (SOCKADDR_IN *) addr;
-
-      //Get port number
-      message.destPort = ntohs(sa->sin_port);
-
-      //Copy IPv4 address
-      message.destIpAddr.length = sizeof(Ipv4Addr);
-      message.destIpAddr.ipv4Addr = sa->sin_addr.s_addr;
+      socketFlags |= SOCKET_FLAG_NO_DELAY;
    }
-   else
-#endif
-#if (IPV6_SUPPORT == ENABLED)
-   //IPv6 address?
-   if(addr->sa_family == AF_INET6 &&
-      msg->msg_namelen >= (socklen_t) sizeof(SOCKADDR_IN6))
-   {
-      //Point to the IPv6 address information
-      SOCKADDR_IN6 *sa = (SOCKADDR_IN6 *) addr;
 
-      //Get port number
-      message.destPort = ntohs(sa->sin6_port);
+   //Send message
+   error = socketSendMsg(sock, &message, socketFlags);
 
-      //Copy IPv6 address
-      message.destIpAddr.length = sizeof(Ipv6Addr);
-      ipv6CopyAddr(&message.destIpAddr.ipv6Addr, sa->sin6_addr.s6_addr);
-   }
-   else
-#endif
-   //Invalid address?
+   //Any error to report?
+   if(error != NO_ERROR)
    {
-      //Report an error
-      socketSetErrnoCode(sock, EINVAL);
+      //Otherwise, a value of SOCKET_ERROR is returned
+      socketTranslateErrorCode(sock, error);
       return SOCKET_ERROR;
    }
 
-   //The ancillary data buffer parameter is optional
-   if(msg->msg_control != NULL)
-   {
-      uint_t n;
-      int_t *val;
-      CMSGHDR *cmsg;
+   //Return the number of bytes transferred so far
+   return message.length;
+}
 
-      //Point to the first control message
-      n = 0;
 
-      //Loop through control messages
-      while((n + sizeof(CMSGHDR)) <= msg->msg_controllen)
-      {
-         //Point to the ancillary data header
-         cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+/**
+ * @brief Send multiple messages
+ * @param[in] s Descriptor that identifies a socket
+ * @param[in,out] msgvec Array of structures describing the messages
+ * @param[in] vlen Number of entries in the array
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @return If no error occurs, sendmmsg returns the number of messages sent
+ *   from the array. The msg_len field of each message is updated with the
+ *   number of bytes sent. Otherwise, a value of SOCKET_ERROR is returned
+ **/
 
-         //Check the length of the control message
-         if(cmsg->cmsg_len >= sizeof(CMSGHDR) &&
-            cmsg->cmsg_len <= (msg->msg_controllen - n))
-         {
-#if (IPV4_SUPPORT == ENABLED)
-            //IPv4 protocol?
-            if(addr->sa_family == AF_INET && cmsg->cmsg_level == IPPROTO_IP)
-            {
-               //Check control message type
-               if(cmsg->cmsg_type == IP_PKTINFO &&
-                  cmsg->cmsg_len >= CMSG_LEN(sizeof(IN_PKTINFO)))
-               {
-                  //Point to the ancillary data value
-                  IN_PKTINFO *pktInfo = (IN_PKTINFO *) CMSG_DATA(cmsg);
-
-                  //Specify source IPv4 address
-                  message.srcIpAddr.length = sizeof(Ipv4Addr);
-                  message.srcIpAddr.ipv4Addr = pktInfo->ipi_addr.s_addr;
-               }
-               else if(cmsg->cmsg_type == IP_TOS &&
-                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
-               {
-                  //Point to the ancillary data value
-                  val = (int_t *) CMSG_DATA(cmsg);
-                  //Specify ToS value
-                  message.tos = (uint8_t) *val;
-               }
-               else if(cmsg->cmsg_type == IP_TTL &&
-                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
-               {
-                  //Point to the ancillary data value
-                  val = (int_t *) CMSG_DATA(cmsg);
-                  //Specify TTL value
-                  message.ttl = (uint8_t) *val;
-               }
-               else if(cmsg->cmsg_type == IP_DONTFRAG &&
-                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
-               {
-                  //Point to the ancillary data value
-                  val = (int_t *) CMSG_DATA(cmsg);
-
-                  //This option can be used to set the "don't fragment" flag
-                  //on IP packets
-                  message.dontFrag = (*val != 0) ? TRUE : FALSE;
-               }
-               else
-               {
-                  //Unknown control message type
-               }
-            }
-            else
-#endif
-#if (IPV6_SUPPORT == ENABLED)
-            //IPv6 protocol?
-            if(addr->sa_family == AF_INET6 && cmsg->cmsg_level == IPPROTO_IPV6)
-            {
-               //Check control message type
-               if(cmsg->cmsg_type == IPV6_PKTINFO &&
-                  cmsg->cmsg_len >= CMSG_LEN(sizeof(IN_PKTINFO)))
-               {
-                  //Point to the ancillary data value
-                  IN6_PKTINFO *pktInfo = (IN6_PKTINFO *) CMSG_DATA(cmsg);
-
-                  //Specify source IPv6 address
-                  message.srcIpAddr.length = sizeof(Ipv6Addr);
-                  ipv6CopyAddr(&message.srcIpAddr.ipv6Addr, pktInfo->ipi6_addr.s6_addr);
-               }
-               else if(cmsg->cmsg_type == IPV6_TCLASS &&
-                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
-               {
-                  //Point to the ancillary data value
-                  val = (int_t *) CMSG_DATA(cmsg);
-                  //Specify Traffic Class value
-                  message.tos = (uint8_t) *val;
-               }
-               else if(cmsg->cmsg_type == IPV6_HOPLIMIT &&
-                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
-               {
-                  //Point to the ancillary data value
-                  val = (int_t *) CMSG_DATA(cmsg);
-                  //Specify Hop Limit value
-                  message.ttl = (uint8_t) *val;
-               }
-               else if(cmsg->cmsg_type == IPV6_DONTFRAG &&
-                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
-               {
-                  //Point to the ancillary data value
-                  val = (int_t *) CMSG_DATA(cmsg);
-
-                  //This option be used to turn off the automatic inserting
-                  //of a fragment header for UDP and raw sockets
-                  message.dontFrag = (*val != 0) ? TRUE : FALSE;
-               }
-               else
-               {
-                  //Unknown control message type
-               }
-            }
-            //Unknown protocol?
-            else
-#endif
-            {
-               //Discard control message
-            }
+int_t sendmmsg(int_t s, struct mmsghdr *msgvec, uint_t vlen, int_t flags)
+{
+   error_t error;
+   uint_t i;
+   uint_t n;
+   uint_t k;
+   uint_t count;
+   uint_t socketFlags;
+   Socket *sock;
+   SocketMsg messages[BSD_SOCKET_MAX_BATCH_SIZE];
 
-            //Next control message
-            n += cmsg->cmsg_len;
-         }
-         else
-         {
-            //Malformed control message
-            break;
-         }
-      }
+   //Make sure the socket descriptor is valid
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
+   {
+      return SOCKET_ERROR;
+   }
+
+   //Point to the socket structure
+   sock = socketTable[s];
+
+   //Check parameters
+   if(msgvec == NULL || vlen == 0)
+   {
+      socketSetErrnoCode(sock, EINVAL);
+      return SOCKET_ERROR;
    }
 
    //The flags parameter can be used to influence the behavior of the function
@@ -881,25 +769,64 @@ int_t sendmsg(int_t s, struct msghdr *msg, int_t flags)
       socketFlags |= SOCKET_FLAG_DONT_ROUTE;
    }
 
-   //The TCP_NODELAY option disables the Nagle algorithm for TCP sockets
-   if((sock->options & SOCKET_OPTION_TCP_NO_DELAY) != 0)
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Send the messages by batches
+   for(n = 0; n < vlen && !error; n += k)
    {
-      socketFlags |= SOCKET_FLAG_NO_DELAY;
-   }
+      //Limit the number of messages processed at a time
+      count = MIN(vlen - n, BSD_SOCKET_MAX_BATCH_SIZE);
 
-   //Send message
-   error = socketSendMsg(sock, &message, socketFlags);
+      //Convert the message headers to message descriptors
+      for(i = 0; i < count && !error; i++)
+      {
+         error = socketParseMsgHeader(&msgvec[n + i].msg_hdr, &messages[i]);
+      }
 
-   //Any error to report?
-   if(error != NO_ERROR)
+      //Malformed message header?
+      if(error)
+      {
+         //Send the messages that precede the malformed one
+         count = i - 1;
+      }
+
+      //Any message to send?
+      if(count > 0)
+      {
+         //Send the current batch
+         error = socketSendMsgBatch(sock, messages, count, &k, socketFlags);
+
+         //Return the number of bytes sent for each message
+         for(i = 0; i < k; i++)
+         {
+            msgvec[n + i].msg_len = messages[i].length;
+         }
+
+         //Partial batch?
+         if(!error && k < count)
+         {
+            //Report an error
+            error = ERROR_FAILURE;
+         }
+      }
+      else
+      {
+         //No message has been sent
+         k = 0;
+      }
+   }
+
+   //Check whether at least one message has been sent
+   if(n == 0)
    {
       //Otherwise, a value of SOCKET_ERROR is returned
       socketTranslateErrorCode(sock, error);
       return SOCKET_ERROR;
    }
 
-   //Return the number of bytes transferred so far
-   return message.length;
+   //Return the number of messages sent
+   return n;
 }
 
 
@@ -922,13 +849,13 @@ int_t recv(int_t s, void *data, size_t size, int_t flags)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //The flags parameter can be used to influence the behavior of the function
    socketFlags = 0;
@@ -997,13 +924,13 @@ int_t recvfrom(int_t s, void *data, size_t size, int_t flags,
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //The flags parameter can be used to influence the behavior of the function
    socketFlags = 0;
@@ -1115,19 +1042,18 @@ int_t recvfrom(int_t s, void *data, size_t size, int_t flags,
 int_t recvmsg(int_t s, struct msghdr *msg, int_t flags)
 {
    error_t error;
-   size_t n;
    uint_t socketFlags;
    Socket *sock;
    SocketMsg message;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Check parameters
    if(msg == NULL || msg->msg_iov == NULL || msg->msg_iovlen != 1)
@@ -1174,293 +1100,159 @@ int_t recvmsg(int_t s, struct msghdr *msg, int_t flags)
       return SOCKET_ERROR;
    }
 
-   //The source address parameter is optional
-   if(msg->msg_name != NULL)
-   {
-#if (IPV4_SUPPORT == ENABLED)
-      //IPv4 address?
-      if(message.srcIpAddr.length == sizeof(Ipv4Addr) &&
-         msg->msg_namelen >= (socklen_t) sizeof(SOCKADDR_IN))
-      {
-         //Point to the IPv4 address information
-         SOCKADDR_IN *sa = (SOCKADDR_IN *) msg->msg_name;
+   //Return the source address and the ancillary data to the caller
+   error = socketFormatMsgHeader(sock, &message, msg);
 
-         //Set address family and port number
-         sa->sin_family = AF_INET;
-         sa->sin_port = htons(message.srcPort);
+   //Any error to report?
+   if(error)
+   {
+      socketTranslateErrorCode(sock, error);
+      return SOCKET_ERROR;
+   }
 
-         //Copy IPv4 address
-         sa->sin_addr.s_addr = message.srcIpAddr.ipv4Addr;
+   //Return the number of bytes received
+   return message.length;
+}
 
-         //Return the actual length of the address
-         msg->msg_namelen = sizeof(SOCKADDR_IN);
-      }
-      else
-#endif
-#if (IPV6_SUPPORT == ENABLED)
-      //IPv6 address?
-      if(message.srcIpAddr.length == sizeof(Ipv6Addr) &&
-         msg->msg_namelen >= (socklen_t) sizeof(SOCKADDR_IN6))
-      {
-         //Point to the IPv6 address information
-         SOCKADDR_IN6 *sa = (SOCKADDR_IN6 *) msg->msg_name;
 
-         //Set address family and port number
-         sa->sin6_family = AF_INET6;
-         sa->sin6_port = htons(message.srcPort);
-         sa->sin6_flowinfo = 0;
-         sa->sin6_scope_id = 0;
+/**
+ * @brief Receive multiple messages
+ *
+ * The call blocks until the first message is received, according to the
+ * flags and the receive timeout of the socket. The messages already queued
+ * are then returned without waiting
+ *
+ * @param[in] s Descriptor that identifies a socket
+ * @param[in,out] msgvec Array of structures describing the messages
+ * @param[in] vlen Number of entries in the array
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @param[in] timeout Zero timeout to request non-blocking operation (optional)
+ * @return If no error occurs, recvmmsg returns the number of messages
+ *   received. The msg_len field of each message is updated with the number
+ *   of bytes received. Otherwise, a value of SOCKET_ERROR is returned
+ **/
 
-         //Copy IPv6 address
-         ipv6CopyAddr(sa->sin6_addr.s6_addr, &message.srcIpAddr.ipv6Addr);
+int_t recvmmsg(int_t s, struct mmsghdr *msgvec, uint_t vlen, int_t flags,
+   struct timeval *timeout)
+{
+   error_t error;
+   uint_t i;
+   uint_t n;
+   uint_t k;
+   uint_t count;
+   uint_t socketFlags;
+   Socket *sock;
+   struct msghdr *msg;
+   SocketMsg messages[BSD_SOCKET_MAX_BATCH_SIZE];
 
-         //Return the actual length of the address
-         msg->msg_namelen = sizeof(SOCKADDR_IN6);
-      }
-      else
-#endif
-      //Invalid address?
-      {
-         //Report an error
-         socketSetErrnoCode(sock, EINVAL);
-         return SOCKET_ERROR;
-      }
-   }
-   else
+   //Make sure the socket descriptor is valid
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
-      msg->msg_namelen = 0;
+      return SOCKET_ERROR;
    }
 
-   //Clear flags
-   msg->msg_flags = 0;
-
-   //Length of the ancillary data buffer
-   n = 0;
+   //Point to the socket structure
+   sock = socketTable[s];
 
-   //The ancillary data buffer parameter is optional
-   if(msg->msg_control != NULL)
+   //Check parameters
+   if(msgvec == NULL || vlen == 0)
    {
-#if (IPV4_SUPPORT == ENABLED)
-      //IPv4 address?
-      if(message.destIpAddr.length == sizeof(Ipv4Addr))
-      {
-         int_t *val;
-         CMSGHDR *cmsg;
-         IN_PKTINFO *pktInfo;
-
-         //The IP_PKTINFO option allows an application to enable or disable
-         //the return of IPv4 packet information
-         if((sock->options & SOCKET_OPTION_IPV4_PKT_INFO) != 0)
-         {
-            //Make sure there is enough room to add the control message
-            if((n + CMSG_SPACE(sizeof(IN_PKTINFO))) <= msg->msg_controllen)
-            {
-               //Point to the ancillary data header
-               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
-
-               //Format ancillary data header
-               cmsg->cmsg_len = CMSG_LEN(sizeof(IN_PKTINFO));
-               cmsg->cmsg_level = IPPROTO_IP;
-               cmsg->cmsg_type = IP_PKTINFO;
-
-               //Point to the ancillary data value
-               pktInfo = (IN_PKTINFO *) CMSG_DATA(cmsg);
-
-               //Format packet information
-               pktInfo->ipi_ifindex = message.interface->index;
-               pktInfo->ipi_addr.s_addr = message.destIpAddr.ipv4Addr;
+      socketSetErrnoCode(sock, EINVAL);
+      return SOCKET_ERROR;
+   }
 
-               //Adjust the actual length of the ancillary data buffer
-               n += CMSG_SPACE(sizeof(IN_PKTINFO));
-            }
-            else
-            {
-               //When the control message buffer is too short to store all
-               //messages, the MSG_CTRUNC flag must be set
-               msg->msg_flags |= MSG_CTRUNC;
-            }
-         }
+   //Each message must describe a single receive buffer
+   for(i = 0; i < vlen; i++)
+   {
+      //Point to the current message header
+      msg = &msgvec[i].msg_hdr;
 
-         //The IP_RECVTOS option allows an application to enable or disable
-         //the return of ToS header field on received datagrams
-         if((sock->options & SOCKET_OPTION_IPV4_RECV_TOS) != 0)
-         {
-            //Make sure there is enough room to add the control message
-            if((n + CMSG_SPACE(sizeof(int_t))) <= msg->msg_controllen)
-            {
-               //Point to the ancillary data header
-               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+      //Check parameters
+      if(msg->msg_iov == NULL || msg->msg_iovlen != 1)
+      {
+         socketSetErrnoCode(sock, EINVAL);
+         return SOCKET_ERROR;
+      }
+   }
 
-               //Format ancillary data header
-               cmsg->cmsg_len = CMSG_LEN(sizeof(int_t));
-               cmsg->cmsg_level = IPPROTO_IP;
-               cmsg->cmsg_type = IP_TOS;
+   //The flags parameter can be used to influence the behavior of the function
+   socketFlags = 0;
 
-               //Point to the ancillary data value
-               val = (int_t *) CMSG_DATA(cmsg);
-               //Set ancillary data value
-               *val = message.tos;
+   //When the MSG_PEEK flag is specified, the data is copied into the buffer,
+   //but is not removed from the input queue
+   if((flags & MSG_PEEK) != 0)
+   {
+      socketFlags |= SOCKET_FLAG_PEEK;
+      vlen = 1;
+   }
 
-               //Adjust the actual length of the ancillary data buffer
-               n += CMSG_SPACE(sizeof(int_t));
-            }
-            else
-            {
-               //When the control message buffer is too short to store all
-               //messages, the MSG_CTRUNC flag must be set
-               msg->msg_flags |= MSG_CTRUNC;
-            }
-         }
+   //The MSG_DONTWAIT flag enables non-blocking operation
+   if((flags & MSG_DONTWAIT) != 0)
+   {
+      socketFlags |= SOCKET_FLAG_DONT_WAIT;
+   }
 
-         //The IP_RECVTTL option allows an application to enable or disable
-         //the return of TTL header field on received datagrams
-         if((sock->options & SOCKET_OPTION_IPV4_RECV_TTL) != 0)
-         {
-            //Make sure there is enough room to add the control message
-            if((n + CMSG_SPACE(sizeof(int_t))) <= msg->msg_controllen)
-            {
-               //Point to the ancillary data header
-               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+   //A zero timeout also enables non-blocking operation
+   if(timeout != NULL && timeout->tv_sec == 0 && timeout->tv_usec == 0)
+   {
+      socketFlags |= SOCKET_FLAG_DONT_WAIT;
+   }
 
-               //Format ancillary data header
-               cmsg->cmsg_len = CMSG_LEN(sizeof(int_t));
-               cmsg->cmsg_level = IPPROTO_IP;
-               cmsg->cmsg_type = IP_TTL;
+   //Initialize status code
+   error = NO_ERROR;
 
-               //Point to the ancillary data value
-               val = (int_t *) CMSG_DATA(cmsg);
-               //Set ancillary data value
-               *val = message.ttl;
+   //Receive the messages by batches
+   for(n = 0; n < vlen && !error; n += k)
+   {
+      //Limit the number of messages processed at a time
+      count = MIN(vlen - n, BSD_SOCKET_MAX_BATCH_SIZE);
 
-               //Adjust the actual length of the ancillary data buffer
-               n += CMSG_SPACE(sizeof(int_t));
-            }
-            else
-            {
-               //When the control message buffer is too short to store all
-               //messages, the MSG_CTRUNC flag must be set
-               msg->msg_flags |= MSG_CTRUNC;
-            }
-         }
-      }
-      else
-#endif
-#if (IPV6_SUPPORT == ENABLED)
-      //IPv6 address?
-      if(message.destIpAddr.length == sizeof(Ipv6Addr))
+      //Point to the receive buffers
+      for(i = 0; i < count; i++)
       {
-         int_t *val;
-         CMSGHDR *cmsg;
-         IN6_PKTINFO *pktInfo;
+         msg = &msgvec[n + i].msg_hdr;
 
-         //The IPV6_PKTINFO option allows an application to enable or disable
-         //the return of IPv6 packet information
-         if((sock->options & SOCKET_OPTION_IPV6_PKT_INFO) != 0)
-         {
-            //Make sure there is enough room to add the control message
-            if((n + CMSG_SPACE(sizeof(IN6_PKTINFO))) <= msg->msg_controllen)
-            {
-               //Point to the ancillary data header
-               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
-
-               //Format ancillary data header
-               cmsg->cmsg_len = CMSG_LEN(sizeof(IN6_PKTINFO));
-               cmsg->cmsg_level = IPPROTO_IPV6;
-               cmsg->cmsg_type = IPV6_PKTINFO;
-
-               //Point to the ancillary data value
-               pktInfo = (IN6_PKTINFO *) CMSG_DATA(cmsg);
-
-               //Format packet information
-               pktInfo->ipi6_ifindex = message.interface->index;
-               ipv6CopyAddr(pktInfo->ipi6_addr.s6_addr, &message.destIpAddr.ipv6Addr);
+         messages[i] = SOCKET_DEFAULT_MSG;
+         messages[i].data = msg->msg_iov[0].iov_base;
+         messages[i].size = msg->msg_iov[0].iov_len;
+      }
 
-               //Adjust the actual length of the ancillary data buffer
-               n += CMSG_SPACE(sizeof(IN6_PKTINFO));
-            }
-            else
-            {
-               //When the control message buffer is too short to store all
-               //messages, the MSG_CTRUNC flag must be set
-               msg->msg_flags |= MSG_CTRUNC;
-            }
-         }
+      //Receive the current batch
+      error = socketReceiveMsgBatch(sock, messages, count, &k, socketFlags);
 
-         //The IPV6_RECVTCLASS option allows an application to enable or disable
-         //the return of Traffic Class header field on received datagrams
-         if((sock->options & SOCKET_OPTION_IPV6_RECV_TRAFFIC_CLASS) != 0)
+      //Return the source address and the ancillary data of each message
+      for(i = 0; i < k; i++)
+      {
+         //The messages have been dequeued and must all be returned
+         if(socketFormatMsgHeader(sock, &messages[i], &msgvec[n + i].msg_hdr))
          {
-            //Make sure there is enough room to add the control message
-            if((n + CMSG_SPACE(sizeof(int_t))) <= msg->msg_controllen)
-            {
-               //Point to the ancillary data header
-               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
-
-               //Format ancillary data header
-               cmsg->cmsg_len = CMSG_LEN(sizeof(int_t));
-               cmsg->cmsg_level = IPPROTO_IPV6;
-               cmsg->cmsg_type = IPV6_TCLASS;
-
-               //Point to the ancillary data value
-               val = (int_t *) CMSG_DATA(cmsg);
-               //Set ancillary data value
-               *val = message.tos;
-
-               //Adjust the actual length of the ancillary data buffer
-               n += CMSG_SPACE(sizeof(int_t));
-            }
-            else
-            {
-               //When the control message buffer is too short to store all
-               //messages, the MSG_CTRUNC flag must be set
-               msg->msg_flags |= MSG_CTRUNC;
-            }
+            error = ERROR_INVALID_PARAMETER;
          }
 
-         //The IPV6_RECVHOPLIMIT option allows an application to enable or
-         //disable the return of Hop Limit header field on received datagrams
-         if((sock->options & SOCKET_OPTION_IPV6_RECV_HOP_LIMIT) != 0)
-         {
-            //Make sure there is enough room to add the control message
-            if((n + CMSG_SPACE(sizeof(int_t))) <= msg->msg_controllen)
-            {
-               //Point to the ancillary data header
-               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
-
-               //Format ancillary data header
-               cmsg->cmsg_len = CMSG_LEN(sizeof(int_t));
-               cmsg->cmsg_level = IPPROTO_IPV6;
-               cmsg->cmsg_type = IPV6_HOPLIMIT;
-
-               //Point to the ancillary data value
-               val = (int_t *) CMSG_DATA(cmsg);
-               //Set ancillary data value
-               *val = message.ttl;
-
-               //Adjust the actual length of the ancillary data buffer
-               n += CMSG_SPACE(sizeof(int_t));
-            }
-            else
-            {
-               //When the control message buffer is too short to store all
-               //messages, the MSG_CTRUNC flag must be set
-               msg->msg_flags |= MSG_CTRUNC;
-            }
-         }
+         //Return the number of bytes received
+         msgvec[n + i].msg_len = messages[i].length;
       }
-      else
-#endif
-      //Invalid address?
+
+      //The receive queue has been drained?
+      if(!error && k < count)
       {
-         //Just for sanity
+         error = ERROR_WOULD_BLOCK;
       }
+
+      //Subsequent batches are received in non-blocking mode
+      socketFlags |= SOCKET_FLAG_DONT_WAIT;
    }
 
-   //Length of the actual length of the ancillary data buffer
-   msg->msg_controllen = n;
+   //Check whether at least one message has been received
+   if(n == 0)
+   {
+      //Otherwise, a value of SOCKET_ERROR is returned
+      socketTranslateErrorCode(sock, error);
+      return SOCKET_ERROR;
+   }
 
-   //Return the number of bytes received
-   return message.length;
+   //Return the number of messages received
+   return n;
 }
 
 
@@ -1479,13 +1271,13 @@ int_t getsockname(int_t s, struct sockaddr *addr, socklen_t *addrlen)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Get exclusive access
    osAcquireMutex(&netMutex);
@@ -1575,13 +1367,13 @@ int_t getpeername(int_t s, struct sockaddr *addr, socklen_t *addrlen)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Get exclusive access
    osAcquireMutex(&netMutex);
@@ -1676,13 +1468,13 @@ int_t setsockopt(int_t s, int_t level, int_t optname, const void *optval,
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Make sure the option is valid
    if(optval != NULL)
@@ -1726,6 +1518,21 @@ int_t setsockopt(int_t s, int_t level, int_t optname, const void *optval,
             //Set SO_KEEPALIVE option
             ret = socketSetSoKeepAliveOption(sock, optval, optlen);
          }
+         else if(optname == SO_BUSY_POLL)
+         {
+            //Set SO_BUSY_POLL option
+            ret = socketSetSoBusyPollOption(sock, optval, optlen);
+         }
+         else if(optname == SO_ATTACH_FILTER)
+         {
+            //Set SO_ATTACH_FILTER option
+            ret = socketSetSoAttachFilterOption(sock, optval, optlen);
+         }
+         else if(optname == SO_DETACH_FILTER)
+         {
+            //Set SO_DETACH_FILTER option
+            ret = socketSetSoDetachFilterOption(sock, optval, optlen);
+         }
          else
          {
             //Unknown option
@@ -1904,6 +1711,21 @@ int_t setsockopt(int_t s, int_t level, int_t optname, const void *optval,
             ret = SOCKET_ERROR;
          }
       }
+      else if(level == IPPROTO_UDP)
+      {
+         //Check option type
+         if(optname == UDP_SEGMENT)
+         {
+            //Set UDP_SEGMENT option
+            ret = socketSetUdpSegmentOption(sock, optval, optlen);
+         }
+         else
+         {
+            //Unknown option
+            socketSetErrnoCode(sock, ENOPROTOOPT);
+            ret = SOCKET_ERROR;
+         }
+      }
       else
       {
          //The specified level is not valid
@@ -1943,13 +1765,13 @@ int_t getsockopt(int_t s, int_t level, int_t optname, void *optval,
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Get exclusive access
    osAcquireMutex(&netMutex);
@@ -1996,6 +1818,11 @@ int_t getsockopt(int_t s, int_t level, int_t optname, void *optval,
             //Get SO_KEEPALIVE option
             ret = socketGetSoKeepAliveOption(sock, optval, optlen);
          }
+         else if(optname == SO_BUSY_POLL)
+         {
+            //Get SO_BUSY_POLL option
+            ret = socketGetSoBusyPollOption(sock, optval, optlen);
+         }
          else if(optname == SO_TYPE)
          {
             //Get SO_TYPE option
@@ -2146,6 +1973,26 @@ int_t getsockopt(int_t s, int_t level, int_t optname, void *optval,
             //Get TCP_KEEPCNT option
             ret = socketGetTcpKeepCntOption(sock, optval, optlen);
          }
+         else if(optname == TCP_INFO)
+         {
+            //Get TCP_INFO option
+            ret = socketGetTcpInfoOption(sock, optval, optlen);
+         }
+         else
+         {
+            //Unknown option
+            socketSetErrnoCode(sock, ENOPROTOOPT);
+            ret = SOCKET_ERROR;
+         }
+      }
+      else if(level == IPPROTO_UDP)
+      {
+         //Check option type
+         if(optname == UDP_SEGMENT)
+         {
+            //Get UDP_SEGMENT option
+            ret = socketGetUdpSegmentOption(sock, optval, optlen);
+         }
          else
          {
             //Unknown option
@@ -2191,13 +2038,13 @@ int_t ioctlsocket(int_t s, uint32_t cmd, void *arg)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Get exclusive access
    osAcquireMutex(&netMutex);
@@ -2224,7 +2071,7 @@ int_t ioctlsocket(int_t s, uint32_t cmd, void *arg)
          //Cast the parameter to the relevant type
          val = (uint_t *) arg;
          //Return the actual value
-         *val = sock->rcvUser;
+         *val = (sock->type == SOCKET_TYPE_STREAM) ? sock->rcvUser : 0;
          //Successful processing
          ret = SOCKET_SUCCESS;
          break;
@@ -2235,7 +2082,8 @@ int_t ioctlsocket(int_t s, uint32_t cmd, void *arg)
          //Cast the parameter to the relevant type
          val = (uint_t *) arg;
          //Return the actual value
-         *val = sock->sndUser + sock->sndNxt - sock->sndUna;
+         *val = (sock->type == SOCKET_TYPE_STREAM) ?
+            sock->sndUser + sock->sndNxt - sock->sndUna : 0;
          //Successful processing
          ret = SOCKET_SUCCESS;
          break;
@@ -2245,8 +2093,8 @@ int_t ioctlsocket(int_t s, uint32_t cmd, void *arg)
          //Cast the parameter to the relevant type
          val = (uint_t *) arg;
          //Return the actual value
-         *val = sock->txBufferSize - (sock->sndUser + sock->sndNxt -
-            sock->sndUna);
+         *val = (sock->type == SOCKET_TYPE_STREAM) ? sock->txBufferSize -
+            (sock->sndUser + sock->sndNxt - sock->sndUna) : 0;
          //Successful processing
          ret = SOCKET_SUCCESS;
          break;
@@ -2290,13 +2138,13 @@ int_t fcntl(int_t s, int_t cmd, int_t arg)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Get exclusive access
    osAcquireMutex(&netMutex);
@@ -2348,13 +2196,13 @@ int_t shutdown(int_t s, int_t how)
    Socket *sock;
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Shut down socket
    error = socketShutdown(sock, how);
@@ -2381,15 +2229,45 @@ int_t shutdown(int_t s, int_t how)
 int_t closesocket(int_t s)
 {
    Socket *sock;
+#if (BSD_SOCKET_MAX_EPOLL_INSTANCES > 0)
+   SocketReadyList *list;
+#endif
+
+#if (BSD_SOCKET_MAX_EPOLL_INSTANCES > 0)
+   //Epoll descriptor?
+   if(s >= SOCKET_MAX_COUNT &&
+      s < (SOCKET_MAX_COUNT + BSD_SOCKET_MAX_EPOLL_INSTANCES))
+   {
+      //Point to the epoll instance
+      list = socketGetEpollInstance(s);
+
+      //Make sure the epoll instance is in use
+      if(list == NULL)
+         return SOCKET_ERROR;
+
+      //Release the ready list
+      socketReadyListDeinit(list);
+
+      //Get exclusive access
+      osAcquireMutex(&netMutex);
+      //The epoll descriptor is now free
+      netContext.bsdSocketContext->epollUsed[s - SOCKET_MAX_COUNT] = FALSE;
+      //Release exclusive access
+      osReleaseMutex(&netMutex);
+
+      //Successful processing
+      return SOCKET_SUCCESS;
+   }
+#endif
 
    //Make sure the socket descriptor is valid
-   if(s < 0 || s >= SOCKET_MAX_COUNT)
+   if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
    {
       return SOCKET_ERROR;
    }
 
    //Point to the socket structure
-   sock = &socketTable[s];
+   sock = socketTable[s];
 
    //Close socket
    socketClose(sock);
@@ -2462,7 +2340,8 @@ int_t select(int_t nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
          for(j = 0; j < fds->fd_count; j++)
          {
             //Invalid socket descriptor?
-            if(fds->fd_array[j] < 0 || fds->fd_array[j] >= SOCKET_MAX_COUNT)
+            if(fds->fd_array[j] < 0 || fds->fd_array[j] >= SOCKET_MAX_COUNT ||
+               socketTable[fds->fd_array[j]] == NULL)
             {
                //Report an error
                return SOCKET_ERROR;
@@ -2512,7 +2391,7 @@ int_t select(int_t nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
             //Get the descriptor associated with the current entry
             s = fds->fd_array[j];
             //Subscribe to the requested events
-            socketRegisterEvents(&socketTable[s], &event, eventMask);
+            socketRegisterEvents(socketTable[s], &event, eventMask);
          }
       }
    }
@@ -2567,9 +2446,9 @@ int_t select(int_t nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
             //Get the descriptor associated with the current entry
             s = fds->fd_array[j];
             //Retrieve event flags for the current socket
-            eventFlags = socketGetEvents(&socketTable[s]);
+            eventFlags = socketGetEvents(socketTable[s]);
             //Unsubscribe previously registered events
-            socketUnregisterEvents(&socketTable[s]);
+            socketUnregisterEvents(socketTable[s]);
 
             //Event flag is set?
             if(eventFlags & eventMask)
@@ -2595,6 +2474,400 @@ int_t select(int_t nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
 }
 
 
+/**
+ * @brief Wait for some event on a set of sockets
+ *
+ * The set is not retained across calls, so every entry is registered and
+ * scanned each time and the cost grows with nfds. epoll_wait() relies on a
+ * persistent ready list instead, and only its cost follows the number of
+ * ready sockets
+ *
+ * @param[in,out] fds Set of sockets to be monitored
+ * @param[in] nfds Number of entries in the set
+ * @param[in] timeout Maximum time to wait, in milliseconds. A negative
+ *   value means an infinite timeout
+ * @return The function returns the number of entries with a non-zero revents
+ *   field, 0 if the time limit expired or SOCKET_ERROR if an error occurred
+ **/
+
+int_t poll(struct pollfd *fds, nfds_t nfds, int_t timeout)
+{
+   int_t n;
+   int_t s;
+   uint_t i;
+   uint_t eventMask;
+   uint_t eventFlags;
+   OsEvent event;
+
+   //Check parameters
+   if(fds == NULL && nfds != 0)
+   {
+      socketSetErrnoCode(NULL, EFAULT);
+      return SOCKET_ERROR;
+   }
+
+   //Create an event object to get notified of socket events
+   if(!osCreateEvent(&event))
+   {
+      //Failed to create event
+      return SOCKET_ERROR;
+   }
+
+   //Count the number of entries with a non-zero revents field
+   n = 0;
+
+   //Subscribe to the requested events
+   for(i = 0; i < nfds; i++)
+   {
+      //Get the descriptor associated with the current entry
+      s = fds[i].fd;
+      //Clear returned events
+      fds[i].revents = 0;
+
+      //Negative descriptors are ignored
+      if(s < 0)
+         continue;
+
+      //Invalid socket descriptor?
+      if(s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
+      {
+         //Report an invalid request
+         fds[i].revents = POLLNVAL;
+         n++;
+      }
+      else
+      {
+         //Convert the requested events
+         eventMask = socketPollEventsToEventMask((uint16_t) fds[i].events);
+         //Subscribe to the requested events
+         socketRegisterEvents(socketTable[s], &event, eventMask);
+      }
+   }
+
+   //Block the current task until an event occurs
+   if(n == 0)
+   {
+      osWaitForEvent(&event, (timeout >= 0) ? (systime_t) timeout :
+         INFINITE_DELAY);
+   }
+
+   //Collect the events in the signaled state
+   for(i = 0; i < nfds; i++)
+   {
+      //Get the descriptor associated with the current entry
+      s = fds[i].fd;
+
+      //Skip negative and invalid descriptors
+      if(s < 0 || s >= SOCKET_MAX_COUNT || socketTable[s] == NULL)
+         continue;
+
+      //Retrieve event flags for the current socket
+      eventFlags = socketGetEvents(socketTable[s]);
+      //Unsubscribe previously registered events
+      socketUnregisterEvents(socketTable[s]);
+
+      //Report the requested events, along with hang-ups and errors
+      fds[i].revents = (int16_t) socketGetPollEvents(socketTable[s],
+         eventFlags, (uint16_t) fds[i].events);
+
+      //Track the number of entries with a non-zero revents field
+      if(fds[i].revents != 0)
+      {
+         n++;
+      }
+   }
+
+   //Delete event object
+   osDeleteEvent(&event);
+   //Return the number of entries with a non-zero revents field
+   return n;
+}
+
+
+/**
+ * @brief Open an epoll instance
+ * @param[in] size Ignored, but must be greater than zero
+ * @return On success, a descriptor referring to the new epoll instance is
+ *   returned. Otherwise, it returns SOCKET_ERROR
+ **/
+
+int_t epoll_create(int_t size)
+{
+   //The size argument must be greater than zero
+   if(size <= 0)
+   {
+      socketSetErrnoCode(NULL, EINVAL);
+      return SOCKET_ERROR;
+   }
+
+   //Open an epoll instance
+   return epoll_create1(0);
+}
+
+
+/**
+ * @brief Open an epoll instance
+ * @param[in] flags Unused parameter included only for compatibility with Linux
+ * @return On success, a descriptor referring to the new epoll instance is
+ *   returned. Otherwise, it returns SOCKET_ERROR
+ **/
+
+int_t epoll_create1(int_t flags)
+{
+#if (BSD_SOCKET_MAX_EPOLL_INSTANCES > 0)
+   error_t error;
+   uint_t i;
+   BsdSocketContext *context;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Point to the BSD socket layer state of the current stack instance
+   context = netContext.bsdSocketContext;
+
+   //The state is created along with the first epoll instance
+   if(context == NULL)
+   {
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+      //Each stack instance owns its epoll instances
+      context = osAllocMem(sizeof(BsdSocketContext));
+#else
+      //Point to the BSD socket layer state
+      context = &bsdSocketContext;
+#endif
+
+      //Successful memory allocation?
+      if(context != NULL)
+      {
+         //Clear the epoll table
+         osMemset(context, 0, sizeof(BsdSocketContext));
+         //Attach the state to the current stack instance
+         netContext.bsdSocketContext = context;
+      }
+   }
+
+   //Look for an unused epoll instance
+   for(i = 0; context != NULL && i < BSD_SOCKET_MAX_EPOLL_INSTANCES; i++)
+   {
+      if(!context->epollUsed[i])
+         break;
+   }
+
+   //Reserve the epoll instance
+   if(context != NULL && i < BSD_SOCKET_MAX_EPOLL_INSTANCES)
+   {
+      context->epollUsed[i] = TRUE;
+   }
+   else
+   {
+      //No epoll instance is available
+      i = BSD_SOCKET_MAX_EPOLL_INSTANCES;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //The maximum number of epoll instances has been reached?
+   if(i >= BSD_SOCKET_MAX_EPOLL_INSTANCES)
+   {
+      socketSetErrnoCode(NULL, EMFILE);
+      return SOCKET_ERROR;
+   }
+
+   //Initialize the ready list
+   error = socketReadyListInit(&context->epollTable[i]);
+
+   //Any error to report?
+   if(error)
+   {
+      //Clean up side effects
+      context->epollUsed[i] = FALSE;
+
+      socketSetErrnoCode(NULL, EMFILE);
+      return SOCKET_ERROR;
+   }
+
+   //Epoll descriptors follow socket descriptors
+   return SOCKET_MAX_COUNT + i;
+#else
+   //Epoll instances are not supported
+   socketSetErrnoCode(NULL, EMFILE);
+   return SOCKET_ERROR;
+#endif
+}
+
+
+/**
+ * @brief Add, modify or remove entries in the interest list of an epoll instance
+ * @param[in] epfd Descriptor referring to the epoll instance
+ * @param[in] op Operation to be performed (EPOLL_CTL_ADD, EPOLL_CTL_MOD or
+ *   EPOLL_CTL_DEL)
+ * @param[in] fd Descriptor of the target socket
+ * @param[in] event Events to be monitored and user data
+ * @return If no error occurs, this function returns SOCKET_SUCCESS.
+ *   Otherwise, it returns SOCKET_ERROR
+ **/
+
+int_t epoll_ctl(int_t epfd, int_t op, int_t fd, struct epoll_event *event)
+{
+#if (BSD_SOCKET_MAX_EPOLL_INSTANCES > 0)
+   error_t error;
+   uint_t flags;
+   uint_t eventMask;
+   Socket *sock;
+   SocketReadyList *list;
+
+   //Point to the epoll instance
+   list = socketGetEpollInstance(epfd);
+
+   //Make sure the epoll descriptor is valid
+   if(list == NULL)
+   {
+      socketSetErrnoCode(NULL, EBADF);
+      return SOCKET_ERROR;
+   }
+
+   //Make sure the socket descriptor is valid
+   if(fd < 0 || fd >= SOCKET_MAX_COUNT || socketTable[fd] == NULL)
+   {
+      socketSetErrnoCode(NULL, EBADF);
+      return SOCKET_ERROR;
+   }
+
+   //The event parameter is required when adding or modifying an entry
+   if(event == NULL && op != EPOLL_CTL_DEL)
+   {
+      socketSetErrnoCode(NULL, EFAULT);
+      return SOCKET_ERROR;
+   }
+
+   //Point to the socket structure
+   sock = socketTable[fd];
+
+   //Convert the requested events
+   eventMask = 0;
+   flags = 0;
+
+   if(event != NULL)
+   {
+      eventMask = socketPollEventsToEventMask(event->events);
+
+      //Edge-triggered notification?
+      if((event->events & EPOLLET) != 0)
+      {
+         flags |= SOCKET_READY_FLAG_EDGE_TRIGGERED;
+      }
+
+      //One-shot notification?
+      if((event->events & EPOLLONESHOT) != 0)
+      {
+         flags |= SOCKET_READY_FLAG_ONE_SHOT;
+      }
+   }
+
+   //Check operation
+   if(op == EPOLL_CTL_ADD)
+   {
+      //Register the socket on the epoll instance
+      error = socketReadyListAdd(list, sock, eventMask, flags, event->data.u64);
+   }
+   else if(op == EPOLL_CTL_MOD)
+   {
+      //Change the settings associated with the socket
+      error = socketReadyListModify(list, sock, eventMask, flags,
+         event->data.u64);
+   }
+   else if(op == EPOLL_CTL_DEL)
+   {
+      //Deregister the socket from the epoll instance
+      error = socketReadyListRemove(list, sock);
+   }
+   else
+   {
+      //Invalid operation
+      error = ERROR_INVALID_PARAMETER;
+   }
+
+   //Any error to report?
+   if(error == ERROR_ALREADY_CONFIGURED)
+   {
+      socketSetErrnoCode(sock, EEXIST);
+      return SOCKET_ERROR;
+   }
+   else if(error == ERROR_NOT_FOUND)
+   {
+      socketSetErrnoCode(sock, ENOENT);
+      return SOCKET_ERROR;
+   }
+   else if(error)
+   {
+      socketTranslateErrorCode(sock, error);
+      return SOCKET_ERROR;
+   }
+
+   //Successful processing
+   return SOCKET_SUCCESS;
+#else
+   //Epoll instances are not supported
+   socketSetErrnoCode(NULL, EBADF);
+   return SOCKET_ERROR;
+#endif
+}
+
+
+/**
+ * @brief Wait for events on an epoll instance
+ * @param[in] epfd Descriptor referring to the epoll instance
+ * @param[out] events Array where to store the events in the signaled state
+ * @param[in] maxevents Maximum number of events to return
+ * @param[in] timeout Maximum time to wait, in milliseconds. A negative
+ *   value means an infinite timeout
+ * @return The function returns the number of sockets ready for the requested
+ *   I/O, 0 if the time limit expired or SOCKET_ERROR if an error occurred
+ **/
+
+int_t epoll_wait(int_t epfd, struct epoll_event *events, int_t maxevents,
+   int_t timeout)
+{
+#if (BSD_SOCKET_MAX_EPOLL_INSTANCES > 0)
+   uint_t n;
+   SocketReadyList *list;
+
+   //Point to the epoll instance
+   list = socketGetEpollInstance(epfd);
+
+   //Make sure the epoll descriptor is valid
+   if(list == NULL)
+   {
+      socketSetErrnoCode(NULL, EBADF);
+      return SOCKET_ERROR;
+   }
+
+   //Check parameters
+   if(events == NULL || maxevents <= 0)
+   {
+      socketSetErrnoCode(NULL, EINVAL);
+      return SOCKET_ERROR;
+   }
+
+   //Each socket is reported at most once
+   n = MIN((uint_t) maxevents, SOCKET_MAX_COUNT);
+
+   //Wait for sockets to become ready. The events are stored directly in
+   //the array supplied by the caller
+   n = socketReadyListWait(list, socketStoreEpollEvent, events, n,
+      (timeout >= 0) ? (systime_t) timeout : INFINITE_DELAY);
+
+   //Return the number of sockets ready for the requested I/O
+   return n;
+#else
+   //Epoll instances are not supported
+   socketSetErrnoCode(NULL, EBADF);
+   return SOCKET_ERROR;
+#endif
+}
+
+
 /**
  * @brief Get system host name
  * @param[out] name Output buffer where to store the system host name
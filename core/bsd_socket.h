@@ -45,6 +45,20 @@
    #error FD_SETSIZE parameter is not valid
 #endif
 
+//Maximum number of messages processed per batch by sendmmsg and recvmmsg
+#ifndef BSD_SOCKET_MAX_BATCH_SIZE
+   #define BSD_SOCKET_MAX_BATCH_SIZE 8
+#elif (BSD_SOCKET_MAX_BATCH_SIZE < 1)
+   #error BSD_SOCKET_MAX_BATCH_SIZE parameter is not valid
+#endif
+
+//Maximum number of epoll instances
+#ifndef BSD_SOCKET_MAX_EPOLL_INSTANCES
+   #define BSD_SOCKET_MAX_EPOLL_INSTANCES 1
+#elif (BSD_SOCKET_MAX_EPOLL_INSTANCES < 0)
+   #error BSD_SOCKET_MAX_EPOLL_INSTANCES parameter is not valid
+#endif
+
 //Set errno variable
 #ifndef BSD_SOCKET_SET_ERRNO
    #define BSD_SOCKET_SET_ERRNO(e)
@@ -122,6 +136,7 @@
 #define MSG_CTRUNC           0x0008
 #define MSG_DONTWAIT         0x0040
 #define MSG_WAITALL          0x0100
+#define MSG_WAITFORONE       0x10000
 
 //Flags used by shutdown function
 #define SD_RECEIVE           0
@@ -133,6 +148,30 @@
 #define SHUT_WR              SD_SEND
 #define SHUT_RDWR            SD_BOTH
 
+//Events used by poll function
+#define POLLIN               0x0001
+#define POLLPRI              0x0002
+#define POLLOUT              0x0004
+#define POLLERR              0x0008
+#define POLLHUP              0x0010
+#define POLLNVAL             0x0020
+#define POLLRDHUP            0x2000
+
+//Events used by epoll functions
+#define EPOLLIN              POLLIN
+#define EPOLLPRI             POLLPRI
+#define EPOLLOUT             POLLOUT
+#define EPOLLERR             POLLERR
+#define EPOLLHUP             POLLHUP
+#define EPOLLRDHUP           POLLRDHUP
+#define EPOLLONESHOT         0x40000000
+#define EPOLLET              0x80000000
+
+//Operations used by epoll_ctl function
+#define EPOLL_CTL_ADD        1
+#define EPOLL_CTL_DEL        2
+#define EPOLL_CTL_MOD        3
+
 //Socket level options
 #define SO_REUSEADDR         0x0004
 #define SO_KEEPALIVE         0x0008
@@ -145,6 +184,9 @@
 #define SO_RCVTIMEO          0x1006
 #define SO_ERROR             0x1007
 #define SO_TYPE              0x1008
+#define SO_BUSY_POLL         0x1010
+#define SO_ATTACH_FILTER     0x1011
+#define SO_DETACH_FILTER     0x1012
 #define SO_MAX_MSG_SIZE      0x2003
 #define SO_BINDTODEVICE      0x3000
 
@@ -183,6 +225,10 @@
 #define TCP_KEEPIDLE         0x0004
 #define TCP_KEEPINTVL        0x0005
 #define TCP_KEEPCNT          0x0006
+#define TCP_INFO             0x000B
+
+//UDP level options
+#define UDP_SEGMENT          103
 
 //IP TOS option
 #define IPTOS_LOWDELAY       0x10
@@ -237,11 +283,16 @@
 #define EAI_OVERFLOW         12
 
 //Error codes
+#define ENOENT               2
 #define EINTR                4
+#define EBADF                9
 #define EAGAIN               11
 #define EWOULDBLOCK          11
+#define ENOMEM               12
 #define EFAULT               14
+#define EEXIST               17
 #define EINVAL               22
+#define EMFILE               24
 #define EINPROGRESS          36
 #define ETIMEDOUT            60
 #define ENAMETOOLONG         63
@@ -391,6 +442,30 @@ typedef struct linger
 } LINGER, *PLINGER;
 
 
+/**
+ * @brief Packet filter instruction
+ **/
+
+typedef struct sock_filter
+{
+   uint16_t code;
+   uint8_t jt;
+   uint8_t jf;
+   uint32_t k;
+} SOCK_FILTER, *PSOCK_FILTER;
+
+
+/**
+ * @brief Packet filter program
+ **/
+
+typedef struct sock_fprog
+{
+   uint16_t len;
+   struct sock_filter *filter;
+} SOCK_FPROG, *PSOCK_FPROG;
+
+
 /**
  * @brief Scatter/gather array
  **/
@@ -418,6 +493,17 @@ typedef struct msghdr
 } MSGHDR, *PMSGHDR;
 
 
+/**
+ * @brief Multiple message header
+ **/
+
+typedef struct mmsghdr
+{
+   struct msghdr msg_hdr;
+   uint_t msg_len;
+} MMSGHDR, *PMMSGHDR;
+
+
 /**
  * @brief Ancillary data header
  **/
@@ -463,6 +549,49 @@ typedef struct fd_set
 } fd_set, FD_SET, *PFD_SET;
 
 
+/**
+ * @brief Number of entries in a poll set
+ **/
+
+typedef uint_t nfds_t;
+
+
+/**
+ * @brief Descriptor monitored by poll
+ **/
+
+typedef struct pollfd
+{
+   int_t fd;
+   int16_t events;
+   int16_t revents;
+} POLLFD, *PPOLLFD;
+
+
+/**
+ * @brief User data attached to an epoll event
+ **/
+
+typedef union epoll_data
+{
+   void *ptr;
+   int_t fd;
+   uint32_t u32;
+   uint64_t u64;
+} epoll_data_t;
+
+
+/**
+ * @brief Event monitored by epoll
+ **/
+
+typedef struct epoll_event
+{
+   uint32_t events;
+   epoll_data_t data;
+} EPOLL_EVENT, *PEPOLL_EVENT;
+
+
 /**
  * @brief Information about a given host
  **/
@@ -548,6 +677,8 @@ int_t sendto(int_t s, const void *data, size_t length, int_t flags,
 
 int_t sendmsg(int_t s, struct msghdr *msg, int_t flags);
 
+int_t sendmmsg(int_t s, struct mmsghdr *msgvec, uint_t vlen, int_t flags);
+
 int_t recv(int_t s, void *data, size_t size, int_t flags);
 
 int_t recvfrom(int_t s, void *data, size_t size, int_t flags,
@@ -555,6 +686,9 @@ int_t recvfrom(int_t s, void *data, size_t size, int_t flags,
 
 int_t recvmsg(int_t s, struct msghdr *msg, int_t flags);
 
+int_t recvmmsg(int_t s, struct mmsghdr *msgvec, uint_t vlen, int_t flags,
+   struct timeval *timeout);
+
 int_t getsockname(int_t s, struct sockaddr *addr, socklen_t *addrlen);
 int_t getpeername(int_t s, struct sockaddr *addr, socklen_t *addrlen);
 
@@ -573,6 +707,15 @@ int_t closesocket(int_t s);
 int_t select(int_t nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
    const struct timeval *timeout);
 
+int_t poll(struct pollfd *fds, nfds_t nfds, int_t timeout);
+
+int_t epoll_create(int_t size);
+int_t epoll_create1(int_t flags);
+int_t epoll_ctl(int_t epfd, int_t op, int_t fd, struct epoll_event *event);
+
+int_t epoll_wait(int_t epfd, struct epoll_event *events, int_t maxevents,
+   int_t timeout);
+
 int_t gethostname(char_t *name, size_t len);
 struct hostent *gethostbyname(const char_t *name);
 
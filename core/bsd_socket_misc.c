@@ -295,4 +295,698 @@ void socketTranslateErrorCode(Socket *socket, error_t errorCode)
    BSD_SOCKET_SET_ERRNO(errnoCode);
 }
 
+
+/**
+ * @brief Convert poll events to socket events
+ * @param[in] events Events requested by the application (POLLIN, POLLOUT...)
+ * @return Logic OR of the corresponding socket events
+ **/
+
+uint_t socketPollEventsToEventMask(uint32_t events)
+{
+   uint_t eventMask;
+
+   //Hang-ups are always reported
+   eventMask = SOCKET_EVENT_CLOSED;
+
+   //Data can be read without blocking?
+   if((events & POLLIN) != 0)
+   {
+      eventMask |= SOCKET_EVENT_RX_READY;
+   }
+
+   //Data can be written without blocking?
+   if((events & POLLOUT) != 0)
+   {
+      eventMask |= SOCKET_EVENT_TX_READY;
+   }
+
+   //The peer has shut down the writing half of the connection?
+   if((events & POLLRDHUP) != 0)
+   {
+      eventMask |= SOCKET_EVENT_RX_SHUTDOWN;
+   }
+
+   //Return the socket events
+   return eventMask;
+}
+
+
+/**
+ * @brief Convert socket events to poll events
+ * @param[in] eventFlags Logic OR of the socket events in the signaled state
+ * @return Corresponding poll events (POLLIN, POLLOUT...)
+ **/
+
+uint32_t socketEventFlagsToPollEvents(uint_t eventFlags)
+{
+   uint32_t events;
+
+   //Initialize poll events
+   events = 0;
+
+   //Convert socket events
+   if((eventFlags & SOCKET_EVENT_RX_READY) != 0)
+   {
+      events |= POLLIN;
+   }
+
+   if((eventFlags & SOCKET_EVENT_TX_READY) != 0)
+   {
+      events |= POLLOUT;
+   }
+
+   if((eventFlags & SOCKET_EVENT_RX_SHUTDOWN) != 0)
+   {
+      events |= POLLRDHUP;
+   }
+
+   if((eventFlags & SOCKET_EVENT_CLOSED) != 0)
+   {
+      events |= POLLHUP;
+   }
+
+   //Return poll events
+   return events;
+}
+
+
+/**
+ * @brief Get the poll events to be reported for a socket
+ *
+ * Only the requested events are reported, except POLLHUP and POLLERR which
+ * are always reported, as specified by POSIX
+ *
+ * @param[in] socket Handle that identifies a socket
+ * @param[in] eventFlags Logic OR of the socket events in the signaled state
+ * @param[in] events Requested poll events
+ * @return Poll events to be reported (POLLIN, POLLOUT...)
+ **/
+
+uint32_t socketGetPollEvents(Socket *socket, uint_t eventFlags,
+   uint32_t events)
+{
+   uint32_t revents;
+
+   //Convert socket events
+   revents = socketEventFlagsToPollEvents(eventFlags);
+
+#if (TCP_SUPPORT == ENABLED)
+   //The connection has been reset by the peer?
+   if(socket->type == SOCKET_TYPE_STREAM && socket->resetFlag)
+   {
+      revents |= POLLERR;
+   }
+#endif
+
+   //Hang-ups and errors are reported even if they were not requested
+   return revents & (events | POLLHUP | POLLERR);
+}
+
+
+/**
+ * @brief Convert a message header to a message descriptor
+ * @param[in] msg Pointer to the structure describing the message
+ * @param[out] message Message descriptor to be initialized
+ * @return Error code
+ **/
+
+error_t socketParseMsgHeader(const struct msghdr *msg, SocketMsg *message)
+{
+   SOCKADDR *addr;
+
+   //Check parameters
+   if(msg == NULL || msg->msg_iov == NULL || msg->msg_iovlen != 1)
+   {
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //Point to the message to be transmitted
+   *message = SOCKET_DEFAULT_MSG;
+   message->data = msg->msg_iov[0].iov_base;
+   message->length = msg->msg_iov[0].iov_len;
+
+   //Check the length of the address
+   if(msg->msg_namelen < (socklen_t) sizeof(SOCKADDR))
+   {
+      //Report an error
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //Point to the destination address
+   addr = (SOCKADDR *) msg->msg_name;
+
+#if (IPV4_SUPPORT == ENABLED)
+   //IPv4 address?
+   if(addr->sa_family == AF_INET &&
+      msg->msg_namelen >= (socklen_t) sizeof(SOCKADDR_IN))
+   {
+      //Point to the IPv4 address information
+      SOCKADDR_IN *sa = (SOCKADDR_IN *) addr;
+
+      //Get port number
+      message->destPort = ntohs(sa->sin_port);
+
+      //Copy IPv4 address
+      message->destIpAddr.length = sizeof(Ipv4Addr);
+      message->destIpAddr.ipv4Addr = sa->sin_addr.s_addr;
+   }
+   else
+#endif
+#if (IPV6_SUPPORT == ENABLED)
+   //IPv6 address?
+   if(addr->sa_family == AF_INET6 &&
+      msg->msg_namelen >= (socklen_t) sizeof(SOCKADDR_IN6))
+   {
+      //Point to the IPv6 address information
+      SOCKADDR_IN6 *sa = (SOCKADDR_IN6 *) addr;
+
+      //Get port number
+      message->destPort = ntohs(sa->sin6_port);
+
+      //Copy IPv6 address
+      message->destIpAddr.length = sizeof(Ipv6Addr);
+      ipv6CopyAddr(&message->destIpAddr.ipv6Addr, sa->sin6_addr.s6_addr);
+   }
+   else
+#endif
+   //Invalid address?
+   {
+      //Report an error
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //The ancillary data buffer parameter is optional
+   if(msg->msg_control != NULL)
+   {
+      uint_t n;
+      int_t *val;
+      CMSGHDR *cmsg;
+
+      //Point to the first control message
+      n = 0;
+
+      //Loop through control messages
+      while((n + sizeof(CMSGHDR)) <= msg->msg_controllen)
+      {
+         //Point to the ancillary data header
+         cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+
+         //Check the length of the control message
+         if(cmsg->cmsg_len >= sizeof(CMSGHDR) &&
+            cmsg->cmsg_len <= (msg->msg_controllen - n))
+         {
+            //UDP protocol?
+            if(cmsg->cmsg_level == IPPROTO_UDP)
+            {
+               //Check control message type
+               if(cmsg->cmsg_type == UDP_SEGMENT &&
+                  cmsg->cmsg_len >= CMSG_LEN(sizeof(uint16_t)))
+               {
+                  //Split the payload into datagrams of the specified size
+                  message->segmentSize = *((uint16_t *) CMSG_DATA(cmsg));
+               }
+               else
+               {
+                  //Unknown control message type
+               }
+            }
+            else
+#if (IPV4_SUPPORT == ENABLED)
+            //IPv4 protocol?
+            if(addr->sa_family == AF_INET && cmsg->cmsg_level == IPPROTO_IP)
+            {
+               //Check control message type
+               if(cmsg->cmsg_type == IP_PKTINFO &&
+                  cmsg->cmsg_len >= CMSG_LEN(sizeof(IN_PKTINFO)))
+               {
+                  //Point to the ancillary data value
+                  IN_PKTINFO *pktInfo = (IN_PKTINFO *) CMSG_DATA(cmsg);
+
+                  //Specify source IPv4 address
+                  message->srcIpAddr.length = sizeof(Ipv4Addr);
+                  message->srcIpAddr.ipv4Addr = pktInfo->ipi_addr.s_addr;
+               }
+               else if(cmsg->cmsg_type == IP_TOS &&
+                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
+               {
+                  //Point to the ancillary data value
+                  val = (int_t *) CMSG_DATA(cmsg);
+                  //Specify ToS value
+                  message->tos = (uint8_t) *val;
+               }
+               else if(cmsg->cmsg_type == IP_TTL &&
+                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
+               {
+                  //Point to the ancillary data value
+                  val = (int_t *) CMSG_DATA(cmsg);
+                  //Specify TTL value
+                  message->ttl = (uint8_t) *val;
+               }
+               else if(cmsg->cmsg_type == IP_DONTFRAG &&
+                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
+               {
+                  //Point to the ancillary data value
+                  val = (int_t *) CMSG_DATA(cmsg);
+
+                  //This option can be used to set the "don't fragment" flag
+                  //on IP packets
+                  message->dontFrag = (*val != 0) ? TRUE : FALSE;
+               }
+               else
+               {
+                  //Unknown control message type
+               }
+            }
+            else
+#endif
+#if (IPV6_SUPPORT == ENABLED)
+            //IPv6 protocol?
+            if(addr->sa_family == AF_INET6 && cmsg->cmsg_level == IPPROTO_IPV6)
+            {
+               //Check control message type
+               if(cmsg->cmsg_type == IPV6_PKTINFO &&
+                  cmsg->cmsg_len >= CMSG_LEN(sizeof(IN_PKTINFO)))
+               {
+                  //Point to the ancillary data value
+                  IN6_PKTINFO *pktInfo = (IN6_PKTINFO *) CMSG_DATA(cmsg);
+
+                  //Specify source IPv6 address
+                  message->srcIpAddr.length = sizeof(Ipv6Addr);
+                  ipv6CopyAddr(&message->srcIpAddr.ipv6Addr, pktInfo->ipi6_addr.s6_addr);
+               }
+               else if(cmsg->cmsg_type == IPV6_TCLASS &&
+                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
+               {
+                  //Point to the ancillary data value
+                  val = (int_t *) CMSG_DATA(cmsg);
+                  //Specify Traffic Class value
+                  message->tos = (uint8_t) *val;
+               }
+               else if(cmsg->cmsg_type == IPV6_HOPLIMIT &&
+                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
+               {
+                  //Point to the ancillary data value
+                  val = (int_t *) CMSG_DATA(cmsg);
+                  //Specify Hop Limit value
+                  message->ttl = (uint8_t) *val;
+               }
+               else if(cmsg->cmsg_type == IPV6_DONTFRAG &&
+                  cmsg->cmsg_len >= CMSG_LEN(sizeof(int_t)))
+               {
+                  //Point to the ancillary data value
+                  val = (int_t *) CMSG_DATA(cmsg);
+
+                  //This option be used to turn off the automatic inserting
+                  //of a fragment header for UDP and raw sockets
+                  message->dontFrag = (*val != 0) ? TRUE : FALSE;
+               }
+               else
+               {
+                  //Unknown control message type
+               }
+            }
+            //Unknown protocol?
+            else
+#endif
+            {
+               //Discard control message
+            }
+
+            //Next control message
+            n += cmsg->cmsg_len;
+         }
+         else
+         {
+            //Malformed control message
+            break;
+         }
+      }
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Return the source address and ancillary data of a received message
+ * @param[in] socket Handle that identifies a socket
+ * @param[in] message Message descriptor filled by the receive function
+ * @param[in,out] msg Pointer to the structure describing the message
+ * @return Error code
+ **/
+
+error_t socketFormatMsgHeader(Socket *socket, const SocketMsg *message,
+   struct msghdr *msg)
+{
+   size_t n;
+
+   //The source address parameter is optional
+   if(msg->msg_name != NULL)
+   {
+#if (IPV4_SUPPORT == ENABLED)
+      //IPv4 address?
+      if(message->srcIpAddr.length == sizeof(Ipv4Addr) &&
+         msg->msg_namelen >= (socklen_t) sizeof(SOCKADDR_IN))
+      {
+         //Point to the IPv4 address information
+         SOCKADDR_IN *sa = (SOCKADDR_IN *) msg->msg_name;
+
+         //Set address family and port number
+         sa->sin_family = AF_INET;
+         sa->sin_port = htons(message->srcPort);
+
+         //Copy IPv4 address
+         sa->sin_addr.s_addr = message->srcIpAddr.ipv4Addr;
+
+         //Return the actual length of the address
+         msg->msg_namelen = sizeof(SOCKADDR_IN);
+      }
+      else
+#endif
+#if (IPV6_SUPPORT == ENABLED)
+      //IPv6 address?
+      if(message->srcIpAddr.length == sizeof(Ipv6Addr) &&
+         msg->msg_namelen >= (socklen_t) sizeof(SOCKADDR_IN6))
+      {
+         //Point to the IPv6 address information
+         SOCKADDR_IN6 *sa = (SOCKADDR_IN6 *) msg->msg_name;
+
+         //Set address family and port number
+         sa->sin6_family = AF_INET6;
+         sa->sin6_port = htons(message->srcPort);
+         sa->sin6_flowinfo = 0;
+         sa->sin6_scope_id = 0;
+
+         //Copy IPv6 address
+         ipv6CopyAddr(sa->sin6_addr.s6_addr, &message->srcIpAddr.ipv6Addr);
+
+         //Return the actual length of the address
+         msg->msg_namelen = sizeof(SOCKADDR_IN6);
+      }
+      else
+#endif
+      //Invalid address?
+      {
+         //Report an error
+         return ERROR_INVALID_PARAMETER;
+      }
+   }
+   else
+   {
+      msg->msg_namelen = 0;
+   }
+
+   //Clear flags
+   msg->msg_flags = 0;
+
+   //Length of the ancillary data buffer
+   n = 0;
+
+   //The ancillary data buffer parameter is optional
+   if(msg->msg_control != NULL)
+   {
+#if (IPV4_SUPPORT == ENABLED)
+      //IPv4 address?
+      if(message->destIpAddr.length == sizeof(Ipv4Addr))
+      {
+         int_t *val;
+         CMSGHDR *cmsg;
+         IN_PKTINFO *pktInfo;
+
+         //The IP_PKTINFO option allows an application to enable or disable
+         //the return of IPv4 packet information
+         if((socket->options & SOCKET_OPTION_IPV4_PKT_INFO) != 0)
+         {
+            //Make sure there is enough room to add the control message
+            if((n + CMSG_SPACE(sizeof(IN_PKTINFO))) <= msg->msg_controllen)
+            {
+               //Point to the ancillary data header
+               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+
+               //Format ancillary data header
+               cmsg->cmsg_len = CMSG_LEN(sizeof(IN_PKTINFO));
+               cmsg->cmsg_level = IPPROTO_IP;
+               cmsg->cmsg_type = IP_PKTINFO;
+
+               //Point to the ancillary data value
+               pktInfo = (IN_PKTINFO *) CMSG_DATA(cmsg);
+
+               //Format packet information
+               pktInfo->ipi_ifindex = message->interface->index;
+               pktInfo->ipi_addr.s_addr = message->destIpAddr.ipv4Addr;
+
+               //Adjust the actual length of the ancillary data buffer
+               n += CMSG_SPACE(sizeof(IN_PKTINFO));
+            }
+            else
+            {
+               //When the control message buffer is too short to store all
+               //messages, the MSG_CTRUNC flag must be set
+               msg->msg_flags |= MSG_CTRUNC;
+            }
+         }
+
+         //The IP_RECVTOS option allows an application to enable or disable
+         //the return of ToS header field on received datagrams
+         if((socket->options & SOCKET_OPTION_IPV4_RECV_TOS) != 0)
+         {
+            //Make sure there is enough room to add the control message
+            if((n + CMSG_SPACE(sizeof(int_t))) <= msg->msg_controllen)
+            {
+               //Point to the ancillary data header
+               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+
+               //Format ancillary data header
+               cmsg->cmsg_len = CMSG_LEN(sizeof(int_t));
+               cmsg->cmsg_level = IPPROTO_IP;
+               cmsg->cmsg_type = IP_TOS;
+
+               //Point to the ancillary data value
+               val = (int_t *) CMSG_DATA(cmsg);
+               //Set ancillary data value
+               *val = message->tos;
+
+               //Adjust the actual length of the ancillary data buffer
+               n += CMSG_SPACE(sizeof(int_t));
+            }
+            else
+            {
+               //When the control message buffer is too short to store all
+               //messages, the MSG_CTRUNC flag must be set
+               msg->msg_flags |= MSG_CTRUNC;
+            }
+         }
+
+         //The IP_RECVTTL option allows an application to enable or disable
+         //the return of TTL header field on received datagrams
+         if((socket->options & SOCKET_OPTION_IPV4_RECV_TTL) != 0)
+         {
+            //Make sure there is enough room to add the control message
+            if((n + CMSG_SPACE(sizeof(int_t))) <= msg->msg_controllen)
+            {
+               //Point to the ancillary data header
+               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+
+               //Format ancillary data header
+               cmsg->cmsg_len = CMSG_LEN(sizeof(int_t));
+               cmsg->cmsg_level = IPPROTO_IP;
+               cmsg->cmsg_type = IP_TTL;
+
+               //Point to the ancillary data value
+               val = (int_t *) CMSG_DATA(cmsg);
+               //Set ancillary data value
+               *val = message->ttl;
+
+               //Adjust the actual length of the ancillary data buffer
+               n += CMSG_SPACE(sizeof(int_t));
+            }
+            else
+            {
+               //When the control message buffer is too short to store all
+               //messages, the MSG_CTRUNC flag must be set
+               msg->msg_flags |= MSG_CTRUNC;
+            }
+         }
+      }
+      else
+#endif
+#if (IPV6_SUPPORT == ENABLED)
+      //IPv6 address?
+      if(message->destIpAddr.length == sizeof(Ipv6Addr))
+      {
+         int_t *val;
+         CMSGHDR *cmsg;
+         IN6_PKTINFO *pktInfo;
+
+         //The IPV6_PKTINFO option allows an application to enable or disable
+         //the return of IPv6 packet information
+         if((socket->options & SOCKET_OPTION_IPV6_PKT_INFO) != 0)
+         {
+            //Make sure there is enough room to add the control message
+            if((n + CMSG_SPACE(sizeof(IN6_PKTINFO))) <= msg->msg_controllen)
+            {
+               //Point to the ancillary data header
+               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+
+               //Format ancillary data header
+               cmsg->cmsg_len = CMSG_LEN(sizeof(IN6_PKTINFO));
+               cmsg->cmsg_level = IPPROTO_IPV6;
+               cmsg->cmsg_type = IPV6_PKTINFO;
+
+               //Point to the ancillary data value
+               pktInfo = (IN6_PKTINFO *) CMSG_DATA(cmsg);
+
+               //Format packet information
+               pktInfo->ipi6_ifindex = message->interface->index;
+               ipv6CopyAddr(pktInfo->ipi6_addr.s6_addr, &message->destIpAddr.ipv6Addr);
+
+               //Adjust the actual length of the ancillary data buffer
+               n += CMSG_SPACE(sizeof(IN6_PKTINFO));
+            }
+            else
+            {
+               //When the control message buffer is too short to store all
+               //messages, the MSG_CTRUNC flag must be set
+               msg->msg_flags |= MSG_CTRUNC;
+            }
+         }
+
+         //The IPV6_RECVTCLASS option allows an application to enable or disable
+         //the return of Traffic Class header field on received datagrams
+         if((socket->options & SOCKET_OPTION_IPV6_RECV_TRAFFIC_CLASS) != 0)
+         {
+            //Make sure there is enough room to add the control message
+            if((n + CMSG_SPACE(sizeof(int_t))) <= msg->msg_controllen)
+            {
+               //Point to the ancillary data header
+               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+
+               //Format ancillary data header
+               cmsg->cmsg_len = CMSG_LEN(sizeof(int_t));
+               cmsg->cmsg_level = IPPROTO_IPV6;
+               cmsg->cmsg_type = IPV6_TCLASS;
+
+               //Point to the ancillary data value
+               val = (int_t *) CMSG_DATA(cmsg);
+               //Set ancillary data value
+               *val = message->tos;
+
+               //Adjust the actual length of the ancillary data buffer
+               n += CMSG_SPACE(sizeof(int_t));
+            }
+            else
+            {
+               //When the control message buffer is too short to store all
+               //messages, the MSG_CTRUNC flag must be set
+               msg->msg_flags |= MSG_CTRUNC;
+            }
+         }
+
+         //The IPV6_RECVHOPLIMIT option allows an application to enable or
+         //disable the return of Hop Limit header field on received datagrams
+         if((socket->options & SOCKET_OPTION_IPV6_RECV_HOP_LIMIT) != 0)
+         {
+            //Make sure there is enough room to add the control message
+            if((n + CMSG_SPACE(sizeof(int_t))) <= msg->msg_controllen)
+            {
+               //Point to the ancillary data header
+               cmsg = (CMSGHDR *) ((uint8_t *) msg->msg_control + n);
+
+               //Format ancillary data header
+               cmsg->cmsg_len = CMSG_LEN(sizeof(int_t));
+               cmsg->cmsg_level = IPPROTO_IPV6;
+               cmsg->cmsg_type = IPV6_HOPLIMIT;
+
+               //Point to the ancillary data value
+               val = (int_t *) CMSG_DATA(cmsg);
+               //Set ancillary data value
+               *val = message->ttl;
+
+               //Adjust the actual length of the ancillary data buffer
+               n += CMSG_SPACE(sizeof(int_t));
+            }
+            else
+            {
+               //When the control message buffer is too short to store all
+               //messages, the MSG_CTRUNC flag must be set
+               msg->msg_flags |= MSG_CTRUNC;
+            }
+         }
+      }
+      else
+#endif
+      //Invalid address?
+      {
+         //Just for sanity
+      }
+   }
+
+   //Length of the actual length of the ancillary data buffer
+   msg->msg_controllen = n;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Retrieve the epoll instance that matches a given descriptor
+ * @param[in] epfd Descriptor referring to the epoll instance
+ * @return Pointer to the ready list of the epoll instance, or NULL if the
+ *   descriptor is not valid
+ **/
+
+SocketReadyList *socketGetEpollInstance(int_t epfd)
+{
+#if (BSD_SOCKET_MAX_EPOLL_INSTANCES > 0)
+   BsdSocketContext *context;
+
+   //Point to the BSD socket layer state of the current stack instance
+   context = netContext.bsdSocketContext;
+
+   //Epoll descriptors follow socket descriptors
+   if(context == NULL || epfd < SOCKET_MAX_COUNT ||
+      epfd >= (SOCKET_MAX_COUNT + BSD_SOCKET_MAX_EPOLL_INSTANCES))
+   {
+      return NULL;
+   }
+
+   //Make sure the epoll instance is in use
+   if(!context->epollUsed[epfd - SOCKET_MAX_COUNT])
+      return NULL;
+
+   //Return a pointer to the ready list
+   return &context->epollTable[epfd - SOCKET_MAX_COUNT];
+#else
+   //Epoll instances are not supported
+   return NULL;
+#endif
+}
+
+
+/**
+ * @brief Store an event reported by a ready list in an epoll_event array
+ * @param[out] events Array of epoll_event structures
+ * @param[in] index Index of the entry to be written
+ * @param[in] socket Socket in the signaled state
+ * @param[in] eventFlags Returned events
+ * @param[in] param User-defined value
+ **/
+
+void socketStoreEpollEvent(void *events, uint_t index, Socket *socket,
+   uint_t eventFlags, uint64_t param)
+{
+   struct epoll_event *event;
+
+   //Point to the entry to be written
+   event = (struct epoll_event *) events + index;
+
+   //Convert the events in the signaled state
+   event->events = socketGetPollEvents(socket, eventFlags, POLLIN | POLLOUT |
+      POLLRDHUP);
+   event->data.u64 = param;
+}
+
 #endif
@@ -34,16 +34,47 @@
 //Dependencies
 #include "core/net.h"
 #include "core/bsd_socket.h"
+#include "core/socket_misc.h"
 
 //C++ guard
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if (BSD_SOCKET_MAX_EPOLL_INSTANCES > 0)
+
+/**
+ * @brief BSD socket layer state
+ **/
+
+typedef struct _BsdSocketContext
+{
+   SocketReadyList epollTable[BSD_SOCKET_MAX_EPOLL_INSTANCES]; ///<Epoll instances
+   bool_t epollUsed[BSD_SOCKET_MAX_EPOLL_INSTANCES];           ///<Epoll instances in use
+} BsdSocketContext;
+
+#endif
+
 //BSD socket related functions
 void socketSetErrnoCode(Socket *socket, uint_t errnoCode);
 void socketTranslateErrorCode(Socket *socket, error_t errorCode);
 
+uint_t socketPollEventsToEventMask(uint32_t events);
+uint32_t socketEventFlagsToPollEvents(uint_t eventFlags);
+
+uint32_t socketGetPollEvents(Socket *socket, uint_t eventFlags,
+   uint32_t events);
+
+error_t socketParseMsgHeader(const struct msghdr *msg, SocketMsg *message);
+
+error_t socketFormatMsgHeader(Socket *socket, const SocketMsg *message,
+   struct msghdr *msg);
+
+SocketReadyList *socketGetEpollInstance(int_t epfd);
+
+void socketStoreEpollEvent(void *events, uint_t index, Socket *socket,
+   uint_t eventFlags, uint64_t param);
+
 //C++ guard
 #ifdef __cplusplus
 }
@@ -340,6 +340,144 @@ int_t socketSetSoKeepAliveOption(Socket *socket, const int_t *optval,
 }
 
 
+/**
+ * @brief Set SO_BUSY_POLL option
+ * @param[in] socket Handle referencing the socket
+ * @param[in] optval A pointer to the buffer in which the value for the
+ *   requested option is specified
+ * @param[in] optlen The size, in bytes, of the buffer pointed to by the optval
+ *   parameter
+ * @return Error code (SOCKET_SUCCESS or SOCKET_ERROR)
+ **/
+
+int_t socketSetSoBusyPollOption(Socket *socket, const int_t *optval,
+   socklen_t optlen)
+{
+   int_t ret;
+
+#if (SOCKET_BUSY_POLL_SUPPORT == ENABLED)
+   //Check the length of the option
+   if(optlen >= (socklen_t) sizeof(int_t) && *optval >= 0)
+   {
+      //The busy-poll duration is expressed in microseconds
+      socketSetBusyPoll(socket, (*optval + 999) / 1000);
+      //Successful processing
+      ret = SOCKET_SUCCESS;
+   }
+   else
+   {
+      //The option length is not valid
+      socketSetErrnoCode(socket, EFAULT);
+      ret = SOCKET_ERROR;
+   }
+#else
+   //Busy-poll mode is not supported
+   socketSetErrnoCode(socket, ENOPROTOOPT);
+   ret = SOCKET_ERROR;
+#endif
+
+   //Return status code
+   return ret;
+}
+
+
+/**
+ * @brief Set SO_ATTACH_FILTER option
+ * @param[in] socket Handle referencing the socket
+ * @param[in] optval A pointer to the buffer in which the value for the
+ *   requested option is specified
+ * @param[in] optlen The size, in bytes, of the buffer pointed to by the optval
+ *   parameter
+ * @return Error code (SOCKET_SUCCESS or SOCKET_ERROR)
+ **/
+
+int_t socketSetSoAttachFilterOption(Socket *socket,
+   const struct sock_fprog *optval, socklen_t optlen)
+{
+   int_t ret;
+#if (BPF_SUPPORT == ENABLED)
+   error_t error;
+
+   //Check the length of the option
+   if(optlen >= (socklen_t) sizeof(struct sock_fprog))
+   {
+      //The sock_filter structure has the same layout as BpfInsn
+      error = socketAttachFilter(socket, (const BpfInsn *) optval->filter,
+         optval->len);
+
+      //Check status code
+      if(!error)
+      {
+         //Successful processing
+         ret = SOCKET_SUCCESS;
+      }
+      else if(error == ERROR_OUT_OF_MEMORY)
+      {
+         //Not enough memory to hold the program
+         socketSetErrnoCode(socket, ENOMEM);
+         ret = SOCKET_ERROR;
+      }
+      else
+      {
+         //The program is not valid
+         socketSetErrnoCode(socket, EINVAL);
+         ret = SOCKET_ERROR;
+      }
+   }
+   else
+   {
+      //The option length is not valid
+      socketSetErrnoCode(socket, EFAULT);
+      ret = SOCKET_ERROR;
+   }
+#else
+   //Packet filters are not supported
+   socketSetErrnoCode(socket, ENOPROTOOPT);
+   ret = SOCKET_ERROR;
+#endif
+
+   //Return status code
+   return ret;
+}
+
+
+/**
+ * @brief Set SO_DETACH_FILTER option
+ * @param[in] socket Handle referencing the socket
+ * @param[in] optval Unused
+ * @param[in] optlen Unused
+ * @return Error code (SOCKET_SUCCESS or SOCKET_ERROR)
+ **/
+
+int_t socketSetSoDetachFilterOption(Socket *socket, const void *optval,
+   socklen_t optlen)
+{
+   int_t ret;
+
+#if (BPF_SUPPORT == ENABLED)
+   //Remove the filter attached to the socket
+   if(!socketDetachFilter(socket))
+   {
+      //Successful processing
+      ret = SOCKET_SUCCESS;
+   }
+   else
+   {
+      //No filter is attached to the socket
+      socketSetErrnoCode(socket, ENOENT);
+      ret = SOCKET_ERROR;
+   }
+#else
+   //Packet filters are not supported
+   socketSetErrnoCode(socket, ENOPROTOOPT);
+   ret = SOCKET_ERROR;
+#endif
+
+   //Return status code
+   return ret;
+}
+
+
 /**
  * @brief Set IP_TOS option
  * @param[in] socket Handle referencing the socket
@@ -1610,8 +1748,15 @@ int_t socketSetTcpKeepIdleOption(Socket *socket, const int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED && TCP_KEEP_ALIVE_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(optlen >= (socklen_t) sizeof(int_t))
+   else if(optlen >= (socklen_t) sizeof(int_t))
    {
       //Convert the time interval to milliseconds
       socket->keepAliveIdle = *optval * 1000;
@@ -1651,8 +1796,15 @@ int_t socketSetTcpKeepIntvlOption(Socket *socket, const int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED && TCP_KEEP_ALIVE_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(optlen >= (socklen_t) sizeof(int_t))
+   else if(optlen >= (socklen_t) sizeof(int_t))
    {
       //Convert the time interval to milliseconds
       socket->keepAliveInterval = *optval * 1000;
@@ -1692,8 +1844,15 @@ int_t socketSetTcpKeepCntOption(Socket *socket, const int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED && TCP_KEEP_ALIVE_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(optlen >= (socklen_t) sizeof(int_t))
+   else if(optlen >= (socklen_t) sizeof(int_t))
    {
       //Save parameter value
       socket->keepAliveMaxProbes = *optval;
@@ -1717,6 +1876,58 @@ int_t socketSetTcpKeepCntOption(Socket *socket, const int_t *optval,
 }
 
 
+/**
+ * @brief Set UDP_SEGMENT option
+ * @param[in] socket Handle referencing the socket
+ * @param[in] optval A pointer to the buffer in which the value for the
+ *   requested option is specified
+ * @param[in] optlen The size, in bytes, of the buffer pointed to by the optval
+ *   parameter
+ * @return Error code (SOCKET_SUCCESS or SOCKET_ERROR)
+ **/
+
+int_t socketSetUdpSegmentOption(Socket *socket, const int_t *optval,
+   socklen_t optlen)
+{
+   int_t ret;
+
+#if (UDP_SUPPORT == ENABLED)
+   //Check the length of the option
+   if(optlen >= (socklen_t) sizeof(int_t))
+   {
+      //Check the value of the option
+      if(*optval >= 0 && *optval <= UINT16_MAX &&
+         socket->type == SOCKET_TYPE_DGRAM)
+      {
+         //Each send operation is split into datagrams of the specified size
+         socket->segmentSize = (uint16_t) *optval;
+         //Successful processing
+         ret = SOCKET_SUCCESS;
+      }
+      else
+      {
+         //The option value is not valid
+         socketSetErrnoCode(socket, EINVAL);
+         ret = SOCKET_ERROR;
+      }
+   }
+   else
+   {
+      //The option length is not valid
+      socketSetErrnoCode(socket, EFAULT);
+      ret = SOCKET_ERROR;
+   }
+#else
+   //UDP is not supported
+   socketSetErrnoCode(socket, ENOPROTOOPT);
+   ret = SOCKET_ERROR;
+#endif
+
+   //Return status code
+   return ret;
+}
+
+
 /**
  * @brief Get SO_REUSEADDR option
  * @param[in] socket Handle referencing the socket
@@ -1921,8 +2132,15 @@ int_t socketGetSoSndBufOption(Socket *socket, int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(*optlen >= (socklen_t) sizeof(int_t))
+   else if(*optlen >= (socklen_t) sizeof(int_t))
    {
       //Return the size of the send buffer
       *optval = socket->txBufferSize;
@@ -1964,8 +2182,15 @@ int_t socketGetSoRcvBufOption(Socket *socket, int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(*optlen >= (socklen_t) sizeof(int_t))
+   else if(*optlen >= (socklen_t) sizeof(int_t))
    {
       //Return the size of the receive buffer
       *optval = socket->rxBufferSize;
@@ -2007,8 +2232,15 @@ int_t socketGetSoKeepAliveOption(Socket *socket, int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED && TCP_KEEP_ALIVE_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(*optlen >= (socklen_t) sizeof(int_t))
+   else if(*optlen >= (socklen_t) sizeof(int_t))
    {
       //This option specifies whether TCP keep-alive is enabled
       *optval = socket->keepAliveEnabled;
@@ -2032,6 +2264,49 @@ int_t socketGetSoKeepAliveOption(Socket *socket, int_t *optval,
 }
 
 
+/**
+ * @brief Get SO_BUSY_POLL option
+ * @param[in] socket Handle referencing the socket
+ * @param[out] optval A pointer to the buffer in which the value for the
+ *   requested option is to be returned
+ * @param[in,out] optlen The size, in bytes, of the buffer pointed to by the
+ *   optval parameter
+ * @return Error code (SOCKET_SUCCESS or SOCKET_ERROR)
+ **/
+
+int_t socketGetSoBusyPollOption(Socket *socket, int_t *optval,
+   socklen_t *optlen)
+{
+   int_t ret;
+
+#if (SOCKET_BUSY_POLL_SUPPORT == ENABLED)
+   //Check the length of the option
+   if(*optlen >= (socklen_t) sizeof(int_t))
+   {
+      //Return the busy-poll duration, in microseconds
+      *optval = socket->busyPollTime * 1000;
+      //Return the actual length of the option
+      *optlen = sizeof(int_t);
+      //Successful processing
+      ret = SOCKET_SUCCESS;
+   }
+   else
+   {
+      //The option length is not valid
+      socketSetErrnoCode(socket, EFAULT);
+      ret = SOCKET_ERROR;
+   }
+#else
+   //Busy-poll mode is not supported
+   socketSetErrnoCode(socket, ENOPROTOOPT);
+   ret = SOCKET_ERROR;
+#endif
+
+   //Return status code
+   return ret;
+}
+
+
 /**
  * @brief Get SO_TYPE option
  * @param[in] socket Handle referencing the socket
@@ -3043,8 +3318,15 @@ int_t socketGetTcpMaxSegOption(Socket *socket, int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(*optlen >= (socklen_t) sizeof(int_t))
+   else if(*optlen >= (socklen_t) sizeof(int_t))
    {
       //Get exclusive access
       osAcquireMutex(&netMutex);
@@ -3099,8 +3381,15 @@ int_t socketGetTcpKeepIdleOption(Socket *socket, int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED && TCP_KEEP_ALIVE_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(*optlen >= (socklen_t) sizeof(int_t))
+   else if(*optlen >= (socklen_t) sizeof(int_t))
    {
       //Convert the time interval to seconds
       *optval = socket->keepAliveIdle / 1000;
@@ -3140,8 +3429,15 @@ int_t socketGetTcpKeepIntvlOption(Socket *socket, int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED && TCP_KEEP_ALIVE_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(*optlen >= (socklen_t) sizeof(int_t))
+   else if(*optlen >= (socklen_t) sizeof(int_t))
    {
       //Convert the time interval to seconds
       *optval = socket->keepAliveInterval / 1000;
@@ -3182,8 +3478,15 @@ int_t socketGetTcpKeepCntOption(Socket *socket, int_t *optval,
    int_t ret;
 
 #if (TCP_SUPPORT == ENABLED && TCP_KEEP_ALIVE_SUPPORT == ENABLED)
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
    //Check the length of the option
-   if(*optlen >= (socklen_t) sizeof(int_t))
+   else if(*optlen >= (socklen_t) sizeof(int_t))
    {
       //Return parameter value
       *optval = socket->keepAliveMaxProbes;
@@ -3207,4 +3510,118 @@ int_t socketGetTcpKeepCntOption(Socket *socket, int_t *optval,
    return ret;
 }
 
+
+/**
+ * @brief Get TCP_INFO option
+ *
+ * If the buffer is smaller than the TcpInfo structure, the returned data is
+ * truncated, so that applications built against an older layout keep working
+ *
+ * @param[in] socket Handle referencing the socket
+ * @param[out] optval A pointer to the buffer in which the value for the
+ *   requested option is to be returned
+ * @param[in,out] optlen The size, in bytes, of the buffer pointed to by the
+ *   optval parameter
+ * @return Error code (SOCKET_SUCCESS or SOCKET_ERROR)
+ **/
+
+int_t socketGetTcpInfoOption(Socket *socket, TcpInfo *optval,
+   socklen_t *optlen)
+{
+   int_t ret;
+
+#if (TCP_SUPPORT == ENABLED && TCP_INFO_SUPPORT == ENABLED)
+   error_t error;
+   TcpInfo info;
+
+   //The option is only relevant for TCP sockets
+   if(socket->type != SOCKET_TYPE_STREAM)
+   {
+      //Report an error
+      socketSetErrnoCode(socket, ENOPROTOOPT);
+      ret = SOCKET_ERROR;
+   }
+   //Check the length of the option
+   else if(*optlen > 0)
+   {
+      //Retrieve TCP connection telemetry
+      error = tcpGetInfo(socket, &info);
+
+      //Check status code
+      if(!error)
+      {
+         //The returned data is truncated to the size of the buffer
+         *optlen = MIN(*optlen, (socklen_t) sizeof(TcpInfo));
+         //Return parameter value
+         osMemcpy(optval, &info, *optlen);
+         //Successful processing
+         ret = SOCKET_SUCCESS;
+      }
+      else
+      {
+         //Report an error
+         socketSetErrnoCode(socket, EINVAL);
+         ret = SOCKET_ERROR;
+      }
+   }
+   else
+   {
+      //The option length is not valid
+      socketSetErrnoCode(socket, EFAULT);
+      ret = SOCKET_ERROR;
+   }
+#else
+   //TCP_INFO is not supported
+   socketSetErrnoCode(socket, ENOPROTOOPT);
+   ret = SOCKET_ERROR;
+#endif
+
+   //Return status code
+   return ret;
+}
+
+
+/**
+ * @brief Get UDP_SEGMENT option
+ * @param[in] socket Handle referencing the socket
+ * @param[out] optval A pointer to the buffer in which the value for the
+ *   requested option is to be returned
+ * @param[in,out] optlen The size, in bytes, of the buffer pointed to by the
+ *   optval parameter
+ * @return Error code (SOCKET_SUCCESS or SOCKET_ERROR)
+ **/
+
+int_t socketGetUdpSegmentOption(Socket *socket, int_t *optval,
+   socklen_t *optlen)
+{
+   int_t ret;
+
+#if (UDP_SUPPORT == ENABLED)
+   //Check the length of the option
+   if(*optlen >= (socklen_t) sizeof(int_t))
+   {
+      //Return the segment size
+      *optval = socket->segmentSize;
+      //Return the actual length of the option
+      *optlen = sizeof(int_t);
+
+      //Successful processing
+      ret = SOCKET_SUCCESS;
+   }
+   else
+   {
+      //The option length is not valid
+      socketSetErrnoCode(socket, EFAULT);
+      ret = SOCKET_ERROR;
+   }
+#else
+   //UDP is not supported
+   socketSetErrnoCode(socket, ENOPROTOOPT);
+   ret = SOCKET_ERROR;
+#endif
+
+   //Return status code
+   return ret;
+}
+
 #endif
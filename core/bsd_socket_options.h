@@ -62,6 +62,15 @@ int_t socketSetSoRcvBufOption(Socket *socket, const int_t *optval,
 int_t socketSetSoKeepAliveOption(Socket *socket, const int_t *optval,
    socklen_t optlen);
 
+int_t socketSetSoBusyPollOption(Socket *socket, const int_t *optval,
+   socklen_t optlen);
+
+int_t socketSetSoAttachFilterOption(Socket *socket,
+   const struct sock_fprog *optval, socklen_t optlen);
+
+int_t socketSetSoDetachFilterOption(Socket *socket, const void *optval,
+   socklen_t optlen);
+
 int_t socketSetIpTosOption(Socket *socket, const int_t *optval,
    socklen_t optlen);
 
@@ -146,6 +155,9 @@ int_t socketSetTcpKeepIntvlOption(Socket *socket, const int_t *optval,
 int_t socketSetTcpKeepCntOption(Socket *socket, const int_t *optval,
    socklen_t optlen);
 
+int_t socketSetUdpSegmentOption(Socket *socket, const int_t *optval,
+   socklen_t optlen);
+
 int_t socketGetSoReuseAddrOption(Socket *socket, int_t *optval,
    socklen_t *optlen);
 
@@ -167,6 +179,9 @@ int_t socketGetSoRcvBufOption(Socket *socket, int_t *optval,
 int_t socketGetSoKeepAliveOption(Socket *socket, int_t *optval,
    socklen_t *optlen);
 
+int_t socketGetSoBusyPollOption(Socket *socket, int_t *optval,
+   socklen_t *optlen);
+
 int_t socketGetSoTypeOption(Socket *socket, int_t *optval,
    socklen_t *optlen);
 
@@ -239,6 +254,12 @@ int_t socketGetTcpKeepIntvlOption(Socket *socket, int_t *optval,
 int_t socketGetTcpKeepCntOption(Socket *socket, int_t *optval,
    socklen_t *optlen);
 
+int_t socketGetTcpInfoOption(Socket *socket, TcpInfo *optval,
+   socklen_t *optlen);
+
+int_t socketGetUdpSegmentOption(Socket *socket, int_t *optval,
+   socklen_t *optlen);
+
 //C++ guard
 #ifdef __cplusplus
 }
@@ -66,6 +66,11 @@ error_t ethInit(NetInterface *interface)
    //Clear the MAC filter table contents
    osMemset(interface->macAddrFilter, 0,
       sizeof(interface->macAddrFilter));
+   //Empty the hash index of the MAC filter table
+   ethUpdateMacAddrFilterHash(interface);
+
+   //Select the CRC32 engine
+   ethCrcInit();
 
    //Successful initialization
    return NO_ERROR;
@@ -97,12 +102,15 @@ void ethProcessFrame(NetInterface *interface, uint8_t *frame, size_t length,
 #if (ETH_PORT_TAGGING_SUPPORT == ENABLED)
    uint8_t port = 0;
 #endif
-#if (ETH_VLAN_SUPPORT == ENABLED)
+#if (ETH_VLAN_SUPPORT == ENABLED || ETH_DEMUX_TABLE_SUPPORT == ENABLED)
    uint16_t vlanId = 0;
 #endif
-#if (ETH_VMAN_SUPPORT == ENABLED)
+#if (ETH_VMAN_SUPPORT == ENABLED || ETH_DEMUX_TABLE_SUPPORT == ENABLED)
    uint16_t vmanId = 0;
 #endif
+#if (ETH_DEMUX_TABLE_SUPPORT == ENABLED)
+   EthDemuxEntry *entry;
+#endif
 
    //Initialize status code
    error = NO_ERROR;
@@ -241,6 +249,41 @@ void ethProcessFrame(NetInterface *interface, uint8_t *frame, size_t length,
    }
 #endif
 
+#if (ETH_DEMUX_TABLE_SUPPORT == ENABLED)
+   //Rebuild the demultiplexing table if the interface configuration changed
+   if(!netContext.ethDemuxTableValid)
+   {
+      ethUpdateDemuxTable();
+   }
+
+   //Only the logical interfaces bound to the same (physical interface, VMAN,
+   //VLAN) tuple need to be examined
+   i = netContext.ethDemuxTable[ethHashDemuxKey(interface, vlanId, vmanId)];
+
+   //Walk the chain
+   for(; i != 0; i = entry->next)
+   {
+      //Point to the current entry
+      entry = &netContext.ethDemuxEntries[i - 1];
+      //Point to the corresponding interface
+      virtualInterface = entry->interface;
+
+      //Discard entries that merely share the same bucket
+      if(entry->physicalInterface != interface ||
+         entry->vlanId != vlanId || entry->vmanId != vmanId)
+      {
+         continue;
+      }
+
+#if (ETH_PORT_TAGGING_SUPPORT == ENABLED)
+      //Retrieve switch port identifier
+      port = entry->port;
+
+      //Check switch port identifier
+      if(port != 0 && port != ancillary->port)
+         continue;
+#endif
+#else
    //802.1Q allows a single physical interface to be bound to multiple
    //virtual interfaces
    for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -271,6 +314,7 @@ void ethProcessFrame(NetInterface *interface, uint8_t *frame, size_t length,
       if((nicGetVmanId(virtualInterface) & VLAN_VID_MASK) != vmanId)
          continue;
 #endif
+#endif
 
 #if (IPV4_SUPPORT == ENABLED && IGMP_ROUTER_SUPPORT == ENABLED)
       //Trap IGMP packets when IGMP router is enabled
@@ -637,6 +681,8 @@ error_t ethAcceptMacAddr(NetInterface *interface, const MacAddr *macAddr)
    firstFreeEntry->addr = *macAddr;
    //Initialize the reference count
    firstFreeEntry->refCount = 1;
+   //Index the new entry
+   ethUpdateMacAddrFilterHash(interface);
 
    //Force the network interface controller to add the current
    //entry to its MAC filter table
@@ -695,6 +741,8 @@ error_t ethDropMacAddr(NetInterface *interface, const MacAddr *macAddr)
                entry->deleteFlag = FALSE;
                //Remove the multicast address from the list
                entry->addr = MAC_UNSPECIFIED_ADDR;
+               //Remove the entry from the hash index
+               ethUpdateMacAddrFilterHash(interface);
             }
 
             //No error to report
@@ -97,6 +97,40 @@
    #error MAC_ADDR_FILTER_SIZE parameter is not valid
 #endif
 
+//Hashed lookup of the MAC address filter
+#ifndef ETH_MAC_FILTER_HASH_SUPPORT
+   #define ETH_MAC_FILTER_HASH_SUPPORT DISABLED
+#elif (ETH_MAC_FILTER_HASH_SUPPORT != ENABLED && ETH_MAC_FILTER_HASH_SUPPORT != DISABLED)
+   #error ETH_MAC_FILTER_HASH_SUPPORT parameter is not valid
+#elif (ETH_MAC_FILTER_HASH_SUPPORT == ENABLED && MAC_ADDR_FILTER_SIZE > 255)
+   #error MAC_ADDR_FILTER_SIZE parameter is not valid
+#endif
+
+//Number of buckets in the MAC address filter hash table (power of two)
+#ifndef MAC_ADDR_FILTER_HASH_SIZE
+   #define MAC_ADDR_FILTER_HASH_SIZE 16
+#elif (MAC_ADDR_FILTER_HASH_SIZE < 1 || MAC_ADDR_FILTER_HASH_SIZE > 256 || \
+   (MAC_ADDR_FILTER_HASH_SIZE & (MAC_ADDR_FILTER_HASH_SIZE - 1)) != 0)
+   #error MAC_ADDR_FILTER_HASH_SIZE parameter is not valid
+#endif
+
+//Logical interface demultiplexing table
+#ifndef ETH_DEMUX_TABLE_SUPPORT
+   #define ETH_DEMUX_TABLE_SUPPORT DISABLED
+#elif (ETH_DEMUX_TABLE_SUPPORT != ENABLED && ETH_DEMUX_TABLE_SUPPORT != DISABLED)
+   #error ETH_DEMUX_TABLE_SUPPORT parameter is not valid
+#elif (ETH_DEMUX_TABLE_SUPPORT == ENABLED && NET_INTERFACE_COUNT > 255)
+   #error NET_INTERFACE_COUNT parameter is not valid
+#endif
+
+//Number of buckets in the demultiplexing table (power of two)
+#ifndef ETH_DEMUX_TABLE_SIZE
+   #define ETH_DEMUX_TABLE_SIZE 16
+#elif (ETH_DEMUX_TABLE_SIZE < 1 || ETH_DEMUX_TABLE_SIZE > 256 || \
+   (ETH_DEMUX_TABLE_SIZE & (ETH_DEMUX_TABLE_SIZE - 1)) != 0)
+   #error ETH_DEMUX_TABLE_SIZE parameter is not valid
+#endif
+
 //CRC32 calculation using a pre-calculated lookup table
 #ifndef ETH_FAST_CRC_SUPPORT
    #define ETH_FAST_CRC_SUPPORT DISABLED
@@ -104,6 +138,27 @@
    #error ETH_FAST_CRC_SUPPORT parameter is not valid
 #endif
 
+//CRC32 calculation using slicing-by-8 lookup tables (8 KB of RAM)
+#ifndef ETH_CRC_SLICING_SUPPORT
+   #define ETH_CRC_SLICING_SUPPORT DISABLED
+#elif (ETH_CRC_SLICING_SUPPORT != ENABLED && ETH_CRC_SLICING_SUPPORT != DISABLED)
+   #error ETH_CRC_SLICING_SUPPORT parameter is not valid
+#endif
+
+//CRC32 calculation using PCLMULQDQ or ARMv8 CRC32 instructions when available
+#ifndef ETH_CRC_HW_ACCEL_SUPPORT
+   #define ETH_CRC_HW_ACCEL_SUPPORT DISABLED
+#elif (ETH_CRC_HW_ACCEL_SUPPORT != ENABLED && ETH_CRC_HW_ACCEL_SUPPORT != DISABLED)
+   #error ETH_CRC_HW_ACCEL_SUPPORT parameter is not valid
+#endif
+
+//Block size used when copying a frame and calculating its CRC in one pass
+#ifndef ETH_CRC_COPY_BLOCK_SIZE
+   #define ETH_CRC_COPY_BLOCK_SIZE 256
+#elif (ETH_CRC_COPY_BLOCK_SIZE < 16)
+   #error ETH_CRC_COPY_BLOCK_SIZE parameter is not valid
+#endif
+
 //Minimum Ethernet frame size
 #define ETH_MIN_FRAME_SIZE 64
 //Maximum Ethernet frame size
@@ -267,6 +322,21 @@ typedef struct
 } MacFilterEntry;
 
 
+/**
+ * @brief Demultiplexing table entry
+ **/
+
+typedef struct
+{
+   NetInterface *interface;         ///<Logical interface
+   NetInterface *physicalInterface; ///<Underlying physical interface
+   uint16_t vlanId;                 ///<VLAN identifier
+   uint16_t vmanId;                 ///<VMAN identifier
+   uint8_t port;                    ///<Switch port identifier
+   uint8_t next;                    ///<Next entry in the same bucket (1-based index)
+} EthDemuxEntry;
+
+
 /**
  * @brief LLC frame received callback
  **/
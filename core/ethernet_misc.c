@@ -47,6 +47,13 @@
 #include "mibs/if_mib_module.h"
 #include "debug.h"
 
+//Instruction set extensions used by the accelerated CRC32 engines
+#if (ETH_CRC_HW_ACCEL_SUPPORT == ENABLED && defined(__ARM_FEATURE_CRC32))
+   #include <arm_acle.h>
+#elif (ETH_CRC_PCLMUL_SUPPORT == ENABLED)
+   #include <immintrin.h>
+#endif
+
 //Check TCP/IP stack configuration
 #if (ETH_SUPPORT == ENABLED)
 
@@ -136,6 +143,16 @@ static const uint32_t crc32Table[256] =
 
 #endif
 
+#if (ETH_CRC_SLICING_SUPPORT == ENABLED)
+//Slicing-by-8 lookup tables (generated at initialization)
+static uint32_t crc32SliceTable[8][256];
+#endif
+
+//CRC32 engine selected at initialization
+static EthCrcEngine ethCrcEngine = NULL;
+//Software engine, also used for the bytes the accelerated engines skip
+static EthCrcEngine ethCrcTailEngine = NULL;
+
 
 /**
  * @brief Ethernet frame padding
@@ -312,6 +329,30 @@ error_t ethCheckDestAddr(NetInterface *interface, const MacAddr *macAddr)
       else
 #endif
       {
+#if (ETH_MAC_FILTER_HASH_SUPPORT == ENABLED)
+         //Only the entries that share the same bucket need to be examined
+         i = interface->macAddrFilterHash[ethHashMacAddr(macAddr)];
+
+         //Walk the chain
+         while(i != 0)
+         {
+            //Point to the current entry
+            entry = &interface->macAddrFilter[i - 1];
+
+            //Check whether the destination MAC address matches a relevant
+            //multicast address
+            if(entry->refCount > 0 && macCompAddr(&entry->addr, macAddr))
+            {
+               //The MAC address is acceptable
+               error = NO_ERROR;
+               //Stop immediately
+               break;
+            }
+
+            //Next entry in the same bucket
+            i = interface->macAddrFilterNext[i - 1];
+         }
+#else
          //Go through the MAC filter table
          for(i = 0; i < MAC_ADDR_FILTER_SIZE; i++)
          {
@@ -332,6 +373,7 @@ error_t ethCheckDestAddr(NetInterface *interface, const MacAddr *macAddr)
                }
             }
          }
+#endif
       }
    }
 
@@ -340,6 +382,153 @@ error_t ethCheckDestAddr(NetInterface *interface, const MacAddr *macAddr)
 }
 
 
+/**
+ * @brief Hash a MAC address into a MAC filter bucket
+ * @param[in] macAddr MAC address
+ * @return Bucket index
+ **/
+
+uint_t ethHashMacAddr(const MacAddr *macAddr)
+{
+   uint32_t h;
+
+   //IPv4 and IPv6 multicast addresses only differ in their last octets
+   h = LOAD32BE(macAddr->b + 2) ^ (macAddr->b[0] << 8) ^ macAddr->b[1];
+
+   //Multiplicative hashing
+   h *= 0x9E3779B1;
+
+   //Return the bucket index
+   return (h >> 16) & (MAC_ADDR_FILTER_HASH_SIZE - 1);
+}
+
+
+/**
+ * @brief Rebuild the hash index of the MAC filter table
+ * @param[in] interface Underlying network interface
+ **/
+
+void ethUpdateMacAddrFilterHash(NetInterface *interface)
+{
+#if (ETH_MAC_FILTER_HASH_SUPPORT == ENABLED)
+   uint_t i;
+   uint_t h;
+
+   //Empty all the buckets
+   osMemset(interface->macAddrFilterHash, 0,
+      sizeof(interface->macAddrFilterHash));
+
+   //Insert entries in reverse order so that each chain is sorted by
+   //increasing index
+   for(i = MAC_ADDR_FILTER_SIZE; i > 0; i--)
+   {
+      //Valid entry?
+      if(interface->macAddrFilter[i - 1].refCount > 0)
+      {
+         //Select the relevant bucket
+         h = ethHashMacAddr(&interface->macAddrFilter[i - 1].addr);
+
+         //Insert the entry at the head of the chain
+         interface->macAddrFilterNext[i - 1] = interface->macAddrFilterHash[h];
+         interface->macAddrFilterHash[h] = (uint8_t) i;
+      }
+      else
+      {
+         //Unused entry
+         interface->macAddrFilterNext[i - 1] = 0;
+      }
+   }
+#endif
+}
+
+
+/**
+ * @brief Hash a (physical interface, VLAN, VMAN) tuple
+ * @param[in] physicalInterface Underlying physical interface
+ * @param[in] vlanId VLAN identifier
+ * @param[in] vmanId VMAN identifier
+ * @return Bucket index
+ **/
+
+uint_t ethHashDemuxKey(NetInterface *physicalInterface, uint16_t vlanId,
+   uint16_t vmanId)
+{
+   uint32_t h;
+
+   //Combine the fields of the key
+   h = (physicalInterface->index << 24) ^ ((vmanId & VLAN_VID_MASK) << 12) ^
+      (vlanId & VLAN_VID_MASK);
+
+   //Multiplicative hashing
+   h *= 0x9E3779B1;
+
+   //Return the bucket index
+   return (h >> 16) & (ETH_DEMUX_TABLE_SIZE - 1);
+}
+
+
+/**
+ * @brief Rebuild the logical interface demultiplexing table
+ **/
+
+void ethUpdateDemuxTable(void)
+{
+#if (ETH_DEMUX_TABLE_SUPPORT == ENABLED)
+   uint_t i;
+   uint_t h;
+   NetInterface *interface;
+   EthDemuxEntry *entry;
+
+   //Empty all the buckets
+   osMemset(netContext.ethDemuxTable, 0, sizeof(netContext.ethDemuxTable));
+
+   //Insert interfaces in reverse order so that frames are delivered in the
+   //same order as a linear scan of the interface table
+   for(i = NET_INTERFACE_COUNT; i > 0; i--)
+   {
+      //Point to the current interface
+      interface = &netInterface[i - 1];
+      //Point to the corresponding entry
+      entry = &netContext.ethDemuxEntries[i - 1];
+
+      //Resolve the demultiplexing key once for all
+      entry->interface = interface;
+      entry->physicalInterface = nicGetPhysicalInterface(interface);
+      entry->vlanId = nicGetVlanId(interface) & VLAN_VID_MASK;
+      entry->vmanId = nicGetVmanId(interface) & VLAN_VID_MASK;
+      entry->port = nicGetSwitchPort(interface);
+
+      //Select the relevant bucket
+      h = ethHashDemuxKey(entry->physicalInterface, entry->vlanId,
+         entry->vmanId);
+
+      //Insert the entry at the head of the chain
+      entry->next = netContext.ethDemuxTable[h];
+      netContext.ethDemuxTable[h] = (uint8_t) i;
+   }
+
+   //The table is now up to date
+   netContext.ethDemuxTableValid = TRUE;
+#endif
+}
+
+
+/**
+ * @brief Invalidate the logical interface demultiplexing table
+ *
+ * The table is rebuilt upon reception of the next frame
+ *
+ **/
+
+void ethInvalidateDemuxTable(void)
+{
+#if (ETH_DEMUX_TABLE_SUPPORT == ENABLED)
+   //Force the table to be rebuilt
+   netContext.ethDemuxTableValid = FALSE;
+#endif
+}
+
+
 /**
  * @brief Trap IGMP packets
  * @param[in] header Pointer to the Ethernet header
@@ -493,48 +682,100 @@ void ethUpdateErrorStats(NetInterface *interface, error_t error)
 
 
 /**
- * @brief Ethernet CRC calculation
- * @param[in] data Pointer to the data over which to calculate the CRC
- * @param[in] length Number of bytes to process
- * @return Resulting CRC value
+ * @brief Select the CRC32 engine
+ *
+ * The fastest engine supported by the build configuration and by the CPU is
+ * selected. The routine can safely be called several times
  **/
 
-uint32_t ethCalcCrc(const void *data, size_t length)
+void ethCrcInit(void)
 {
-//A lookup table can be used to speed up CRC calculation
-#if (ETH_FAST_CRC_SUPPORT == ENABLED)
+#if (ETH_CRC_SLICING_SUPPORT == ENABLED)
    uint_t i;
+   uint_t j;
+   uint32_t crc;
+#endif
 
-   //Point to the data over which to calculate the CRC
-   const uint8_t *p = (uint8_t *) data;
-   //CRC preset value
-   uint32_t crc = 0xFFFFFFFF;
+   //The engine has already been selected?
+   if(ethCrcEngine != NULL)
+      return;
 
-   //Loop through data
-   for(i = 0; i < length; i++)
+#if (ETH_CRC_SLICING_SUPPORT == ENABLED)
+   //Generate the first table from the reflected polynomial
+   for(i = 0; i < 256; i++)
    {
-      //The message is processed byte by byte
-      crc = (crc >> 8) ^ crc32Table[(crc & 0xFF) ^ p[i]];
+      crc = i;
+
+      for(j = 0; j < 8; j++)
+      {
+         if(crc & 0x00000001)
+         {
+            crc = (crc >> 1) ^ 0xEDB88320;
+         }
+         else
+         {
+            crc = crc >> 1;
+         }
+      }
+
+      crc32SliceTable[0][i] = crc;
    }
 
-   //Return 1's complement value
-   return ~crc;
+   //Each subsequent table advances the CRC by one more zero byte
+   for(i = 0; i < 256; i++)
+   {
+      crc = crc32SliceTable[0][i];
 
-//Bit by bit CRC calculation
+      for(j = 1; j < 8; j++)
+      {
+         crc = (crc >> 8) ^ crc32SliceTable[0][crc & 0xFF];
+         crc32SliceTable[j][i] = crc;
+      }
+   }
+
+   //Slicing-by-8 software engine
+   ethCrcTailEngine = ethCrcUpdateSlice8;
+#elif (ETH_FAST_CRC_SUPPORT == ENABLED)
+   //Byte-wise table-driven engine
+   ethCrcTailEngine = ethCrcUpdateTable;
 #else
-   uint_t i;
-   uint_t j;
+   //Bit-wise engine
+   ethCrcTailEngine = ethCrcUpdateBitwise;
+#endif
 
-   //Point to the data over which to calculate the CRC
-   const uint8_t *p = (uint8_t *) data;
-   //CRC preset value
-   uint32_t crc = 0xFFFFFFFF;
+   //Default to the software engine
+   ethCrcEngine = ethCrcTailEngine;
+
+#if (ETH_CRC_HW_ACCEL_SUPPORT == ENABLED && defined(__ARM_FEATURE_CRC32))
+   //The ARMv8 CRC32 instructions are available
+   ethCrcEngine = ethCrcUpdateArm;
+#elif (ETH_CRC_HW_ACCEL_SUPPORT == ENABLED && ETH_CRC_PCLMUL_SUPPORT == ENABLED)
+   //Check whether the CPU implements carry-less multiplication
+   if(__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+   {
+      ethCrcEngine = ethCrcUpdatePclmul;
+   }
+#endif
+}
+
+
+/**
+ * @brief Update CRC32 register (bit by bit)
+ * @param[in] crc Current value of the CRC register
+ * @param[in] data Pointer to the data to process
+ * @param[in] length Number of bytes to process
+ * @return Updated value of the CRC register
+ **/
+
+uint32_t ethCrcUpdateBitwise(uint32_t crc, const uint8_t *data, size_t length)
+{
+   uint_t j;
 
    //Loop through data
-   for(i = 0; i < length; i++)
+   while(length > 0)
    {
       //Update CRC value
-      crc ^= p[i];
+      crc ^= *data;
 
       //The message is processed bit by bit
       for(j = 0; j < 8; j++)
@@ -548,11 +789,276 @@ uint32_t ethCalcCrc(const void *data, size_t length)
             crc = crc >> 1;
          }
       }
+
+      //Next byte
+      data++;
+      length--;
    }
 
-   //Return 1's complement value
-   return ~crc;
+   //Return updated CRC value
+   return crc;
+}
+
+
+#if (ETH_FAST_CRC_SUPPORT == ENABLED)
+
+/**
+ * @brief Update CRC32 register (byte by byte, using a lookup table)
+ * @param[in] crc Current value of the CRC register
+ * @param[in] data Pointer to the data to process
+ * @param[in] length Number of bytes to process
+ * @return Updated value of the CRC register
+ **/
+
+uint32_t ethCrcUpdateTable(uint32_t crc, const uint8_t *data, size_t length)
+{
+   //Loop through data
+   while(length > 0)
+   {
+      //The message is processed byte by byte
+      crc = (crc >> 8) ^ crc32Table[(crc & 0xFF) ^ *data];
+
+      //Next byte
+      data++;
+      length--;
+   }
+
+   //Return updated CRC value
+   return crc;
+}
+
+#endif
+#if (ETH_CRC_SLICING_SUPPORT == ENABLED)
+
+/**
+ * @brief Update CRC32 register (8 bytes at a time, using slicing-by-8)
+ * @param[in] crc Current value of the CRC register
+ * @param[in] data Pointer to the data to process
+ * @param[in] length Number of bytes to process
+ * @return Updated value of the CRC register
+ **/
+
+uint32_t ethCrcUpdateSlice8(uint32_t crc, const uint8_t *data, size_t length)
+{
+   uint32_t high;
+
+   //Process 8 bytes at a time
+   while(length >= 8)
+   {
+      //Fold the next 8 bytes into the CRC register
+      crc ^= LOAD32LE(data);
+      high = LOAD32LE(data + 4);
+
+      //Eight independent table lookups
+      crc = crc32SliceTable[7][crc & 0xFF] ^
+         crc32SliceTable[6][(crc >> 8) & 0xFF] ^
+         crc32SliceTable[5][(crc >> 16) & 0xFF] ^
+         crc32SliceTable[4][crc >> 24] ^
+         crc32SliceTable[3][high & 0xFF] ^
+         crc32SliceTable[2][(high >> 8) & 0xFF] ^
+         crc32SliceTable[1][(high >> 16) & 0xFF] ^
+         crc32SliceTable[0][high >> 24];
+
+      //Next block
+      data += 8;
+      length -= 8;
+   }
+
+   //Process the remaining bytes
+   while(length > 0)
+   {
+      crc = (crc >> 8) ^ crc32SliceTable[0][(crc & 0xFF) ^ *data];
+
+      //Next byte
+      data++;
+      length--;
+   }
+
+   //Return updated CRC value
+   return crc;
+}
+
 #endif
+#if (ETH_CRC_HW_ACCEL_SUPPORT == ENABLED && defined(__ARM_FEATURE_CRC32))
+
+/**
+ * @brief Update CRC32 register (using ARMv8 CRC32 instructions)
+ * @param[in] crc Current value of the CRC register
+ * @param[in] data Pointer to the data to process
+ * @param[in] length Number of bytes to process
+ * @return Updated value of the CRC register
+ **/
+
+uint32_t ethCrcUpdateArm(uint32_t crc, const uint8_t *data, size_t length)
+{
+   //Process 8 bytes at a time
+   while(length >= 8)
+   {
+      crc = __crc32d(crc, ((uint64_t) LOAD32LE(data + 4) << 32) |
+         LOAD32LE(data));
+
+      //Next block
+      data += 8;
+      length -= 8;
+   }
+
+   //Process the remaining bytes
+   while(length > 0)
+   {
+      crc = __crc32b(crc, *data);
+
+      //Next byte
+      data++;
+      length--;
+   }
+
+   //Return updated CRC value
+   return crc;
+}
+
+#elif (ETH_CRC_HW_ACCEL_SUPPORT == ENABLED && ETH_CRC_PCLMUL_SUPPORT == ENABLED)
+
+/**
+ * @brief Update CRC32 register (using PCLMULQDQ folding)
+ *
+ * Blocks of 64 bytes are folded in parallel, then reduced to 32 bits using
+ * Barrett reduction, as described in Intel's "Fast CRC Computation for
+ * Generic Polynomials Using PCLMULQDQ Instruction". The trailing bytes are
+ * handed over to the software engine
+ *
+ * @param[in] crc Current value of the CRC register
+ * @param[in] data Pointer to the data to process
+ * @param[in] length Number of bytes to process
+ * @return Updated value of the CRC register
+ **/
+
+__attribute__((target("pclmul,sse4.1")))
+uint32_t ethCrcUpdatePclmul(uint32_t crc, const uint8_t *data, size_t length)
+{
+   size_t n;
+   __m128i k;
+   __m128i x1;
+   __m128i x2;
+   __m128i x3;
+   __m128i x4;
+   __m128i x5;
+   __m128i x6;
+   __m128i x7;
+   __m128i x8;
+   __m128i mask;
+
+   //Short blocks are processed in software
+   if(length < 64)
+      return ethCrcTailEngine(crc, data, length);
+
+   //Number of bytes processed using carry-less multiplication
+   n = length & ~(size_t) 15;
+
+   //Load the first 64 bytes and fold in the initial CRC value
+   x1 = _mm_loadu_si128((const __m128i *) (data + 0));
+   x2 = _mm_loadu_si128((const __m128i *) (data + 16));
+   x3 = _mm_loadu_si128((const __m128i *) (data + 32));
+   x4 = _mm_loadu_si128((const __m128i *) (data + 48));
+   x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int) crc));
+
+   //Fold by 4 constants (k1, k2)
+   k = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+
+   //Parallel folding of 64-byte blocks
+   for(data += 64, length -= 64, n -= 64; n >= 64; data += 64, n -= 64,
+      length -= 64)
+   {
+      x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+      x6 = _mm_clmulepi64_si128(x2, k, 0x00);
+      x7 = _mm_clmulepi64_si128(x3, k, 0x00);
+      x8 = _mm_clmulepi64_si128(x4, k, 0x00);
+
+      x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+      x2 = _mm_clmulepi64_si128(x2, k, 0x11);
+      x3 = _mm_clmulepi64_si128(x3, k, 0x11);
+      x4 = _mm_clmulepi64_si128(x4, k, 0x11);
+
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+         _mm_loadu_si128((const __m128i *) (data + 0)));
+      x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+         _mm_loadu_si128((const __m128i *) (data + 16)));
+      x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+         _mm_loadu_si128((const __m128i *) (data + 32)));
+      x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+         _mm_loadu_si128((const __m128i *) (data + 48)));
+   }
+
+   //Fold by 1 constants (k3, k4)
+   k = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+
+   //Fold the 4 lanes into a single 128-bit value
+   x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+   x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+   x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+   x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+   x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+   x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+   x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+   x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+   x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+   //Fold the remaining 16-byte blocks
+   for(; n >= 16; data += 16, n -= 16, length -= 16)
+   {
+      x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+      x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+         _mm_loadu_si128((const __m128i *) data));
+   }
+
+   //Fold 128 bits down to 64 bits
+   mask = _mm_setr_epi32(~0, 0, ~0, 0);
+   x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+   x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+   //Constant k5
+   k = _mm_set_epi64x(0, 0x0163CD6124);
+
+   x2 = _mm_srli_si128(x1, 4);
+   x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x00);
+   x1 = _mm_xor_si128(x1, x2);
+
+   //Barrett reduction to 32 bits (P(x)' and u')
+   k = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+
+   x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x10);
+   x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), k, 0x00);
+   x1 = _mm_xor_si128(x1, x2);
+
+   //Retrieve the CRC register
+   crc = (uint32_t) _mm_extract_epi32(x1, 1);
+
+   //Process the trailing bytes in software
+   return ethCrcTailEngine(crc, data, length);
+}
+
+#endif
+
+
+/**
+ * @brief Ethernet CRC calculation
+ * @param[in] data Pointer to the data over which to calculate the CRC
+ * @param[in] length Number of bytes to process
+ * @return Resulting CRC value
+ **/
+
+uint32_t ethCalcCrc(const void *data, size_t length)
+{
+   //Make sure a CRC engine has been selected
+   if(ethCrcEngine == NULL)
+   {
+      ethCrcInit();
+   }
+
+   //Apply the preset value and return the 1's complement of the register
+   return ~ethCrcEngine(0xFFFFFFFF, (const uint8_t *) data, length);
 }
 
 
@@ -570,9 +1076,12 @@ uint32_t ethCalcCrcEx(const NetBuffer *buffer, size_t offset, size_t length)
    uint_t n;
    uint32_t crc;
    uint8_t *p;
-#if (ETH_FAST_CRC_SUPPORT == DISABLED)
-   uint_t k;
-#endif
+
+   //Make sure a CRC engine has been selected
+   if(ethCrcEngine == NULL)
+   {
+      ethCrcInit();
+   }
 
    //CRC preset value
    crc = 0xFFFFFFFF;
@@ -591,32 +1100,7 @@ uint32_t ethCalcCrcEx(const NetBuffer *buffer, size_t offset, size_t length)
          length -= n;
 
          //Process current chunk
-         while(n > 0)
-         {
-#if (ETH_FAST_CRC_SUPPORT == ENABLED)
-            //The message is processed byte by byte
-            crc = (crc >> 8) ^ crc32Table[(crc & 0xFF) ^ *p];
-#else
-            //Update CRC value
-            crc ^= *p;
-
-            //The message is processed bit by bit
-            for(k = 0; k < 8; k++)
-            {
-               if(crc & 0x00000001)
-               {
-                  crc = (crc >> 1) ^ 0xEDB88320;
-               }
-               else
-               {
-                  crc = crc >> 1;
-               }
-            }
-#endif
-            //Next byte
-            p++;
-            n--;
-         }
+         crc = ethCrcEngine(crc, p, n);
 
          //Process the next block from the start
          offset = 0;
@@ -633,6 +1117,60 @@ uint32_t ethCalcCrcEx(const NetBuffer *buffer, size_t offset, size_t length)
 }
 
 
+/**
+ * @brief Copy a frame and calculate its CRC in a single pass
+ *
+ * The data is copied in blocks small enough to remain in the data cache, so
+ * that the CRC engine reads the copy rather than the source buffer. This
+ * suits drivers that copy frames out of DMA or SPI buffers
+ *
+ * @param[out] dest Destination buffer
+ * @param[in] src Source buffer
+ * @param[in] length Number of bytes to copy
+ * @return Resulting CRC value
+ **/
+
+uint32_t ethCopyCalcCrc(void *dest, const void *src, size_t length)
+{
+   size_t n;
+   uint32_t crc;
+   uint8_t *d;
+   const uint8_t *s;
+
+   //Make sure a CRC engine has been selected
+   if(ethCrcEngine == NULL)
+   {
+      ethCrcInit();
+   }
+
+   //Point to the buffers
+   d = (uint8_t *) dest;
+   s = (const uint8_t *) src;
+
+   //CRC preset value
+   crc = 0xFFFFFFFF;
+
+   //Process the data block by block
+   while(length > 0)
+   {
+      //Size of the current block
+      n = MIN(length, ETH_CRC_COPY_BLOCK_SIZE);
+
+      //Copy the block, then update the CRC while it is still cached
+      osMemcpy(d, s, n);
+      crc = ethCrcEngine(crc, d, n);
+
+      //Next block
+      d += n;
+      s += n;
+      length -= n;
+   }
+
+   //Return 1's complement value
+   return ~crc;
+}
+
+
 /**
  * @brief Ethernet CRC verification
  * @param[in] interface Underlying network interface
@@ -35,11 +35,31 @@
 #include "core/net.h"
 #include "core/ethernet.h"
 
+//Carry-less multiplication engine (x86 targets built with GCC or Clang)
+#if (ETH_CRC_HW_ACCEL_SUPPORT == ENABLED && !defined(__ARM_FEATURE_CRC32) && \
+   defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+   #define ETH_CRC_PCLMUL_SUPPORT ENABLED
+#else
+   #define ETH_CRC_PCLMUL_SUPPORT DISABLED
+#endif
+
 //C++ guard
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+
+/**
+ * @brief CRC32 engine
+ *
+ * Updates the CRC register (preset and final complement excluded) over a
+ * block of data
+ **/
+
+typedef uint32_t (*EthCrcEngine)(uint32_t crc, const uint8_t *data,
+   size_t length);
+
+
 //Ethernet related constants
 extern const uint8_t ethPadding[64];
 
@@ -55,6 +75,15 @@ error_t ethDecodeVlanTag(const uint8_t *frame, size_t length, uint16_t *vlanId,
 error_t ethCheckDestAddr(NetInterface *interface, const MacAddr *macAddr);
 bool_t ethTrapIgmpPacket(EthHeader *header, uint8_t *data, size_t length);
 
+uint_t ethHashMacAddr(const MacAddr *macAddr);
+void ethUpdateMacAddrFilterHash(NetInterface *interface);
+
+uint_t ethHashDemuxKey(NetInterface *physicalInterface, uint16_t vlanId,
+   uint16_t vmanId);
+
+void ethUpdateDemuxTable(void);
+void ethInvalidateDemuxTable(void);
+
 void ethUpdateInStats(NetInterface *interface, const MacAddr *destMacAddr);
 
 void ethUpdateOutStats(NetInterface *interface, const MacAddr *destMacAddr,
@@ -62,8 +91,17 @@ void ethUpdateOutStats(NetInterface *interface, const MacAddr *destMacAddr,
 
 void ethUpdateErrorStats(NetInterface *interface, error_t error);
 
+void ethCrcInit(void);
+
+uint32_t ethCrcUpdateBitwise(uint32_t crc, const uint8_t *data, size_t length);
+uint32_t ethCrcUpdateTable(uint32_t crc, const uint8_t *data, size_t length);
+uint32_t ethCrcUpdateSlice8(uint32_t crc, const uint8_t *data, size_t length);
+uint32_t ethCrcUpdateArm(uint32_t crc, const uint8_t *data, size_t length);
+uint32_t ethCrcUpdatePclmul(uint32_t crc, const uint8_t *data, size_t length);
+
 uint32_t ethCalcCrc(const void *data, size_t length);
 uint32_t ethCalcCrcEx(const NetBuffer *buffer, size_t offset, size_t length);
+uint32_t ethCopyCalcCrc(void *dest, const void *src, size_t length);
 
 error_t ethCheckCrc(NetInterface *interface, const uint8_t *frame,
    size_t length);
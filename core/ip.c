@@ -69,6 +69,11 @@ error_t ipSendDatagram(NetInterface *interface,
 {
    error_t error;
 
+#if (NET_STATS_SUPPORT == ENABLED)
+   //Save the time at which the packet entered the IP layer
+   ancillary->statsTimestamp = NET_STATS_GET_TIME_US();
+#endif
+
 #if (IPV4_SUPPORT == ENABLED)
    //Destination address is an IPv4 address?
    if(pseudoHeader->length == sizeof(Ipv4PseudoHeader))
@@ -305,6 +310,48 @@ bool_t ipIsBroadcastAddr(const IpAddr *ipAddr)
 }
 
 
+/**
+ * @brief Check whether the upper-layer checksum of a packet can be omitted
+ *
+ * Packets addressed to the local host are delivered through the loopback
+ * interface and cannot be corrupted in transit
+ *
+ * @param[in] destAddr Destination IP address
+ * @return TRUE if the checksum calculation can be skipped, else FALSE
+ **/
+
+bool_t ipIsChecksumBypassed(const IpAddr *destAddr)
+{
+   bool_t result;
+
+#if (NET_LOOPBACK_IF_CHECKSUM_BYPASS == ENABLED && IPV4_SUPPORT == ENABLED)
+   //IPv4 address?
+   if(destAddr->length == sizeof(Ipv4Addr))
+   {
+      //Check whether the packet is sent through the loopback interface
+      result = ipv4IsLocalHostAddr(destAddr->ipv4Addr);
+   }
+   else
+#endif
+#if (NET_LOOPBACK_IF_CHECKSUM_BYPASS == ENABLED && IPV6_SUPPORT == ENABLED)
+   //IPv6 address?
+   if(destAddr->length == sizeof(Ipv6Addr))
+   {
+      //Check whether the packet is sent through the loopback interface
+      result = ipv6IsLocalHostAddr(&destAddr->ipv6Addr);
+   }
+   else
+#endif
+   //Any other address?
+   {
+      result = FALSE;
+   }
+
+   //Return TRUE if the checksum calculation can be skipped
+   return result;
+}
+
+
 /**
  * @brief Compare IP addresses
  * @param[in] ipAddr1 First IP address
@@ -127,6 +127,7 @@ bool_t ipIsUnspecifiedAddr(const IpAddr *ipAddr);
 bool_t ipIsLinkLocalAddr(const IpAddr *ipAddr);
 bool_t ipIsMulticastAddr(const IpAddr *ipAddr);
 bool_t ipIsBroadcastAddr(const IpAddr *ipAddr);
+bool_t ipIsChecksumBypassed(const IpAddr *destAddr);
 
 bool_t ipCompAddr(const IpAddr *ipAddr1, const IpAddr *ipAddr2);
 
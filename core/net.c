@@ -35,10 +35,12 @@
 #include <stdlib.h>
 #include "core/net.h"
 #include "core/socket.h"
+#include "core/socket_async.h"
 #include "core/raw_socket.h"
 #include "core/tcp_timer.h"
 #include "core/tcp_misc.h"
 #include "core/ethernet.h"
+#include "core/ethernet_misc.h"
 #include "ipv4/arp.h"
 #include "ipv4/ipv4.h"
 #include "ipv4/ipv4_routing.h"
@@ -71,8 +73,15 @@
    #include "web_socket/web_socket.h"
 #endif
 
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+//Default TCP/IP stack context
+static NetContext netDefaultContext;
+//Stack instance the calling task operates on
+NET_THREAD_LOCAL NetContext *netCurrentContext = &netDefaultContext;
+#else
 //TCP/IP stack context
 NetContext netContext;
+#endif
 
 
 /**
@@ -130,6 +139,9 @@ error_t netInitEx(NetContext *context, const NetSettings *settings)
    uint_t i;
    NetInterface *interface;
 
+   //Bind the calling task to the stack instance being initialized
+   netSetCurrentContext(context);
+
    //Clear TCP/IP stack context
    osMemset(context, 0, sizeof(NetContext));
 
@@ -142,6 +154,14 @@ error_t netInitEx(NetContext *context, const NetSettings *settings)
    //Get current time
    netTimestamp = osGetSystemTime();
 
+#if (NET_LOCK_PROFILING_SUPPORT == ENABLED)
+   //Lock contention profiling must be ready before the first mutex is used
+   error = netLockInit();
+   //Any error to report?
+   if(error)
+      return error;
+#endif
+
    //Create a mutex to prevent simultaneous access to the TCP/IP stack
    if(!osCreateMutex(&netMutex))
    {
@@ -174,6 +194,8 @@ error_t netInitEx(NetContext *context, const NetSettings *settings)
       //Default interface name
       osSprintf(interface->name, "eth%u", i);
 
+      //Stack instance the interface belongs to
+      interface->context = context;
       //Zero-based index
       interface->index = i;
       //Unique number identifying the interface
@@ -241,60 +263,6 @@ error_t netInitEx(NetContext *context, const NetSettings *settings)
       return error;
 #endif
 
-   //Initialize tick counters
-   nicTickCounter = 0;
-
-#if (PPP_SUPPORT == ENABLED)
-   pppTickCounter = 0;
-#endif
-#if (IPV4_SUPPORT == ENABLED && ETH_SUPPORT == ENABLED)
-   arpTickCounter = 0;
-#endif
-#if (IPV4_SUPPORT == ENABLED && IPV4_FRAG_SUPPORT == ENABLED)
-   ipv4FragTickCounter = 0;
-#endif
-#if (IPV4_SUPPORT == ENABLED && (IGMP_HOST_SUPPORT == ENABLED || \
-   IGMP_ROUTER_SUPPORT == ENABLED || IGMP_SNOOPING_SUPPORT == ENABLED))
-   igmpTickCounter = 0;
-#endif
-#if (IPV4_SUPPORT == ENABLED && AUTO_IP_SUPPORT == ENABLED)
-   autoIpTickCounter = 0;
-#endif
-#if (IPV4_SUPPORT == ENABLED && DHCP_CLIENT_SUPPORT == ENABLED)
-   dhcpClientTickCounter = 0;
-#endif
-#if (IPV4_SUPPORT == ENABLED && DHCP_SERVER_SUPPORT == ENABLED)
-   dhcpServerTickCounter = 0;
-#endif
-#if (IPV6_SUPPORT == ENABLED && IPV6_FRAG_SUPPORT == ENABLED)
-   ipv6FragTickCounter = 0;
-#endif
-#if (IPV6_SUPPORT == ENABLED && MLD_SUPPORT == ENABLED)
-   mldTickCounter = 0;
-#endif
-#if (IPV6_SUPPORT == ENABLED && NDP_SUPPORT == ENABLED)
-   ndpTickCounter = 0;
-#endif
-#if (IPV6_SUPPORT == ENABLED && NDP_ROUTER_ADV_SUPPORT == ENABLED)
-   ndpRouterAdvTickCounter = 0;
-#endif
-#if (IPV6_SUPPORT == ENABLED && DHCPV6_CLIENT_SUPPORT == ENABLED)
-   dhcpv6ClientTickCounter = 0;
-#endif
-#if (TCP_SUPPORT == ENABLED)
-   tcpTickCounter = 0;
-#endif
-#if (DNS_CLIENT_SUPPORT == ENABLED || MDNS_CLIENT_SUPPORT == ENABLED || \
-   NBNS_CLIENT_SUPPORT == ENABLED)
-   dnsTickCounter = 0;
-#endif
-#if (MDNS_RESPONDER_SUPPORT == ENABLED)
-   mdnsResponderTickCounter = 0;
-#endif
-#if (DNS_SD_SUPPORT == ENABLED)
-   dnsSdTickCounter = 0;
-#endif
-
    //Successful initialization
    return NO_ERROR;
 }
@@ -326,6 +294,41 @@ error_t netStart(NetContext *context)
 }
 
 
+/**
+ * @brief Select the stack instance the calling task operates on
+ *
+ * When several stack instances run in the same process, every task that
+ * calls the socket or configuration API must first bind itself to the
+ * instance it uses. The binding is per task and defaults to the instance
+ * initialized by netInit()
+ *
+ * @param[in] context Pointer to the TCP/IP stack context
+ **/
+
+void netSetCurrentContext(NetContext *context)
+{
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Valid context?
+   if(context != NULL)
+   {
+      netCurrentContext = context;
+   }
+#endif
+}
+
+
+/**
+ * @brief Retrieve the stack instance the calling task operates on
+ * @return Pointer to the TCP/IP stack context
+ **/
+
+NetContext *netGetCurrentContext(void)
+{
+   //Return the current stack instance
+   return &netContext;
+}
+
+
 /**
  * @brief Seed the pseudo-random number generator
  * @param[in] seed Pointer to the random seed
@@ -706,6 +709,10 @@ error_t netSetVlanId(NetInterface *interface, uint16_t vlanId)
    osAcquireMutex(&netMutex);
    //Set VLAN identifier
    interface->vlanId = vlanId;
+#if (ETH_SUPPORT == ENABLED)
+   //The demultiplexing key of the interface may have changed
+   ethInvalidateDemuxTable();
+#endif
    //Release exclusive access
    osReleaseMutex(&netMutex);
 
@@ -740,6 +747,10 @@ error_t netSetVmanId(NetInterface *interface, uint16_t vmanId)
    osAcquireMutex(&netMutex);
    //Set VMAN identifier
    interface->vmanId = vmanId;
+#if (ETH_SUPPORT == ENABLED)
+   //The demultiplexing key of the interface may have changed
+   ethInvalidateDemuxTable();
+#endif
    //Release exclusive access
    osReleaseMutex(&netMutex);
 
@@ -773,6 +784,10 @@ error_t netSetParentInterface(NetInterface *interface,
    osAcquireMutex(&netMutex);
    //Bind the virtual interface to the physical interface
    interface->parent = physicalInterface;
+#if (ETH_SUPPORT == ENABLED)
+   //The demultiplexing key of the interface may have changed
+   ethInvalidateDemuxTable();
+#endif
    //Release exclusive access
    osReleaseMutex(&netMutex);
 
@@ -802,6 +817,10 @@ error_t netSetDriver(NetInterface *interface, const NicDriver *driver)
    osAcquireMutex(&netMutex);
    //Set Ethernet MAC driver
    interface->nicDriver = driver;
+#if (ETH_SUPPORT == ENABLED)
+   //The demultiplexing key of the interface may have changed
+   ethInvalidateDemuxTable();
+#endif
    //Release exclusive access
    osReleaseMutex(&netMutex);
 
@@ -922,6 +941,10 @@ error_t netSetSwitchPort(NetInterface *interface, uint8_t port)
    osAcquireMutex(&netMutex);
    //Set switch port identifier
    interface->port = port;
+#if (ETH_SUPPORT == ENABLED)
+   //The demultiplexing key of the interface may have changed
+   ethInvalidateDemuxTable();
+#endif
    //Release exclusive access
    osReleaseMutex(&netMutex);
 
@@ -1536,10 +1559,17 @@ void netTask(void)
 void netTaskEx(NetContext *context)
 {
    uint_t i;
+   uint_t n;
    bool_t status;
    systime_t time;
    systime_t timeout;
    NetInterface *interface;
+#if (NET_STATS_SUPPORT == ENABLED)
+   uint32_t lockTime;
+#endif
+
+   //Bind the task to its stack instance
+   netSetCurrentContext(context);
 
 #if (NET_RTOS_SUPPORT == ENABLED)
    //Task prologue
@@ -1595,32 +1625,29 @@ void netTaskEx(NetContext *context)
       //Check whether the specified event is in signaled state
       if(status)
       {
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Start of the wait
+         lockTime = NET_STATS_GET_TIME_US();
+#endif
          //Get exclusive access
          osAcquireMutex(&netMutex);
 
-         //Process events
-         for(i = 0; i < NET_INTERFACE_COUNT; i++)
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Time spent waiting for the lock
+         netStatsRecord(NET_STATS_MUTEX_WAIT, NET_STATS_GET_TIME_US() - lockTime);
+         lockTime = NET_STATS_GET_TIME_US();
+#endif
+
+         //Process events, starting with a different interface on each round
+         //so that a busy interface cannot starve the others
+         for(n = 0; n < NET_INTERFACE_COUNT; n++)
          {
             //Point to the current network interface
+            i = (context->rxIndex + n) % NET_INTERFACE_COUNT;
             interface = &netInterface[i];
 
-            //Check whether a NIC event is pending
-            if(interface->nicEvent)
-            {
-               //Acknowledge the event by clearing the flag
-               interface->nicEvent = FALSE;
-
-               //Valid NIC driver?
-               if(interface->nicDriver != NULL)
-               {
-                  //Disable hardware interrupts
-                  interface->nicDriver->disableIrq(interface);
-                  //Handle NIC events
-                  interface->nicDriver->eventHandler(interface);
-                  //Re-enable hardware interrupts
-                  interface->nicDriver->enableIrq(interface);
-               }
-            }
+            //Handle pending NIC events
+            nicProcessEvents(interface);
 
 #if (ETH_SUPPORT == ENABLED)
             //Check whether a PHY event is pending
@@ -1658,6 +1685,13 @@ void netTaskEx(NetContext *context)
 #endif
          }
 
+         //Rotate the first interface to be serviced
+         context->rxIndex = (context->rxIndex + 1) % NET_INTERFACE_COUNT;
+
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Time during which the lock was held
+         netStatsRecord(NET_STATS_MUTEX_HOLD, NET_STATS_GET_TIME_US() - lockTime);
+#endif
          //Release exclusive access
          osReleaseMutex(&netMutex);
       }
@@ -1668,16 +1702,36 @@ void netTaskEx(NetContext *context)
       //Check current time
       if(timeCompare(time, netTimestamp) >= 0)
       {
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Start of the wait
+         lockTime = NET_STATS_GET_TIME_US();
+#endif
          //Get exclusive access
          osAcquireMutex(&netMutex);
+
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Time spent waiting for the lock
+         netStatsRecord(NET_STATS_MUTEX_WAIT, NET_STATS_GET_TIME_US() - lockTime);
+         lockTime = NET_STATS_GET_TIME_US();
+#endif
          //Handle periodic operations
          netTick();
+
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Time during which the lock was held
+         netStatsRecord(NET_STATS_MUTEX_HOLD, NET_STATS_GET_TIME_US() - lockTime);
+#endif
          //Release exclusive access
          osReleaseMutex(&netMutex);
 
          //Next event
          netTimestamp = time + NET_TICK_INTERVAL;
       }
+
+#if (SOCKET_ASYNC_SUPPORT == ENABLED)
+      //Complete the operations posted to the asynchronous socket rings
+      socketAsyncProcess();
+#endif
 #if (NET_RTOS_SUPPORT == ENABLED)
    }
 #endif
@@ -35,14 +35,26 @@
 struct _NetInterface;
 #define NetInterface struct _NetInterface
 
+//Forward declaration of per-instance state structures
+struct _NetContext;
+struct _SocketContext;
+struct _UdpContext;
+struct _DnsCacheContext;
+struct _BsdSocketContext;
+struct _Ipv6RoutingContext;
+
 //Dependencies
 #include "os_port.h"
 #include "net_config.h"
 #include "core/net_legacy.h"
+#include "core/net_stats.h"
 #include "core/net_mem.h"
 #include "core/net_misc.h"
 #include "core/nic.h"
 #include "core/ethernet.h"
+#include "core/net_capture.h"
+#include "core/net_trace.h"
+#include "core/net_lock.h"
 #include "ipv4/ipv4.h"
 #include "ipv4/ipv4_frag.h"
 #include "ipv4/auto_ip.h"
@@ -108,6 +120,34 @@ struct _NetInterface;
    #error NET_RTOS_SUPPORT parameter is not valid
 #endif
 
+//Multiple stack instances support. A few objects remain shared by all the
+//instances: the network buffer pool (protected by its own mutex), the
+//Ethernet CRC tables (read-only once generated), the trace rings (one per
+//core, with atomic slot reservation) and the lock profiles (protected by
+//their own mutex). They are set up by the first call to netInitEx, so the
+//instances must be initialized one after the other. Interrupt handlers
+//signal the instance that owns the interface
+#ifndef NET_MULTI_INSTANCE_SUPPORT
+   #define NET_MULTI_INSTANCE_SUPPORT DISABLED
+#elif (NET_MULTI_INSTANCE_SUPPORT != ENABLED && NET_MULTI_INSTANCE_SUPPORT != DISABLED)
+   #error NET_MULTI_INSTANCE_SUPPORT parameter is not valid
+#endif
+
+//Storage class of the pointer to the current stack instance
+#ifndef NET_THREAD_LOCAL
+   #if (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L)
+      #define NET_THREAD_LOCAL _Thread_local
+   #elif defined(__GNUC__) || defined(__clang__)
+      #define NET_THREAD_LOCAL __thread
+   #elif defined(_MSC_VER)
+      #define NET_THREAD_LOCAL __declspec(thread)
+   #elif (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+      #error NET_THREAD_LOCAL must be defined for this toolchain
+   #else
+      #define NET_THREAD_LOCAL
+   #endif
+#endif
+
 //Number of network adapters
 #ifndef NET_INTERFACE_COUNT
    #define NET_INTERFACE_COUNT 1
@@ -122,6 +162,13 @@ struct _NetInterface;
    #error NET_LOOPBACK_IF_SUPPORT parameter is not valid
 #endif
 
+//Omit upper-layer checksums for packets sent through the loopback interface
+#ifndef NET_LOOPBACK_IF_CHECKSUM_BYPASS
+   #define NET_LOOPBACK_IF_CHECKSUM_BYPASS DISABLED
+#elif (NET_LOOPBACK_IF_CHECKSUM_BYPASS != ENABLED && NET_LOOPBACK_IF_CHECKSUM_BYPASS != DISABLED)
+   #error NET_LOOPBACK_IF_CHECKSUM_BYPASS parameter is not valid
+#endif
+
 //Maximum number of link change callback functions that can be registered
 #ifndef NET_MAX_LINK_CHANGE_CALLBACKS
    #define NET_MAX_LINK_CHANGE_CALLBACKS (6 * NET_INTERFACE_COUNT)
@@ -198,6 +245,7 @@ struct _NetInterface
    Eui64 eui64;                                   ///<EUI-64 interface identifier
    char_t name[NET_MAX_IF_NAME_LEN + 1];          ///<A unique name identifying the interface
    char_t hostname[NET_MAX_HOSTNAME_LEN + 1];     ///<Host name
+   struct _NetContext *context;                   ///<TCP/IP stack instance the interface belongs to
    const NicDriver *nicDriver;                    ///<NIC driver
    const SpiDriver *spiDriver;                    ///<Underlying SPI driver
    const UartDriver *uartDriver;                  ///<Underlying UART driver
@@ -205,6 +253,10 @@ struct _NetInterface
    uint8_t nicContext[NIC_CONTEXT_SIZE];          ///<Driver specific context
    OsEvent nicTxEvent;                            ///<Network controller TX event
    bool_t nicEvent;                               ///<A NIC event is pending
+#if (NIC_RX_BUDGET > 0)
+   uint_t nicRxBudget;                            ///<Number of frames that can still be received in the current round
+   bool_t nicPollMode;                            ///<The interface is polled rather than interrupt-driven
+#endif
    NicLinkState adminLinkState;                   ///<Administrative link state
    bool_t linkState;                              ///<Link state
    uint32_t linkSpeed;                            ///<Link speed
@@ -220,6 +272,10 @@ struct _NetInterface
    const SmiDriver *smiDriver;                    ///<SMI driver
    MacAddr macAddr;                               ///<Link-layer address
    MacFilterEntry macAddrFilter[MAC_ADDR_FILTER_SIZE]; ///<MAC filter table
+#if (ETH_MAC_FILTER_HASH_SUPPORT == ENABLED)
+   uint8_t macAddrFilterHash[MAC_ADDR_FILTER_HASH_SIZE]; ///<First MAC filter entry in each bucket (1-based index)
+   uint8_t macAddrFilterNext[MAC_ADDR_FILTER_SIZE];      ///<Next MAC filter entry in the same bucket (1-based index)
+#endif
    bool_t promiscuous;                            ///<Promiscuous mode
    bool_t acceptAllMulticast;                     ///<Accept all frames with a multicast destination address
 #endif
@@ -294,6 +350,14 @@ struct _NetInterface
 #if (PPP_SUPPORT == ENABLED)
    PppContext *pppContext;                        ///<PPP context
 #endif
+
+#if (NET_CAPTURE_SUPPORT == ENABLED)
+   NetCaptureContext *captureContext;             ///<Capture tap context
+#endif
+
+#if (NET_STATS_SUPPORT == ENABLED)
+   NetHistogram statsHistograms[NET_STATS_IF_HISTOGRAM_COUNT]; ///<Per-interface latency histograms
+#endif
 };
 
 
@@ -311,7 +375,7 @@ typedef struct
  * @brief TCP/IP stack context
  **/
 
-typedef struct
+typedef struct _NetContext
 {
    OsMutex mutex;                                ///<Mutex preventing simultaneous access to the TCP/IP stack
    OsEvent event;                                ///<Event object to receive notifications from drivers
@@ -325,6 +389,39 @@ typedef struct
    NetInterface interfaces[NET_INTERFACE_COUNT]; ///<Network interfaces
    NetLinkChangeCallbackEntry linkChangeCallbacks[NET_MAX_LINK_CHANGE_CALLBACKS];
    NetTimerCallbackEntry timerCallbacks[NET_MAX_TIMER_CALLBACKS];
+   uint_t rxIndex;                               ///<Interface serviced first on the next round
+   struct _SocketContext *socketContext;         ///<Socket layer state
+   struct _UdpContext *udpContext;               ///<UDP layer state
+   struct _DnsCacheContext *dnsCacheContext;     ///<DNS cache
+   struct _BsdSocketContext *bsdSocketContext;   ///<BSD socket layer state
+   struct _Ipv6RoutingContext *ipv6RoutingContext; ///<IPv6 routing table
+   systime_t nicTickCounter;
+   systime_t pppTickCounter;
+   systime_t arpTickCounter;
+   systime_t ipv4FragTickCounter;
+   systime_t igmpTickCounter;
+   systime_t autoIpTickCounter;
+   systime_t dhcpClientTickCounter;
+   systime_t dhcpServerTickCounter;
+   systime_t ipv6FragTickCounter;
+   systime_t mldTickCounter;
+   systime_t ndpTickCounter;
+   systime_t ndpRouterAdvTickCounter;
+   systime_t dhcpv6ClientTickCounter;
+   systime_t tcpTickCounter;
+   systime_t dnsTickCounter;
+   systime_t mdnsResponderTickCounter;
+   systime_t dnsSdTickCounter;
+   uint16_t pingSequenceNumber;                  ///<Sequence number of the next ICMP Echo Request
+#if (ETH_DEMUX_TABLE_SUPPORT == ENABLED)
+   EthDemuxEntry ethDemuxEntries[NET_INTERFACE_COUNT]; ///<Logical interfaces, keyed by (parent, VMAN, VLAN)
+   uint8_t ethDemuxTable[ETH_DEMUX_TABLE_SIZE];        ///<First entry in each bucket (1-based index)
+   bool_t ethDemuxTableValid;                          ///<The demultiplexing table is up to date
+#endif
+#if (NET_STATS_SUPPORT == ENABLED)
+   NetHistogram statsHistograms[NET_STATS_HISTOGRAM_COUNT]; ///<Stack-wide latency histograms
+   uint32_t statsCostNested;                                ///<Cost of the nested code paths measured so far
+#endif
 #if (IPV4_IPSEC_SUPPORT == ENABLED)
    void *ipsecContext;                           ///<IPsec context
    void *ikeContext;                             ///<IKE context
@@ -333,7 +430,12 @@ typedef struct
 
 
 //Global variables
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern NET_THREAD_LOCAL NetContext *netCurrentContext;
+#define netContext (*netCurrentContext)
+#else
 extern NetContext netContext;
+#endif
 
 //TCP/IP stack related functions
 void netGetDefaultSettings(NetSettings *settings);
@@ -342,6 +444,9 @@ error_t netInitEx(NetContext *context, const NetSettings *settings);
 
 error_t netStart(NetContext *context);
 
+void netSetCurrentContext(NetContext *context);
+NetContext *netGetCurrentContext(void);
+
 error_t netSeedRand(const uint8_t *seed, size_t length);
 uint32_t netGetRand(void);
 uint32_t netGetRandRange(uint32_t min, uint32_t max);
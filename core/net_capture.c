@@ -0,0 +1,593 @@
+/**
+ * @file net_capture.c
+ * @brief Packet capture tap (pcapng)
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "core/net_capture.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (NET_CAPTURE_SUPPORT == ENABLED)
+
+
+/**
+ * @brief Initialize settings with default values
+ * @param[out] settings Structure that contains capture tap settings
+ **/
+
+void netCaptureGetDefaultSettings(NetCaptureSettings *settings)
+{
+   //Default task parameters
+   settings->task = OS_TASK_DEFAULT_PARAMS;
+   settings->task.stackSize = NET_CAPTURE_TASK_STACK_SIZE;
+   settings->task.priority = NET_CAPTURE_TASK_PRIORITY;
+
+   //Use default interface
+   settings->interface = netGetDefaultInterface();
+
+   //Capture ring
+   settings->buffer = NULL;
+   settings->bufferSize = 0;
+
+   //Capture the beginning of every frame, in both directions
+   settings->snapLength = NET_CAPTURE_DEFAULT_SNAP_LENGTH;
+   settings->direction = NET_CAPTURE_DIR_BOTH;
+   settings->ethType = 0;
+
+   //Capture output callback
+   settings->writeCallback = NULL;
+   settings->param = NULL;
+}
+
+
+/**
+ * @brief Capture tap initialization
+ * @param[in] context Pointer to the capture tap context
+ * @param[in] settings Capture tap specific settings
+ * @return Error code
+ **/
+
+error_t netCaptureInit(NetCaptureContext *context,
+   const NetCaptureSettings *settings)
+{
+   //Debug message
+   TRACE_INFO("Initializing capture tap...\r\n");
+
+   //Ensure the parameters are valid
+   if(context == NULL || settings == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //The capture tap must be bound to a valid interface
+   if(settings->interface == NULL || settings->writeCallback == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //The size of the ring must be a power of two
+   if(settings->buffer == NULL || settings->bufferSize < 256 ||
+      (settings->bufferSize & (settings->bufferSize - 1)) != 0)
+   {
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //Records are 32-bit aligned
+   if(((uintptr_t) settings->buffer % sizeof(uint32_t)) != 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //A record must never take more than half of the ring
+   if(settings->snapLength == 0 || settings->snapLength > UINT16_MAX ||
+      (sizeof(NetCaptureRecord) + settings->snapLength + 3) >
+      (settings->bufferSize / 2))
+   {
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //Clear the capture tap context
+   osMemset(context, 0, sizeof(NetCaptureContext));
+
+   //Initialize task parameters
+   context->taskParams = settings->task;
+   context->taskId = OS_INVALID_TASK_ID;
+
+   //Initialize capture tap context
+   context->interface = settings->interface;
+   context->buffer = settings->buffer;
+   context->bufferSize = (uint32_t) settings->bufferSize;
+   context->snapLength = settings->snapLength;
+   context->direction = settings->direction;
+   context->ethType = settings->ethType;
+   context->writeCallback = settings->writeCallback;
+   context->param = settings->param;
+
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Start capturing frames
+ * @param[in] context Pointer to the capture tap context
+ * @return Error code
+ **/
+
+error_t netCaptureStart(NetCaptureContext *context)
+{
+   error_t error;
+
+   //Make sure the capture tap context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Debug message
+   TRACE_INFO("Starting capture tap...\r\n");
+
+   //Make sure the capture tap is not already running
+   if(context->running)
+      return ERROR_ALREADY_RUNNING;
+
+   //Each capture starts with a new section
+   error = netCaptureWriteHeader(context);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Empty the ring
+   context->head = 0;
+   context->tail = 0;
+
+   //Start the capture task
+   context->stop = FALSE;
+   context->running = TRUE;
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+   //Create a task
+   context->taskId = osCreateTask("Capture", (OsTaskCode) netCaptureTask,
+      context, &context->taskParams);
+
+   //Failed to create task?
+   if(context->taskId == OS_INVALID_TASK_ID)
+   {
+      //Clean up side effects
+      context->running = FALSE;
+      //Report an error
+      return ERROR_OUT_OF_RESOURCES;
+   }
+#endif
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+   //Attach the tap to the interface
+   context->interface->captureContext = context;
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Stop capturing frames
+ * @param[in] context Pointer to the capture tap context
+ * @return Error code
+ **/
+
+error_t netCaptureStop(NetCaptureContext *context)
+{
+   //Make sure the capture tap context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Debug message
+   TRACE_INFO("Stopping capture tap...\r\n");
+
+   //Check whether the capture tap is running
+   if(context->running)
+   {
+      //Get exclusive access
+      osAcquireMutex(&netMutex);
+      //Detach the tap from the interface
+      context->interface->captureContext = NULL;
+      //Release exclusive access
+      osReleaseMutex(&netMutex);
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+      //Stop the capture task
+      context->stop = TRUE;
+
+      //Wait for the task to flush the ring and terminate
+      while(context->running)
+      {
+         osDelayTask(1);
+      }
+#else
+      //Flush the ring
+      netCaptureProcess(context);
+      //The capture is over
+      context->running = FALSE;
+#endif
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Get capture statistics
+ * @param[in] context Pointer to the capture tap context
+ * @param[out] frames Number of frames stored in the ring
+ * @param[out] drops Number of frames dropped because the ring was full
+ * @return Error code
+ **/
+
+error_t netCaptureGetStats(NetCaptureContext *context, uint32_t *frames,
+   uint32_t *drops)
+{
+   //Check parameters
+   if(context == NULL || frames == NULL || drops == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Return statistics
+   *frames = context->frames;
+   *drops = context->drops;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Store a frame in the capture ring
+ *
+ * This function is called from the data path with the TCP/IP stack lock
+ * held. It never blocks: frames that do not fit in the ring are counted
+ * and dropped
+ *
+ * @param[in] context Pointer to the capture tap context
+ * @param[in] direction Capture direction
+ * @param[in] buffer Multi-part buffer containing the frame
+ * @param[in] offset Offset to the first byte of the frame
+ * @param[in] length Length of the frame, in bytes
+ **/
+
+void netCaptureFrame(NetCaptureContext *context, uint_t direction,
+   const NetBuffer *buffer, size_t offset, size_t length)
+{
+   size_t n;
+   uint32_t head;
+   uint32_t tail;
+   uint32_t pos;
+   uint32_t pad;
+   uint32_t size;
+   uint64_t time;
+   uint8_t type[2];
+   NetCaptureRecord *record;
+
+   //Direction filter
+   if((context->direction & direction) == 0)
+      return;
+
+   //EtherType filter
+   if(context->ethType != 0 &&
+      context->interface->nicDriver->type == NIC_TYPE_ETHERNET)
+   {
+      //Retrieve the value of the EtherType field
+      if(netBufferRead(type, buffer, offset + 12, sizeof(type)) < sizeof(type))
+         return;
+
+      //Discard frames that do not match the filter
+      if(LOAD16BE(type) != context->ethType)
+         return;
+   }
+
+   //Number of bytes to capture
+   n = MIN(length, context->snapLength);
+   //Size of the record, rounded up to a multiple of 4 bytes
+   size = (sizeof(NetCaptureRecord) + n + 3) & ~3U;
+
+   //Read the indices
+   head = context->head;
+   tail = context->tail;
+   netCaptureBarrier();
+
+   //Records are never split at the end of the ring
+   pos = head & (context->bufferSize - 1);
+   pad = (pos + size > context->bufferSize) ? (context->bufferSize - pos) : 0;
+
+   //Not enough room in the ring?
+   if((pad + size) > (context->bufferSize - (head - tail)))
+   {
+      //The frame is dropped rather than stalling the data path
+      context->drops++;
+      return;
+   }
+
+   //Skip the end of the ring if necessary
+   if(pad != 0)
+   {
+      //Insert a wrap marker
+      *(uint32_t *) (context->buffer + pos) = 0;
+
+      //Start over from the beginning of the ring
+      head += pad;
+      pos = 0;
+   }
+
+   //Point to the record
+   record = (NetCaptureRecord *) (context->buffer + pos);
+
+   //Get current time
+   time = osGetSystemTime64();
+
+   //Format record header
+   record->size = size;
+   record->length = (uint16_t) n;
+   record->origLength = (uint16_t) MIN(length, UINT16_MAX);
+   record->timestampHigh = (uint32_t) (time >> 32);
+   record->timestampLow = (uint32_t) time;
+   record->direction = (uint8_t) direction;
+
+   //Copy the beginning of the frame
+   netBufferRead(record + 1, buffer, offset, n);
+
+   //Make sure the record is complete before publishing it
+   netCaptureBarrier();
+   context->head = head + size;
+
+   //Number of frames stored in the ring
+   context->frames++;
+}
+
+
+/**
+ * @brief Drain the capture ring
+ * @param[in] context Pointer to the capture tap context
+ * @return Number of frames written to the output
+ **/
+
+uint_t netCaptureProcess(NetCaptureContext *context)
+{
+   uint_t count;
+   uint32_t head;
+   uint32_t tail;
+   uint32_t pos;
+   NetCaptureRecord *record;
+
+   //Number of frames written to the output
+   count = 0;
+
+   //Drain the ring
+   while(1)
+   {
+      //Read the indices
+      tail = context->tail;
+      head = context->head;
+      netCaptureBarrier();
+
+      //Empty ring?
+      if(tail == head)
+         break;
+
+      //Point to the oldest record
+      pos = tail & (context->bufferSize - 1);
+      record = (NetCaptureRecord *) (context->buffer + pos);
+
+      //Wrap marker?
+      if(record->size == 0)
+      {
+         //Continue from the beginning of the ring
+         context->tail = tail + context->bufferSize - pos;
+      }
+      else
+      {
+         //Write the record to the output
+         netCaptureWriteRecord(context, record);
+
+         //The record must have been consumed before the space is released
+         netCaptureBarrier();
+         context->tail = tail + record->size;
+
+         //Increment frame counter
+         count++;
+      }
+   }
+
+   //Return the number of frames written to the output
+   return count;
+}
+
+
+/**
+ * @brief Write pcapng section header and interface description blocks
+ * @param[in] context Pointer to the capture tap context
+ * @return Error code
+ **/
+
+error_t netCaptureWriteHeader(NetCaptureContext *context)
+{
+   error_t error;
+   uint16_t linkType;
+   uint8_t *p;
+
+   //Point to the scratch buffer
+   p = context->block;
+
+   //Format section header block
+   STORE32LE(PCAPNG_BLOCK_TYPE_SHB, p);
+   STORE32LE(28, p + 4);
+   STORE32LE(PCAPNG_BYTE_ORDER_MAGIC, p + 8);
+   STORE16LE(1, p + 12);
+   STORE16LE(0, p + 14);
+   STORE32LE(0xFFFFFFFF, p + 16);
+   STORE32LE(0xFFFFFFFF, p + 20);
+   STORE32LE(28, p + 24);
+
+   //Write section header block
+   error = context->writeCallback(context, p, 28, context->param);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Select the link type that matches the interface
+   if(context->interface->nicDriver == NULL ||
+      context->interface->nicDriver->type == NIC_TYPE_ETHERNET)
+   {
+      linkType = PCAPNG_LINKTYPE_ETHERNET;
+   }
+   else if(context->interface->nicDriver->type == NIC_TYPE_PPP)
+   {
+      linkType = PCAPNG_LINKTYPE_PPP;
+   }
+   else
+   {
+      linkType = PCAPNG_LINKTYPE_RAW;
+   }
+
+   //Format interface description block. Time stamps are expressed in
+   //milliseconds (if_tsresol = 3)
+   STORE32LE(PCAPNG_BLOCK_TYPE_IDB, p);
+   STORE32LE(32, p + 4);
+   STORE16LE(linkType, p + 8);
+   STORE16LE(0, p + 10);
+   STORE32LE(context->snapLength, p + 12);
+   STORE16LE(PCAPNG_OPT_IF_TSRESOL, p + 16);
+   STORE16LE(1, p + 18);
+   STORE32LE(3, p + 20);
+   STORE32LE(PCAPNG_OPT_ENDOFOPT, p + 24);
+   STORE32LE(32, p + 28);
+
+   //Write interface description block
+   return context->writeCallback(context, p, 32, context->param);
+}
+
+
+/**
+ * @brief Write a record as a pcapng enhanced packet block
+ * @param[in] context Pointer to the capture tap context
+ * @param[in] record Record to be written
+ * @return Error code
+ **/
+
+error_t netCaptureWriteRecord(NetCaptureContext *context,
+   const NetCaptureRecord *record)
+{
+   error_t error;
+   size_t n;
+   uint32_t totalLength;
+   uint8_t *p;
+
+   //Point to the scratch buffer
+   p = context->block;
+
+   //Length of the packet data, padded to 32 bits
+   n = (record->length + 3) & ~3U;
+   //Total length of the block
+   totalLength = 28 + n + 12 + 4;
+
+   //Format the fixed part of the enhanced packet block
+   STORE32LE(PCAPNG_BLOCK_TYPE_EPB, p);
+   STORE32LE(totalLength, p + 4);
+   STORE32LE(0, p + 8);
+   STORE32LE(record->timestampHigh, p + 12);
+   STORE32LE(record->timestampLow, p + 16);
+   STORE32LE(record->length, p + 20);
+   STORE32LE(record->origLength, p + 24);
+
+   //Write the fixed part
+   error = context->writeCallback(context, p, 28, context->param);
+
+   //Write the packet data, padding included, straight from the ring
+   if(!error)
+   {
+      error = context->writeCallback(context, record + 1, n, context->param);
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //The epb_flags option reports the direction (1 = inbound,
+      //2 = outbound)
+      STORE16LE(PCAPNG_OPT_EPB_FLAGS, p);
+      STORE16LE(4, p + 2);
+      STORE32LE((record->direction == NET_CAPTURE_DIR_RX) ? 1 : 2, p + 4);
+      STORE32LE(PCAPNG_OPT_ENDOFOPT, p + 8);
+      STORE32LE(totalLength, p + 12);
+
+      //Write the options and the trailing length
+      error = context->writeCallback(context, p, 16, context->param);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Capture task
+ * @param[in] context Pointer to the capture tap context
+ **/
+
+void netCaptureTask(NetCaptureContext *context)
+{
+#if (NET_RTOS_SUPPORT == ENABLED)
+   //Task prologue
+   osEnterTask();
+
+   //Main loop
+   while(1)
+   {
+#endif
+      //Stop request?
+      if(context->stop)
+      {
+         //Flush the frames captured before the tap was detached
+         netCaptureProcess(context);
+
+         //Stop capture task operation
+         context->running = FALSE;
+         //Task epilogue
+         osExitTask();
+         //Kill ourselves
+         osDeleteTask(OS_SELF_TASK_ID);
+      }
+
+      //Drain the ring, then sleep if there was nothing to do
+      if(netCaptureProcess(context) == 0)
+      {
+         osDelayTask(NET_CAPTURE_POLLING_INTERVAL);
+      }
+#if (NET_RTOS_SUPPORT == ENABLED)
+   }
+#endif
+}
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * @file net_capture.h
+ * @brief Packet capture tap (pcapng)
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _NET_CAPTURE_H
+#define _NET_CAPTURE_H
+
+//Forward declaration of NetCaptureContext structure
+struct _NetCaptureContext;
+#define NetCaptureContext struct _NetCaptureContext
+
+//Dependencies
+#include "core/net.h"
+
+//Packet capture support
+#ifndef NET_CAPTURE_SUPPORT
+   #define NET_CAPTURE_SUPPORT DISABLED
+#elif (NET_CAPTURE_SUPPORT != ENABLED && NET_CAPTURE_SUPPORT != DISABLED)
+   #error NET_CAPTURE_SUPPORT parameter is not valid
+#endif
+
+//Stack size required to run the capture task
+#ifndef NET_CAPTURE_TASK_STACK_SIZE
+   #define NET_CAPTURE_TASK_STACK_SIZE 500
+#elif (NET_CAPTURE_TASK_STACK_SIZE < 1)
+   #error NET_CAPTURE_TASK_STACK_SIZE parameter is not valid
+#endif
+
+//Priority at which the capture task should run
+#ifndef NET_CAPTURE_TASK_PRIORITY
+   #define NET_CAPTURE_TASK_PRIORITY OS_TASK_PRIORITY_NORMAL
+#endif
+
+//Interval between two passes of the capture task when the ring is empty
+#ifndef NET_CAPTURE_POLLING_INTERVAL
+   #define NET_CAPTURE_POLLING_INTERVAL 50
+#elif (NET_CAPTURE_POLLING_INTERVAL < 1)
+   #error NET_CAPTURE_POLLING_INTERVAL parameter is not valid
+#endif
+
+//Default snap length
+#ifndef NET_CAPTURE_DEFAULT_SNAP_LENGTH
+   #define NET_CAPTURE_DEFAULT_SNAP_LENGTH 128
+#elif (NET_CAPTURE_DEFAULT_SNAP_LENGTH < 14)
+   #error NET_CAPTURE_DEFAULT_SNAP_LENGTH parameter is not valid
+#endif
+
+//Memory barrier ordering the accesses to the capture ring (must be provided
+//by the port when the compiler has no built-in barrier)
+#ifndef netCaptureBarrier
+   #if defined(__GNUC__)
+      #define netCaptureBarrier() __sync_synchronize()
+   #elif (NET_CAPTURE_SUPPORT == ENABLED)
+      #error netCaptureBarrier must be defined for this compiler
+   #endif
+#endif
+
+//pcapng block types
+#define PCAPNG_BLOCK_TYPE_SHB 0x0A0D0D0A
+#define PCAPNG_BLOCK_TYPE_IDB 0x00000001
+#define PCAPNG_BLOCK_TYPE_EPB 0x00000006
+
+//pcapng byte-order magic
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+
+//pcapng options
+#define PCAPNG_OPT_ENDOFOPT  0
+#define PCAPNG_OPT_IF_TSRESOL 9
+#define PCAPNG_OPT_EPB_FLAGS 2
+
+//Link types
+#define PCAPNG_LINKTYPE_ETHERNET 1
+#define PCAPNG_LINKTYPE_PPP      9
+#define PCAPNG_LINKTYPE_RAW      101
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Capture direction
+ **/
+
+typedef enum
+{
+   NET_CAPTURE_DIR_NONE = 0,
+   NET_CAPTURE_DIR_RX   = 1, ///<Inbound frames
+   NET_CAPTURE_DIR_TX   = 2, ///<Outbound frames
+   NET_CAPTURE_DIR_BOTH = 3
+} NetCaptureDirection;
+
+
+/**
+ * @brief Capture output callback
+ *
+ * Receives the pcapng stream, one piece at a time. The callback may write
+ * to a file, a socket or a serial link
+ *
+ **/
+
+typedef error_t (*NetCaptureWriteCallback)(NetCaptureContext *context,
+   const void *data, size_t length, void *param);
+
+
+/**
+ * @brief Record stored in the capture ring
+ **/
+
+typedef struct
+{
+   uint32_t size;           ///<Size of the record, including padding (0 marks a wrap)
+   uint16_t length;         ///<Number of bytes captured
+   uint16_t origLength;     ///<Original length of the frame
+   uint32_t timestampHigh;  ///<Capture time (upper 32 bits, in milliseconds)
+   uint32_t timestampLow;   ///<Capture time (lower 32 bits, in milliseconds)
+   uint8_t direction;       ///<Capture direction
+   uint8_t reserved[3];
+} NetCaptureRecord;
+
+
+/**
+ * @brief Capture tap settings
+ **/
+
+typedef struct
+{
+   OsTaskParameters task;                 ///<Task parameters
+   NetInterface *interface;               ///<Interface to be tapped
+   uint8_t *buffer;                       ///<Capture ring (32-bit aligned)
+   size_t bufferSize;                     ///<Size of the capture ring (power of two)
+   size_t snapLength;                     ///<Maximum number of bytes captured per frame
+   uint_t direction;                      ///<Frames to capture (NET_CAPTURE_DIR_RX and/or NET_CAPTURE_DIR_TX)
+   uint16_t ethType;                      ///<Only capture frames with this EtherType (0 to capture all)
+   NetCaptureWriteCallback writeCallback; ///<Capture output callback
+   void *param;                           ///<Callback parameter
+} NetCaptureSettings;
+
+
+/**
+ * @brief Capture tap context
+ **/
+
+struct _NetCaptureContext
+{
+   OsTaskParameters taskParams;           ///<Task parameters
+   OsTaskId taskId;                       ///<Task identifier
+   bool_t running;                        ///<The capture task is running
+   bool_t stop;                           ///<Stop request
+   NetInterface *interface;               ///<Tapped interface
+   uint8_t *buffer;                       ///<Capture ring
+   uint32_t bufferSize;                   ///<Size of the capture ring
+   volatile uint32_t head;                ///<Write index (TCP/IP stack)
+   volatile uint32_t tail;                ///<Read index (capture task)
+   size_t snapLength;                     ///<Maximum number of bytes captured per frame
+   uint_t direction;                      ///<Frames to capture
+   uint16_t ethType;                      ///<EtherType filter
+   NetCaptureWriteCallback writeCallback; ///<Capture output callback
+   void *param;                           ///<Callback parameter
+   uint32_t frames;                       ///<Number of frames stored in the ring
+   uint32_t drops;                        ///<Number of frames dropped because the ring was full
+   uint8_t block[32];                     ///<Scratch buffer used to format pcapng blocks
+};
+
+
+//Capture tap related functions
+void netCaptureGetDefaultSettings(NetCaptureSettings *settings);
+
+error_t netCaptureInit(NetCaptureContext *context,
+   const NetCaptureSettings *settings);
+
+error_t netCaptureStart(NetCaptureContext *context);
+error_t netCaptureStop(NetCaptureContext *context);
+
+error_t netCaptureGetStats(NetCaptureContext *context, uint32_t *frames,
+   uint32_t *drops);
+
+void netCaptureFrame(NetCaptureContext *context, uint_t direction,
+   const NetBuffer *buffer, size_t offset, size_t length);
+
+uint_t netCaptureProcess(NetCaptureContext *context);
+
+error_t netCaptureWriteHeader(NetCaptureContext *context);
+
+error_t netCaptureWriteRecord(NetCaptureContext *context,
+   const NetCaptureRecord *record);
+
+void netCaptureTask(NetCaptureContext *context);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,680 @@
+/**
+ * @file net_lock.c
+ * @brief Lock contention profiling
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "core/net_lock.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (NET_LOCK_PROFILING_SUPPORT == ENABLED)
+
+//This module calls the underlying primitives
+#undef osAcquireMutex
+#undef osReleaseMutex
+#undef osWaitForEvent
+
+//Mutex protecting the profile table and the event statistics
+static OsMutex netLockMutex;
+//The profile table has been initialized
+static bool_t netLockInitialized = FALSE;
+//Number of entries in use
+static volatile uint_t netLockProfileCount = 0;
+//Profile table
+static NetLockProfile netLockProfiles[NET_LOCK_PROFILING_MAX_OBJECTS];
+//Call site table (open addressing, shared by all the profiled objects)
+static NetLockSite netLockSites[NET_LOCK_PROFILING_MAX_SITES];
+//Number of acquisitions and waits on objects that could not be profiled
+static uint32_t netLockObjectOverflows = 0;
+
+
+/**
+ * @brief Lock contention profiling initialization
+ * @return Error code
+ **/
+
+error_t netLockInit(void)
+{
+   //The profile table is shared by all the stack instances and is only
+   //initialized once
+   if(netLockInitialized)
+      return NO_ERROR;
+
+   //Create a mutex to protect the profile table
+   if(!osCreateMutex(&netLockMutex))
+   {
+      //Failed to create mutex
+      return ERROR_OUT_OF_RESOURCES;
+   }
+
+   //Clear profile and call site tables
+   osMemset(netLockProfiles, 0, sizeof(netLockProfiles));
+   osMemset(netLockSites, 0, sizeof(netLockSites));
+   netLockProfileCount = 0;
+   netLockObjectOverflows = 0;
+
+   //Profiling can start
+   netLockInitialized = TRUE;
+
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Acquire ownership of a mutex and profile the acquisition
+ * @param[in] mutex Pointer to the mutex object
+ * @param[in] name Expression naming the mutex at the call site
+ * @param[in] file Source file of the call site
+ * @param[in] line Line number of the call site
+ **/
+
+void netLockAcquireMutex(OsMutex *mutex, const char_t *name,
+   const char_t *file, uint_t line)
+{
+   uint32_t time;
+   uint32_t wait;
+   bool_t contended;
+   NetLockSite *site;
+   NetLockSite *holder;
+   NetLockProfile *profile;
+
+   //Retrieve the profile of the mutex
+   profile = netLockGetProfile(mutex, name, NET_LOCK_TYPE_MUTEX, NULL, 0);
+
+   //The mutex cannot be profiled?
+   if(profile == NULL)
+   {
+      osAcquireMutex(mutex);
+      return;
+   }
+
+   //Check whether the mutex is currently held by another call site
+   contended = profile->locked;
+   holder = profile->holder;
+
+   //Acquire ownership of the mutex
+   time = NET_STATS_GET_TIME_US();
+   osAcquireMutex(mutex);
+   wait = NET_STATS_GET_TIME_US() - time;
+
+   //The profile is now protected by the mutex itself
+   profile->count++;
+   netHistogramRecord(&profile->waitTime, wait);
+
+   //Contended acquisition?
+   if(contended)
+   {
+      profile->contended++;
+
+      //Blame the call site that was holding the mutex
+      if(holder != NULL)
+      {
+         holder->blocking += wait;
+      }
+   }
+
+   //Update call site statistics
+   site = netLockGetSite(profile, file, line);
+
+   //Check whether the call site can be tracked
+   if(site != NULL)
+   {
+      site->count++;
+      site->totalWait += wait;
+      site->maxWait = MAX(site->maxWait, wait);
+
+      if(contended)
+      {
+         site->contended++;
+      }
+   }
+   else
+   {
+      profile->siteOverflows++;
+   }
+
+   //Save the identity of the holder
+   profile->locked = TRUE;
+   profile->holder = site;
+   profile->acquireTime = NET_STATS_GET_TIME_US();
+}
+
+
+/**
+ * @brief Release ownership of a mutex and profile the hold time
+ * @param[in] mutex Pointer to the mutex object
+ **/
+
+void netLockReleaseMutex(OsMutex *mutex)
+{
+   uint32_t hold;
+   NetLockProfile *profile;
+
+   //Retrieve the profile of the mutex
+   profile = netLockGetProfile(mutex, NULL, NET_LOCK_TYPE_MUTEX, NULL, 0);
+
+   //Profiled mutex?
+   if(profile != NULL && profile->locked)
+   {
+      //Time during which the mutex was held
+      hold = NET_STATS_GET_TIME_US() - profile->acquireTime;
+      netHistogramRecord(&profile->holdTime, hold);
+
+      //Update the statistics of the holding call site
+      if(profile->holder != NULL)
+      {
+         profile->holder->totalHold += hold;
+         profile->holder->maxHold = MAX(profile->holder->maxHold, hold);
+      }
+
+      //The mutex is about to be released
+      profile->locked = FALSE;
+      profile->holder = NULL;
+   }
+
+   //Release ownership of the mutex
+   osReleaseMutex(mutex);
+}
+
+
+/**
+ * @brief Wait until an event is signaled and profile the wait
+ * @param[in] event Pointer to the event object
+ * @param[in] timeout Timeout interval
+ * @param[in] name Expression naming the event at the call site
+ * @param[in] file Source file of the call site
+ * @param[in] line Line number of the call site
+ * @return The function returns TRUE if the state of the specified object is
+ *   signaled. FALSE is returned if the timeout interval elapsed
+ **/
+
+bool_t netLockWaitForEvent(OsEvent *event, systime_t timeout,
+   const char_t *name, const char_t *file, uint_t line)
+{
+   bool_t status;
+   uint32_t time;
+   uint32_t wait;
+   NetLockSite *site;
+   NetLockProfile *profile;
+
+   //Event waits are profiled per call site
+   profile = netLockGetProfile(NULL, name, NET_LOCK_TYPE_EVENT, file, line);
+
+   //Wait until the event is signaled
+   time = NET_STATS_GET_TIME_US();
+   status = osWaitForEvent(event, timeout);
+   wait = NET_STATS_GET_TIME_US() - time;
+
+   //Profiled call site?
+   if(profile != NULL)
+   {
+      //Retrieve the statistics of the call site
+      site = netLockGetSite(profile, file, line);
+
+      //Several tasks may wait at the same call site
+      osAcquireMutex(&netLockMutex);
+
+      //Update statistics
+      profile->count++;
+      netHistogramRecord(&profile->waitTime, wait);
+
+      //Timeout?
+      if(!status)
+      {
+         profile->timeouts++;
+      }
+
+      //Check whether the call site can be tracked
+      if(site != NULL)
+      {
+         site->count++;
+         site->totalWait += wait;
+         site->maxWait = MAX(site->maxWait, wait);
+      }
+      else
+      {
+         profile->siteOverflows++;
+      }
+
+      //Release exclusive access
+      osReleaseMutex(&netLockMutex);
+   }
+
+   //Return status
+   return status;
+}
+
+
+/**
+ * @brief Find or create the profile of a mutex or of an event wait site
+ * @param[in] object Pointer to the mutex (NULL for event wait sites)
+ * @param[in] name Expression naming the object (NULL to look up an
+ *   existing profile without creating a new one)
+ * @param[in] type Object type
+ * @param[in] file Source file of the call site (event wait sites only)
+ * @param[in] line Line number of the call site (event wait sites only)
+ * @return Pointer to the profile, or NULL if the table is full
+ **/
+
+NetLockProfile *netLockGetProfile(const void *object, const char_t *name,
+   NetLockType type, const char_t *file, uint_t line)
+{
+   uint_t i;
+   uint_t n;
+   NetLockProfile *profile;
+
+   //Profiling is not ready yet?
+   if(!netLockInitialized)
+      return NULL;
+
+   //Entries are never removed, hence the table can be searched without
+   //holding the lock
+   n = netLockProfileCount;
+
+   //Loop through the profile table
+   for(i = 0; i < n; i++)
+   {
+      //Point to the current entry
+      profile = &netLockProfiles[i];
+
+      //Matching entry?
+      if(profile->type == type && profile->object == object &&
+         (type == NET_LOCK_TYPE_MUTEX || (profile->file == file &&
+         profile->line == line)))
+      {
+         return profile;
+      }
+   }
+
+   //Lookup only?
+   if(name == NULL)
+      return NULL;
+
+   //Get exclusive access
+   osAcquireMutex(&netLockMutex);
+
+   //The entry may have been created in the meantime
+   for(profile = NULL, i = 0; i < netLockProfileCount; i++)
+   {
+      //Matching entry?
+      if(netLockProfiles[i].type == type &&
+         netLockProfiles[i].object == object &&
+         (type == NET_LOCK_TYPE_MUTEX ||
+         (netLockProfiles[i].file == file &&
+         netLockProfiles[i].line == line)))
+      {
+         profile = &netLockProfiles[i];
+         break;
+      }
+   }
+
+   //No matching entry?
+   if(profile == NULL && netLockProfileCount >= NET_LOCK_PROFILING_MAX_OBJECTS)
+   {
+      //The table is full, so the object is not profiled
+      netLockObjectOverflows++;
+   }
+   else if(profile == NULL)
+   {
+      //Point to the first free entry
+      profile = &netLockProfiles[netLockProfileCount];
+
+      //Initialize the entry
+      osMemset(profile, 0, sizeof(NetLockProfile));
+      profile->object = object;
+      profile->name = name;
+      profile->type = type;
+
+      //Event wait sites are identified by their call site
+      if(type == NET_LOCK_TYPE_EVENT)
+      {
+         profile->file = file;
+         profile->line = line;
+      }
+
+      //Publish the entry
+      netLockBarrier();
+      netLockProfileCount++;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netLockMutex);
+
+   //Return a pointer to the profile
+   return profile;
+}
+
+
+/**
+ * @brief Find or create the statistics of a call site
+ * @param[in] profile Pointer to the profile
+ * @param[in] file Source file of the call site
+ * @param[in] line Line number of the call site
+ * @return Pointer to the call site statistics, or NULL if the table is full
+ **/
+
+NetLockSite *netLockGetSite(NetLockProfile *profile, const char_t *file,
+   uint_t line)
+{
+   uint_t i;
+   uint_t k;
+   NetLockSite *site;
+
+   //Hash the call site
+   k = (uint_t) (((uintptr_t) file >> 3) ^ (line * 31) ^
+      ((uintptr_t) profile >> 4)) % NET_LOCK_PROFILING_MAX_SITES;
+
+   //Entries are never removed, hence the table can be searched without
+   //holding the lock
+   for(i = 0; i < NET_LOCK_PROFILING_MAX_SITES; i++)
+   {
+      //Point to the current entry
+      site = &netLockSites[(k + i) % NET_LOCK_PROFILING_MAX_SITES];
+
+      //Free entry?
+      if(site->file == NULL)
+         break;
+
+      //Matching entry?
+      if(site->profile == profile && site->file == file && site->line == line)
+         return site;
+   }
+
+   //The table is full?
+   if(i >= NET_LOCK_PROFILING_MAX_SITES)
+      return NULL;
+
+   //Get exclusive access
+   osAcquireMutex(&netLockMutex);
+
+   //The entry may have been created in the meantime
+   for(; i < NET_LOCK_PROFILING_MAX_SITES; i++)
+   {
+      //Point to the current entry
+      site = &netLockSites[(k + i) % NET_LOCK_PROFILING_MAX_SITES];
+
+      //Free entry?
+      if(site->file == NULL)
+      {
+         //Track the new call site
+         site->profile = profile;
+         site->line = line;
+
+         //Publish the entry
+         netLockBarrier();
+         site->file = file;
+         break;
+      }
+
+      //Matching entry?
+      if(site->profile == profile && site->file == file && site->line == line)
+         break;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netLockMutex);
+
+   //Return a pointer to the call site statistics
+   return (i < NET_LOCK_PROFILING_MAX_SITES) ? site : NULL;
+}
+
+
+/**
+ * @brief Get the number of profiled objects
+ * @return Number of entries in the profile table
+ **/
+
+uint_t netLockGetProfileCount(void)
+{
+   return netLockProfileCount;
+}
+
+
+/**
+ * @brief Get the number of acquisitions and waits that were not profiled
+ *
+ * The count is incremented whenever a mutex or an event wait site cannot be
+ * added because the profile table is full
+ *
+ * @return Number of acquisitions and waits on objects that are not profiled
+ **/
+
+uint32_t netLockGetObjectOverflows(void)
+{
+   return netLockObjectOverflows;
+}
+
+
+/**
+ * @brief Retrieve a copy of a profile
+ * @param[in] index Zero-based index of the entry
+ * @param[out] profile Copy of the profile
+ * @return Error code
+ **/
+
+error_t netLockReadProfile(uint_t index, NetLockProfile *profile)
+{
+   //Check parameters
+   if(index >= netLockProfileCount || profile == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netLockMutex);
+   //Copy the entry
+   *profile = netLockProfiles[index];
+   //Release exclusive access
+   osReleaseMutex(&netLockMutex);
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Clear the statistics of all the profiled objects
+ *
+ * Call sites are kept, so that a mutex can be held while its statistics are
+ * being reset
+ **/
+
+void netLockResetProfiles(void)
+{
+   uint_t i;
+   NetLockSite *site;
+   NetLockProfile *profile;
+
+   //Get exclusive access
+   osAcquireMutex(&netLockMutex);
+
+   //Clear global counter
+   netLockObjectOverflows = 0;
+
+   //Loop through the profile table
+   for(i = 0; i < netLockProfileCount; i++)
+   {
+      //Point to the current entry
+      profile = &netLockProfiles[i];
+
+      //Clear statistics
+      profile->count = 0;
+      profile->contended = 0;
+      profile->timeouts = 0;
+      profile->siteOverflows = 0;
+      netHistogramReset(&profile->waitTime);
+      netHistogramReset(&profile->holdTime);
+   }
+
+   //Loop through the call site table
+   for(i = 0; i < NET_LOCK_PROFILING_MAX_SITES; i++)
+   {
+      //Point to the current entry
+      site = &netLockSites[i];
+
+      //Clear call site statistics
+      if(site->file != NULL)
+      {
+         site->count = 0;
+         site->contended = 0;
+         site->maxWait = 0;
+         site->totalWait = 0;
+         site->maxHold = 0;
+         site->totalHold = 0;
+         site->blocking = 0;
+      }
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netLockMutex);
+}
+
+
+/**
+ * @brief Format a contention report as a JSON object
+ * @param[out] buffer Output buffer
+ * @param[in] size Size of the output buffer
+ * @return Length of the resulting string
+ **/
+
+size_t netLockFormatReport(char_t *buffer, size_t size)
+{
+   uint_t i;
+   uint_t j;
+   uint_t k;
+   int_t ret;
+   size_t n;
+   const char_t *p;
+   const char_t *file;
+   NetLockSite *site;
+   NetLockProfile *profile;
+
+   //Check parameters
+   if(buffer == NULL || size == 0)
+      return 0;
+
+   //Get exclusive access
+   osAcquireMutex(&netLockMutex);
+
+   //Beginning of the JSON object
+   ret = osSnprintf(buffer, size, "{\"object_overflows\":%" PRIu32
+      ",\"objects\":[", netLockObjectOverflows);
+   n = (ret > 0) ? ret : 0;
+
+   //Loop through the profile table
+   for(i = 0; i < netLockProfileCount && n < size; i++)
+   {
+      //Point to the current entry
+      profile = &netLockProfiles[i];
+
+      //Format object summary
+      ret = osSnprintf(buffer + n, size - n,
+         "%s{\"name\":\"%s\",\"type\":\"%s\",\"count\":%" PRIu32 ","
+         "\"contended\":%" PRIu32 ",\"timeouts\":%" PRIu32 ","
+         "\"wait_us\":{\"p50\":%" PRIu32 ",\"p99\":%" PRIu32 ","
+         "\"max\":%" PRIu32 "},\"hold_us\":{\"p50\":%" PRIu32 ","
+         "\"p99\":%" PRIu32 ",\"max\":%" PRIu32 "},"
+         "\"site_overflows\":%" PRIu32 ",\"sites\":[",
+         (i == 0) ? "" : ",", profile->name,
+         (profile->type == NET_LOCK_TYPE_MUTEX) ? "mutex" : "event",
+         profile->count, profile->contended, profile->timeouts,
+         netHistogramGetPercentile(&profile->waitTime, 500),
+         netHistogramGetPercentile(&profile->waitTime, 990),
+         profile->waitTime.max,
+         netHistogramGetPercentile(&profile->holdTime, 500),
+         netHistogramGetPercentile(&profile->holdTime, 990),
+         profile->holdTime.max, profile->siteOverflows);
+
+      n += (ret > 0) ? ret : 0;
+
+      //Loop through the call site table
+      for(k = 0, j = 0; j < NET_LOCK_PROFILING_MAX_SITES && n < size; j++)
+      {
+         //Point to the current call site
+         site = &netLockSites[j];
+
+         //Skip the call sites of the other objects
+         if(site->file == NULL || site->profile != profile)
+            continue;
+
+         //Only keep the last component of the path
+         for(file = site->file, p = site->file; *p != '\0'; p++)
+         {
+            if(*p == '/' || *p == '\\')
+            {
+               file = p + 1;
+            }
+         }
+
+         //Format call site statistics
+         ret = osSnprintf(buffer + n, size - n,
+            "%s{\"site\":\"%s:%u\",\"count\":%" PRIu32 ","
+            "\"contended\":%" PRIu32 ",\"max_wait_us\":%" PRIu32 ","
+            "\"total_wait_us\":%" PRIu32 ",\"max_hold_us\":%" PRIu32 ","
+            "\"total_hold_us\":%" PRIu32 ",\"blocking_us\":%" PRIu32 "}",
+            (k++ == 0) ? "" : ",", file, site->line, site->count,
+            site->contended, site->maxWait, (uint32_t) site->totalWait,
+            site->maxHold, (uint32_t) site->totalHold,
+            (uint32_t) site->blocking);
+
+         n += (ret > 0) ? ret : 0;
+      }
+
+      //End of the object
+      if(n < size)
+      {
+         ret = osSnprintf(buffer + n, size - n, "]}");
+         n += (ret > 0) ? ret : 0;
+      }
+   }
+
+   //End of the JSON object
+   if(n < size)
+   {
+      ret = osSnprintf(buffer + n, size - n, "]}");
+      n += (ret > 0) ? ret : 0;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netLockMutex);
+
+   //Check whether the output has been truncated
+   if(n >= size)
+   {
+      n = size - 1;
+   }
+
+   //Return the length of the resulting string
+   return n;
+}
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * @file net_lock.h
+ * @brief Lock contention profiling
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _NET_LOCK_H
+#define _NET_LOCK_H
+
+//Dependencies
+#include "core/net.h"
+#include "core/net_stats.h"
+#include "error.h"
+
+//Lock contention profiling support
+#ifndef NET_LOCK_PROFILING_SUPPORT
+   #define NET_LOCK_PROFILING_SUPPORT DISABLED
+#elif (NET_LOCK_PROFILING_SUPPORT != ENABLED && NET_LOCK_PROFILING_SUPPORT != DISABLED)
+   #error NET_LOCK_PROFILING_SUPPORT parameter is not valid
+#endif
+
+//Maximum number of mutexes and event wait sites that can be profiled (the
+//stack creates about a dozen mutexes and waits for events at about two
+//dozen call sites)
+#ifndef NET_LOCK_PROFILING_MAX_OBJECTS
+   #define NET_LOCK_PROFILING_MAX_OBJECTS 48
+#elif (NET_LOCK_PROFILING_MAX_OBJECTS < 1)
+   #error NET_LOCK_PROFILING_MAX_OBJECTS parameter is not valid
+#endif
+
+//Maximum number of call sites tracked, all objects included (the stack
+//acquires the netMutex from about 250 call sites)
+#ifndef NET_LOCK_PROFILING_MAX_SITES
+   #define NET_LOCK_PROFILING_MAX_SITES 512
+#elif (NET_LOCK_PROFILING_MAX_SITES < 1)
+   #error NET_LOCK_PROFILING_MAX_SITES parameter is not valid
+#endif
+
+//Memory barrier used to publish new entries of the profile table
+#ifndef netLockBarrier
+   #if defined(__GNUC__)
+      #define netLockBarrier() __sync_synchronize()
+   #else
+      #define netLockBarrier()
+   #endif
+#endif
+
+//Instrumented wrappers. Every module that includes net.h goes through the
+//wrappers, so that each acquisition can be attributed to its call site
+#if (NET_LOCK_PROFILING_SUPPORT == ENABLED)
+   #define osAcquireMutex(mutex) \
+      netLockAcquireMutex(mutex, #mutex, __FILE__, __LINE__)
+   #define osReleaseMutex(mutex) \
+      netLockReleaseMutex(mutex)
+   #define osWaitForEvent(event, timeout) \
+      netLockWaitForEvent(event, timeout, #event, __FILE__, __LINE__)
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Profiled object type
+ **/
+
+typedef enum
+{
+   NET_LOCK_TYPE_MUTEX = 0, ///<Mutex (profiled per object)
+   NET_LOCK_TYPE_EVENT = 1  ///<Event wait (profiled per call site)
+} NetLockType;
+
+
+/**
+ * @brief Call site statistics
+ **/
+
+typedef struct _NetLockSite
+{
+   struct _NetLockProfile *profile; ///<Profiled object the call site belongs to
+   const char_t *file;              ///<Source file
+   uint_t line;                     ///<Line number
+   uint32_t count;                  ///<Number of acquisitions (or waits)
+   uint32_t contended;              ///<Number of acquisitions that found the mutex held
+   uint32_t maxWait;                ///<Longest wait, in microseconds
+   uint64_t totalWait;              ///<Total wait time, in microseconds
+   uint32_t maxHold;                ///<Longest hold, in microseconds
+   uint64_t totalHold;              ///<Total hold time, in microseconds
+   uint64_t blocking;               ///<Time other call sites spent waiting while this site held the mutex
+} NetLockSite;
+
+
+/**
+ * @brief Profile of a mutex or of an event wait site
+ **/
+
+typedef struct _NetLockProfile
+{
+   const void *object;     ///<Profiled mutex (NULL for event wait sites)
+   const char_t *name;     ///<Expression naming the object at the call site
+   NetLockType type;       ///<Object type
+   const char_t *file;     ///<Source file of the call site (event wait sites only)
+   uint_t line;            ///<Line number of the call site (event wait sites only)
+   uint32_t count;         ///<Number of acquisitions (or waits)
+   uint32_t contended;     ///<Number of acquisitions that found the mutex held
+   uint32_t timeouts;      ///<Number of event waits that timed out
+   uint32_t siteOverflows; ///<Acquisitions from call sites that could not be tracked
+   bool_t locked;          ///<The mutex is currently held
+   NetLockSite *holder;    ///<Call site currently holding the mutex
+   uint32_t acquireTime;   ///<Time at which the mutex was acquired
+   NetHistogram waitTime;  ///<Wait time distribution, in microseconds
+   NetHistogram holdTime;  ///<Hold time distribution, in microseconds
+} NetLockProfile;
+
+
+//Lock contention profiling related functions
+error_t netLockInit(void);
+
+void netLockAcquireMutex(OsMutex *mutex, const char_t *name,
+   const char_t *file, uint_t line);
+
+void netLockReleaseMutex(OsMutex *mutex);
+
+bool_t netLockWaitForEvent(OsEvent *event, systime_t timeout,
+   const char_t *name, const char_t *file, uint_t line);
+
+NetLockProfile *netLockGetProfile(const void *object, const char_t *name,
+   NetLockType type, const char_t *file, uint_t line);
+
+NetLockSite *netLockGetSite(NetLockProfile *profile, const char_t *file,
+   uint_t line);
+
+uint_t netLockGetProfileCount(void);
+uint32_t netLockGetObjectOverflows(void);
+error_t netLockReadProfile(uint_t index, NetLockProfile *profile);
+void netLockResetProfiles(void);
+
+size_t netLockFormatReport(char_t *buffer, size_t size);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
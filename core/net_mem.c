@@ -59,6 +59,11 @@ uint_t memPoolCurrentUsage;
 //Maximum number of buffers that have been allocated so far
 uint_t memPoolMaxUsage;
 
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+//The memory pool has been initialized by a previous stack instance
+static bool_t memPoolInitialized = FALSE;
+#endif
+
 #endif
 
 
@@ -71,6 +76,16 @@ error_t memPoolInit(void)
 {
 //Use fixed-size blocks allocation?
 #if (NET_MEM_POOL_SUPPORT == ENABLED)
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //The memory pool is shared by all the stack instances and is only
+   //initialized once
+   if(memPoolInitialized)
+      return NO_ERROR;
+
+   //The memory pool is now initialized
+   memPoolInitialized = TRUE;
+#endif
+
    //Create a mutex to prevent simultaneous access to the memory pool
    if(!osCreateMutex(&memPoolMutex))
    {
@@ -151,6 +166,8 @@ void *memPoolAlloc(size_t size)
    {
       //Debug message
       TRACE_WARNING("Memory allocation failed!\r\n");
+      //Tracepoint
+      NET_TRACE(NET_TRACE_EVENT_ALLOC_FAILURE, 0, size, 0, 0);
    }
 
    //Return a pointer to the allocated memory block
@@ -233,6 +250,25 @@ void memPoolGetStats(uint_t *currentUsage, uint_t *maxUsage, uint_t *size)
 }
 
 
+/**
+ * @brief Get memory pool pressure
+ * @return Percentage of the memory pool currently allocated, across all the
+ *   stack instances (always 0 when fixed-size blocks allocation is not used)
+ **/
+
+uint_t memPoolGetPressure(void)
+{
+//Use fixed-size blocks allocation?
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+   //Occupancy of the memory pool
+   return (memPoolCurrentUsage * 100) / NET_MEM_POOL_BUFFER_COUNT;
+#else
+   //Memory pool is not used...
+   return 0;
+#endif
+}
+
+
 /**
  * @brief Allocate a multi-part buffer
  * @param[in] length Desired length
@@ -36,7 +36,8 @@
 #include "os_port.h"
 #include "error.h"
 
-//Use fixed-size blocks allocation?
+//Use fixed-size blocks allocation? (the pool is shared by all the stack
+//instances, so its usage and its pressure are process-wide figures)
 #ifndef NET_MEM_POOL_SUPPORT
    #define NET_MEM_POOL_SUPPORT DISABLED
 #elif (NET_MEM_POOL_SUPPORT != ENABLED && NET_MEM_POOL_SUPPORT != DISABLED)
@@ -106,6 +107,7 @@ error_t memPoolInit(void);
 void *memPoolAlloc(size_t size);
 void memPoolFree(void *p);
 void memPoolGetStats(uint_t *currentUsage, uint_t *maxUsage, uint_t *size);
+uint_t memPoolGetPressure(void);
 
 NetBuffer *netBufferAlloc(size_t length);
 void netBufferFree(NetBuffer *buffer);
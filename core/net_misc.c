@@ -95,6 +95,9 @@ const NetTxAncillary NET_DEFAULT_TX_ANCILLARY =
 #if (ETH_TIMESTAMP_SUPPORT == ENABLED)
    -1,            //Unique identifier for hardware time stamping
 #endif
+#if (NET_STATS_SUPPORT == ENABLED)
+   0,             //Time at which the packet entered the IP layer
+#endif
 };
 
 //Default options passed to the stack (RX path)
@@ -102,6 +105,7 @@ const NetRxAncillary NET_DEFAULT_RX_ANCILLARY =
 {
    0,       //Time-to-live value
    0,       //Type-of-service value
+   FALSE,   //Upper-layer checksum needs not be verified
 #if (ETH_SUPPORT == ENABLED)
    {{{0}}}, //Source MAC address
    {{{0}}}, //Destination MAC address
@@ -113,6 +117,9 @@ const NetRxAncillary NET_DEFAULT_RX_ANCILLARY =
 #if (ETH_TIMESTAMP_SUPPORT == ENABLED)
    {0},     //Captured time stamp
 #endif
+#if (NET_STATS_SUPPORT == ENABLED)
+   0,       //Time at which the packet was received
+#endif
 };
 
 
@@ -299,37 +306,29 @@ void netProcessLinkChange(NetInterface *interface)
       }
    }
 
-   //Loop through opened sockets
-   for(i = 0; i < SOCKET_MAX_COUNT; i++)
-   {
-      //Point to the current socket
-      socket = socketTable + i;
-
 #if (TCP_SUPPORT == ENABLED)
-      //Connection-oriented socket?
-      if(socket->type == SOCKET_TYPE_STREAM)
-      {
-         tcpUpdateEvents(socket);
-      }
+   //Loop through connection-oriented sockets
+   for(socket = tcpSocketList; socket != NULL; socket = socket->next)
+   {
+      tcpUpdateEvents(socket);
+   }
 #endif
 
 #if (UDP_SUPPORT == ENABLED)
-      //Connectionless socket?
-      if(socket->type == SOCKET_TYPE_DGRAM)
-      {
-         udpUpdateEvents(socket);
-      }
+   //Loop through connectionless sockets
+   for(socket = udpSocketList; socket != NULL; socket = socket->next)
+   {
+      udpUpdateEvents(socket);
+   }
 #endif
 
 #if (RAW_SOCKET_SUPPORT == ENABLED)
-      //Raw socket?
-      if(socket->type == SOCKET_TYPE_RAW_IP ||
-         socket->type == SOCKET_TYPE_RAW_ETH)
-      {
-         rawSocketUpdateEvents(socket);
-      }
-#endif
+   //Loop through raw sockets
+   for(socket = rawSocketList; socket != NULL; socket = socket->next)
+   {
+      rawSocketUpdateEvents(socket);
    }
+#endif
 }
 
 
@@ -416,10 +415,10 @@ void netTick(void)
    NetTimerCallbackEntry *entry;
 
    //Increment tick counter
-   nicTickCounter += NET_TICK_INTERVAL;
+   netContext.nicTickCounter += NET_TICK_INTERVAL;
 
    //Handle periodic operations such as polling the link state
-   if(nicTickCounter >= NIC_TICK_INTERVAL)
+   if(netContext.nicTickCounter >= NIC_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -430,15 +429,15 @@ void netTick(void)
       }
 
       //Reset tick counter
-      nicTickCounter = 0;
+      netContext.nicTickCounter = 0;
    }
 
 #if (PPP_SUPPORT == ENABLED)
    //Increment tick counter
-   pppTickCounter += NET_TICK_INTERVAL;
+   netContext.pppTickCounter += NET_TICK_INTERVAL;
 
    //Manage PPP related timers
-   if(pppTickCounter >= PPP_TICK_INTERVAL)
+   if(netContext.pppTickCounter >= PPP_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -449,16 +448,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      pppTickCounter = 0;
+      netContext.pppTickCounter = 0;
    }
 #endif
 
 #if (IPV4_SUPPORT == ENABLED && ETH_SUPPORT == ENABLED)
    //Increment tick counter
-   arpTickCounter += NET_TICK_INTERVAL;
+   netContext.arpTickCounter += NET_TICK_INTERVAL;
 
    //Manage ARP cache
-   if(arpTickCounter >= ARP_TICK_INTERVAL)
+   if(netContext.arpTickCounter >= ARP_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -469,16 +468,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      arpTickCounter = 0;
+      netContext.arpTickCounter = 0;
    }
 #endif
 
 #if (IPV4_SUPPORT == ENABLED && IPV4_FRAG_SUPPORT == ENABLED)
    //Increment tick counter
-   ipv4FragTickCounter += NET_TICK_INTERVAL;
+   netContext.ipv4FragTickCounter += NET_TICK_INTERVAL;
 
    //Handle IPv4 fragment reassembly timeout
-   if(ipv4FragTickCounter >= IPV4_FRAG_TICK_INTERVAL)
+   if(netContext.ipv4FragTickCounter >= IPV4_FRAG_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -489,17 +488,17 @@ void netTick(void)
       }
 
       //Reset tick counter
-      ipv4FragTickCounter = 0;
+      netContext.ipv4FragTickCounter = 0;
    }
 #endif
 
 #if (IPV4_SUPPORT == ENABLED && (IGMP_HOST_SUPPORT == ENABLED || \
    IGMP_ROUTER_SUPPORT == ENABLED || IGMP_SNOOPING_SUPPORT == ENABLED))
    //Increment tick counter
-   igmpTickCounter += NET_TICK_INTERVAL;
+   netContext.igmpTickCounter += NET_TICK_INTERVAL;
 
    //Handle IGMP related timers
-   if(igmpTickCounter >= IGMP_TICK_INTERVAL)
+   if(netContext.igmpTickCounter >= IGMP_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -510,16 +509,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      igmpTickCounter = 0;
+      netContext.igmpTickCounter = 0;
    }
 #endif
 
 #if (IPV4_SUPPORT == ENABLED && AUTO_IP_SUPPORT == ENABLED)
    //Increment tick counter
-   autoIpTickCounter += NET_TICK_INTERVAL;
+   netContext.autoIpTickCounter += NET_TICK_INTERVAL;
 
    //Handle Auto-IP related timers
-   if(autoIpTickCounter >= AUTO_IP_TICK_INTERVAL)
+   if(netContext.autoIpTickCounter >= AUTO_IP_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -528,16 +527,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      autoIpTickCounter = 0;
+      netContext.autoIpTickCounter = 0;
    }
 #endif
 
 #if (IPV4_SUPPORT == ENABLED && DHCP_CLIENT_SUPPORT == ENABLED)
    //Increment tick counter
-   dhcpClientTickCounter += NET_TICK_INTERVAL;
+   netContext.dhcpClientTickCounter += NET_TICK_INTERVAL;
 
    //Handle DHCP client related timers
-   if(dhcpClientTickCounter >= DHCP_CLIENT_TICK_INTERVAL)
+   if(netContext.dhcpClientTickCounter >= DHCP_CLIENT_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -546,16 +545,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      dhcpClientTickCounter = 0;
+      netContext.dhcpClientTickCounter = 0;
    }
 #endif
 
 #if (IPV4_SUPPORT == ENABLED && DHCP_SERVER_SUPPORT == ENABLED)
    //Increment tick counter
-   dhcpServerTickCounter += NET_TICK_INTERVAL;
+   netContext.dhcpServerTickCounter += NET_TICK_INTERVAL;
 
    //Handle DHCP server related timers
-   if(dhcpServerTickCounter >= DHCP_SERVER_TICK_INTERVAL)
+   if(netContext.dhcpServerTickCounter >= DHCP_SERVER_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -564,16 +563,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      dhcpServerTickCounter = 0;
+      netContext.dhcpServerTickCounter = 0;
    }
 #endif
 
 #if (IPV6_SUPPORT == ENABLED && IPV6_FRAG_SUPPORT == ENABLED)
    //Increment tick counter
-   ipv6FragTickCounter += NET_TICK_INTERVAL;
+   netContext.ipv6FragTickCounter += NET_TICK_INTERVAL;
 
    //Handle IPv6 fragment reassembly timeout
-   if(ipv6FragTickCounter >= IPV6_FRAG_TICK_INTERVAL)
+   if(netContext.ipv6FragTickCounter >= IPV6_FRAG_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -584,16 +583,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      ipv6FragTickCounter = 0;
+      netContext.ipv6FragTickCounter = 0;
    }
 #endif
 
 #if (IPV6_SUPPORT == ENABLED && MLD_SUPPORT == ENABLED)
    //Increment tick counter
-   mldTickCounter += NET_TICK_INTERVAL;
+   netContext.mldTickCounter += NET_TICK_INTERVAL;
 
    //Handle MLD related timers
-   if(mldTickCounter >= MLD_TICK_INTERVAL)
+   if(netContext.mldTickCounter >= MLD_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -604,16 +603,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      mldTickCounter = 0;
+      netContext.mldTickCounter = 0;
    }
 #endif
 
 #if (IPV6_SUPPORT == ENABLED && NDP_SUPPORT == ENABLED)
    //Increment tick counter
-   ndpTickCounter += NET_TICK_INTERVAL;
+   netContext.ndpTickCounter += NET_TICK_INTERVAL;
 
    //Handle NDP related timers
-   if(ndpTickCounter >= NDP_TICK_INTERVAL)
+   if(netContext.ndpTickCounter >= NDP_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -624,16 +623,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      ndpTickCounter = 0;
+      netContext.ndpTickCounter = 0;
    }
 #endif
 
 #if (IPV6_SUPPORT == ENABLED && NDP_ROUTER_ADV_SUPPORT == ENABLED)
    //Increment tick counter
-   ndpRouterAdvTickCounter += NET_TICK_INTERVAL;
+   netContext.ndpRouterAdvTickCounter += NET_TICK_INTERVAL;
 
    //Handle RA service related timers
-   if(ndpRouterAdvTickCounter >= NDP_ROUTER_ADV_TICK_INTERVAL)
+   if(netContext.ndpRouterAdvTickCounter >= NDP_ROUTER_ADV_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -642,16 +641,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      ndpRouterAdvTickCounter = 0;
+      netContext.ndpRouterAdvTickCounter = 0;
    }
 #endif
 
 #if (IPV6_SUPPORT == ENABLED && DHCPV6_CLIENT_SUPPORT == ENABLED)
    //Increment tick counter
-   dhcpv6ClientTickCounter += NET_TICK_INTERVAL;
+   netContext.dhcpv6ClientTickCounter += NET_TICK_INTERVAL;
 
    //Handle DHCPv6 client related timers
-   if(dhcpv6ClientTickCounter >= DHCPV6_CLIENT_TICK_INTERVAL)
+   if(netContext.dhcpv6ClientTickCounter >= DHCPV6_CLIENT_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -660,45 +659,45 @@ void netTick(void)
       }
 
       //Reset tick counter
-      dhcpv6ClientTickCounter = 0;
+      netContext.dhcpv6ClientTickCounter = 0;
    }
 #endif
 
 #if (TCP_SUPPORT == ENABLED)
    //Increment tick counter
-   tcpTickCounter += NET_TICK_INTERVAL;
+   netContext.tcpTickCounter += NET_TICK_INTERVAL;
 
    //Manage TCP related timers
-   if(tcpTickCounter >= TCP_TICK_INTERVAL)
+   if(netContext.tcpTickCounter >= TCP_TICK_INTERVAL)
    {
       //TCP timer handler
       tcpTick();
       //Reset tick counter
-      tcpTickCounter = 0;
+      netContext.tcpTickCounter = 0;
    }
 #endif
 
 #if (DNS_CLIENT_SUPPORT == ENABLED || MDNS_CLIENT_SUPPORT == ENABLED || \
    NBNS_CLIENT_SUPPORT == ENABLED || LLMNR_CLIENT_SUPPORT == ENABLED)
    //Increment tick counter
-   dnsTickCounter += NET_TICK_INTERVAL;
+   netContext.dnsTickCounter += NET_TICK_INTERVAL;
 
    //Manage DNS cache
-   if(dnsTickCounter >= DNS_TICK_INTERVAL)
+   if(netContext.dnsTickCounter >= DNS_TICK_INTERVAL)
    {
       //DNS timer handler
       dnsTick();
       //Reset tick counter
-      dnsTickCounter = 0;
+      netContext.dnsTickCounter = 0;
    }
 #endif
 
 #if (MDNS_RESPONDER_SUPPORT == ENABLED)
    //Increment tick counter
-   mdnsResponderTickCounter += NET_TICK_INTERVAL;
+   netContext.mdnsResponderTickCounter += NET_TICK_INTERVAL;
 
    //Manage mDNS probing and announcing
-   if(mdnsResponderTickCounter >= MDNS_RESPONDER_TICK_INTERVAL)
+   if(netContext.mdnsResponderTickCounter >= MDNS_RESPONDER_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -707,16 +706,16 @@ void netTick(void)
       }
 
       //Reset tick counter
-      mdnsResponderTickCounter = 0;
+      netContext.mdnsResponderTickCounter = 0;
    }
 #endif
 
 #if (DNS_SD_SUPPORT == ENABLED)
    //Increment tick counter
-   dnsSdTickCounter += NET_TICK_INTERVAL;
+   netContext.dnsSdTickCounter += NET_TICK_INTERVAL;
 
    //Manage DNS-SD probing and announcing
-   if(dnsSdTickCounter >= DNS_SD_TICK_INTERVAL)
+   if(netContext.dnsSdTickCounter >= DNS_SD_TICK_INTERVAL)
    {
       //Loop through network interfaces
       for(i = 0; i < NET_INTERFACE_COUNT; i++)
@@ -725,7 +724,7 @@ void netTick(void)
       }
 
       //Reset tick counter
-      dnsSdTickCounter = 0;
+      netContext.dnsSdTickCounter = 0;
    }
 #endif
 
@@ -825,6 +824,26 @@ bool_t netTimerExpired(NetTimer *timer)
 }
 
 
+/**
+ * @brief Get the current value of the monotonic time source
+ *
+ * The resolution of the returned value is given by NET_TIME_RESOLUTION_US
+ *
+ * @return Monotonic time, in microseconds
+ **/
+
+uint64_t netGetTimeUs(void)
+{
+#ifdef OS_TIME_RESOLUTION_US
+   //Read the monotonic clock provided by the RTOS port
+   return osGetTimeUs();
+#else
+   //Fall back to the system tick
+   return osGetSystemTime64() * 1000;
+#endif
+}
+
+
 /**
  * @brief Initialize random number generator
  **/
@@ -51,6 +51,23 @@ struct _NetRxAncillary;
 #define NET_RAND_STATE_SET_BIT(s, n, v) s[(n - 1) / 8] = \
    (s[(n - 1) / 8] & ~(1 << ((n - 1) % 8))) | (v) << ((n - 1) % 8)
 
+//Resolution of the monotonic time source returned by netGetTimeUs, in
+//microseconds. A port that implements osGetTimeUs() advertises it by
+//defining OS_TIME_RESOLUTION_US, else the 64-bit system tick is used
+#ifdef OS_TIME_RESOLUTION_US
+   #define NET_TIME_RESOLUTION_US OS_TIME_RESOLUTION_US
+#else
+   #define NET_TIME_RESOLUTION_US 1000
+#endif
+
+//The timers of the TCP/IP stack run on the system time, unless the
+//application provides its own time source (in milliseconds) through
+//NET_SYSTEM_TIME_HOOK, e.g. the virtual clock of a network emulator
+#ifdef NET_SYSTEM_TIME_HOOK
+   #undef osGetSystemTime
+   #define osGetSystemTime() NET_SYSTEM_TIME_HOOK()
+#endif
+
 //C++ guard
 #ifdef __cplusplus
 extern "C" {
@@ -139,6 +156,9 @@ struct _NetTxAncillary
 #if (ETH_TIMESTAMP_SUPPORT == ENABLED)
    int32_t timestampId; ///<Unique identifier for hardware time stamping
 #endif
+#if (NET_STATS_SUPPORT == ENABLED)
+   uint32_t statsTimestamp; ///<Time at which the packet entered the IP layer, in microseconds
+#endif
 };
 
 
@@ -150,6 +170,7 @@ struct _NetRxAncillary
 {
    uint8_t ttl;            ///<Time-to-live value
    uint8_t tos;            ///<Type-of-service value
+   bool_t checksumValid;   ///<Upper-layer checksum needs not be verified
 #if (ETH_SUPPORT == ENABLED)
    MacAddr srcMacAddr;     ///<Source MAC address
    MacAddr destMacAddr;    ///<Destination MAC address
@@ -161,6 +182,9 @@ struct _NetRxAncillary
 #if (ETH_TIMESTAMP_SUPPORT == ENABLED)
    NetTimestamp timestamp; ///<Captured time stamp
 #endif
+#if (NET_STATS_SUPPORT == ENABLED)
+   uint32_t statsTimestamp; ///<Time at which the packet was received, in microseconds
+#endif
 };
 
 
@@ -212,6 +236,12 @@ void netStopTimer(NetTimer *timer);
 bool_t netTimerRunning(NetTimer *timer);
 bool_t netTimerExpired(NetTimer *timer);
 
+uint64_t netGetTimeUs(void);
+
+#ifdef NET_SYSTEM_TIME_HOOK
+systime_t NET_SYSTEM_TIME_HOOK(void);
+#endif
+
 void netInitRand(void);
 uint32_t netGenerateRand(void);
 uint32_t netGenerateRandRange(uint32_t min, uint32_t max);
@@ -0,0 +1,492 @@
+/**
+ * @file net_stats.c
+ * @brief Latency histograms and stack statistics
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "core/net_stats.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration (the histograms are also used by the lock
+//contention profiler)
+#if (NET_STATS_SUPPORT == ENABLED || NET_LOCK_PROFILING_SUPPORT == ENABLED)
+
+//Number of linear buckets in each power of two
+#define NET_HISTOGRAM_SUB_BUCKET_COUNT (1U << NET_STATS_SUB_BUCKET_BITS)
+
+
+/**
+ * @brief Add a sample to a histogram
+ * @param[in] histogram Pointer to the histogram
+ * @param[in] value Sample value
+ **/
+
+void netHistogramRecord(NetHistogram *histogram, uint32_t value)
+{
+   //Update the lowest and highest samples
+   if(histogram->count == 0 || value < histogram->min)
+   {
+      histogram->min = value;
+   }
+
+   if(histogram->count == 0 || value > histogram->max)
+   {
+      histogram->max = value;
+   }
+
+   //Update sample count and sum
+   histogram->count++;
+   histogram->sum += value;
+
+   //Increment the relevant bucket
+   histogram->buckets[netHistogramGetBucketIndex(value)]++;
+}
+
+
+/**
+ * @brief Remove all the samples from a histogram
+ * @param[in] histogram Pointer to the histogram
+ **/
+
+void netHistogramReset(NetHistogram *histogram)
+{
+   osMemset(histogram, 0, sizeof(NetHistogram));
+}
+
+
+/**
+ * @brief Get the bucket a value falls into
+ * @param[in] value Sample value
+ * @return Bucket index
+ **/
+
+uint_t netHistogramGetBucketIndex(uint32_t value)
+{
+   uint_t n;
+   uint_t shift;
+
+   //Small values are counted exactly
+   if(value < (2 * NET_HISTOGRAM_SUB_BUCKET_COUNT))
+      return value;
+
+   //Find the position of the most significant bit
+   n = 0;
+
+   if((value >> 16) != 0)
+   {
+      n += 16;
+   }
+
+   if((value >> (n + 8)) != 0)
+   {
+      n += 8;
+   }
+
+   if((value >> (n + 4)) != 0)
+   {
+      n += 4;
+   }
+
+   if((value >> (n + 2)) != 0)
+   {
+      n += 2;
+   }
+
+   if((value >> (n + 1)) != 0)
+   {
+      n += 1;
+   }
+
+   //Only the most significant bits are kept
+   shift = n - NET_STATS_SUB_BUCKET_BITS;
+
+   //Return the index of the bucket
+   return ((shift + 1) << NET_STATS_SUB_BUCKET_BITS) + (value >> shift) -
+      NET_HISTOGRAM_SUB_BUCKET_COUNT;
+}
+
+
+/**
+ * @brief Get the lowest value that falls into a given bucket
+ * @param[in] index Bucket index
+ * @return Lowest value of the bucket
+ **/
+
+uint32_t netHistogramGetBucketValue(uint_t index)
+{
+   uint_t shift;
+   uint32_t value;
+
+   //Small values are counted exactly
+   if(index < (2 * NET_HISTOGRAM_SUB_BUCKET_COUNT))
+      return index;
+
+   //Retrieve the power of two the bucket belongs to
+   shift = (index >> NET_STATS_SUB_BUCKET_BITS) - 1;
+
+   //Retrieve the most significant bits
+   value = (index & (NET_HISTOGRAM_SUB_BUCKET_COUNT - 1)) +
+      NET_HISTOGRAM_SUB_BUCKET_COUNT;
+
+   //Return the lowest value of the bucket
+   return value << shift;
+}
+
+
+/**
+ * @brief Estimate a percentile
+ * @param[in] histogram Pointer to the histogram
+ * @param[in] permille Percentile, in tenths of a percent (for instance,
+ *   990 for the 99th percentile and 999 for the 99.9th percentile)
+ * @return Highest value of the bucket the percentile falls into
+ **/
+
+uint32_t netHistogramGetPercentile(const NetHistogram *histogram,
+   uint_t permille)
+{
+   uint_t i;
+   uint32_t n;
+   uint32_t value;
+   uint64_t rank;
+
+   //Empty histogram?
+   if(histogram->count == 0)
+      return 0;
+
+   //Number of samples that lie at or below the percentile
+   rank = ((uint64_t) histogram->count * MIN(permille, 1000) + 999) / 1000;
+   rank = MAX(rank, 1);
+
+   //Walk through the buckets
+   for(n = 0, i = 0; i < NET_HISTOGRAM_BUCKET_COUNT; i++)
+   {
+      n += histogram->buckets[i];
+
+      //The percentile falls into the current bucket?
+      if(n >= rank)
+         break;
+   }
+
+   //Retrieve the highest value of the bucket
+   if((i + 1) < NET_HISTOGRAM_BUCKET_COUNT)
+   {
+      value = netHistogramGetBucketValue(i + 1) - 1;
+   }
+   else
+   {
+      value = UINT32_MAX;
+   }
+
+   //The estimate cannot exceed the highest sample
+   return MIN(value, histogram->max);
+}
+
+#endif
+
+//Check TCP/IP stack configuration
+#if (NET_STATS_SUPPORT == ENABLED)
+
+//Names of the stack-wide histograms
+static const char_t *const netStatsHistogramNames[NET_STATS_HISTOGRAM_COUNT] =
+{
+   "rx_delivery_us",
+   "tx_to_wire_us",
+   "nic_tx_wait_us",
+   "accept_us",
+   "mutex_wait_us",
+   "mutex_hold_us",
+   "tcp_rx_cost",
+   "tcp_tx_cost"
+};
+
+//Names of the per-interface histograms
+static const char_t *const netStatsIfHistogramNames[NET_STATS_IF_HISTOGRAM_COUNT] =
+{
+   "rtt_us",
+   "srtt_us"
+};
+
+
+/**
+ * @brief Retrieve a copy of a histogram
+ * @param[in] interface Underlying network interface (NULL for stack-wide
+ *   histograms)
+ * @param[in] id Histogram identifier
+ * @param[out] histogram Copy of the histogram
+ * @return Error code
+ **/
+
+error_t netStatsGetHistogram(NetInterface *interface, uint_t id,
+   NetHistogram *histogram)
+{
+   error_t error;
+
+   //Check parameters
+   if(histogram == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Stack-wide or per-interface histogram?
+   if(interface == NULL && id < NET_STATS_HISTOGRAM_COUNT)
+   {
+      *histogram = netContext.statsHistograms[id];
+   }
+   else if(interface != NULL && id < NET_STATS_IF_HISTOGRAM_COUNT)
+   {
+      *histogram = interface->statsHistograms[id];
+   }
+   else
+   {
+      error = ERROR_INVALID_PARAMETER;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Start measuring the processing cost of a code path
+ *
+ * Measurements may be nested. The cost recorded for a code path excludes the
+ * cost of the nested code paths, which is recorded separately. The probe
+ * lives on the stack of the caller, so the function is reentrant as long as
+ * the calling task holds the stack lock
+ *
+ * @param[out] probe Measurement in progress
+ **/
+
+void netStatsCostBegin(NetStatsCostProbe *probe)
+{
+   //Save the cost of the nested code paths of the enclosing measurement
+   probe->nested = netContext.statsCostNested;
+   netContext.statsCostNested = 0;
+
+   //Start measuring the processing cost
+   probe->start = NET_STATS_GET_COST();
+}
+
+
+/**
+ * @brief Record the processing cost of a code path
+ * @param[in] probe Measurement started by netStatsCostBegin
+ * @param[in] id Histogram identifier
+ **/
+
+void netStatsCostEnd(NetStatsCostProbe *probe, uint_t id)
+{
+   uint32_t cost;
+
+   //Total cost of the code path
+   cost = NET_STATS_GET_COST() - probe->start;
+
+   //Record the cost of the code path itself
+   if(id < NET_STATS_HISTOGRAM_COUNT)
+   {
+      netStatsRecord(id, cost - MIN(netContext.statsCostNested, cost));
+   }
+
+   //The whole cost is nested in the enclosing measurement
+   netContext.statsCostNested = probe->nested + cost;
+}
+
+
+/**
+ * @brief Remove all the samples from all the histograms
+ **/
+
+void netStatsReset(void)
+{
+   uint_t i;
+   uint_t j;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Reset stack-wide histograms
+   for(i = 0; i < NET_STATS_HISTOGRAM_COUNT; i++)
+   {
+      netHistogramReset(&netContext.statsHistograms[i]);
+   }
+
+   //Reset per-interface histograms
+   for(i = 0; i < NET_INTERFACE_COUNT; i++)
+   {
+      for(j = 0; j < NET_STATS_IF_HISTOGRAM_COUNT; j++)
+      {
+         netHistogramReset(&netInterface[i].statsHistograms[j]);
+      }
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+}
+
+
+/**
+ * @brief Get the name of a histogram
+ * @param[in] interface Underlying network interface (NULL for stack-wide
+ *   histograms)
+ * @param[in] id Histogram identifier
+ * @return Histogram name
+ **/
+
+const char_t *netStatsGetHistogramName(NetInterface *interface, uint_t id)
+{
+   //Stack-wide or per-interface histogram?
+   if(interface == NULL && id < NET_STATS_HISTOGRAM_COUNT)
+   {
+      return netStatsHistogramNames[id];
+   }
+   else if(interface != NULL && id < NET_STATS_IF_HISTOGRAM_COUNT)
+   {
+      return netStatsIfHistogramNames[id];
+   }
+   else
+   {
+      return "unknown";
+   }
+}
+
+
+/**
+ * @brief Format a summary of all the histograms as a JSON object
+ *
+ * The resulting string is meant to be served by the HTTP server (for
+ * instance from a CGI handler)
+ *
+ * @param[out] buffer Output buffer
+ * @param[in] size Size of the output buffer
+ * @return Length of the resulting string
+ **/
+
+size_t netStatsFormatJson(char_t *buffer, size_t size)
+{
+   uint_t i;
+   uint_t j;
+   int_t ret;
+   size_t n;
+   NetInterface *interface;
+   NetHistogram *histogram;
+
+   //Check parameters
+   if(buffer == NULL || size == 0)
+      return 0;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Beginning of the JSON object (the resolution of the time source tells
+   //how much of the low-order digits of the samples is significant)
+   ret = osSnprintf(buffer, size, "{\"resolution_us\":%u,"
+      "\"cost_unit\":\"" NET_STATS_COST_UNIT "\",\"stack\":{",
+      NET_STATS_TIME_RESOLUTION_US);
+   n = (ret > 0) ? ret : 0;
+
+   //Loop through the stack-wide and per-interface histograms
+   for(i = 0; i <= NET_INTERFACE_COUNT && n < size; i++)
+   {
+      //The stack-wide histograms come first
+      interface = (i == 0) ? NULL : &netInterface[i - 1];
+
+      //Each interface has its own object
+      if(interface != NULL)
+      {
+         ret = osSnprintf(buffer + n, size - n, "},\"%s\":{", interface->name);
+         n += (ret > 0) ? ret : 0;
+      }
+
+      //Loop through the histograms
+      for(j = 0; n < size; j++)
+      {
+         //Point to the current histogram
+         if(interface == NULL && j < NET_STATS_HISTOGRAM_COUNT)
+         {
+            histogram = &netContext.statsHistograms[j];
+         }
+         else if(interface != NULL && j < NET_STATS_IF_HISTOGRAM_COUNT)
+         {
+            histogram = &interface->statsHistograms[j];
+         }
+         else
+         {
+            break;
+         }
+
+         //Format summary
+         ret = osSnprintf(buffer + n, size - n,
+            "%s\"%s\":{\"count\":%" PRIu32 ",\"min\":%" PRIu32 ","
+            "\"mean\":%" PRIu32 ",\"p50\":%" PRIu32 ",\"p90\":%" PRIu32 ","
+            "\"p99\":%" PRIu32 ",\"p999\":%" PRIu32 ",\"max\":%" PRIu32 "}",
+            (j == 0) ? "" : ",", netStatsGetHistogramName(interface, j),
+            histogram->count, histogram->min,
+            (histogram->count != 0) ?
+            (uint32_t) (histogram->sum / histogram->count) : 0,
+            netHistogramGetPercentile(histogram, 500),
+            netHistogramGetPercentile(histogram, 900),
+            netHistogramGetPercentile(histogram, 990),
+            netHistogramGetPercentile(histogram, 999),
+            histogram->max);
+
+         n += (ret > 0) ? ret : 0;
+      }
+   }
+
+   //End of the JSON object
+   if(n < size)
+   {
+      ret = osSnprintf(buffer + n, size - n, "}}");
+      n += (ret > 0) ? ret : 0;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Check whether the output has been truncated
+   if(n >= size)
+   {
+      n = size - 1;
+   }
+
+   //Return the length of the resulting string
+   return n;
+}
+
+#endif
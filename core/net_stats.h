@@ -0,0 +1,187 @@
+/**
+ * @file net_stats.h
+ * @brief Latency histograms and stack statistics
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _NET_STATS_H
+#define _NET_STATS_H
+
+//Dependencies
+#include "core/net.h"
+#include "error.h"
+
+//Latency statistics support
+#ifndef NET_STATS_SUPPORT
+   #define NET_STATS_SUPPORT DISABLED
+#elif (NET_STATS_SUPPORT != ENABLED && NET_STATS_SUPPORT != DISABLED)
+   #error NET_STATS_SUPPORT parameter is not valid
+#endif
+
+//Number of bits of precision within each power of two (the relative error
+//of a recorded value is less than 1 / 2^NET_STATS_SUB_BUCKET_BITS)
+#ifndef NET_STATS_SUB_BUCKET_BITS
+   #define NET_STATS_SUB_BUCKET_BITS 2
+#elif (NET_STATS_SUB_BUCKET_BITS < 1 || NET_STATS_SUB_BUCKET_BITS > 5)
+   #error NET_STATS_SUB_BUCKET_BITS parameter is not valid
+#endif
+
+//Time source used to measure latencies, in microseconds. The value is
+//truncated to 32 bits, since only differences between samples are recorded
+#ifndef NET_STATS_GET_TIME_US
+   #define NET_STATS_GET_TIME_US() ((uint32_t) netGetTimeUs())
+   #define NET_STATS_TIME_RESOLUTION_US NET_TIME_RESOLUTION_US
+#endif
+
+//Resolution of the time source, in microseconds
+#ifndef NET_STATS_TIME_RESOLUTION_US
+   #define NET_STATS_TIME_RESOLUTION_US 1
+#endif
+
+//Counter used to measure the processing cost of a code path (for instance
+//the DWT cycle counter on Cortex-M devices). The time-stamp counter is used
+//on x86 targets. Elsewhere the cost is measured with the microsecond time
+//source and reported in nanoseconds
+#if defined(NET_STATS_GET_CYCLES)
+   #define NET_STATS_GET_COST() ((uint32_t) NET_STATS_GET_CYCLES())
+   #define NET_STATS_COST_UNIT "cycles"
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+   #define NET_STATS_GET_COST() ((uint32_t) __builtin_ia32_rdtsc())
+   #define NET_STATS_COST_UNIT "cycles"
+#else
+   #define NET_STATS_GET_COST() (NET_STATS_GET_TIME_US() * 1000)
+   #define NET_STATS_COST_UNIT "ns"
+#endif
+
+//Number of buckets in a histogram covering the whole 32-bit range
+#define NET_HISTOGRAM_BUCKET_COUNT ((33 - NET_STATS_SUB_BUCKET_BITS) << NET_STATS_SUB_BUCKET_BITS)
+
+//Record a stack-wide latency sample
+#define netStatsRecord(id, value) \
+   netHistogramRecord(&netContext.statsHistograms[id], value)
+
+//Measure the processing cost of a code path
+#if (NET_STATS_SUPPORT == ENABLED)
+   #define NET_STATS_COST_BEGIN(probe) netStatsCostBegin(&(probe))
+   #define NET_STATS_COST_END(probe, id) netStatsCostEnd(&(probe), id)
+#else
+   #define NET_STATS_COST_BEGIN(probe)
+   #define NET_STATS_COST_END(probe, id)
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Stack-wide histograms
+ **/
+
+typedef enum
+{
+   NET_STATS_RX_DELIVERY = 0, ///<From the NIC driver to the socket layer
+   NET_STATS_TX_TO_WIRE  = 1, ///<From the IP layer to the NIC driver, address resolution included
+   NET_STATS_NIC_TX_WAIT = 2, ///<Time spent waiting for the transmitter to be ready
+   NET_STATS_ACCEPT      = 3, ///<From the reception of the SYN to the acceptance of the connection
+   NET_STATS_MUTEX_WAIT  = 4, ///<Time spent by the TCP/IP task waiting for the stack lock
+   NET_STATS_MUTEX_HOLD  = 5, ///<Time during which the TCP/IP task holds the stack lock
+   NET_STATS_TCP_RX_COST = 6, ///<Cost of tcpProcessSegment, segments sent in response excluded
+   NET_STATS_TCP_TX_COST = 7, ///<Cost of tcpSendSegment
+   NET_STATS_HISTOGRAM_COUNT = 8
+} NetStatsHistogramId;
+
+
+/**
+ * @brief Per-interface histograms
+ **/
+
+typedef enum
+{
+   NET_STATS_IF_RTT  = 0, ///<TCP round-trip time samples
+   NET_STATS_IF_SRTT = 1, ///<TCP smoothed round-trip time
+   NET_STATS_IF_HISTOGRAM_COUNT = 2
+} NetStatsIfHistogramId;
+
+
+/**
+ * @brief Log-linear histogram
+ *
+ * Values are grouped by power of two, and each power of two is divided in
+ * 2^NET_STATS_SUB_BUCKET_BITS linear buckets
+ **/
+
+typedef struct
+{
+   uint32_t count;                               ///<Number of samples
+   uint32_t min;                                 ///<Lowest sample
+   uint32_t max;                                 ///<Highest sample
+   uint64_t sum;                                 ///<Sum of all samples
+   uint32_t buckets[NET_HISTOGRAM_BUCKET_COUNT]; ///<Sample counts
+} NetHistogram;
+
+
+/**
+ * @brief Processing cost measurement in progress
+ **/
+
+typedef struct
+{
+   uint32_t start;  ///<Counter value when the measurement started
+   uint32_t nested; ///<Cost of the enclosing code path measured so far
+} NetStatsCostProbe;
+
+
+//Latency statistics related functions
+void netHistogramRecord(NetHistogram *histogram, uint32_t value);
+void netHistogramReset(NetHistogram *histogram);
+
+uint_t netHistogramGetBucketIndex(uint32_t value);
+uint32_t netHistogramGetBucketValue(uint_t index);
+
+uint32_t netHistogramGetPercentile(const NetHistogram *histogram,
+   uint_t permille);
+
+error_t netStatsGetHistogram(NetInterface *interface, uint_t id,
+   NetHistogram *histogram);
+
+void netStatsCostBegin(NetStatsCostProbe *probe);
+void netStatsCostEnd(NetStatsCostProbe *probe, uint_t id);
+
+void netStatsReset(void);
+
+const char_t *netStatsGetHistogramName(NetInterface *interface, uint_t id);
+
+size_t netStatsFormatJson(char_t *buffer, size_t size);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
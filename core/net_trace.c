@@ -0,0 +1,499 @@
+/**
+ * @file net_trace.c
+ * @brief Binary event tracing
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "core/net_trace.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (NET_TRACE_SUPPORT == ENABLED)
+
+//Tracing is turned off until explicitly enabled
+bool_t netTraceEnabled = FALSE;
+//Per-core trace rings
+NetTraceRing netTraceRings[NET_TRACE_CORE_COUNT];
+
+//Event names (as displayed by trace viewers)
+static const char_t *const netTraceEventNames[NET_TRACE_EVENT_COUNT] =
+{
+   "none",
+   "ipv4_rx",
+   "tcp_rx",
+   "tcp_tx",
+   "tcp_state",
+   "tcp_retransmit",
+   "tcp_cwnd",
+   "alloc_failure"
+};
+
+
+/**
+ * @brief Enable or disable event tracing
+ * @param[in] enable Specifies whether tracepoints should record events
+ **/
+
+void netTraceEnable(bool_t enable)
+{
+   netTraceEnabled = enable;
+}
+
+
+/**
+ * @brief Discard all the recorded events
+ **/
+
+void netTraceClear(void)
+{
+   uint_t i;
+
+   //Reset each ring
+   for(i = 0; i < NET_TRACE_CORE_COUNT; i++)
+   {
+      netTraceRings[i].writeIndex = 0;
+   }
+}
+
+
+/**
+ * @brief Record an event
+ *
+ * This function does not format anything and never blocks. Once a ring is
+ * full, the oldest records are overwritten
+ *
+ * @param[in] eventId Event identifier
+ * @param[in] id Socket descriptor or interface index
+ * @param[in] arg0 First event specific argument
+ * @param[in] arg1 Second event specific argument
+ * @param[in] arg2 Third event specific argument
+ **/
+
+void netTraceEvent(uint_t eventId, uint_t id, uint32_t arg0, uint32_t arg1,
+   uint32_t arg2)
+{
+   uint_t i;
+   uint32_t n;
+   NetTraceRing *ring;
+   NetTraceRecord *record;
+
+   //Select the ring that belongs to the current core
+   i = NET_TRACE_GET_CORE_ID();
+   ring = &netTraceRings[i % NET_TRACE_CORE_COUNT];
+
+   //Reserve a slot
+   n = netTraceFetchAndInc(&ring->writeIndex);
+   record = &ring->records[n & (NET_TRACE_RING_SIZE - 1)];
+
+   //Fill in the record
+   record->timestamp = NET_TRACE_GET_TIMESTAMP();
+   record->eventId = (uint16_t) eventId;
+   record->id = (uint16_t) id;
+   record->arg[0] = arg0;
+   record->arg[1] = arg1;
+   record->arg[2] = arg2;
+}
+
+
+/**
+ * @brief Retrieve the most recent records of a given ring
+ * @param[in] coreIndex Zero-based index of the ring
+ * @param[out] records Buffer where to copy the records, oldest first
+ * @param[in] maxRecords Maximum number of records to copy
+ * @return Number of records copied
+ **/
+
+uint_t netTraceRead(uint_t coreIndex, NetTraceRecord *records,
+   uint_t maxRecords)
+{
+   uint_t i;
+   uint_t n;
+   uint32_t writeIndex;
+   NetTraceRing *ring;
+
+   //Check parameters
+   if(coreIndex >= NET_TRACE_CORE_COUNT || records == NULL)
+      return 0;
+
+   //Point to the relevant ring
+   ring = &netTraceRings[coreIndex];
+   writeIndex = ring->writeIndex;
+
+   //Number of records available
+   n = MIN(writeIndex, NET_TRACE_RING_SIZE);
+   n = MIN(n, maxRecords);
+
+   //Copy the records, oldest first
+   for(i = 0; i < n; i++)
+   {
+      records[i] = ring->records[(writeIndex - n + i) &
+         (NET_TRACE_RING_SIZE - 1)];
+   }
+
+   //Return the number of records
+   return n;
+}
+
+
+/**
+ * @brief Write a binary dump of the trace rings
+ *
+ * The dump is little-endian regardless of the target, so that it can be
+ * decoded offline with netTraceDecode
+ *
+ * @param[in] callback Output callback
+ * @param[in] param Callback parameter
+ * @return Error code
+ **/
+
+error_t netTraceDump(NetTraceWriteCallback callback, void *param)
+{
+   error_t error;
+   uint_t i;
+   uint_t j;
+   uint32_t n;
+   uint32_t writeIndex;
+   const NetTraceRecord *record;
+   uint8_t buffer[sizeof(NetTraceRecord)];
+
+   //Check parameters
+   if(callback == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Format dump header
+   STORE32LE(NET_TRACE_DUMP_MAGIC, buffer);
+   STORE16LE(NET_TRACE_DUMP_VERSION, buffer + 4);
+   STORE16LE(sizeof(NetTraceRecord), buffer + 6);
+   STORE32LE(NET_TRACE_CORE_COUNT, buffer + 8);
+   STORE32LE(NET_TRACE_TIMESTAMP_RESOLUTION, buffer + 12);
+
+   //Write dump header
+   error = callback(buffer, sizeof(NetTraceDumpHeader), param);
+
+   //Loop through the rings
+   for(i = 0; i < NET_TRACE_CORE_COUNT && !error; i++)
+   {
+      //Number of records available
+      writeIndex = netTraceRings[i].writeIndex;
+      n = MIN(writeIndex, NET_TRACE_RING_SIZE);
+
+      //Each ring starts with its record count
+      STORE32LE(n, buffer);
+      error = callback(buffer, sizeof(uint32_t), param);
+
+      //Write the records, oldest first
+      for(j = 0; j < n && !error; j++)
+      {
+         //Point to the current record
+         record = &netTraceRings[i].records[(writeIndex - n + j) &
+            (NET_TRACE_RING_SIZE - 1)];
+
+         //Convert the record to little-endian byte order
+         STORE64LE(record->timestamp, buffer);
+         STORE16LE(record->eventId, buffer + 8);
+         STORE16LE(record->id, buffer + 10);
+         STORE32LE(record->arg[0], buffer + 12);
+         STORE32LE(record->arg[1], buffer + 16);
+         STORE32LE(record->arg[2], buffer + 20);
+
+         //Write the record
+         error = callback(buffer, sizeof(NetTraceRecord), param);
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Export the trace rings in Chrome trace event format
+ *
+ * The resulting JSON document can be loaded in chrome://tracing or in the
+ * Perfetto UI
+ *
+ * @param[in] callback Output callback
+ * @param[in] param Callback parameter
+ * @return Error code
+ **/
+
+error_t netTraceExport(NetTraceWriteCallback callback, void *param)
+{
+   error_t error;
+   uint_t i;
+   uint_t j;
+   uint32_t n;
+   uint32_t writeIndex;
+   size_t length;
+   bool_t first;
+   const NetTraceRecord *record;
+   char_t buffer[200];
+
+   //Check parameters
+   if(callback == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Beginning of the JSON document (the resolution of the timestamps is
+   //reported as metadata)
+   length = osSprintf(buffer, "{\"otherData\":{\"timestamp_resolution_us\":"
+      "%u},\"traceEvents\":[\n", NET_TRACE_TIMESTAMP_RESOLUTION);
+   error = callback(buffer, length, param);
+   first = TRUE;
+
+   //Loop through the rings
+   for(i = 0; i < NET_TRACE_CORE_COUNT && !error; i++)
+   {
+      //Number of records available
+      writeIndex = netTraceRings[i].writeIndex;
+      n = MIN(writeIndex, NET_TRACE_RING_SIZE);
+
+      //Loop through the records, oldest first
+      for(j = 0; j < n && !error; j++)
+      {
+         //Point to the current record
+         record = &netTraceRings[i].records[(writeIndex - n + j) &
+            (NET_TRACE_RING_SIZE - 1)];
+
+         //Events are separated by commas
+         if(!first)
+         {
+            error = callback(",\n", 2, param);
+         }
+
+         //Format and write the event
+         if(!error)
+         {
+            length = netTraceFormatRecord(record, i, buffer, sizeof(buffer));
+            error = callback(buffer, length, param);
+         }
+
+         first = FALSE;
+      }
+   }
+
+   //End of the JSON document
+   if(!error)
+   {
+      error = callback("\n]}\n", 4, param);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Convert a binary trace dump to Chrome trace event format
+ *
+ * This function does not depend on the state of the TCP/IP stack, and can
+ * be compiled on a host machine to decode dumps retrieved from a target
+ *
+ * @param[in] data Binary dump generated by netTraceDump
+ * @param[in] length Length of the dump, in bytes
+ * @param[in] callback Output callback
+ * @param[in] param Callback parameter
+ * @return Error code
+ **/
+
+error_t netTraceDecode(const uint8_t *data, size_t length,
+   NetTraceWriteCallback callback, void *param)
+{
+   error_t error;
+   uint_t i;
+   uint32_t j;
+   uint32_t n;
+   uint32_t coreCount;
+   uint32_t resolution;
+   size_t recordSize;
+   size_t k;
+   bool_t first;
+   NetTraceRecord record;
+   char_t buffer[200];
+
+   //Check parameters
+   if(data == NULL || callback == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Malformed dump?
+   if(length < sizeof(NetTraceDumpHeader))
+      return ERROR_INVALID_LENGTH;
+
+   //Check the magic number and the version of the format
+   if(LOAD32LE(data) != NET_TRACE_DUMP_MAGIC ||
+      LOAD16LE(data + 4) != NET_TRACE_DUMP_VERSION)
+   {
+      return ERROR_INVALID_SYNTAX;
+   }
+
+   //Records may be extended by future versions of the format
+   recordSize = LOAD16LE(data + 6);
+   coreCount = LOAD32LE(data + 8);
+   resolution = LOAD32LE(data + 12);
+
+   //Sanity check
+   if(recordSize < sizeof(NetTraceRecord))
+      return ERROR_INVALID_SYNTAX;
+
+   //Point to the first ring
+   k = sizeof(NetTraceDumpHeader);
+
+   //Beginning of the JSON document (the resolution of the timestamps is
+   //reported as metadata)
+   error = callback(buffer, osSprintf(buffer, "{\"otherData\":"
+      "{\"timestamp_resolution_us\":%" PRIu32 "},\"traceEvents\":[\n",
+      resolution), param);
+   first = TRUE;
+
+   //Loop through the rings
+   for(i = 0; i < coreCount && !error; i++)
+   {
+      //Malformed dump?
+      if((length - k) < sizeof(uint32_t))
+      {
+         error = ERROR_INVALID_LENGTH;
+         break;
+      }
+
+      //Retrieve the number of records
+      n = LOAD32LE(data + k);
+      k += sizeof(uint32_t);
+
+      //Malformed dump?
+      if(n > ((length - k) / recordSize))
+      {
+         error = ERROR_INVALID_LENGTH;
+         break;
+      }
+
+      //Loop through the records
+      for(j = 0; j < n && !error; j++)
+      {
+         //Decode the current record
+         record.timestamp = LOAD64LE(data + k);
+         record.eventId = LOAD16LE(data + k + 8);
+         record.id = LOAD16LE(data + k + 10);
+         record.arg[0] = LOAD32LE(data + k + 12);
+         record.arg[1] = LOAD32LE(data + k + 16);
+         record.arg[2] = LOAD32LE(data + k + 20);
+         k += recordSize;
+
+         //Events are separated by commas
+         if(!first)
+         {
+            error = callback(",\n", 2, param);
+         }
+
+         //Format and write the event
+         if(!error)
+         {
+            error = callback(buffer, netTraceFormatRecord(&record, i,
+               buffer, sizeof(buffer)), param);
+         }
+
+         first = FALSE;
+      }
+   }
+
+   //End of the JSON document
+   if(!error)
+   {
+      error = callback("\n]}\n", 4, param);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Format a record as a Chrome trace event
+ * @param[in] record Pointer to the record
+ * @param[in] coreIndex Index of the ring the record comes from
+ * @param[out] buffer Output buffer
+ * @param[in] size Size of the output buffer
+ * @return Length of the resulting string
+ **/
+
+size_t netTraceFormatRecord(const NetTraceRecord *record, uint_t coreIndex,
+   char_t *buffer, size_t size)
+{
+   int_t n;
+
+   //Congestion window updates are displayed as counter tracks
+   if(record->eventId == NET_TRACE_EVENT_TCP_CWND)
+   {
+      n = osSnprintf(buffer, size,
+         "{\"name\":\"cwnd[%u]\",\"ph\":\"C\",\"ts\":%" PRIu64 ","
+         "\"pid\":0,\"tid\":%u,\"args\":{\"cwnd\":%" PRIu32 ","
+         "\"ssthresh\":%" PRIu32 "}}",
+         record->id, record->timestamp, coreIndex, record->arg[0],
+         record->arg[1]);
+   }
+   else
+   {
+      n = osSnprintf(buffer, size,
+         "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%" PRIu64 ","
+         "\"pid\":0,\"tid\":%u,\"args\":{\"id\":%u,\"arg0\":%" PRIu32 ","
+         "\"arg1\":%" PRIu32 ",\"arg2\":%" PRIu32 "}}",
+         netTraceGetEventName(record->eventId), record->timestamp,
+         coreIndex, record->id, record->arg[0], record->arg[1],
+         record->arg[2]);
+   }
+
+   //Check whether the output has been truncated
+   if(n < 0 || (size_t) n >= size)
+   {
+      n = size - 1;
+   }
+
+   //Return the length of the resulting string
+   return n;
+}
+
+
+/**
+ * @brief Get the name of a trace event
+ * @param[in] eventId Event identifier
+ * @return Event name
+ **/
+
+const char_t *netTraceGetEventName(uint_t eventId)
+{
+   //Unknown events are reported with a generic name
+   if(eventId >= NET_TRACE_EVENT_COUNT)
+      return "unknown";
+
+   //Return the name of the event
+   return netTraceEventNames[eventId];
+}
+
+#endif
@@ -0,0 +1,217 @@
+/**
+ * @file net_trace.h
+ * @brief Binary event tracing
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _NET_TRACE_H
+#define _NET_TRACE_H
+
+//Dependencies
+#include "core/net.h"
+
+//Binary event tracing support
+#ifndef NET_TRACE_SUPPORT
+   #define NET_TRACE_SUPPORT DISABLED
+#elif (NET_TRACE_SUPPORT != ENABLED && NET_TRACE_SUPPORT != DISABLED)
+   #error NET_TRACE_SUPPORT parameter is not valid
+#endif
+
+//Number of trace rings (one per core)
+#ifndef NET_TRACE_CORE_COUNT
+   #define NET_TRACE_CORE_COUNT 1
+#elif (NET_TRACE_CORE_COUNT < 1)
+   #error NET_TRACE_CORE_COUNT parameter is not valid
+#endif
+
+//Number of records in each trace ring (must be a power of two)
+#ifndef NET_TRACE_RING_SIZE
+   #define NET_TRACE_RING_SIZE 256
+#elif (NET_TRACE_RING_SIZE < 16 || (NET_TRACE_RING_SIZE & (NET_TRACE_RING_SIZE - 1)) != 0)
+   #error NET_TRACE_RING_SIZE parameter is not valid
+#endif
+
+//Index of the core the caller is running on
+#ifndef NET_TRACE_GET_CORE_ID
+   #define NET_TRACE_GET_CORE_ID() 0
+#endif
+
+//Time source used to stamp records, in microseconds (for instance, the DWT
+//cycle counter divided by the core frequency gives a much finer resolution
+//than the system tick on Cortex-M devices)
+#ifndef NET_TRACE_GET_TIMESTAMP
+   #define NET_TRACE_GET_TIMESTAMP() netGetTimeUs()
+   #define NET_TRACE_TIMESTAMP_RESOLUTION NET_TIME_RESOLUTION_US
+#endif
+
+//Resolution of the time source, in microseconds
+#ifndef NET_TRACE_TIMESTAMP_RESOLUTION
+   #define NET_TRACE_TIMESTAMP_RESOLUTION 1
+#endif
+
+//Atomically reserve a slot in a trace ring (must be provided by the port
+//when the compiler has no built-in atomic operations)
+#ifndef netTraceFetchAndInc
+   #if defined(__GNUC__)
+      #define netTraceFetchAndInc(p) __sync_fetch_and_add(p, 1)
+   #elif (NET_TRACE_SUPPORT == ENABLED)
+      #error netTraceFetchAndInc must be defined for this compiler
+   #endif
+#endif
+
+//Magic number identifying a binary trace dump
+#define NET_TRACE_DUMP_MAGIC 0x4352544E
+//Version of the binary trace dump format
+#define NET_TRACE_DUMP_VERSION 2
+
+//Static tracepoints
+#if (NET_TRACE_SUPPORT == ENABLED)
+   #define NET_TRACE(eventId, id, arg0, arg1, arg2) \
+      (netTraceEnabled ? netTraceEvent(eventId, id, (uint32_t) (arg0), \
+      (uint32_t) (arg1), (uint32_t) (arg2)) : (void) 0)
+#else
+   #define NET_TRACE(eventId, id, arg0, arg1, arg2)
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Trace event identifiers
+ **/
+
+typedef enum
+{
+   NET_TRACE_EVENT_NONE           = 0,
+   NET_TRACE_EVENT_IPV4_RX        = 1, ///<IPv4 packet received (length, protocol, source address)
+   NET_TRACE_EVENT_TCP_RX         = 2, ///<TCP segment received (sequence number, data length, flags)
+   NET_TRACE_EVENT_TCP_TX         = 3, ///<TCP segment sent (sequence number, data length, flags)
+   NET_TRACE_EVENT_TCP_STATE      = 4, ///<TCP state change (old state, new state)
+   NET_TRACE_EVENT_TCP_RETRANSMIT = 5, ///<TCP retransmission (sequence number, data length, retransmission count)
+   NET_TRACE_EVENT_TCP_CWND       = 6, ///<Congestion window update (cwnd, ssthresh, congestion state)
+   NET_TRACE_EVENT_ALLOC_FAILURE  = 7, ///<Memory allocation failure (requested size)
+   NET_TRACE_EVENT_COUNT          = 8
+} NetTraceEventId;
+
+
+//CC-RX, CodeWarrior or Win32 compiler?
+#if defined(__CCRX__)
+   #pragma pack
+#elif defined(__CWCC__) || defined(_WIN32)
+   #pragma pack(push, 1)
+#endif
+
+
+/**
+ * @brief Trace record
+ **/
+
+typedef __packed_struct
+{
+   uint64_t timestamp; ///<Timestamp, in microseconds
+   uint16_t eventId;   ///<Event identifier
+   uint16_t id;        ///<Socket descriptor or interface index
+   uint32_t arg[3];    ///<Event specific arguments
+} NetTraceRecord;
+
+
+/**
+ * @brief Binary trace dump header
+ **/
+
+typedef __packed_struct
+{
+   uint32_t magic;      ///<Magic number
+   uint16_t version;    ///<Format version
+   uint16_t recordSize; ///<Size of a record, in bytes
+   uint32_t coreCount;  ///<Number of rings that follow
+   uint32_t resolution; ///<Resolution of the timestamps, in microseconds
+} NetTraceDumpHeader;
+
+
+//CC-RX, CodeWarrior or Win32 compiler?
+#if defined(__CCRX__)
+   #pragma unpack
+#elif defined(__CWCC__) || defined(_WIN32)
+   #pragma pack(pop)
+#endif
+
+
+/**
+ * @brief Per-core trace ring
+ **/
+
+typedef struct
+{
+   volatile uint32_t writeIndex;                ///<Number of records written so far
+   NetTraceRecord records[NET_TRACE_RING_SIZE]; ///<Most recent records
+} NetTraceRing;
+
+
+/**
+ * @brief Output callback
+ **/
+
+typedef error_t (*NetTraceWriteCallback)(const void *data, size_t length,
+   void *param);
+
+
+//Global variables
+extern bool_t netTraceEnabled;
+extern NetTraceRing netTraceRings[NET_TRACE_CORE_COUNT];
+
+//Binary event tracing related functions
+void netTraceEnable(bool_t enable);
+void netTraceClear(void);
+
+void netTraceEvent(uint_t eventId, uint_t id, uint32_t arg0, uint32_t arg1,
+   uint32_t arg2);
+
+uint_t netTraceRead(uint_t coreIndex, NetTraceRecord *records,
+   uint_t maxRecords);
+
+error_t netTraceDump(NetTraceWriteCallback callback, void *param);
+
+error_t netTraceExport(NetTraceWriteCallback callback, void *param);
+
+error_t netTraceDecode(const uint8_t *data, size_t length,
+   NetTraceWriteCallback callback, void *param);
+
+size_t netTraceFormatRecord(const NetTraceRecord *record, uint_t coreIndex,
+   char_t *buffer, size_t size);
+
+const char_t *netTraceGetEventName(uint_t eventId);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
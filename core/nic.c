@@ -39,9 +39,6 @@
 #include "ipv6/ipv6_misc.h"
 #include "debug.h"
 
-//Tick counter to handle periodic operations
-systime_t nicTickCounter;
-
 
 /**
  * @brief Retrieve logical interface
@@ -267,6 +264,89 @@ void nicTick(NetInterface *interface)
 }
 
 
+/**
+ * @brief Process pending network controller events
+ *
+ * This routine is called by the TCP/IP stack, and by tasks that busy-poll
+ * the network interfaces, to handle events signaled by the interrupt
+ * service routine. The netMutex must be held by the caller
+ *
+ * @param[in] interface Underlying network interface
+ * @return TRUE if an event has been processed, else FALSE
+ **/
+
+bool_t nicProcessEvents(NetInterface *interface)
+{
+   //Check whether a NIC event is pending
+   if(!interface->nicEvent)
+      return FALSE;
+
+   //Acknowledge the event by clearing the flag
+   interface->nicEvent = FALSE;
+
+   //Valid NIC driver?
+   if(interface->nicDriver != NULL)
+   {
+#if (NIC_RX_BUDGET > 0)
+      //Refill the receive budget for this round
+      interface->nicRxBudget = NIC_RX_BUDGET;
+#endif
+
+      //Disable hardware interrupts
+      interface->nicDriver->disableIrq(interface);
+      //Handle NIC events
+      interface->nicDriver->eventHandler(interface);
+
+#if (NIC_RX_BUDGET > 0)
+      //The whole budget has been consumed?
+      if(interface->nicRxBudget == 0)
+      {
+         //More frames are likely pending. Leave interrupts masked and poll
+         //the interface again on the next round, so that the other
+         //interfaces and the timers get their share of processing time
+         interface->nicPollMode = TRUE;
+         interface->nicEvent = TRUE;
+         osSetEvent(&netEvent);
+      }
+      else
+      {
+         //The receive buffer has been drained, so return to interrupt mode
+         interface->nicPollMode = FALSE;
+         interface->nicDriver->enableIrq(interface);
+      }
+#else
+      //Re-enable hardware interrupts
+      interface->nicDriver->enableIrq(interface);
+#endif
+   }
+
+   //The event has been processed
+   return TRUE;
+}
+
+
+/**
+ * @brief Check whether a frame can be received in the current round
+ *
+ * Drivers call this routine from their event handler to stop draining the
+ * receive buffer once the per-round budget has been consumed
+ *
+ * @param[in] interface Underlying network interface
+ * @return TRUE if another frame can be received, else FALSE
+ **/
+
+bool_t nicRxBudgetAvailable(NetInterface *interface)
+{
+#if (NIC_RX_BUDGET > 0)
+   //Check remaining budget
+   return (interface->nicRxBudget > 0) ? TRUE : FALSE;
+#else
+   //The receive buffer is drained at once
+   return TRUE;
+#endif
+}
+
+
 /**
  * @brief Send a packet to the network controller
  * @param[in] interface Underlying network interface
@@ -282,6 +362,9 @@ error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
 {
    error_t error;
    bool_t status;
+#if (NET_STATS_SUPPORT == ENABLED)
+   uint32_t time;
+#endif
 
 #if (TRACE_LEVEL >= TRACE_LEVEL_DEBUG)
    //Retrieve the length of the packet
@@ -295,6 +378,15 @@ error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
    //Gather entropy
    netContext.entropy += netGetSystemTickCount();
 
+#if (NET_CAPTURE_SUPPORT == ENABLED)
+   //Capture outgoing frame
+   if(interface->captureContext != NULL)
+   {
+      netCaptureFrame(interface->captureContext, NET_CAPTURE_DIR_TX, buffer,
+         offset, netBufferGetLength(buffer) - offset);
+   }
+#endif
+
    //Check whether the interface is enabled for operation
    if(interface->configured && interface->nicDriver != NULL)
    {
@@ -306,8 +398,17 @@ error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
       }
       else
       {
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Start of the wait
+         time = NET_STATS_GET_TIME_US();
+#endif
          //Wait for the transmitter to be ready to send
          status = osWaitForEvent(&interface->nicTxEvent, NIC_MAX_BLOCKING_TIME);
+
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Time spent waiting for the transmitter
+         netStatsRecord(NET_STATS_NIC_TX_WAIT, NET_STATS_GET_TIME_US() - time);
+#endif
       }
 
       //Check whether the specified event is in signaled state
@@ -320,6 +421,15 @@ error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
          error = interface->nicDriver->sendPacket(interface, buffer, offset,
             ancillary);
 
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Time elapsed since the packet entered the IP layer
+         if(ancillary->statsTimestamp != 0)
+         {
+            netStatsRecord(NET_STATS_TX_TO_WIRE, NET_STATS_GET_TIME_US() -
+               ancillary->statsTimestamp);
+         }
+#endif
+
          //Re-enable interrupts if necessary
          if(interface->configured)
          {
@@ -391,151 +501,199 @@ error_t nicUpdateMacAddrFilter(NetInterface *interface)
 void nicProcessPacket(NetInterface *interface, uint8_t *packet, size_t length,
    NetRxAncillary *ancillary)
 {
-   NicType type;
-
    //Gather entropy
    netContext.entropy += netGetSystemTickCount();
 
+#if (NET_STATS_SUPPORT == ENABLED)
+   //Save the time at which the packet was received
+   ancillary->statsTimestamp = NET_STATS_GET_TIME_US();
+#endif
+
+#if (NET_CAPTURE_SUPPORT == ENABLED)
+   //Capture incoming frame
+   if(interface->captureContext != NULL)
+   {
+      NetBuffer1 buffer;
+
+      //The frame is contained in a single chunk
+      buffer.chunkCount = 1;
+      buffer.maxChunkCount = 1;
+      buffer.chunk[0].address = packet;
+      buffer.chunk[0].length = (uint16_t) length;
+      buffer.chunk[0].size = 0;
+
+      netCaptureFrame(interface->captureContext, NET_CAPTURE_DIR_RX,
+         (NetBuffer *) &buffer, 0, length);
+   }
+#endif
+
+#if (NIC_RX_BUDGET > 0)
+   //Consume one unit of the receive budget
+   if(interface->nicRxBudget > 0)
+   {
+      interface->nicRxBudget--;
+   }
+#endif
+
    //Check whether the interface is enabled for operation
    if(interface->configured)
    {
       //Re-enable interrupts
       interface->nicDriver->enableIrq(interface);
 
-      //Debug message
-      TRACE_DEBUG("Packet received (%" PRIuSIZE " bytes)...\r\n", length);
-      TRACE_DEBUG_ARRAY("  ", packet, length);
+      //Process incoming packet
+      nicHandlePacket(interface, packet, length, ancillary);
 
-      //Retrieve network interface type
-      type = interface->nicDriver->type;
+      //Disable interrupts
+      interface->nicDriver->disableIrq(interface);
+   }
+}
+
+
+/**
+ * @brief Dispatch an incoming packet to the relevant protocol layer
+ * @param[in] interface Underlying network interface
+ * @param[in] packet Incoming packet to process
+ * @param[in] length Total packet length
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ **/
+
+void nicHandlePacket(NetInterface *interface, uint8_t *packet, size_t length,
+   NetRxAncillary *ancillary)
+{
+   NicType type;
+
+   //Debug message
+   TRACE_DEBUG("Packet received (%" PRIuSIZE " bytes)...\r\n", length);
+   TRACE_DEBUG_ARRAY("  ", packet, length);
+
+   //Retrieve network interface type
+   type = interface->nicDriver->type;
 
 #if (ETH_SUPPORT == ENABLED)
-      //Ethernet interface?
-      if(type == NIC_TYPE_ETHERNET)
-      {
-         //Process incoming Ethernet frame
-         ethProcessFrame(interface, packet, length, ancillary);
-      }
-      else
+   //Ethernet interface?
+   if(type == NIC_TYPE_ETHERNET)
+   {
+      //Process incoming Ethernet frame
+      ethProcessFrame(interface, packet, length, ancillary);
+   }
+   else
 #endif
 #if (PPP_SUPPORT == ENABLED)
-      //PPP interface?
-      if(type == NIC_TYPE_PPP)
-      {
-         //Process incoming PPP frame
-         pppProcessFrame(interface, packet, length, ancillary);
-      }
-      else
+   //PPP interface?
+   if(type == NIC_TYPE_PPP)
+   {
+      //Process incoming PPP frame
+      pppProcessFrame(interface, packet, length, ancillary);
+   }
+   else
 #endif
 #if (IPV4_SUPPORT == ENABLED)
-      //IPv4 interface?
-      if(type == NIC_TYPE_IPV4)
-      {
-         //Process incoming IPv4 packet
-         ipv4ProcessPacket(interface, (Ipv4Header *) packet, length,
-            ancillary);
-      }
-      else
+   //IPv4 interface?
+   if(type == NIC_TYPE_IPV4)
+   {
+      //Process incoming IPv4 packet
+      ipv4ProcessPacket(interface, (Ipv4Header *) packet, length,
+         ancillary);
+   }
+   else
 #endif
 #if (IPV6_SUPPORT == ENABLED)
-      //6LoWPAN interface?
-      if(type == NIC_TYPE_6LOWPAN)
-      {
-         NetBuffer1 buffer;
+   //6LoWPAN interface?
+   if(type == NIC_TYPE_6LOWPAN)
+   {
+      NetBuffer1 buffer;
 
-         //The incoming packet fits in a single chunk
-         buffer.chunkCount = 1;
-         buffer.maxChunkCount = 1;
-         buffer.chunk[0].address = packet;
-         buffer.chunk[0].length = (uint16_t) length;
-         buffer.chunk[0].size = 0;
+      //The incoming packet fits in a single chunk
+      buffer.chunkCount = 1;
+      buffer.maxChunkCount = 1;
+      buffer.chunk[0].address = packet;
+      buffer.chunk[0].length = (uint16_t) length;
+      buffer.chunk[0].size = 0;
 
-         //Process incoming IPv6 packet
-         ipv6ProcessPacket(interface, (NetBuffer *) &buffer, 0, ancillary);
-      }
-      else
+      //Process incoming IPv6 packet
+      ipv6ProcessPacket(interface, (NetBuffer *) &buffer, 0, ancillary);
+   }
+   else
 #endif
 #if (NET_LOOPBACK_IF_SUPPORT == ENABLED)
-      //Loopback interface?
-      if(type == NIC_TYPE_LOOPBACK)
-      {
+   //Loopback interface?
+   if(type == NIC_TYPE_LOOPBACK)
+   {
 #if (IPV4_SUPPORT == ENABLED)
-         //IPv4 packet received?
-         if(length >= sizeof(Ipv4Header) && (packet[0] >> 4) == 4)
-         {
-            error_t error;
-            uint_t i;
-            Ipv4Header *header;
+      //IPv4 packet received?
+      if(length >= sizeof(Ipv4Header) && (packet[0] >> 4) == 4)
+      {
+         error_t error;
+         uint_t i;
+         Ipv4Header *header;
 
-            //Point to the IPv4 header
-            header = (Ipv4Header *) packet;
+         //Point to the IPv4 header
+         header = (Ipv4Header *) packet;
+
+         //Loop through network interfaces
+         for(i = 0; i < NET_INTERFACE_COUNT; i++)
+         {
+            //Check destination address
+            error = ipv4CheckDestAddr(&netInterface[i], header->destAddr);
 
-            //Loop through network interfaces
-            for(i = 0; i < NET_INTERFACE_COUNT; i++)
+            //Valid destination address?
+            if(!error)
             {
-               //Check destination address
-               error = ipv4CheckDestAddr(&netInterface[i], header->destAddr);
-
-               //Valid destination address?
-               if(!error)
-               {
-                  //Process incoming IPv4 packet
-                  ipv4ProcessPacket(&netInterface[i], (Ipv4Header *) packet,
-                     length, ancillary);
-               }
+               //Process incoming IPv4 packet
+               ipv4ProcessPacket(&netInterface[i], (Ipv4Header *) packet,
+                  length, ancillary);
             }
          }
-         else
+      }
+      else
 #endif
 #if (IPV6_SUPPORT == ENABLED)
-         //IPv6 packet received?
-         if(length >= sizeof(Ipv6Header) && (packet[0] >> 4) == 6)
-         {
-            error_t error;
-            uint_t i;
-            NetBuffer1 buffer;
-            Ipv6Header *header;
+      //IPv6 packet received?
+      if(length >= sizeof(Ipv6Header) && (packet[0] >> 4) == 6)
+      {
+         error_t error;
+         uint_t i;
+         NetBuffer1 buffer;
+         Ipv6Header *header;
 
-            //Point to the IPv6 header
-            header = (Ipv6Header *) packet;
+         //Point to the IPv6 header
+         header = (Ipv6Header *) packet;
 
-            //Loop through network interfaces
-            for(i = 0; i < NET_INTERFACE_COUNT; i++)
+         //Loop through network interfaces
+         for(i = 0; i < NET_INTERFACE_COUNT; i++)
+         {
+            //Check destination address
+            error = ipv6CheckDestAddr(&netInterface[i], &header->destAddr);
+
+            //Valid destination address?
+            if(!error)
             {
-               //Check destination address
-               error = ipv6CheckDestAddr(&netInterface[i], &header->destAddr);
-
-               //Valid destination address?
-               if(!error)
-               {
-                  //The incoming packet fits in a single chunk
-                  buffer.chunkCount = 1;
-                  buffer.maxChunkCount = 1;
-                  buffer.chunk[0].address = packet;
-                  buffer.chunk[0].length = (uint16_t) length;
-                  buffer.chunk[0].size = 0;
-
-                  //Process incoming IPv6 packet
-                  ipv6ProcessPacket(&netInterface[i], (NetBuffer *) &buffer, 0,
-                     ancillary);
-               }
+               //The incoming packet fits in a single chunk
+               buffer.chunkCount = 1;
+               buffer.maxChunkCount = 1;
+               buffer.chunk[0].address = packet;
+               buffer.chunk[0].length = (uint16_t) length;
+               buffer.chunk[0].size = 0;
+
+               //Process incoming IPv6 packet
+               ipv6ProcessPacket(&netInterface[i], (NetBuffer *) &buffer, 0,
+                  ancillary);
             }
          }
-         else
-#endif
-         {
-            //Invalid version number
-         }
       }
       else
 #endif
-      //Unknown interface type?
       {
-         //Silently discard the received packet
+         //Invalid version number
       }
-
-      //Disable interrupts
-      interface->nicDriver->disableIrq(interface);
+   }
+   else
+#endif
+   //Unknown interface type?
+   {
+      //Silently discard the received packet
    }
 }
 
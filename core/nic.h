@@ -48,6 +48,14 @@
    #error NIC_MAX_BLOCKING_TIME parameter is not valid
 #endif
 
+//Maximum number of frames received per interface and per round (0 means
+//the driver drains its receive buffer at once)
+#ifndef NIC_RX_BUDGET
+   #define NIC_RX_BUDGET 0
+#elif (NIC_RX_BUDGET < 0)
+   #error NIC_RX_BUDGET parameter is not valid
+#endif
+
 //Size of the NIC driver context
 #ifndef NIC_CONTEXT_SIZE
    #define NIC_CONTEXT_SIZE 16
@@ -398,9 +406,6 @@ typedef struct
 } ExtIntDriver;
 
 
-//Tick counter to handle periodic operations
-extern systime_t nicTickCounter;
-
 //NIC abstraction layer
 NetInterface *nicGetLogicalInterface(NetInterface *interface);
 NetInterface *nicGetPhysicalInterface(NetInterface *interface);
@@ -411,6 +416,8 @@ uint16_t nicGetVmanId(NetInterface *interface);
 bool_t nicIsParentInterface(NetInterface *interface, NetInterface *parent);
 
 void nicTick(NetInterface *interface);
+bool_t nicProcessEvents(NetInterface *interface);
+bool_t nicRxBudgetAvailable(NetInterface *interface);
 
 error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
    size_t offset, NetTxAncillary *ancillary);
@@ -420,6 +427,9 @@ error_t nicUpdateMacAddrFilter(NetInterface *interface);
 void nicProcessPacket(NetInterface *interface, uint8_t *packet, size_t length,
    NetRxAncillary *ancillary);
 
+void nicHandlePacket(NetInterface *interface, uint8_t *packet, size_t length,
+   NetRxAncillary *ancillary);
+
 void nicNotifyLinkChange(NetInterface *interface);
 
 //C++ guard
@@ -47,9 +47,6 @@
 //Check TCP/IP stack configuration
 #if (PING_SUPPORT == ENABLED && RAW_SOCKET_SUPPORT == ENABLED)
 
-//Sequence number field
-static uint16_t pingSequenceNumber = 0;
-
 
 /**
  * @brief Test the reachability of a host
@@ -216,7 +213,7 @@ error_t pingSendRequest(PingContext *context,
    //Get exclusive access
    osAcquireMutex(&netMutex);
    //Sequence Number field is increment each time an Echo Request is sent
-   context->sequenceNumber = pingSequenceNumber++;
+   context->sequenceNumber = netContext.pingSequenceNumber++;
    //Release exclusive access
    osReleaseMutex(&netMutex);
 
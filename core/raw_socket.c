@@ -39,6 +39,7 @@
 //Dependencies
 #include "core/net.h"
 #include "core/socket.h"
+#include "core/socket_misc.h"
 #include "core/raw_socket.h"
 #include "core/ethernet_misc.h"
 #include "ipv4/ipv4.h"
@@ -73,16 +74,20 @@ error_t rawSocketProcessIpPacket(NetInterface *interface,
    Socket *socket;
    SocketQueueItem *queueItem;
    NetBuffer *p;
+#if (BPF_SUPPORT == ENABLED)
+   size_t n;
+   bool_t filtered;
+
+   //No packet has been rejected by a filter yet
+   filtered = FALSE;
+#endif
 
    //Retrieve the length of the raw IP packet
    length = netBufferGetLength(buffer) - offset;
 
-   //Loop through opened sockets
-   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   //Loop through active raw sockets
+   for(socket = rawSocketList; socket != NULL; socket = socket->next)
    {
-      //Point to the current socket
-      socket = socketTable + i;
-
       //Raw socket found?
       if(socket->type != SOCKET_TYPE_RAW_IP)
          continue;
@@ -215,13 +220,50 @@ error_t rawSocketProcessIpPacket(NetInterface *interface,
          continue;
       }
 
+#if (BPF_SUPPORT == ENABLED)
+      //Any packet filter attached to the socket?
+      if(socket->filter != NULL)
+      {
+         //Run the filter before allocating any memory
+         n = bpfRunProgram(socket->filter, interface, buffer, offset, length,
+            ancillary);
+
+         //Packet rejected by the filter?
+         if(n == 0)
+         {
+            filtered = TRUE;
+            continue;
+         }
+
+         //The filter may truncate the packet
+         length = MIN(length, n);
+      }
+#endif
+
       //The current socket meets all the criteria
       break;
    }
 
    //Drop incoming packet if no matching socket was found
-   if(i >= SOCKET_MAX_COUNT)
+   if(socket == NULL)
+   {
+#if (BPF_SUPPORT == ENABLED)
+      //Packets rejected by a filter are silently discarded
+      if(filtered)
+         return NO_ERROR;
+#endif
       return ERROR_PROTOCOL_UNREACHABLE;
+   }
+
+#if (SOCKET_RX_RING_SUPPORT == ENABLED)
+   //Receive ring attached to the socket?
+   if(socket->rxRing != NULL)
+   {
+      //Copy the packet directly into the ring
+      return rawSocketWriteRxRing(socket, interface, pseudoHeader, buffer,
+         offset, length, netBufferGetLength(buffer) - offset, ancillary);
+   }
+#endif
 
    //Empty receive queue?
    if(socket->receiveQueue == NULL)
@@ -361,18 +403,25 @@ void rawSocketProcessEthPacket(NetInterface *interface, const uint8_t *data,
    size_t length, const NetRxAncillary *ancillary)
 {
 #if (ETH_SUPPORT == ENABLED)
-   uint_t i;
    uint_t j;
+   size_t n;
    Socket *socket;
    SocketQueueItem *queueItem;
    NetBuffer *p;
+#if (BPF_SUPPORT == ENABLED || SOCKET_RX_RING_SUPPORT == ENABLED)
+   NetBuffer1 buffer;
+
+   //The payload fits in a single chunk
+   buffer.chunkCount = 1;
+   buffer.maxChunkCount = 1;
+   buffer.chunk[0].address = (void *) data;
+   buffer.chunk[0].length = (uint16_t) length;
+   buffer.chunk[0].size = 0;
+#endif
 
-   //Loop through opened sockets
-   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   //Loop through active raw sockets
+   for(socket = rawSocketList; socket != NULL; socket = socket->next)
    {
-      //Point to the current socket
-      socket = socketTable + i;
-
       //Raw socket found?
       if(socket->type != SOCKET_TYPE_RAW_ETH)
          continue;
@@ -399,12 +448,45 @@ void rawSocketProcessEthPacket(NetInterface *interface, const uint8_t *data,
             continue;
       }
 
+      //Number of bytes to capture
+      n = length;
+
+#if (BPF_SUPPORT == ENABLED)
+      //Any packet filter attached to the socket?
+      if(socket->filter != NULL)
+      {
+         //Run the filter before allocating any memory
+         n = bpfRunProgram(socket->filter, interface, (NetBuffer *) &buffer,
+            0, length, ancillary);
+
+         //Packet rejected by the filter?
+         if(n == 0)
+            continue;
+
+         //The filter may truncate the packet
+         n = MIN(n, length);
+      }
+#endif
+
+#if (SOCKET_RX_RING_SUPPORT == ENABLED)
+      //Receive ring attached to the socket?
+      if(socket->rxRing != NULL)
+      {
+         //Copy the payload directly into the ring
+         rawSocketWriteRxRing(socket, interface, NULL, (NetBuffer *) &buffer,
+            0, n, length, ancillary);
+
+         //Process the next socket
+         continue;
+      }
+#endif
+
       //Empty receive queue?
       if(socket->receiveQueue == NULL)
       {
          //Allocate a memory buffer to hold the data and the associated
          //descriptor
-         p = netBufferAlloc(sizeof(SocketQueueItem) + length);
+         p = netBufferAlloc(sizeof(SocketQueueItem) + n);
 
          //Successful memory allocation?
          if(p != NULL)
@@ -446,7 +528,7 @@ void rawSocketProcessEthPacket(NetInterface *interface, const uint8_t *data,
 
          //Allocate a memory buffer to hold the data and the associated
          //descriptor
-         p = netBufferAlloc(sizeof(SocketQueueItem) + length);
+         p = netBufferAlloc(sizeof(SocketQueueItem) + n);
 
          //Successful memory allocation?
          if(p != NULL)
@@ -490,7 +572,7 @@ void rawSocketProcessEthPacket(NetInterface *interface, const uint8_t *data,
       queueItem->offset = sizeof(SocketQueueItem);
 
       //Copy the payload
-      netBufferWrite(queueItem->buffer, queueItem->offset, data, length);
+      netBufferWrite(queueItem->buffer, queueItem->offset, data, n);
 
       //Additional options can be passed to the stack along with the packet
       queueItem->ancillary = *ancillary;
@@ -801,23 +883,34 @@ error_t rawSocketReceiveIpPacket(Socket *socket, SocketMsg *message,
 {
    error_t error;
    SocketQueueItem *queueItem;
+   systime_t timeout;
 
    //The SOCKET_FLAG_DONT_WAIT enables non-blocking operation
    if((flags & SOCKET_FLAG_DONT_WAIT) == 0)
    {
+      //Maximum time to wait for incoming data
+      timeout = socket->timeout;
+
       //Check whether the receive queue is empty
       if(socket->receiveQueue == NULL)
       {
          //Set the events the application is interested in
          socket->eventMask = SOCKET_EVENT_RX_READY;
 
+         //Busy-poll the network interfaces before blocking, if enabled
+         timeout = socketBusyPoll(socket, timeout);
+      }
+
+      //Check whether the receive queue is still empty
+      if(socket->receiveQueue == NULL)
+      {
          //Reset the event object
          osResetEvent(&socket->event);
 
          //Release exclusive access
          osReleaseMutex(&netMutex);
          //Wait until an event is triggered
-         osWaitForEvent(&socket->event, socket->timeout);
+         osWaitForEvent(&socket->event, timeout);
          //Get exclusive access
          osAcquireMutex(&netMutex);
       }
@@ -907,23 +1000,34 @@ error_t rawSocketReceiveEthPacket(Socket *socket, SocketMsg *message,
 {
    error_t error;
    SocketQueueItem *queueItem;
+   systime_t timeout;
 
    //The SOCKET_FLAG_DONT_WAIT enables non-blocking operation
    if((flags & SOCKET_FLAG_DONT_WAIT) == 0)
    {
+      //Maximum time to wait for incoming data
+      timeout = socket->timeout;
+
       //Check whether the receive queue is empty
       if(socket->receiveQueue == NULL)
       {
          //Set the events the application is interested in
          socket->eventMask = SOCKET_EVENT_RX_READY;
 
+         //Busy-poll the network interfaces before blocking, if enabled
+         timeout = socketBusyPoll(socket, timeout);
+      }
+
+      //Check whether the receive queue is still empty
+      if(socket->receiveQueue == NULL)
+      {
          //Reset the event object
          osResetEvent(&socket->event);
 
          //Release exclusive access
          osReleaseMutex(&netMutex);
          //Wait until an event is triggered
-         osWaitForEvent(&socket->event, socket->timeout);
+         osWaitForEvent(&socket->event, timeout);
          //Get exclusive access
          osAcquireMutex(&netMutex);
       }
@@ -992,6 +1096,231 @@ error_t rawSocketReceiveEthPacket(Socket *socket, SocketMsg *message,
 }
 
 
+/**
+ * @brief Store an incoming packet in the receive ring of a raw socket
+ * @param[in] socket Handle referencing the socket
+ * @param[in] interface Underlying network interface
+ * @param[in] pseudoHeader IPv4 or IPv6 pseudo header (NULL for Ethernet
+ *   frames)
+ * @param[in] buffer Multi-part buffer containing the packet
+ * @param[in] offset Offset to the first byte of the packet
+ * @param[in] length Number of bytes to capture
+ * @param[in] origLength Original length of the packet
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @return Error code
+ **/
+
+error_t rawSocketWriteRxRing(Socket *socket, NetInterface *interface,
+   const IpPseudoHeader *pseudoHeader, const NetBuffer *buffer, size_t offset,
+   size_t length, size_t origLength, const NetRxAncillary *ancillary)
+{
+#if (SOCKET_RX_RING_SUPPORT == ENABLED)
+   SocketRingSlot *slot;
+
+   //Point to the next slot to be filled
+   slot = rawSocketGetRxRingSlot(socket, socket->rxRingHead);
+
+   //The application has not released the slot yet?
+   if(slot->status != SOCKET_RING_SLOT_FREE)
+   {
+      //Number of packets dropped because the ring was full
+      socket->rxRingDrops++;
+
+      //Number of inbound packets which were chosen to be discarded even
+      //though no errors had been detected
+      MIB2_IF_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
+      IF_MIB_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
+
+      //Report an error
+      return ERROR_RECEIVE_QUEUE_FULL;
+   }
+
+   //Truncate the packet if it does not fit in the slot
+   length = MIN(length, socket->rxRingSlotSize - sizeof(SocketRingSlot));
+
+   //Copy the packet right after the slot header. This is the only copy
+   //performed on the receive path
+   slot->length = (uint16_t) netBufferRead(SOCKET_RING_SLOT_DATA(slot), buffer,
+      offset, length);
+
+   //Save packet metadata
+   slot->origLength = (uint16_t) origLength;
+   slot->timestamp = osGetSystemTime();
+   slot->interface = interface;
+   slot->vlanId = nicGetVlanId(interface);
+
+#if (ETH_SUPPORT == ENABLED)
+   //Save source and destination MAC addresses
+   slot->srcMacAddr = ancillary->srcMacAddr;
+   slot->destMacAddr = ancillary->destMacAddr;
+   //Save the value of the EtherType field
+   slot->ethType = ancillary->ethType;
+#else
+   //Link-layer information is not available
+   slot->srcMacAddr = MAC_UNSPECIFIED_ADDR;
+   slot->destMacAddr = MAC_UNSPECIFIED_ADDR;
+   slot->ethType = 0;
+#endif
+
+#if (ETH_PORT_TAGGING_SUPPORT == ENABLED)
+   //Save switch port identifier
+   slot->switchPort = ancillary->port;
+#endif
+
+#if (ETH_TIMESTAMP_SUPPORT == ENABLED)
+   //Save captured time stamp
+   slot->hwTimestamp = ancillary->timestamp;
+#endif
+
+   //Raw IP packets carry the source and destination addresses
+   slot->srcIpAddr = IP_ADDR_ANY;
+   slot->destIpAddr = IP_ADDR_ANY;
+
+#if (IPV4_SUPPORT == ENABLED)
+   //IPv4 packet?
+   if(pseudoHeader != NULL && pseudoHeader->length == sizeof(Ipv4PseudoHeader))
+   {
+      slot->srcIpAddr.length = sizeof(Ipv4Addr);
+      slot->srcIpAddr.ipv4Addr = pseudoHeader->ipv4Data.srcAddr;
+      slot->destIpAddr.length = sizeof(Ipv4Addr);
+      slot->destIpAddr.ipv4Addr = pseudoHeader->ipv4Data.destAddr;
+   }
+#endif
+#if (IPV6_SUPPORT == ENABLED)
+   //IPv6 packet?
+   if(pseudoHeader != NULL && pseudoHeader->length == sizeof(Ipv6PseudoHeader))
+   {
+      slot->srcIpAddr.length = sizeof(Ipv6Addr);
+      slot->srcIpAddr.ipv6Addr = pseudoHeader->ipv6Data.srcAddr;
+      slot->destIpAddr.length = sizeof(Ipv6Addr);
+      slot->destIpAddr.ipv6Addr = pseudoHeader->ipv6Data.destAddr;
+   }
+#endif
+
+   //The slot now belongs to the application
+   slot->status = SOCKET_RING_SLOT_READY;
+
+   //Advance the write index
+   socket->rxRingHead = (socket->rxRingHead + 1) % socket->rxRingSlotCount;
+   //Number of packets stored in the ring
+   socket->rxRingPackets++;
+
+   //Notify user that data is available
+   rawSocketUpdateEvents(socket);
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+ * @brief Hand out the next packet stored in the receive ring
+ * @param[in] socket Handle referencing the socket
+ * @param[out] slot Slot holding the packet
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @return Error code
+ **/
+
+error_t rawSocketReceiveRxRing(Socket *socket, SocketRingSlot **slot,
+   uint_t flags)
+{
+#if (SOCKET_RX_RING_SUPPORT == ENABLED)
+   SocketRingSlot *p;
+   systime_t timeout;
+
+   //Point to the next slot to be handed out
+   p = rawSocketGetRxRingSlot(socket, socket->rxRingTail);
+
+   //The SOCKET_FLAG_DONT_WAIT enables non-blocking operation
+   if((flags & SOCKET_FLAG_DONT_WAIT) == 0)
+   {
+      //Maximum time to wait for incoming data
+      timeout = socket->timeout;
+
+      //Check whether the ring is empty
+      if(p->status != SOCKET_RING_SLOT_READY)
+      {
+         //Set the events the application is interested in
+         socket->eventMask = SOCKET_EVENT_RX_READY;
+
+         //Busy-poll the network interfaces before blocking, if enabled
+         timeout = socketBusyPoll(socket, timeout);
+      }
+
+      //Check whether the ring is still empty
+      if(p->status != SOCKET_RING_SLOT_READY)
+      {
+         //Reset the event object
+         osResetEvent(&socket->event);
+
+         //Release exclusive access
+         osReleaseMutex(&netMutex);
+         //Wait until an event is triggered
+         osWaitForEvent(&socket->event, timeout);
+         //Get exclusive access
+         osAcquireMutex(&netMutex);
+      }
+   }
+
+   //The ring may have been detached while waiting
+   if(socket->rxRing == NULL)
+      return ERROR_INVALID_SOCKET;
+
+   //Point to the next slot to be handed out
+   p = rawSocketGetRxRingSlot(socket, socket->rxRingTail);
+
+   //Any packet received?
+   if(p->status != SOCKET_RING_SLOT_READY)
+   {
+      //Report a timeout error
+      return ERROR_TIMEOUT;
+   }
+
+   //The slot remains owned by the application until it is released
+   p->status = SOCKET_RING_SLOT_USER;
+
+   //Advance the read index
+   socket->rxRingTail = (socket->rxRingTail + 1) % socket->rxRingSlotCount;
+
+   //Update socket events
+   rawSocketUpdateEvents(socket);
+
+   //Return a pointer to the slot
+   *slot = p;
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+ * @brief Point to a given slot of the receive ring
+ * @param[in] socket Handle referencing the socket
+ * @param[in] index Slot index
+ * @return Pointer to the slot header
+ **/
+
+SocketRingSlot *rawSocketGetRxRingSlot(Socket *socket, uint_t index)
+{
+#if (SOCKET_RX_RING_SUPPORT == ENABLED)
+   //Slots are laid out back to back
+   return (SocketRingSlot *) (socket->rxRing + index * socket->rxRingSlotSize);
+#else
+   //Not implemented
+   return NULL;
+#endif
+}
+
+
 /**
  * @brief Update event state for raw sockets
  * @param[in] socket Handle referencing the socket
@@ -1006,6 +1335,16 @@ void rawSocketUpdateEvents(Socket *socket)
    if(socket->receiveQueue)
       socket->eventFlags |= SOCKET_EVENT_RX_READY;
 
+#if (SOCKET_RX_RING_SUPPORT == ENABLED)
+   //The socket is also readable if the receive ring holds a packet that has
+   //not been handed out yet
+   if(socket->rxRing != NULL && rawSocketGetRxRingSlot(socket,
+      socket->rxRingTail)->status == SOCKET_RING_SLOT_READY)
+   {
+      socket->eventFlags |= SOCKET_EVENT_RX_READY;
+   }
+#endif
+
    //Check whether the socket is bound to a particular network interface
    if(socket->interface != NULL)
    {
@@ -1020,6 +1359,9 @@ void rawSocketUpdateEvents(Socket *socket)
       }
    }
 
+   //Notify the ready list the socket is attached to, if any
+   socketReadyListUpdate(socket);
+
    //Mask unused events
    socket->eventFlags &= socket->eventMask;
 
@@ -75,6 +75,15 @@ error_t rawSocketReceiveIpPacket(Socket *socket, SocketMsg *message,
 error_t rawSocketReceiveEthPacket(Socket *socket, SocketMsg *message,
    uint_t flags);
 
+error_t rawSocketWriteRxRing(Socket *socket, NetInterface *interface,
+   const IpPseudoHeader *pseudoHeader, const NetBuffer *buffer, size_t offset,
+   size_t length, size_t origLength, const NetRxAncillary *ancillary);
+
+error_t rawSocketReceiveRxRing(Socket *socket, SocketRingSlot **slot,
+   uint_t flags);
+
+SocketRingSlot *rawSocketGetRxRingSlot(Socket *socket, uint_t index);
+
 void rawSocketUpdateEvents(Socket *socket);
 
 //C++ guard
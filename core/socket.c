@@ -45,8 +45,10 @@
 #include "llmnr/llmnr_client.h"
 #include "debug.h"
 
-//Socket table
-Socket socketTable[SOCKET_MAX_COUNT];
+#if (NET_MULTI_INSTANCE_SUPPORT == DISABLED)
+//Socket layer state
+static SocketContext socketContext;
+#endif
 
 //Default socket message
 const SocketMsg SOCKET_DEFAULT_MSG =
@@ -62,6 +64,7 @@ const SocketMsg SOCKET_DEFAULT_MSG =
    0,             //Source port
    {0},           //Destination IP address
    0,             //Destination port
+   0,             //Segment size for UDP segmentation
 #if (ETH_SUPPORT == ENABLED)
    {{{0}}},       //Source MAC address
    {{{0}}},       //Destination MAC address
@@ -84,31 +87,56 @@ const SocketMsg SOCKET_DEFAULT_MSG =
 
 error_t socketInit(void)
 {
+#if (SOCKET_DYNAMIC_ALLOC_SUPPORT == DISABLED)
    uint_t i;
    uint_t j;
+#endif
+   SocketContext *context;
+
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Each stack instance owns its socket layer state
+   context = osAllocMem(sizeof(SocketContext));
+   //Failed to allocate memory?
+   if(context == NULL)
+      return ERROR_OUT_OF_MEMORY;
+#else
+   //Point to the socket layer state
+   context = &socketContext;
+#endif
 
-   //Initialize socket descriptors
-   osMemset(socketTable, 0, sizeof(socketTable));
+   //Initialize socket descriptors, lists of active sockets and socket
+   //control blocks
+   osMemset(context, 0, sizeof(SocketContext));
 
+   //Attach the socket layer state to the current stack instance
+   netContext.socketContext = context;
+
+#if (SOCKET_DYNAMIC_ALLOC_SUPPORT == DISABLED)
    //Loop through socket descriptors
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
+      //Each descriptor is bound to a statically allocated control block
+      socketTable[i] = &context->pool[i];
+
       //Set socket identifier
-      socketTable[i].descriptor = i;
+      socketTable[i]->descriptor = i;
 
       //Create an event object to track socket events
-      if(!osCreateEvent(&socketTable[i].event))
+      if(!osCreateEvent(&socketTable[i]->event))
       {
          //Clean up side effects
          for(j = 0; j < i; j++)
          {
-            osDeleteEvent(&socketTable[j].event);
+            osDeleteEvent(&socketTable[j]->event);
          }
 
          //Report an error
          return ERROR_OUT_OF_RESOURCES;
       }
    }
+#else
+   //Socket control blocks are allocated on demand
+#endif
 
    //Successful initialization
    return NO_ERROR;
@@ -163,6 +191,42 @@ error_t socketSetTimeout(Socket *socket, systime_t timeout)
 }
 
 
+/**
+ * @brief Enable busy-poll mode
+ *
+ * When a blocking receive operation finds no data, the calling task first
+ * processes the pending NIC events inline for up to the specified duration
+ * before blocking. This saves the wake-up of the TCP/IP task on low-latency
+ * request/response traffic, at the expense of CPU time
+ *
+ * @param[in] socket Handle to a socket
+ * @param[in] duration Maximum time spent busy-polling, in milliseconds
+ *   (0 to disable busy-poll mode)
+ * @return Error code
+ **/
+
+error_t socketSetBusyPoll(Socket *socket, systime_t duration)
+{
+#if (SOCKET_BUSY_POLL_SUPPORT == ENABLED)
+   //Make sure the socket handle is valid
+   if(socket == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+   //Record busy-poll duration
+   socket->busyPollTime = duration;
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //No error to report
+   return NO_ERROR;
+#else
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
 /**
  * @brief Set TTL value for unicast datagrams
  * @param[in] socket Handle to a socket
@@ -539,6 +603,10 @@ error_t socketEnableKeepAlive(Socket *socket, bool_t enabled)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //This function shall be used with connection-oriented socket types
+   if(socket->type != SOCKET_TYPE_STREAM)
+      return ERROR_INVALID_SOCKET;
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
@@ -591,6 +659,10 @@ error_t socketSetKeepAliveParams(Socket *socket, systime_t idle,
       return ERROR_INVALID_PARAMETER;
    }
 
+   //This function shall be used with connection-oriented socket types
+   if(socket->type != SOCKET_TYPE_STREAM)
+      return ERROR_INVALID_SOCKET;
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
@@ -630,6 +702,10 @@ error_t socketSetMaxSegmentSize(Socket *socket, size_t mss)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //This function shall be used with connection-oriented socket types
+   if(socket->type != SOCKET_TYPE_STREAM)
+      return ERROR_INVALID_SOCKET;
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
@@ -653,6 +729,47 @@ error_t socketSetMaxSegmentSize(Socket *socket, size_t mss)
 }
 
 
+/**
+ * @brief Specify the segment size for UDP segmentation
+ *
+ * When a non-zero segment size is set, each send operation is split into
+ * a train of datagrams carrying at most segmentSize bytes of payload
+ *
+ * @param[in] socket Handle to a socket
+ * @param[in] segmentSize Segment size, in bytes (0 to disable segmentation)
+ * @return Error code
+ **/
+
+error_t socketSetUdpSegmentSize(Socket *socket, size_t segmentSize)
+{
+#if (UDP_SUPPORT == ENABLED)
+   //Make sure the socket handle is valid
+   if(socket == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //This option only applies to connectionless sockets
+   if(socket->type != SOCKET_TYPE_DGRAM)
+      return ERROR_INVALID_SOCKET;
+
+   //The payload of a datagram cannot exceed 65535 bytes
+   if(segmentSize > UINT16_MAX)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+   //Save the segment size
+   socket->segmentSize = (uint16_t) segmentSize;
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //No error to report
+   return NO_ERROR;
+#else
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
 /**
  * @brief Specify the size of the TCP send buffer
  * @param[in] socket Handle to a socket
@@ -681,6 +798,12 @@ error_t socketSetTxBufferSize(Socket *socket, size_t size)
 
    //Use the specified buffer size
    socket->txBufferSize = size;
+
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   //The size of the buffer is no longer adjusted automatically
+   socket->txBufferLocked = TRUE;
+#endif
+
    //No error to report
    return NO_ERROR;
 #else
@@ -717,6 +840,12 @@ error_t socketSetRxBufferSize(Socket *socket, size_t size)
 
    //Use the specified buffer size
    socket->rxBufferSize = size;
+
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   //The size of the buffer is no longer adjusted automatically
+   socket->rxBufferLocked = TRUE;
+#endif
+
    //No error to report
    return NO_ERROR;
 #else
@@ -725,6 +854,33 @@ error_t socketSetRxBufferSize(Socket *socket, size_t size)
 }
 
 
+/**
+ * @brief Retrieve TCP connection telemetry
+ * @param[in] socket Handle to a socket
+ * @param[out] info Snapshot of the connection state and counters
+ * @return Error code
+ **/
+
+error_t socketGetTcpInfo(Socket *socket, TcpInfo *info)
+{
+#if (TCP_SUPPORT == ENABLED && TCP_INFO_SUPPORT == ENABLED)
+   //Check parameters
+   if(socket == NULL || info == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //This function shall be used with connection-oriented socket types
+   if(socket->type != SOCKET_TYPE_STREAM)
+      return ERROR_INVALID_SOCKET;
+
+   //Retrieve TCP connection telemetry
+   return tcpGetInfo(socket, info);
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
 /**
  * @brief Bind a socket to a particular network interface
  * @param[in] socket Handle to a socket
@@ -767,6 +923,352 @@ NetInterface *socketGetInterface(Socket *socket)
 }
 
 
+/**
+ * @brief Attach a packet filter to a raw socket
+ *
+ * The filter runs against every packet that matches the socket, before any
+ * memory is allocated. Its return value is the number of bytes to capture
+ * (0 drops the packet). Raw Ethernet sockets see the frame payload, without
+ * the link-layer header, while raw IP sockets see the IP packet
+ *
+ * @param[in] socket Handle to a socket
+ * @param[in] program Filter instructions (classic BPF)
+ * @param[in] length Number of instructions
+ * @return Error code
+ **/
+
+error_t socketAttachFilter(Socket *socket, const BpfInsn *program,
+   uint_t length)
+{
+#if (RAW_SOCKET_SUPPORT == ENABLED && BPF_SUPPORT == ENABLED)
+   error_t error;
+   BpfInsn *filter;
+
+   //Make sure the socket handle is valid
+   if(socket == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Packet filters only apply to raw sockets
+   if(socket->type != SOCKET_TYPE_RAW_IP &&
+      socket->type != SOCKET_TYPE_RAW_ETH)
+   {
+      return ERROR_INVALID_SOCKET;
+   }
+
+   //Reject programs that could fault or loop
+   error = bpfCheckProgram(program, length);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Allocate a memory block to hold a private copy of the program
+   filter = memPoolAlloc(length * sizeof(BpfInsn));
+   //Failed to allocate memory?
+   if(filter == NULL)
+      return ERROR_OUT_OF_MEMORY;
+
+   //Copy the program
+   osMemcpy(filter, program, length * sizeof(BpfInsn));
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Release the previous filter, if any
+   if(socket->filter != NULL)
+   {
+      memPoolFree(socket->filter);
+   }
+
+   //Attach the new filter
+   socket->filter = filter;
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+ * @brief Remove the packet filter attached to a raw socket
+ * @param[in] socket Handle to a socket
+ * @return Error code
+ **/
+
+error_t socketDetachFilter(Socket *socket)
+{
+#if (RAW_SOCKET_SUPPORT == ENABLED && BPF_SUPPORT == ENABLED)
+   error_t error;
+
+   //Make sure the socket handle is valid
+   if(socket == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Any filter attached to the socket?
+   if(socket->filter != NULL)
+   {
+      //Release the filter
+      memPoolFree(socket->filter);
+      socket->filter = NULL;
+
+      //Successful processing
+      error = NO_ERROR;
+   }
+   else
+   {
+      //No filter is attached to the socket
+      error = ERROR_NOT_FOUND;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Return status code
+   return error;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+ * @brief Attach a shared-memory receive ring to a raw socket
+ *
+ * Once a ring is attached, incoming packets are copied straight into its
+ * slots instead of being queued in separately allocated buffers. The
+ * application retrieves packets in place with socketReceiveRxRing() and
+ * hands each slot back with socketReleaseRxRing(). Packets that arrive
+ * while the next slot is still owned by the application are dropped and
+ * accounted for
+ *
+ * @param[in] socket Handle to a socket
+ * @param[in] buffer Memory area holding the slots (NULL to detach the ring).
+ *   The buffer must remain valid as long as the ring is attached and be
+ *   aligned on a SOCKET_RX_RING_ALIGNMENT boundary
+ * @param[in] slotSize Size of each slot, including its header, in bytes
+ *   (multiple of SOCKET_RX_RING_ALIGNMENT)
+ * @param[in] slotCount Number of slots
+ * @return Error code
+ **/
+
+error_t socketSetRxRing(Socket *socket, void *buffer, size_t slotSize,
+   uint_t slotCount)
+{
+#if (RAW_SOCKET_SUPPORT == ENABLED && SOCKET_RX_RING_SUPPORT == ENABLED)
+   uint_t i;
+
+   //Make sure the socket handle is valid
+   if(socket == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Receive rings only apply to raw sockets
+   if(socket->type != SOCKET_TYPE_RAW_IP &&
+      socket->type != SOCKET_TYPE_RAW_ETH)
+   {
+      return ERROR_INVALID_SOCKET;
+   }
+
+   //Valid memory area?
+   if(buffer != NULL)
+   {
+      //Each slot must hold a header and keep the next one properly aligned
+      if(slotSize <= sizeof(SocketRingSlot) ||
+         (slotSize % SOCKET_RX_RING_ALIGNMENT) != 0 || slotCount == 0)
+      {
+         return ERROR_INVALID_PARAMETER;
+      }
+
+      //The memory area must be suitably aligned for the slot header
+      if(((uintptr_t) buffer % SOCKET_RX_RING_ALIGNMENT) != 0)
+         return ERROR_INVALID_PARAMETER;
+   }
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Attach (or detach) the ring
+   socket->rxRing = buffer;
+   socket->rxRingSlotSize = slotSize;
+   socket->rxRingSlotCount = (buffer != NULL) ? slotCount : 0;
+   socket->rxRingHead = 0;
+   socket->rxRingTail = 0;
+   socket->rxRingPackets = 0;
+   socket->rxRingDrops = 0;
+
+   //All the slots initially belong to the TCP/IP stack
+   for(i = 0; i < socket->rxRingSlotCount; i++)
+   {
+      rawSocketGetRxRingSlot(socket, i)->status = SOCKET_RING_SLOT_FREE;
+   }
+
+   //Unblock any task waiting on the previous ring
+   rawSocketUpdateEvents(socket);
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+ * @brief Retrieve the next packet from the receive ring
+ *
+ * The packet is not copied: the returned slot holds the packet metadata and
+ * SOCKET_RING_SLOT_DATA(slot) points to the captured bytes. The slot must
+ * be released with socketReleaseRxRing() once processed
+ *
+ * @param[in] socket Handle to a socket
+ * @param[out] slot Slot holding the packet
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @return Error code
+ **/
+
+error_t socketReceiveRxRing(Socket *socket, SocketRingSlot **slot,
+   uint_t flags)
+{
+#if (RAW_SOCKET_SUPPORT == ENABLED && SOCKET_RX_RING_SUPPORT == ENABLED)
+   error_t error;
+
+   //Check parameters
+   if(socket == NULL || slot == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Make sure a receive ring is attached to the socket
+   if(socket->rxRing != NULL)
+   {
+      //Hand out the next packet
+      error = rawSocketReceiveRxRing(socket, slot, flags);
+   }
+   else
+   {
+      //Report an error
+      error = ERROR_INVALID_SOCKET;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Return status code
+   return error;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+ * @brief Give a receive ring slot back to the TCP/IP stack
+ * @param[in] socket Handle to a socket
+ * @param[in] slot Slot previously returned by socketReceiveRxRing()
+ * @return Error code
+ **/
+
+error_t socketReleaseRxRing(Socket *socket, SocketRingSlot *slot)
+{
+#if (RAW_SOCKET_SUPPORT == ENABLED && SOCKET_RX_RING_SUPPORT == ENABLED)
+   error_t error;
+   size_t offset;
+
+   //Check parameters
+   if(socket == NULL || slot == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Offset of the slot within the ring
+   offset = (uint8_t *) slot - socket->rxRing;
+
+   //Make sure the slot belongs to the ring and is owned by the application
+   if(socket->rxRing != NULL && (uint8_t *) slot >= socket->rxRing &&
+      offset < socket->rxRingSlotCount * socket->rxRingSlotSize &&
+      (offset % socket->rxRingSlotSize) == 0 &&
+      slot->status == SOCKET_RING_SLOT_USER)
+   {
+      //The slot can be filled again
+      slot->status = SOCKET_RING_SLOT_FREE;
+      //Successful processing
+      error = NO_ERROR;
+   }
+   else
+   {
+      //Report an error
+      error = ERROR_INVALID_PARAMETER;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Return status code
+   return error;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+ * @brief Get receive ring statistics
+ *
+ * The counters are reset each time they are read
+ *
+ * @param[in] socket Handle to a socket
+ * @param[out] packets Number of packets stored in the ring
+ * @param[out] drops Number of packets dropped because the ring was full
+ * @return Error code
+ **/
+
+error_t socketGetRxRingStats(Socket *socket, uint32_t *packets,
+   uint32_t *drops)
+{
+#if (RAW_SOCKET_SUPPORT == ENABLED && SOCKET_RX_RING_SUPPORT == ENABLED)
+   //Check parameters
+   if(socket == NULL || packets == NULL || drops == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Read the counters
+   *packets = socket->rxRingPackets;
+   *drops = socket->rxRingDrops;
+
+   //Reset the counters
+   socket->rxRingPackets = 0;
+   socket->rxRingDrops = 0;
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
 /**
  * @brief Associate a local address with a socket
  * @param[in] socket Handle to a socket
@@ -1139,6 +1641,113 @@ error_t socketSendMsg(Socket *socket, const SocketMsg *message, uint_t flags)
 }
 
 
+/**
+ * @brief Send a batch of messages
+ *
+ * The messages are sent in order with a single acquisition of the stack
+ * lock. Consecutive UDP datagrams sent to the same destination share the
+ * source address selection and the address resolution
+ *
+ * @param[in] socket Handle that identifies a socket
+ * @param[in] messages Array of messages to be sent
+ * @param[in] count Number of entries in the array
+ * @param[out] sent Number of messages that have been sent (optional)
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @return Error code
+ **/
+
+error_t socketSendMsgBatch(Socket *socket, const SocketMsg *messages,
+   uint_t count, uint_t *sent, uint_t flags)
+{
+   error_t error;
+   uint_t i;
+   uint_t n;
+#if (UDP_SUPPORT == ENABLED)
+   UdpRouteCache cache;
+#endif
+
+   //No message has been sent yet
+   if(sent != NULL)
+   {
+      *sent = 0;
+   }
+
+   //Check parameters
+   if(socket == NULL || messages == NULL || count == 0)
+      return ERROR_INVALID_PARAMETER;
+
+#if (UDP_SUPPORT == ENABLED)
+   //Initialize route cache
+   osMemset(&cache, 0, sizeof(UdpRouteCache));
+#endif
+
+   //Initialize status code
+   error = NO_ERROR;
+   n = 0;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Send messages in order
+   for(i = 0; i < count && !error; i++)
+   {
+#if (UDP_SUPPORT == ENABLED)
+      //Connectionless socket?
+      if(socket->type == SOCKET_TYPE_DGRAM)
+      {
+         //Send UDP datagram
+         error = udpSendDatagramEx(socket, &messages[i], flags, &cache);
+      }
+      else
+#endif
+#if (RAW_SOCKET_SUPPORT == ENABLED)
+      //Raw socket?
+      if(socket->type == SOCKET_TYPE_RAW_IP)
+      {
+         //Send a raw IP packet
+         error = rawSocketSendIpPacket(socket, &messages[i], flags);
+      }
+      else if(socket->type == SOCKET_TYPE_RAW_ETH)
+      {
+         //Send a raw Ethernet packet
+         error = rawSocketSendEthPacket(socket, &messages[i], flags);
+      }
+      else
+#endif
+      //Invalid socket type?
+      {
+         //Report an error
+         error = ERROR_INVALID_SOCKET;
+      }
+
+      //Check status code
+      if(!error)
+      {
+         //Total number of messages successfully sent
+         n++;
+      }
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Total number of messages successfully sent
+   if(sent != NULL)
+   {
+      *sent = n;
+   }
+
+   //The call succeeds as long as at least one message has been sent
+   if(n > 0)
+   {
+      error = NO_ERROR;
+   }
+
+   //Return status code
+   return error;
+}
+
+
 /**
  * @brief Receive data from a connected socket
  * @param[in] socket Handle that identifies a connected socket
@@ -1402,6 +2011,118 @@ error_t socketReceiveMsg(Socket *socket, SocketMsg *message, uint_t flags)
 }
 
 
+/**
+ * @brief Receive a batch of messages
+ *
+ * The first message is received according to the specified flags. The
+ * subsequent messages are only taken from the receive queue without waiting,
+ * so that all the datagrams already queued are drained with a single
+ * acquisition of the stack lock
+ *
+ * @param[in] socket Handle that identifies a socket
+ * @param[in,out] messages Array of messages where to store the incoming data
+ * @param[in] count Number of entries in the array
+ * @param[out] received Number of messages that have been received (optional)
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @return Error code
+ **/
+
+error_t socketReceiveMsgBatch(Socket *socket, SocketMsg *messages,
+   uint_t count, uint_t *received, uint_t flags)
+{
+   error_t error;
+   uint_t i;
+   uint_t n;
+
+   //No message has been received yet
+   if(received != NULL)
+   {
+      *received = 0;
+   }
+
+   //Check parameters
+   if(socket == NULL || messages == NULL || count == 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //Peeking at the receive queue always returns the same message
+   if((flags & SOCKET_FLAG_PEEK) != 0)
+   {
+      count = 1;
+   }
+
+   //Initialize status code
+   error = NO_ERROR;
+   n = 0;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Drain the receive queue
+   for(i = 0; i < count && !error; i++)
+   {
+      //No data has been received yet
+      messages[i].length = 0;
+
+#if (UDP_SUPPORT == ENABLED)
+      //Connectionless socket?
+      if(socket->type == SOCKET_TYPE_DGRAM)
+      {
+         //Receive UDP datagram
+         error = udpReceiveDatagram(socket, &messages[i], flags);
+      }
+      else
+#endif
+#if (RAW_SOCKET_SUPPORT == ENABLED)
+      //Raw socket?
+      if(socket->type == SOCKET_TYPE_RAW_IP)
+      {
+         //Receive a raw IP packet
+         error = rawSocketReceiveIpPacket(socket, &messages[i], flags);
+      }
+      else if(socket->type == SOCKET_TYPE_RAW_ETH)
+      {
+         //Receive a raw Ethernet packet
+         error = rawSocketReceiveEthPacket(socket, &messages[i], flags);
+      }
+      else
+#endif
+      //Invalid socket type?
+      {
+         //Report an error
+         error = ERROR_INVALID_SOCKET;
+      }
+
+      //Check status code
+      if(!error)
+      {
+         //Total number of messages successfully received
+         n++;
+      }
+
+      //Subsequent messages are received in non-blocking mode
+      flags |= SOCKET_FLAG_DONT_WAIT;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Total number of messages successfully received
+   if(received != NULL)
+   {
+      *received = n;
+   }
+
+   //The call succeeds as long as at least one message has been received
+   if(n > 0)
+   {
+      error = NO_ERROR;
+   }
+
+   //Return status code
+   return error;
+}
+
+
 /**
  * @brief Retrieve the local address for a given socket
  * @param[in] socket Handle that identifies a socket
@@ -1545,6 +2266,7 @@ void socketClose(Socket *socket)
       //Abort the current TCP connection
       tcpAbort(socket);
    }
+   else
 #endif
 #if (UDP_SUPPORT == ENABLED || RAW_SOCKET_SUPPORT == ENABLED)
    //Connectionless socket or raw socket?
@@ -1566,10 +2288,15 @@ void socketClose(Socket *socket)
          queueItem = nextQueueItem;
       }
 
-      //Mark the socket as closed
-      socket->type = SOCKET_TYPE_UNUSED;
+      //Release the socket
+      socketFree(socket);
    }
+   else
 #endif
+   //Invalid socket type?
+   {
+      //Just for sanity
+   }
 
    //Release exclusive access
    osReleaseMutex(&netMutex);
@@ -40,6 +40,7 @@ struct _Socket;
 #include "core/ethernet.h"
 #include "core/ip.h"
 #include "core/tcp.h"
+#include "core/bpf.h"
 
 //Number of sockets that can be opened simultaneously
 #ifndef SOCKET_MAX_COUNT
@@ -69,6 +70,64 @@ struct _Socket;
    #error SOCKET_EPHEMERAL_PORT_MAX parameter is not valid
 #endif
 
+//Dynamic allocation of socket control blocks
+#ifndef SOCKET_DYNAMIC_ALLOC_SUPPORT
+   #define SOCKET_DYNAMIC_ALLOC_SUPPORT DISABLED
+#elif (SOCKET_DYNAMIC_ALLOC_SUPPORT != ENABLED && SOCKET_DYNAMIC_ALLOC_SUPPORT != DISABLED)
+   #error SOCKET_DYNAMIC_ALLOC_SUPPORT parameter is not valid
+#endif
+
+//Busy-poll support
+#ifndef SOCKET_BUSY_POLL_SUPPORT
+   #define SOCKET_BUSY_POLL_SUPPORT DISABLED
+#elif (SOCKET_BUSY_POLL_SUPPORT != ENABLED && SOCKET_BUSY_POLL_SUPPORT != DISABLED)
+   #error SOCKET_BUSY_POLL_SUPPORT parameter is not valid
+#endif
+
+//Shared-memory receive ring support (raw sockets)
+#ifndef SOCKET_RX_RING_SUPPORT
+   #define SOCKET_RX_RING_SUPPORT DISABLED
+#elif (SOCKET_RX_RING_SUPPORT != ENABLED && SOCKET_RX_RING_SUPPORT != DISABLED)
+   #error SOCKET_RX_RING_SUPPORT parameter is not valid
+#endif
+
+//Asynchronous socket API support
+#ifndef SOCKET_ASYNC_SUPPORT
+   #define SOCKET_ASYNC_SUPPORT DISABLED
+#elif (SOCKET_ASYNC_SUPPORT != ENABLED && SOCKET_ASYNC_SUPPORT != DISABLED)
+   #error SOCKET_ASYNC_SUPPORT parameter is not valid
+#endif
+
+//Maximum number of asynchronous rings per stack instance
+#ifndef SOCKET_ASYNC_MAX_RINGS
+   #define SOCKET_ASYNC_MAX_RINGS 2
+#elif (SOCKET_ASYNC_MAX_RINGS < 1)
+   #error SOCKET_ASYNC_MAX_RINGS parameter is not valid
+#endif
+
+//Size of a cache line
+#ifndef SOCKET_CACHE_LINE_SIZE
+   #define SOCKET_CACHE_LINE_SIZE 32
+#elif (SOCKET_CACHE_LINE_SIZE < 4 || (SOCKET_CACHE_LINE_SIZE & (SOCKET_CACHE_LINE_SIZE - 1)) != 0)
+   #error SOCKET_CACHE_LINE_SIZE parameter is not valid
+#endif
+
+//Alignment of the variables accessed on the data path. It only applies to
+//statically allocated control blocks, as the memory allocator does not
+//guarantee the alignment of the blocks it returns
+#ifndef SOCKET_HOT_ALIGN
+   #if (SOCKET_DYNAMIC_ALLOC_SUPPORT == DISABLED && NET_MULTI_INSTANCE_SUPPORT == DISABLED && \
+      (defined(__GNUC__) || defined(__clang__)))
+      #define SOCKET_HOT_ALIGN __attribute__((aligned(SOCKET_CACHE_LINE_SIZE)))
+   #else
+      #define SOCKET_HOT_ALIGN
+   #endif
+#endif
+
+//Alignment of receive ring slots (the slot header holds pointers, time
+//values and IP addresses)
+#define SOCKET_RX_RING_ALIGNMENT MAX(sizeof(void *), sizeof(uint64_t))
+
 //C++ guard
 #ifdef __cplusplus
 extern "C" {
@@ -242,6 +301,7 @@ typedef struct
    uint16_t srcPort;        ///<Source port
    IpAddr destIpAddr;       ///<Destination IP address
    uint16_t destPort;       ///<Destination port
+   size_t segmentSize;      ///<Segment size for UDP segmentation (0 if not used)
 #if (ETH_SUPPORT == ENABLED)
    MacAddr srcMacAddr;      ///<Source MAC address
    MacAddr destMacAddr;     ///<Destination MAC address
@@ -274,26 +334,64 @@ typedef struct _SocketQueueItem
 } SocketQueueItem;
 
 
+/**
+ * @brief Receive ring slot state
+ **/
+
+typedef enum
+{
+   SOCKET_RING_SLOT_FREE  = 0, ///<The slot can be filled by the TCP/IP stack
+   SOCKET_RING_SLOT_READY = 1, ///<The slot holds a packet not yet handed out
+   SOCKET_RING_SLOT_USER  = 2  ///<The slot is being processed by the application
+} SocketRingSlotStatus;
+
+
+/**
+ * @brief Receive ring slot header
+ *
+ * The captured packet immediately follows the header
+ *
+ **/
+
+typedef struct
+{
+   volatile uint32_t status;  ///<Slot state (see SocketRingSlotStatus)
+   uint16_t length;           ///<Number of bytes stored in the slot
+   uint16_t origLength;       ///<Original length of the packet
+   systime_t timestamp;       ///<Reception time
+   NetInterface *interface;   ///<Interface where the packet was received
+   uint16_t vlanId;           ///<VLAN identifier of the interface
+   uint16_t ethType;          ///<Ethernet type field
+   MacAddr srcMacAddr;        ///<Source MAC address
+   MacAddr destMacAddr;       ///<Destination MAC address
+   IpAddr srcIpAddr;          ///<Source IP address (raw IP sockets)
+   IpAddr destIpAddr;         ///<Destination IP address (raw IP sockets)
+#if (ETH_PORT_TAGGING_SUPPORT == ENABLED)
+   uint8_t switchPort;        ///<Switch port identifier
+#endif
+#if (ETH_TIMESTAMP_SUPPORT == ENABLED)
+   NetTimestamp hwTimestamp;  ///<Captured time stamp
+#endif
+} SocketRingSlot;
+
+//Point to the packet stored in a receive ring slot
+#define SOCKET_RING_SLOT_DATA(slot) ((uint8_t *) (slot) + sizeof(SocketRingSlot))
+
+
 /**
  * @brief Structure describing a socket
  **/
 
 struct _Socket
 {
-   uint_t descriptor;
-   uint_t type;
-   uint_t protocol;
-   NetInterface *interface;
-   IpAddr localIpAddr;
-   uint16_t localPort;
-   IpAddr remoteIpAddr;
-   uint16_t remotePort;
-   uint32_t options;              ///<Socket options
+//Generic configuration variables
    systime_t timeout;
+#if (SOCKET_BUSY_POLL_SUPPORT == ENABLED)
+   systime_t busyPollTime;        ///<Maximum time spent busy-polling before blocking
+#endif
    uint8_t tos;                   ///<Type-of-service value
    uint8_t ttl;                   ///<Time-to-live value for unicast datagrams
    uint8_t multicastTtl;          ///<Time-to-live value for multicast datagrams
-   IpAddr multicastGroups[SOCKET_MAX_MULTICAST_GROUPS]; ///<Multicast groups
 #if (ETH_VLAN_SUPPORT == ENABLED)
    int8_t vlanPcp;                ///<VLAN priority (802.1Q)
    int8_t vlanDei;                ///<Drop eligible indicator
@@ -304,35 +402,73 @@ struct _Socket
 #endif
    int_t errnoCode;
    OsEvent event;
+   IpAddr multicastGroups[SOCKET_MAX_MULTICAST_GROUPS]; ///<Multicast groups
+
+//Generic variables accessed on the data path. They start on a cache line
+//boundary and are immediately followed by the UDP and TCP variables that
+//are accessed for every packet
+   uint_t descriptor SOCKET_HOT_ALIGN;
+   uint_t type;
+   uint_t protocol;
+   struct _Socket *next;          ///<Next socket in the per-protocol list
+   NetInterface *interface;
+   uint16_t localPort;
+   uint16_t remotePort;
+   IpAddr localIpAddr;
+   IpAddr remoteIpAddr;
+   uint32_t options;              ///<Socket options
    uint_t eventMask;
    uint_t eventFlags;
    OsEvent *userEvent;
+   struct _SocketReadyEntry *readyEntry; ///<Ready list entry the socket is attached to
+
+//UDP specific variables
+#if (UDP_SUPPORT == ENABLED || RAW_SOCKET_SUPPORT == ENABLED)
+   SocketQueueItem *receiveQueue;
+   uint16_t segmentSize;          ///<Segment size for UDP segmentation
+#endif
+#if (BPF_SUPPORT == ENABLED)
+   BpfInsn *filter;               ///<Packet filter program attached to the socket
+#endif
+#if (SOCKET_RX_RING_SUPPORT == ENABLED)
+   uint8_t *rxRing;               ///<Receive ring (application-provided memory)
+   size_t rxRingSlotSize;         ///<Size of each slot, in bytes
+   uint_t rxRingSlotCount;        ///<Number of slots
+   uint_t rxRingHead;             ///<Next slot to be filled by the TCP/IP stack
+   uint_t rxRingTail;             ///<Next slot to be handed out to the application
+   uint32_t rxRingPackets;        ///<Number of packets stored in the ring
+   uint32_t rxRingDrops;          ///<Number of packets dropped because the ring was full
+#endif
 
-//TCP specific variables
+//TCP specific variables (must be placed at the end of the structure)
 #if (TCP_SUPPORT == ENABLED)
    TcpState state;                ///<Current state of the TCP finite state machine
-   bool_t ownedFlag;              ///<The user is the owner of the TCP socket
-   bool_t closedFlag;             ///<The connection has been closed properly
-   bool_t resetFlag;              ///<The connection has been reset
-
-   uint16_t mss;                  ///<Maximum segment size
-   uint16_t smss;                 ///<Sender maximum segment size
-   uint16_t rmss;                 ///<Receiver maximum segment size
-   uint32_t iss;                  ///<Initial send sequence number
-   uint32_t irs;                  ///<Initial receive sequence number
 
+   //Variables accessed for every incoming or outgoing segment
    uint32_t sndUna;               ///<Data that have been sent but not yet acknowledged
    uint32_t sndNxt;               ///<Sequence number of the next byte to be sent
+   uint32_t sndWl1;               ///<Segment sequence number used for last window update
+   uint32_t sndWl2;               ///<Segment acknowledgment number used for last window update
    uint16_t sndUser;              ///<Amount of data buffered but not yet sent
    uint16_t sndWnd;               ///<Size of the send window
    uint16_t maxSndWnd;            ///<Maximum send window it has seen so far on the connection
-   uint32_t sndWl1;               ///<Segment sequence number used for last window update
-   uint32_t sndWl2;               ///<Segment acknowledgment number used for last window update
+   uint16_t smss;                 ///<Sender maximum segment size
 
    uint32_t rcvNxt;               ///<Receive next sequence number
    uint16_t rcvUser;              ///<Number of data received but not yet consumed
    uint16_t rcvWnd;               ///<Receive window
+   uint16_t rmss;                 ///<Receiver maximum segment size
+
+#if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
+   uint16_t cwnd;                 ///<Congestion window
+   uint16_t ssthresh;             ///<Slow start threshold
+   TcpCongestState congestState;  ///<Congestion state
+   uint_t dupAckCount;            ///<Number of consecutive duplicate ACKs
+   uint_t n;                      ///<Number of bytes acknowledged during the whole round-trip
+   uint32_t recover;              ///<NewReno modification to TCP's fast recovery algorithm
+#endif
 
+   TcpQueueItem *retransmitQueue; ///<Retransmission queue
    bool_t rttBusy;                ///<RTT measurement is being performed
    uint32_t rttSeqNum;            ///<Sequence number identifying a TCP segment
    systime_t rttStartTime;        ///<Round-trip start time
@@ -340,14 +476,20 @@ struct _Socket
    systime_t rttvar;              ///<Round-trip time variation
    systime_t rto;                 ///<Retransmission timeout
 
-#if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
-   TcpCongestState congestState;  ///<Congestion state
-   uint16_t cwnd;                 ///<Congestion window
-   uint16_t ssthresh;             ///<Slow start threshold
-   uint_t dupAckCount;            ///<Number of consecutive duplicate ACKs
-   uint_t n;                      ///<Number of bytes acknowledged during the whole round-trip
-   uint32_t recover;              ///<NewReno modification to TCP's fast recovery algorithm
+#if (TCP_SACK_SUPPORT == ENABLED)
+   bool_t sackPermitted;          ///<SACK Permitted option received
 #endif
+   uint_t sackBlockCount;         ///<Number of non-contiguous blocks that have been received
+
+   //Variables accessed during connection setup and teardown or by timers
+   bool_t ownedFlag;              ///<The user is the owner of the TCP socket
+   bool_t closedFlag;             ///<The connection has been closed properly
+   bool_t resetFlag;              ///<The connection has been reset
+
+   uint16_t mss;                  ///<Maximum segment size
+   uint16_t peerMss;              ///<SMSS negotiated with the peer, before any PMTU reduction
+   uint32_t iss;                  ///<Initial send sequence number
+   uint32_t irs;                  ///<Initial receive sequence number
 
 #if (TCP_KEEP_ALIVE_SUPPORT == ENABLED)
    bool_t keepAliveEnabled;       ///<Specifies whether TCP keep-alive mechanism is enabled
@@ -358,25 +500,31 @@ struct _Socket
    systime_t keepAliveTimestamp;  ///<Keep-alive timestamp
 #endif
 
-#if (TCP_SACK_SUPPORT == ENABLED)
-   bool_t sackPermitted;          ///<SACK Permitted option received
-#endif
-
    TcpSackBlock sackBlock[TCP_MAX_SACK_BLOCKS]; ///<List of non-contiguous blocks that have been received
-   uint_t sackBlockCount;                       ///<Number of non-contiguous blocks that have been received
 
-   TcpTxBuffer txBuffer;          ///<Send buffer
-   size_t txBufferSize;           ///<Size of the send buffer
-   TcpRxBuffer rxBuffer;          ///<Receive buffer
-   size_t rxBufferSize;           ///<Size of the receive buffer
-
-   TcpQueueItem *retransmitQueue; ///<Retransmission queue
    NetTimer retransmitTimer;      ///<Retransmission timer
    uint_t retransmitCount;        ///<Number of retransmissions
 
    TcpSynQueueItem *synQueue;     ///<SYN queue for listening sockets
    uint_t synQueueSize;           ///<Maximum number of pending connections for listening sockets
 
+#if (TCP_INFO_SUPPORT == ENABLED)
+   uint32_t segsOut;              ///<Number of segments sent
+   uint32_t segsIn;               ///<Number of segments received
+   uint32_t totalRetrans;         ///<Number of segments retransmitted
+   uint64_t bytesSent;            ///<Data bytes sent, retransmissions included
+   uint64_t bytesRetrans;         ///<Data bytes retransmitted
+   uint64_t bytesAcked;           ///<Sequence space acknowledged by the peer
+   uint64_t bytesReceived;        ///<Data bytes received in sequence
+   uint64_t rttBytesAcked;        ///<Value of bytesAcked when the RTT measurement started
+   uint32_t deliveryRate;         ///<Most recent delivery rate sample, in bytes per second
+   TcpLimit limit;                ///<Factor currently limiting the sender
+   systime_t limitTimestamp;      ///<Time at which the current limit was entered
+   systime_t cwndLimitedTime;     ///<Time spent limited by the congestion window
+   systime_t rwndLimitedTime;     ///<Time spent limited by the receiver window
+   systime_t appLimitedTime;      ///<Time spent waiting for data from the application
+#endif
+
    uint_t wndProbeCount;          ///<Zero window probe counter
    systime_t wndProbeInterval;    ///<Interval between successive probes
 
@@ -384,11 +532,22 @@ struct _Socket
    NetTimer overrideTimer;        ///<Override timer
    NetTimer finWait2Timer;        ///<FIN-WAIT-2 timer
    NetTimer timeWaitTimer;        ///<2MSL timer
-#endif
 
-//UDP specific variables
-#if (UDP_SUPPORT == ENABLED || RAW_SOCKET_SUPPORT == ENABLED)
-   SocketQueueItem *receiveQueue;
+   //Data buffers
+   size_t txBufferSize;           ///<Size of the send buffer
+   size_t rxBufferSize;           ///<Size of the receive buffer
+   uint32_t txBufferStart;        ///<Sequence number stored at the start of the send buffer
+   uint32_t rxBufferStart;        ///<Sequence number stored at the start of the receive buffer
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   bool_t txBufferLocked;         ///<The size of the send buffer was set by the application
+   bool_t rxBufferLocked;         ///<The size of the receive buffer was set by the application
+   size_t txBufferTarget;         ///<Pending size of the send buffer
+   size_t rxBufferTarget;         ///<Pending size of the receive buffer
+   systime_t rxAutotuneTimestamp; ///<Start of the current receive measurement interval
+   uint32_t rxAutotuneSeqNum;     ///<Value of RCV.NXT at the start of the interval
+#endif
+   TcpTxBuffer txBuffer;          ///<Send buffer
+   TcpRxBuffer rxBuffer;          ///<Receive buffer
 #endif
 };
 
@@ -405,11 +564,37 @@ typedef struct
 } SocketEventDesc;
 
 
+/**
+ * @brief Socket layer state
+ **/
+
+typedef struct _SocketContext
+{
+   Socket *table[SOCKET_MAX_COUNT]; ///<Socket descriptors
+   Socket *tcpList;                 ///<List of active TCP sockets
+   Socket *udpList;                 ///<List of active UDP sockets
+   Socket *rawList;                 ///<List of active raw sockets
+   uint16_t tcpDynamicPort;         ///<Next TCP ephemeral port
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   size_t tcpBufferUsage;           ///<Total size of the TCP send and receive buffers
+#endif
+#if (SOCKET_ASYNC_SUPPORT == ENABLED)
+   struct _SocketAsyncRing *asyncRings[SOCKET_ASYNC_MAX_RINGS]; ///<Registered asynchronous rings
+#endif
+#if (SOCKET_DYNAMIC_ALLOC_SUPPORT == DISABLED)
+   Socket pool[SOCKET_MAX_COUNT];   ///<Statically allocated socket control blocks
+#endif
+} SocketContext;
+
+
 //Global constants
 extern const SocketMsg SOCKET_DEFAULT_MSG;
 
-//Global variables
-extern Socket socketTable[SOCKET_MAX_COUNT];
+//Per-instance socket layer state
+#define socketTable (netContext.socketContext->table)
+#define tcpSocketList (netContext.socketContext->tcpList)
+#define udpSocketList (netContext.socketContext->udpList)
+#define rawSocketList (netContext.socketContext->rawList)
 
 //Socket related functions
 error_t socketInit(void);
@@ -417,6 +602,7 @@ error_t socketInit(void);
 Socket *socketOpen(uint_t type, uint_t protocol);
 
 error_t socketSetTimeout(Socket *socket, systime_t timeout);
+error_t socketSetBusyPoll(Socket *socket, systime_t duration);
 
 error_t socketSetTtl(Socket *socket, uint8_t ttl);
 error_t socketSetMulticastTtl(Socket *socket, uint8_t ttl);
@@ -438,13 +624,32 @@ error_t socketSetKeepAliveParams(Socket *socket, systime_t idle,
    systime_t interval, uint_t maxProbes);
 
 error_t socketSetMaxSegmentSize(Socket *socket, size_t mss);
+error_t socketSetUdpSegmentSize(Socket *socket, size_t segmentSize);
 
 error_t socketSetTxBufferSize(Socket *socket, size_t size);
 error_t socketSetRxBufferSize(Socket *socket, size_t size);
 
+error_t socketGetTcpInfo(Socket *socket, TcpInfo *info);
+
 error_t socketSetInterface(Socket *socket, NetInterface *interface);
 NetInterface *socketGetInterface(Socket *socket);
 
+error_t socketAttachFilter(Socket *socket, const BpfInsn *program,
+   uint_t length);
+
+error_t socketDetachFilter(Socket *socket);
+
+error_t socketSetRxRing(Socket *socket, void *buffer, size_t slotSize,
+   uint_t slotCount);
+
+error_t socketReceiveRxRing(Socket *socket, SocketRingSlot **slot,
+   uint_t flags);
+
+error_t socketReleaseRxRing(Socket *socket, SocketRingSlot *slot);
+
+error_t socketGetRxRingStats(Socket *socket, uint32_t *packets,
+   uint32_t *drops);
+
 error_t socketBind(Socket *socket, const IpAddr *localIpAddr,
    uint16_t localPort);
 
@@ -464,6 +669,9 @@ error_t socketSendTo(Socket *socket, const IpAddr *destIpAddr, uint16_t destPort
 
 error_t socketSendMsg(Socket *socket, const SocketMsg *message, uint_t flags);
 
+error_t socketSendMsgBatch(Socket *socket, const SocketMsg *messages,
+   uint_t count, uint_t *sent, uint_t flags);
+
 error_t socketReceive(Socket *socket, void *data,
    size_t size, size_t *received, uint_t flags);
 
@@ -475,6 +683,9 @@ error_t socketReceiveEx(Socket *socket, IpAddr *srcIpAddr, uint16_t *srcPort,
 
 error_t socketReceiveMsg(Socket *socket, SocketMsg *message, uint_t flags);
 
+error_t socketReceiveMsgBatch(Socket *socket, SocketMsg *messages,
+   uint_t count, uint_t *received, uint_t flags);
+
 error_t socketGetLocalAddr(Socket *socket, IpAddr *localIpAddr,
    uint16_t *localPort);
 
@@ -0,0 +1,593 @@
+/**
+ * @file socket_async.c
+ * @brief Completion-based asynchronous socket API
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The application posts send, receive, accept and connect operations to a
+ * submission ring. The operations are carried out by the TCP/IP stack task
+ * in non-blocking mode and their results are posted to a completion ring,
+ * so that a single application task can drive many connections
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL SOCKET_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "core/socket.h"
+#include "core/socket_misc.h"
+#include "core/socket_async.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (SOCKET_ASYNC_SUPPORT == ENABLED)
+
+
+/**
+ * @brief Initialize a submission/completion ring pair
+ *
+ * The ring is registered with the current stack instance, which processes
+ * the submitted operations from its own task
+ *
+ * @param[in] ring Pointer to the ring pair
+ * @return Error code
+ **/
+
+error_t socketAsyncInit(SocketAsyncRing *ring)
+{
+   error_t error;
+   uint_t i;
+   NetContext *context;
+
+   //Check parameters
+   if(ring == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Clear the structure
+   osMemset(ring, 0, sizeof(SocketAsyncRing));
+
+   //The ring belongs to the stack instance of the calling task
+   context = netGetCurrentContext();
+   ring->context = context;
+
+   //Create a mutex to protect the ring
+   if(!osCreateMutex(&ring->mutex))
+      return ERROR_OUT_OF_RESOURCES;
+
+   //Create an event object to notify the application of completions
+   if(!osCreateEvent(&ring->event))
+   {
+      osDeleteMutex(&ring->mutex);
+      return ERROR_OUT_OF_RESOURCES;
+   }
+
+   //Initialize status code
+   error = ERROR_OUT_OF_RESOURCES;
+
+   //Get exclusive access
+   osAcquireMutex(&context->mutex);
+
+   //Loop through the table of registered rings
+   for(i = 0; i < SOCKET_ASYNC_MAX_RINGS; i++)
+   {
+      //Free entry?
+      if(context->socketContext->asyncRings[i] == NULL)
+      {
+         //Register the ring
+         context->socketContext->asyncRings[i] = ring;
+         error = NO_ERROR;
+         break;
+      }
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&context->mutex);
+
+   //Any error to report?
+   if(error)
+   {
+      osDeleteEvent(&ring->event);
+      osDeleteMutex(&ring->mutex);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Release a submission/completion ring pair
+ *
+ * In-flight operations are abandoned and no completion is reported for them
+ *
+ * @param[in] ring Pointer to the ring pair
+ **/
+
+void socketAsyncDeinit(SocketAsyncRing *ring)
+{
+   uint_t i;
+   NetContext *context;
+
+   //Valid ring?
+   if(ring != NULL)
+   {
+      //Point to the stack instance the ring is registered with
+      context = ring->context;
+
+      //Get exclusive access
+      osAcquireMutex(&context->mutex);
+
+      //Unregister the ring
+      for(i = 0; i < SOCKET_ASYNC_MAX_RINGS; i++)
+      {
+         if(context->socketContext->asyncRings[i] == ring)
+         {
+            context->socketContext->asyncRings[i] = NULL;
+         }
+      }
+
+      //Release exclusive access
+      osReleaseMutex(&context->mutex);
+
+      //Wait for the stack task to be done with the ring
+      osAcquireMutex(&ring->mutex);
+      osReleaseMutex(&ring->mutex);
+
+      //Stop monitoring the sockets of the in-flight operations
+      for(i = 0; i < SOCKET_ASYNC_MAX_PENDING; i++)
+      {
+         if(ring->ops[i].used && !ring->ops[i].done)
+         {
+            socketUnregisterEvents(ring->ops[i].sqe.socket);
+         }
+      }
+
+      //Release resources
+      osDeleteEvent(&ring->event);
+      osDeleteMutex(&ring->mutex);
+   }
+}
+
+
+/**
+ * @brief Post operations to the submission ring
+ * @param[in] ring Pointer to the ring pair
+ * @param[in] sqe Array of operations to submit
+ * @param[in] count Number of entries in the array
+ * @param[out] submitted Number of operations actually submitted (optional)
+ * @return Error code
+ **/
+
+error_t socketAsyncSubmit(SocketAsyncRing *ring, const SocketAsyncSqe *sqe,
+   uint_t count, uint_t *submitted)
+{
+   error_t error;
+   uint_t i;
+   uint_t n;
+
+   //No operation has been submitted yet
+   if(submitted != NULL)
+   {
+      *submitted = 0;
+   }
+
+   //Check parameters
+   if(ring == NULL || sqe == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Acquire exclusive access to the ring
+   osAcquireMutex(&ring->mutex);
+
+   //Copy as many entries as possible
+   for(n = 0; n < count; n++)
+   {
+      //Malformed entry?
+      if(sqe[n].socket == NULL || sqe[n].opcode < SOCKET_ASYNC_OP_SEND ||
+         sqe[n].opcode > SOCKET_ASYNC_OP_CONNECT)
+      {
+         error = ERROR_INVALID_PARAMETER;
+         break;
+      }
+
+      //The submission ring is full?
+      if(ring->sqCount >= SOCKET_ASYNC_SQ_SIZE)
+      {
+         error = ERROR_BUFFER_OVERFLOW;
+         break;
+      }
+
+      //Append the entry to the submission ring
+      i = (ring->sqHead + ring->sqCount) % SOCKET_ASYNC_SQ_SIZE;
+      ring->sq[i] = sqe[n];
+      ring->sqCount++;
+   }
+
+   //Release exclusive access to the ring
+   osReleaseMutex(&ring->mutex);
+
+   //Any operation submitted?
+   if(n > 0)
+   {
+      //Notify the stack instance the ring is registered with
+      osSetEvent(&ring->context->event);
+      //The call succeeds as long as at least one operation has been submitted
+      error = NO_ERROR;
+   }
+
+   //Return the number of operations submitted
+   if(submitted != NULL)
+   {
+      *submitted = n;
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Retrieve completions from the completion ring
+ * @param[in] ring Pointer to the ring pair
+ * @param[out] cqe Array where to store the completions
+ * @param[in] count Number of entries in the array
+ * @param[out] received Number of completions retrieved (optional)
+ * @param[in] timeout Maximum time to wait for the first completion
+ * @return Error code
+ **/
+
+error_t socketAsyncGetCompletions(SocketAsyncRing *ring, SocketAsyncCqe *cqe,
+   uint_t count, uint_t *received, systime_t timeout)
+{
+   uint_t n;
+   bool_t blocked;
+
+   //No completion has been retrieved yet
+   if(received != NULL)
+   {
+      *received = 0;
+   }
+
+   //Check parameters
+   if(ring == NULL || cqe == NULL || count == 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //Acquire exclusive access to the ring
+   osAcquireMutex(&ring->mutex);
+
+   //The completion ring is empty?
+   if(ring->cqCount == 0)
+   {
+      //Reset the event object
+      osResetEvent(&ring->event);
+
+      //Release exclusive access to the ring
+      osReleaseMutex(&ring->mutex);
+      //Wait for completions
+      osWaitForEvent(&ring->event, timeout);
+      //Acquire exclusive access to the ring
+      osAcquireMutex(&ring->mutex);
+   }
+
+   //Retrieve as many completions as possible
+   for(n = 0; n < count && ring->cqCount > 0; n++)
+   {
+      cqe[n] = ring->cq[ring->cqHead];
+      ring->cqHead = (ring->cqHead + 1) % SOCKET_ASYNC_CQ_SIZE;
+      ring->cqCount--;
+   }
+
+   //Completions may be waiting for room in the completion ring
+   blocked = (n > 0) ? ring->cqBlocked : FALSE;
+
+   //Release exclusive access to the ring
+   osReleaseMutex(&ring->mutex);
+
+   //Let the TCP/IP stack post the remaining completions
+   if(blocked)
+   {
+      osSetEvent(&ring->context->event);
+   }
+
+   //Return the number of completions retrieved
+   if(received != NULL)
+   {
+      *received = n;
+   }
+
+   //Return status code
+   return (n > 0) ? NO_ERROR : ERROR_TIMEOUT;
+}
+
+
+/**
+ * @brief Events that allow an in-flight operation to make progress
+ * @param[in] op Pointer to the in-flight operation
+ * @return Event mask
+ **/
+
+uint_t socketAsyncGetEventMask(const SocketAsyncOp *op)
+{
+   uint_t eventMask;
+
+   //Check operation code
+   switch(op->sqe.opcode)
+   {
+   case SOCKET_ASYNC_OP_SEND:
+      eventMask = SOCKET_EVENT_TX_READY | SOCKET_EVENT_CLOSED;
+      break;
+   case SOCKET_ASYNC_OP_RECEIVE:
+      eventMask = SOCKET_EVENT_RX_READY | SOCKET_EVENT_CLOSED;
+      break;
+   case SOCKET_ASYNC_OP_ACCEPT:
+      eventMask = SOCKET_EVENT_RX_READY;
+      break;
+   default:
+      eventMask = SOCKET_EVENT_CONNECTED | SOCKET_EVENT_CLOSED;
+      break;
+   }
+
+   //Return event mask
+   return eventMask;
+}
+
+
+/**
+ * @brief Try to make progress on an in-flight operation
+ *
+ * The operation is performed with a zero timeout so that the stack task
+ * never blocks on behalf of the application
+ *
+ * @param[in] op Pointer to the in-flight operation
+ **/
+
+void socketAsyncExecute(SocketAsyncOp *op)
+{
+   error_t error;
+   size_t n;
+   systime_t timeout;
+   Socket *socket;
+   const IpAddr *ipAddr;
+
+   //Point to the socket
+   socket = op->sqe.socket;
+   //Number of bytes transferred by this attempt
+   n = 0;
+
+   //Operate the socket in non-blocking mode
+   timeout = socket->timeout;
+   socketSetTimeout(socket, 0);
+
+   //Check operation code
+   if(op->sqe.opcode == SOCKET_ASYNC_OP_SEND)
+   {
+      //The remote address is optional for connected sockets
+      ipAddr = (op->sqe.ipAddr.length != 0) ? &op->sqe.ipAddr : NULL;
+
+      //Send the remaining data
+      error = socketSendTo(socket, ipAddr, op->sqe.port,
+         (uint8_t *) op->sqe.data + op->cqe.result,
+         op->sqe.length - op->cqe.result, &n, op->sqe.flags);
+
+      //Update the number of bytes sent
+      op->cqe.result += n;
+
+      //The operation completes when all the data have been buffered
+      if((error == ERROR_TIMEOUT || error == ERROR_WOULD_BLOCK) &&
+         op->cqe.result < op->sqe.length)
+      {
+         error = ERROR_IN_PROGRESS;
+      }
+   }
+   else if(op->sqe.opcode == SOCKET_ASYNC_OP_RECEIVE)
+   {
+      //Receive as much data as available
+      error = socketReceiveEx(socket, &op->cqe.ipAddr, &op->cqe.port, NULL,
+         op->sqe.data, op->sqe.length, &n,
+         op->sqe.flags | SOCKET_FLAG_DONT_WAIT);
+
+      //Save the number of bytes received
+      op->cqe.result = n;
+
+      //The operation completes as soon as some data are available
+      if(error == ERROR_TIMEOUT || error == ERROR_WOULD_BLOCK)
+      {
+         error = (n > 0) ? NO_ERROR : ERROR_IN_PROGRESS;
+      }
+   }
+   else if(op->sqe.opcode == SOCKET_ASYNC_OP_ACCEPT)
+   {
+      //Accept a pending connection, if any
+      op->cqe.newSocket = socketAccept(socket, &op->cqe.ipAddr,
+         &op->cqe.port);
+
+      //The SYN queue may be empty
+      error = (op->cqe.newSocket != NULL) ? NO_ERROR : ERROR_IN_PROGRESS;
+   }
+   else
+   {
+      //Initiate the connection or check its progress
+      error = socketConnect(socket, &op->sqe.ipAddr, op->sqe.port);
+
+      //The three-way handshake may not be complete yet
+      if(error == ERROR_TIMEOUT)
+      {
+         error = ERROR_IN_PROGRESS;
+      }
+   }
+
+   //Restore the timeout value of the socket
+   socketSetTimeout(socket, timeout);
+
+   //Completed operation?
+   if(error != ERROR_IN_PROGRESS)
+   {
+      op->cqe.status = error;
+      op->done = TRUE;
+   }
+}
+
+
+/**
+ * @brief Process the registered rings
+ *
+ * This function is called by the TCP/IP stack task. It pulls new operations
+ * from the submission rings, makes progress on the in-flight operations and
+ * posts completed ones to the completion rings
+ **/
+
+void socketAsyncProcess(void)
+{
+   uint_t i;
+   uint_t j;
+   bool_t posted;
+   SocketAsyncOp *op;
+   SocketAsyncRing *ring;
+
+   //Loop through the table of registered rings
+   for(i = 0; i < SOCKET_ASYNC_MAX_RINGS; i++)
+   {
+      //Get exclusive access
+      osAcquireMutex(&netMutex);
+
+      //Point to the current ring
+      ring = netContext.socketContext->asyncRings[i];
+
+      //Lock the ring before it can be unregistered
+      if(ring != NULL)
+      {
+         osAcquireMutex(&ring->mutex);
+      }
+
+      //Release exclusive access
+      osReleaseMutex(&netMutex);
+
+      //Skip unused entries
+      if(ring == NULL)
+         continue;
+
+      //Pull new operations from the submission ring
+      for(j = 0; j < SOCKET_ASYNC_MAX_PENDING && ring->sqCount > 0; j++)
+      {
+         //Point to the current in-flight operation
+         op = &ring->ops[j];
+
+         //Free entry?
+         if(!op->used)
+         {
+            op->used = TRUE;
+            op->done = FALSE;
+            op->sqe = ring->sq[ring->sqHead];
+
+            //Initialize the completion
+            osMemset(&op->cqe, 0, sizeof(SocketAsyncCqe));
+            op->cqe.opcode = op->sqe.opcode;
+            op->cqe.socket = op->sqe.socket;
+            op->cqe.userData = op->sqe.userData;
+
+            //Remove the entry from the submission ring
+            ring->sqHead = (ring->sqHead + 1) % SOCKET_ASYNC_SQ_SIZE;
+            ring->sqCount--;
+         }
+      }
+
+      //Make progress on the in-flight operations
+      for(j = 0; j < SOCKET_ASYNC_MAX_PENDING; j++)
+      {
+         //Point to the current in-flight operation
+         op = &ring->ops[j];
+
+         //Pending operation?
+         if(op->used && !op->done)
+         {
+            //The socket notifications are refreshed below
+            socketUnregisterEvents(op->sqe.socket);
+            //Perform the operation in non-blocking mode
+            socketAsyncExecute(op);
+         }
+      }
+
+      //No completion has been posted yet
+      posted = FALSE;
+      ring->cqBlocked = FALSE;
+
+      //Post completed operations and re-arm the pending ones
+      for(j = 0; j < SOCKET_ASYNC_MAX_PENDING; j++)
+      {
+         //Point to the current in-flight operation
+         op = &ring->ops[j];
+
+         //Skip unused entries
+         if(!op->used)
+            continue;
+
+         //Completed operation?
+         if(op->done)
+         {
+            //Room available in the completion ring?
+            if(ring->cqCount < SOCKET_ASYNC_CQ_SIZE)
+            {
+               //Append the entry to the completion ring
+               ring->cq[(ring->cqHead + ring->cqCount) %
+                  SOCKET_ASYNC_CQ_SIZE] = op->cqe;
+               ring->cqCount++;
+
+               //Release the entry
+               op->used = FALSE;
+               posted = TRUE;
+            }
+            else
+            {
+               //The completion will be posted once the application has
+               //retrieved some entries
+               ring->cqBlocked = TRUE;
+            }
+         }
+         else
+         {
+            //Wake up the stack task as soon as the operation can progress
+            socketRegisterEvents(op->sqe.socket, &netEvent,
+               socketAsyncGetEventMask(op));
+         }
+      }
+
+      //Notify the application
+      if(posted)
+      {
+         osSetEvent(&ring->event);
+      }
+
+      //Release exclusive access to the ring
+      osReleaseMutex(&ring->mutex);
+   }
+}
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * @file socket_async.h
+ * @brief Completion-based asynchronous socket API
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _SOCKET_ASYNC_H
+#define _SOCKET_ASYNC_H
+
+//Dependencies
+#include "core/net.h"
+#include "core/socket.h"
+
+//Size of the submission ring
+#ifndef SOCKET_ASYNC_SQ_SIZE
+   #define SOCKET_ASYNC_SQ_SIZE 16
+#elif (SOCKET_ASYNC_SQ_SIZE < 1)
+   #error SOCKET_ASYNC_SQ_SIZE parameter is not valid
+#endif
+
+//Size of the completion ring
+#ifndef SOCKET_ASYNC_CQ_SIZE
+   #define SOCKET_ASYNC_CQ_SIZE 32
+#elif (SOCKET_ASYNC_CQ_SIZE < 1)
+   #error SOCKET_ASYNC_CQ_SIZE parameter is not valid
+#endif
+
+//Maximum number of in-flight operations per ring
+#ifndef SOCKET_ASYNC_MAX_PENDING
+   #define SOCKET_ASYNC_MAX_PENDING 32
+#elif (SOCKET_ASYNC_MAX_PENDING < 1)
+   #error SOCKET_ASYNC_MAX_PENDING parameter is not valid
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Asynchronous operation codes
+ **/
+
+typedef enum
+{
+   SOCKET_ASYNC_OP_SEND    = 1,
+   SOCKET_ASYNC_OP_RECEIVE = 2,
+   SOCKET_ASYNC_OP_ACCEPT  = 3,
+   SOCKET_ASYNC_OP_CONNECT = 4
+} SocketAsyncOpcode;
+
+
+/**
+ * @brief Submission queue entry
+ **/
+
+typedef struct
+{
+   SocketAsyncOpcode opcode; ///<Operation to be performed
+   Socket *socket;           ///<Handle referencing the socket
+   void *data;               ///<Data to send or receive buffer
+   size_t length;            ///<Number of bytes to send or size of the buffer
+   uint_t flags;             ///<Socket flags (SOCKET_FLAG_xxx)
+   IpAddr ipAddr;            ///<Remote address (connect, optional for send)
+   uint16_t port;            ///<Remote port (connect, optional for send)
+   void *userData;           ///<Opaque value returned in the completion
+} SocketAsyncSqe;
+
+
+/**
+ * @brief Completion queue entry
+ **/
+
+typedef struct
+{
+   SocketAsyncOpcode opcode; ///<Operation that completed
+   Socket *socket;           ///<Socket the operation was submitted on
+   error_t status;           ///<Status code of the operation
+   size_t result;            ///<Number of bytes sent or received
+   Socket *newSocket;        ///<Accepted connection
+   IpAddr ipAddr;            ///<Source address (receive) or client address (accept)
+   uint16_t port;            ///<Source port (receive) or client port (accept)
+   void *userData;           ///<Opaque value copied from the submission
+} SocketAsyncCqe;
+
+
+/**
+ * @brief In-flight operation
+ **/
+
+typedef struct
+{
+   bool_t used;         ///<The entry is in use
+   bool_t done;         ///<The operation has completed
+   SocketAsyncSqe sqe;  ///<Submitted operation
+   SocketAsyncCqe cqe;  ///<Completion being built
+} SocketAsyncOp;
+
+
+/**
+ * @brief Submission/completion ring pair
+ **/
+
+typedef struct _SocketAsyncRing
+{
+   NetContext *context;                        ///<Stack instance the ring is registered with
+   OsMutex mutex;                              ///<Mutex protecting the ring
+   OsEvent event;                              ///<Signaled when completions are available
+   SocketAsyncSqe sq[SOCKET_ASYNC_SQ_SIZE];    ///<Submission ring
+   uint_t sqHead;                              ///<Read index of the submission ring
+   uint_t sqCount;                             ///<Number of pending submissions
+   SocketAsyncCqe cq[SOCKET_ASYNC_CQ_SIZE];    ///<Completion ring
+   uint_t cqHead;                              ///<Read index of the completion ring
+   uint_t cqCount;                             ///<Number of pending completions
+   bool_t cqBlocked;                           ///<Completions are waiting for room
+   SocketAsyncOp ops[SOCKET_ASYNC_MAX_PENDING]; ///<In-flight operations
+} SocketAsyncRing;
+
+
+//Asynchronous socket API
+error_t socketAsyncInit(SocketAsyncRing *ring);
+void socketAsyncDeinit(SocketAsyncRing *ring);
+
+error_t socketAsyncSubmit(SocketAsyncRing *ring, const SocketAsyncSqe *sqe,
+   uint_t count, uint_t *submitted);
+
+error_t socketAsyncGetCompletions(SocketAsyncRing *ring, SocketAsyncCqe *cqe,
+   uint_t count, uint_t *received, systime_t timeout);
+
+void socketAsyncProcess(void);
+uint_t socketAsyncGetEventMask(const SocketAsyncOp *op);
+void socketAsyncExecute(SocketAsyncOp *op);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -53,6 +53,7 @@ Socket *socketAllocate(uint_t type, uint_t protocol)
 {
    error_t error;
    uint_t i;
+   size_t size;
    uint16_t port;
    Socket *socket;
 
@@ -104,41 +105,67 @@ Socket *socketAllocate(uint_t type, uint_t protocol)
    //Check status code
    if(!error)
    {
-      //Loop through socket descriptors
-      for(i = 0; i < SOCKET_MAX_COUNT; i++)
-      {
-         //Unused socket found?
-         if(socketTable[i].type == SOCKET_TYPE_UNUSED)
-         {
-            //Save socket handle
-            socket = &socketTable[i];
-            //We are done
-            break;
-         }
-      }
+      //Look for a free socket descriptor
+      i = socketGetFreeDescriptor();
 
 #if (TCP_SUPPORT == ENABLED)
       //No more sockets available?
-      if(socket == NULL)
+      if(i >= SOCKET_MAX_COUNT)
       {
          //Kill the oldest connection in the TIME-WAIT state whenever the
          //socket table runs out of space
-         socket = tcpKillOldestConnection();
+         if(!tcpKillOldestConnection())
+         {
+            //The corresponding descriptor can be reused
+            i = socketGetFreeDescriptor();
+         }
       }
 #endif
 
-      //Check whether the current entry is free
-      if(socket != NULL)
+      //Any descriptor available?
+      if(i < SOCKET_MAX_COUNT)
       {
-         //Save socket descriptor
-         i = socket->descriptor;
+         //UDP and raw sockets do not need to carry the TCP specific variables
+         size = socketGetControlBlockSize(type);
+
+#if (SOCKET_DYNAMIC_ALLOC_SUPPORT == ENABLED)
+         //Allocate a new control block
+         socket = osAllocMem(size);
+
+         //Successful memory allocation?
+         if(socket != NULL)
+         {
+            //Clear the structure
+            osMemset(socket, 0, size);
+
+            //Create an event object to track socket events
+            if(osCreateEvent(&socket->event))
+            {
+               //Bind the control block to the descriptor
+               socketTable[i] = socket;
+            }
+            else
+            {
+               //Clean up side effects
+               osFreeMem(socket);
+               socket = NULL;
+            }
+         }
+#else
+         //Point to the statically allocated control block
+         socket = socketTable[i];
 
          //Clear the structure keeping the event field untouched
          osMemset(socket, 0, offsetof(Socket, event));
 
          osMemset((uint8_t *) socket + offsetof(Socket, event) + sizeof(OsEvent),
-            0, sizeof(Socket) - offsetof(Socket, event) - sizeof(OsEvent));
+            0, size - offsetof(Socket, event) - sizeof(OsEvent));
+#endif
+      }
 
+      //Successful allocation?
+      if(socket != NULL)
+      {
          //Save socket characteristics
          socket->descriptor = i;
          socket->type = type;
@@ -158,25 +185,32 @@ Socket *socketAllocate(uint_t type, uint_t protocol)
          socket->vmanDei = -1;
 #endif
 
-#if (TCP_SUPPORT == ENABLED && TCP_KEEP_ALIVE_SUPPORT == ENABLED)
-         //TCP keep-alive mechanism must be disabled by default (refer to
-         //RFC 1122, section 4.2.3.6)
-         socket->keepAliveEnabled = FALSE;
+#if (TCP_SUPPORT == ENABLED)
+         //TCP socket?
+         if(type == SOCKET_TYPE_STREAM)
+         {
+#if (TCP_KEEP_ALIVE_SUPPORT == ENABLED)
+            //TCP keep-alive mechanism must be disabled by default (refer to
+            //RFC 1122, section 4.2.3.6)
+            socket->keepAliveEnabled = FALSE;
 
-         //Default TCP keep-alive parameters
-         socket->keepAliveIdle = TCP_DEFAULT_KEEP_ALIVE_IDLE;
-         socket->keepAliveInterval = TCP_DEFAULT_KEEP_ALIVE_INTERVAL;
-         socket->keepAliveMaxProbes = TCP_DEFAULT_KEEP_ALIVE_PROBES;
+            //Default TCP keep-alive parameters
+            socket->keepAliveIdle = TCP_DEFAULT_KEEP_ALIVE_IDLE;
+            socket->keepAliveInterval = TCP_DEFAULT_KEEP_ALIVE_INTERVAL;
+            socket->keepAliveMaxProbes = TCP_DEFAULT_KEEP_ALIVE_PROBES;
 #endif
 
-#if (TCP_SUPPORT == ENABLED)
-         //Default MSS value
-         socket->mss = TCP_MAX_MSS;
+            //Default MSS value
+            socket->mss = TCP_MAX_MSS;
 
-         //Default TX and RX buffer size
-         socket->txBufferSize = MIN(TCP_DEFAULT_TX_BUFFER_SIZE, TCP_MAX_TX_BUFFER_SIZE);
-         socket->rxBufferSize = MIN(TCP_DEFAULT_RX_BUFFER_SIZE, TCP_MAX_RX_BUFFER_SIZE);
+            //Default TX and RX buffer size
+            socket->txBufferSize = MIN(TCP_DEFAULT_TX_BUFFER_SIZE, TCP_MAX_TX_BUFFER_SIZE);
+            socket->rxBufferSize = MIN(TCP_DEFAULT_RX_BUFFER_SIZE, TCP_MAX_RX_BUFFER_SIZE);
+         }
 #endif
+
+         //Add the socket to the relevant list of active sockets
+         socketAddToList(socket);
       }
    }
 
@@ -185,6 +219,186 @@ Socket *socketAllocate(uint_t type, uint_t protocol)
 }
 
 
+/**
+ * @brief Release a socket
+ * @param[in] socket Handle referencing the socket to be released
+ **/
+
+void socketFree(Socket *socket)
+{
+   Socket **list;
+
+   //Point to the list the socket belongs to
+   list = socketGetList(socket->type);
+
+   //Remove the socket from the list of active sockets
+   if(list != NULL)
+   {
+      //Search the list for the current socket
+      while(*list != NULL && *list != socket)
+      {
+         list = &(*list)->next;
+      }
+
+      //Unlink the socket
+      if(*list != NULL)
+      {
+         *list = socket->next;
+      }
+   }
+
+   //Detach the socket from its ready list, if any
+   if(socket->readyEntry != NULL)
+   {
+      socketReadyListDetach(socket);
+   }
+
+#if (BPF_SUPPORT == ENABLED)
+   //Release the packet filter, if any
+   if(socket->filter != NULL)
+   {
+      memPoolFree(socket->filter);
+      socket->filter = NULL;
+   }
+#endif
+
+   //Mark the socket as closed
+   socket->type = SOCKET_TYPE_UNUSED;
+   socket->next = NULL;
+
+#if (SOCKET_DYNAMIC_ALLOC_SUPPORT == ENABLED)
+   //The descriptor is now free
+   socketTable[socket->descriptor] = NULL;
+
+   //Release resources
+   osDeleteEvent(&socket->event);
+   osFreeMem(socket);
+#endif
+}
+
+
+/**
+ * @brief Search the socket table for a free descriptor
+ * @return Index of the free descriptor. SOCKET_MAX_COUNT is returned if
+ *   the socket table runs out of space
+ **/
+
+uint_t socketGetFreeDescriptor(void)
+{
+   uint_t i;
+
+   //Loop through socket descriptors
+   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   {
+#if (SOCKET_DYNAMIC_ALLOC_SUPPORT == ENABLED)
+      //No control block attached to the descriptor?
+      if(socketTable[i] == NULL)
+         break;
+#else
+      //Unused socket found?
+      if(socketTable[i]->type == SOCKET_TYPE_UNUSED)
+         break;
+#endif
+   }
+
+   //Return the index of the free descriptor
+   return i;
+}
+
+
+/**
+ * @brief Get the size of the control block for a given socket type
+ * @param[in] type Socket type
+ * @return Size of the control block, in bytes
+ **/
+
+size_t socketGetControlBlockSize(uint_t type)
+{
+   size_t size;
+
+#if (TCP_SUPPORT == ENABLED)
+   //TCP sockets require the full control block
+   if(type == SOCKET_TYPE_STREAM)
+   {
+      size = sizeof(Socket);
+   }
+   else
+   {
+      //The TCP specific variables are placed at the end of the structure
+      size = offsetof(Socket, state);
+   }
+#else
+   //Full control block
+   size = sizeof(Socket);
+#endif
+
+   //Return the size of the control block
+   return size;
+}
+
+
+/**
+ * @brief Get the list of active sockets for a given socket type
+ * @param[in] type Socket type
+ * @return Pointer to the head of the list
+ **/
+
+Socket **socketGetList(uint_t type)
+{
+   Socket **list;
+
+   //Check socket type
+   if(type == SOCKET_TYPE_STREAM)
+   {
+      list = &tcpSocketList;
+   }
+   else if(type == SOCKET_TYPE_DGRAM)
+   {
+      list = &udpSocketList;
+   }
+   else if(type == SOCKET_TYPE_RAW_IP || type == SOCKET_TYPE_RAW_ETH)
+   {
+      list = &rawSocketList;
+   }
+   else
+   {
+      list = NULL;
+   }
+
+   //Return a pointer to the head of the list
+   return list;
+}
+
+
+/**
+ * @brief Add a socket to the relevant list of active sockets
+ * @param[in] socket Handle referencing the socket
+ **/
+
+void socketAddToList(Socket *socket)
+{
+   Socket **list;
+
+   //Point to the list matching the socket type
+   list = socketGetList(socket->type);
+
+   //Valid socket type?
+   if(list != NULL)
+   {
+      //Sockets are kept in descriptor order so that lookups return the
+      //same match as a scan of the socket table
+      while(*list != NULL && (*list)->descriptor < socket->descriptor)
+      {
+         list = &(*list)->next;
+      }
+
+      //Insert the socket
+      socket->next = *list;
+      *list = socket;
+   }
+}
+
+
 /**
  * @brief Subscribe to the specified socket events
  * @param[in] socket Handle that identifies a socket
@@ -213,28 +427,8 @@ void socketRegisterEvents(Socket *socket, OsEvent *event, uint_t eventMask)
       //Suscribe to get notified of events
       socket->userEvent = event;
 
-#if (TCP_SUPPORT == ENABLED)
-      //Handle TCP specific events
-      if(socket->type == SOCKET_TYPE_STREAM)
-      {
-         tcpUpdateEvents(socket);
-      }
-#endif
-#if (UDP_SUPPORT == ENABLED)
-      //Handle UDP specific events
-      if(socket->type == SOCKET_TYPE_DGRAM)
-      {
-         udpUpdateEvents(socket);
-      }
-#endif
-#if (RAW_SOCKET_SUPPORT == ENABLED)
-      //Handle events that are specific to raw sockets
-      if(socket->type == SOCKET_TYPE_RAW_IP ||
-         socket->type == SOCKET_TYPE_RAW_ETH)
-      {
-         rawSocketUpdateEvents(socket);
-      }
-#endif
+      //Update the state of events
+      socketUpdateEvents(socket);
 
       //Release exclusive access
       osReleaseMutex(&netMutex);
@@ -295,3 +489,556 @@ uint_t socketGetEvents(Socket *socket)
    //Return the events in the signaled state
    return eventFlags;
 }
+
+
+/**
+ * @brief Update the state of the events of a given socket
+ * @param[in] socket Handle that identifies a socket
+ **/
+
+void socketUpdateEvents(Socket *socket)
+{
+#if (TCP_SUPPORT == ENABLED)
+   //Handle TCP specific events
+   if(socket->type == SOCKET_TYPE_STREAM)
+   {
+      tcpUpdateEvents(socket);
+   }
+#endif
+#if (UDP_SUPPORT == ENABLED)
+   //Handle UDP specific events
+   if(socket->type == SOCKET_TYPE_DGRAM)
+   {
+      udpUpdateEvents(socket);
+   }
+#endif
+#if (RAW_SOCKET_SUPPORT == ENABLED)
+   //Handle events that are specific to raw sockets
+   if(socket->type == SOCKET_TYPE_RAW_IP ||
+      socket->type == SOCKET_TYPE_RAW_ETH)
+   {
+      rawSocketUpdateEvents(socket);
+   }
+#endif
+}
+
+
+/**
+ * @brief Busy-poll the network interfaces on behalf of a socket
+ *
+ * The calling task processes the pending NIC events itself until one of the
+ * events the socket is waiting for is signaled or the busy-poll duration
+ * elapses. The netMutex must be held by the caller, and the event mask of
+ * the socket must be set before calling this function
+ *
+ * @param[in] socket Handle that identifies a socket
+ * @param[in] timeout Timeout of the blocking operation
+ * @return Remaining time before the blocking operation times out
+ **/
+
+systime_t socketBusyPoll(Socket *socket, systime_t timeout)
+{
+#if (SOCKET_BUSY_POLL_SUPPORT == ENABLED)
+   uint_t i;
+   systime_t duration;
+   systime_t startTime;
+   systime_t elapsed;
+
+   //Busy-poll mode disabled?
+   if(socket->busyPollTime == 0)
+      return timeout;
+
+   //The busy-poll duration cannot exceed the timeout of the operation
+   duration = MIN(socket->busyPollTime, timeout);
+   //Save current time
+   startTime = osGetSystemTime();
+
+   //Busy-poll loop
+   while(1)
+   {
+      //Process pending NIC events inline
+      for(i = 0; i < NET_INTERFACE_COUNT; i++)
+      {
+         nicProcessEvents(&netInterface[i]);
+      }
+
+      //Update the state of events
+      socketUpdateEvents(socket);
+
+      //Time spent busy-polling
+      elapsed = osGetSystemTime() - startTime;
+
+      //Any event the socket is waiting for?
+      if(socket->eventFlags != 0)
+         break;
+
+      //Busy-poll duration elapsed?
+      if(elapsed >= duration)
+         break;
+
+      //Give other tasks a chance to access the stack
+      osReleaseMutex(&netMutex);
+      osAcquireMutex(&netMutex);
+   }
+
+   //An infinite timeout never elapses
+   if(timeout != INFINITE_DELAY)
+   {
+      //Deduct the time spent busy-polling from the timeout
+      timeout = (elapsed < timeout) ? (timeout - elapsed) : 0;
+   }
+#endif
+
+   //Return the remaining time
+   return timeout;
+}
+
+
+/**
+ * @brief Initialize a ready list
+ * @param[in] list Pointer to the ready list
+ * @return Error code
+ **/
+
+error_t socketReadyListInit(SocketReadyList *list)
+{
+   //Make sure the ready list is valid
+   if(list == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Clear the ready list
+   osMemset(list, 0, sizeof(SocketReadyList));
+
+   //Create an event object to get notified when an entry becomes ready
+   if(!osCreateEvent(&list->event))
+   {
+      return ERROR_OUT_OF_RESOURCES;
+   }
+
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Add a socket to the interest set of a ready list
+ * @param[in] list Pointer to the ready list
+ * @param[in] socket Handle that identifies a socket
+ * @param[in] eventMask Logic OR of the requested socket events
+ * @param[in] flags Notification flags (see SocketReadyFlags enumeration)
+ * @param[in] param User-defined value returned along with the events
+ * @return Error code
+ **/
+
+error_t socketReadyListAdd(SocketReadyList *list, Socket *socket,
+   uint_t eventMask, uint_t flags, uint64_t param)
+{
+   error_t error;
+   SocketReadyEntry *entry;
+
+   //Check parameters
+   if(list == NULL || socket == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //A socket can be attached to a single ready list at a time
+   if(socket->type == SOCKET_TYPE_UNUSED)
+   {
+      error = ERROR_INVALID_SOCKET;
+   }
+   else if(socket->readyEntry != NULL)
+   {
+      error = ERROR_ALREADY_CONFIGURED;
+   }
+   else
+   {
+      //Point to the entry that matches the socket descriptor
+      entry = &list->entries[socket->descriptor];
+
+      //Initialize entry
+      entry->socket = socket;
+      entry->eventMask = eventMask;
+      entry->eventFlags = 0;
+      entry->flags = flags;
+      entry->param = param;
+      entry->queued = FALSE;
+      entry->list = list;
+      entry->next = NULL;
+
+      //Attach the socket to the ready list
+      socket->readyEntry = entry;
+
+      //Check whether the socket is already in the signaled state
+      socketUpdateEvents(socket);
+
+      //Successful processing
+      error = NO_ERROR;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Change the events monitored for a given socket
+ * @param[in] list Pointer to the ready list
+ * @param[in] socket Handle that identifies a socket
+ * @param[in] eventMask Logic OR of the requested socket events
+ * @param[in] flags Notification flags (see SocketReadyFlags enumeration)
+ * @param[in] param User-defined value returned along with the events
+ * @return Error code
+ **/
+
+error_t socketReadyListModify(SocketReadyList *list, Socket *socket,
+   uint_t eventMask, uint_t flags, uint64_t param)
+{
+   error_t error;
+   SocketReadyEntry *entry;
+
+   //Check parameters
+   if(list == NULL || socket == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Point to the entry the socket is attached to
+   entry = socket->readyEntry;
+
+   //The socket must belong to the interest set of the ready list
+   if(entry != NULL && entry->list == list)
+   {
+      //Update entry
+      entry->eventMask = eventMask;
+      entry->flags = flags;
+      entry->param = param;
+
+      //Re-evaluate the state of the socket against the new mask
+      socketUpdateEvents(socket);
+
+      //Successful processing
+      error = NO_ERROR;
+   }
+   else
+   {
+      //The socket is not monitored by the ready list
+      error = ERROR_NOT_FOUND;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Remove a socket from the interest set of a ready list
+ * @param[in] list Pointer to the ready list
+ * @param[in] socket Handle that identifies a socket
+ * @return Error code
+ **/
+
+error_t socketReadyListRemove(SocketReadyList *list, Socket *socket)
+{
+   error_t error;
+
+   //Check parameters
+   if(list == NULL || socket == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //The socket must belong to the interest set of the ready list
+   if(socket->readyEntry != NULL && socket->readyEntry->list == list)
+   {
+      //Detach the socket from the ready list
+      socketReadyListDetach(socket);
+      //Successful processing
+      error = NO_ERROR;
+   }
+   else
+   {
+      //The socket is not monitored by the ready list
+      error = ERROR_NOT_FOUND;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Wait for sockets of the interest set to become ready
+ *
+ * The events are stored by the callback straight into the array supplied by
+ * the caller. The callback is invoked while holding the netMutex
+ *
+ * @param[in] list Pointer to the ready list
+ * @param[in] callback Callback function that stores an event
+ * @param[out] events Array where to store the events in the signaled state
+ * @param[in] maxEvents Maximum number of events to return
+ * @param[in] timeout Maximum time to wait
+ * @return Number of events returned
+ **/
+
+uint_t socketReadyListWait(SocketReadyList *list, SocketReadyCallback callback,
+   void *events, uint_t maxEvents, systime_t timeout)
+{
+   uint_t n;
+   uint_t eventFlags;
+   systime_t time;
+   systime_t startTime;
+   SocketReadyEntry *entry;
+   SocketReadyEntry *pending;
+
+   //Check parameters
+   if(list == NULL || callback == NULL || events == NULL || maxEvents == 0)
+      return 0;
+
+   //Save current time
+   startTime = osGetSystemTime();
+
+   //Wait for at least one event
+   while(1)
+   {
+      //Get exclusive access
+      osAcquireMutex(&netMutex);
+
+      //Detach the entries currently linked in the ready list
+      pending = list->head;
+      list->head = NULL;
+      list->tail = NULL;
+
+      //Only the entries in the ready list have to be examined
+      for(n = 0; pending != NULL; )
+      {
+         //Point to the current entry
+         entry = pending;
+         pending = entry->next;
+
+         //Unlink the entry
+         entry->next = NULL;
+         entry->queued = FALSE;
+
+         //Retrieve the events that are still in the signaled state
+         eventFlags = entry->eventFlags & entry->eventMask;
+
+         //Check whether the socket is still ready
+         if(eventFlags == 0)
+         {
+            //The entry is linked again as soon as the socket is signaled
+         }
+         else if(n >= maxEvents)
+         {
+            //The event will be reported by a subsequent call
+            socketReadyListEnqueue(list, entry);
+         }
+         else
+         {
+            //Report the events
+            callback(events, n, entry->socket, eventFlags, entry->param);
+            n++;
+
+            //Check notification flags
+            if((entry->flags & SOCKET_READY_FLAG_ONE_SHOT) != 0)
+            {
+               //One-shot entries are disabled once an event has been reported
+               entry->eventMask = 0;
+            }
+            else if((entry->flags & SOCKET_READY_FLAG_EDGE_TRIGGERED) == 0)
+            {
+               //Level-triggered entries stay in the ready list as long as
+               //the socket is in the signaled state
+               socketReadyListEnqueue(list, entry);
+            }
+            else
+            {
+               //Edge-triggered entries are reported once per state change
+            }
+         }
+      }
+
+      //Release exclusive access
+      osReleaseMutex(&netMutex);
+
+      //Any event to report?
+      if(n > 0)
+         break;
+
+      //Get current time
+      time = osGetSystemTime() - startTime;
+
+      //Timeout error?
+      if(timeout != INFINITE_DELAY && time >= timeout)
+         break;
+
+      //Wait until an entry is linked in the ready list
+      osWaitForEvent(&list->event, (timeout != INFINITE_DELAY) ?
+         (timeout - time) : INFINITE_DELAY);
+   }
+
+   //Return the number of events
+   return n;
+}
+
+
+/**
+ * @brief Notify the ready list a socket is attached to
+ *
+ * This function is called each time the state of the events of a socket is
+ * updated. The netMutex must be held by the caller
+ *
+ * @param[in] socket Handle that identifies a socket
+ **/
+
+void socketReadyListUpdate(Socket *socket)
+{
+   SocketReadyEntry *entry;
+
+   //Point to the entry the socket is attached to
+   entry = socket->readyEntry;
+
+   //Any ready list to notify?
+   if(entry != NULL)
+   {
+      //Save the events in the signaled state
+      entry->eventFlags = socket->eventFlags;
+
+      //Any requested event?
+      if((entry->eventFlags & entry->eventMask) != 0 && !entry->queued)
+      {
+         //Append the entry to the ready list
+         socketReadyListEnqueue(entry->list, entry);
+         //Wake up the task waiting on the ready list
+         osSetEvent(&entry->list->event);
+      }
+   }
+}
+
+
+/**
+ * @brief Append an entry to a ready list
+ * @param[in] list Pointer to the ready list
+ * @param[in] entry Entry to be appended
+ **/
+
+void socketReadyListEnqueue(SocketReadyList *list, SocketReadyEntry *entry)
+{
+   //Link the entry at the end of the ready list
+   entry->next = NULL;
+   entry->queued = TRUE;
+
+   if(list->tail != NULL)
+   {
+      list->tail->next = entry;
+   }
+   else
+   {
+      list->head = entry;
+   }
+
+   list->tail = entry;
+}
+
+
+/**
+ * @brief Detach a socket from its ready list
+ *
+ * The netMutex must be held by the caller
+ *
+ * @param[in] socket Handle that identifies a socket
+ **/
+
+void socketReadyListDetach(Socket *socket)
+{
+   SocketReadyList *list;
+   SocketReadyEntry *p;
+   SocketReadyEntry *entry;
+   SocketReadyEntry *prevEntry;
+
+   //Point to the entry the socket is attached to
+   entry = socket->readyEntry;
+   //Point to the ready list
+   list = entry->list;
+
+   //Unlink the entry from the ready list
+   if(entry->queued)
+   {
+      //Search the ready list for the previous entry
+      prevEntry = NULL;
+
+      for(p = list->head; p != NULL && p != entry; p = p->next)
+      {
+         prevEntry = p;
+      }
+
+      //Remove the entry
+      if(prevEntry != NULL)
+      {
+         prevEntry->next = entry->next;
+      }
+      else
+      {
+         list->head = entry->next;
+      }
+
+      //Update the tail of the list
+      if(list->tail == entry)
+      {
+         list->tail = prevEntry;
+      }
+   }
+
+   //Release entry
+   osMemset(entry, 0, sizeof(SocketReadyEntry));
+   //The socket is no longer monitored
+   socket->readyEntry = NULL;
+}
+
+
+/**
+ * @brief Release a ready list
+ * @param[in] list Pointer to the ready list
+ **/
+
+void socketReadyListDeinit(SocketReadyList *list)
+{
+   uint_t i;
+
+   //Valid ready list?
+   if(list != NULL)
+   {
+      //Get exclusive access
+      osAcquireMutex(&netMutex);
+
+      //Detach all the sockets of the interest set
+      for(i = 0; i < SOCKET_MAX_COUNT; i++)
+      {
+         if(list->entries[i].socket != NULL)
+         {
+            list->entries[i].socket->readyEntry = NULL;
+         }
+      }
+
+      //Release exclusive access
+      osReleaseMutex(&netMutex);
+
+      //Delete event object
+      osDeleteEvent(&list->event);
+
+      //Clear the ready list
+      osMemset(list, 0, sizeof(SocketReadyList));
+   }
+}
@@ -40,12 +40,93 @@
 extern "C" {
 #endif
 
+
+/**
+ * @brief Ready list flags
+ **/
+
+typedef enum
+{
+   SOCKET_READY_FLAG_EDGE_TRIGGERED = 0x01, ///<Report state transitions only
+   SOCKET_READY_FLAG_ONE_SHOT       = 0x02  ///<Disable the entry after one event
+} SocketReadyFlags;
+
+
+/**
+ * @brief Ready list entry
+ **/
+
+typedef struct _SocketReadyEntry
+{
+   Socket *socket;                  ///<Socket being monitored
+   uint_t eventMask;                ///<Requested events
+   uint_t eventFlags;               ///<Events in the signaled state
+   uint_t flags;                    ///<Notification flags
+   uint64_t param;                  ///<User-defined value
+   bool_t queued;                   ///<The entry is linked in the ready list
+   struct _SocketReadyList *list;   ///<Ready list the entry belongs to
+   struct _SocketReadyEntry *next;  ///<Next entry in the ready list
+} SocketReadyEntry;
+
+
+/**
+ * @brief Ready list
+ *
+ * The interest set persists across calls. Sockets link their entry into
+ * the ready list as soon as one of the requested events is signaled, so
+ * that waiting for events does not require to scan the whole set
+ *
+ **/
+
+typedef struct _SocketReadyList
+{
+   OsEvent event;                               ///<Event signaled when an entry becomes ready
+   SocketReadyEntry *head;                      ///<First entry in the ready list
+   SocketReadyEntry *tail;                      ///<Last entry in the ready list
+   SocketReadyEntry entries[SOCKET_MAX_COUNT];  ///<Interest set (indexed by socket descriptor)
+} SocketReadyList;
+
+
+/**
+ * @brief Callback used to report the events of a ready list
+ **/
+
+typedef void (*SocketReadyCallback)(void *events, uint_t index,
+   Socket *socket, uint_t eventFlags, uint64_t param);
+
+
 //Socket related functions
 Socket *socketAllocate(uint_t type, uint_t protocol);
+void socketFree(Socket *socket);
+
+uint_t socketGetFreeDescriptor(void);
+size_t socketGetControlBlockSize(uint_t type);
+Socket **socketGetList(uint_t type);
+void socketAddToList(Socket *socket);
 
 void socketRegisterEvents(Socket *socket, OsEvent *event, uint_t eventMask);
 void socketUnregisterEvents(Socket *socket);
 uint_t socketGetEvents(Socket *socket);
+void socketUpdateEvents(Socket *socket);
+systime_t socketBusyPoll(Socket *socket, systime_t timeout);
+
+error_t socketReadyListInit(SocketReadyList *list);
+
+error_t socketReadyListAdd(SocketReadyList *list, Socket *socket,
+   uint_t eventMask, uint_t flags, uint64_t param);
+
+error_t socketReadyListModify(SocketReadyList *list, Socket *socket,
+   uint_t eventMask, uint_t flags, uint64_t param);
+
+error_t socketReadyListRemove(SocketReadyList *list, Socket *socket);
+
+uint_t socketReadyListWait(SocketReadyList *list, SocketReadyCallback callback,
+   void *events, uint_t maxEvents, systime_t timeout);
+
+void socketReadyListUpdate(Socket *socket);
+void socketReadyListEnqueue(SocketReadyList *list, SocketReadyEntry *entry);
+void socketReadyListDetach(Socket *socket);
+void socketReadyListDeinit(SocketReadyList *list);
 
 //C++ guard
 #ifdef __cplusplus
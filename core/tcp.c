@@ -45,12 +45,6 @@
 //Check TCP/IP stack configuration
 #if (TCP_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t tcpTickCounter;
-
-//Ephemeral ports are used for dynamic port assignment
-static uint16_t tcpDynamicPort;
-
 
 /**
  * @brief TCP related initialization
@@ -60,7 +54,7 @@ static uint16_t tcpDynamicPort;
 error_t tcpInit(void)
 {
    //Reset ephemeral port number
-   tcpDynamicPort = 0;
+   netContext.socketContext->tcpDynamicPort = 0;
 
    //Successful initialization
    return NO_ERROR;
@@ -108,7 +102,7 @@ uint16_t tcpGetDynamicPort(void)
    uint_t port;
 
    //Retrieve current port number
-   port = tcpDynamicPort;
+   port = netContext.socketContext->tcpDynamicPort;
 
    //Invalid port number?
    if(port < SOCKET_EPHEMERAL_PORT_MIN || port > SOCKET_EPHEMERAL_PORT_MAX)
@@ -122,12 +116,12 @@ uint16_t tcpGetDynamicPort(void)
    if(port < SOCKET_EPHEMERAL_PORT_MAX)
    {
       //Increment port number
-      tcpDynamicPort = port + 1;
+      netContext.socketContext->tcpDynamicPort = port + 1;
    }
    else
    {
       //Wrap around if necessary
-      tcpDynamicPort = SOCKET_EPHEMERAL_PORT_MIN;
+      netContext.socketContext->tcpDynamicPort = SOCKET_EPHEMERAL_PORT_MIN;
    }
 
    //Return an ephemeral port number
@@ -189,6 +183,13 @@ error_t tcpConnect(Socket *socket, const IpAddr *remoteIpAddr,
       socket->txBuffer.maxChunkCount = arraysize(socket->txBuffer.chunk);
       socket->rxBuffer.maxChunkCount = arraysize(socket->rxBuffer.chunk);
 
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+      //The buffers may still be held from a previous connection
+      netContext.socketContext->tcpBufferUsage -=
+         netBufferGetLength((NetBuffer *) &socket->txBuffer) +
+         netBufferGetLength((NetBuffer *) &socket->rxBuffer);
+#endif
+
       //Allocate transmit buffer
       error = netBufferSetLength((NetBuffer *) &socket->txBuffer,
          socket->txBufferSize);
@@ -200,6 +201,13 @@ error_t tcpConnect(Socket *socket, const IpAddr *remoteIpAddr,
             socket->rxBufferSize);
       }
 
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+      //Charge the memory held by the buffers to the budget
+      netContext.socketContext->tcpBufferUsage +=
+         netBufferGetLength((NetBuffer *) &socket->txBuffer) +
+         netBufferGetLength((NetBuffer *) &socket->rxBuffer);
+#endif
+
       //Failed to allocate memory?
       if(error)
       {
@@ -212,6 +220,8 @@ error_t tcpConnect(Socket *socket, const IpAddr *remoteIpAddr,
       //The SMSS is the size of the largest segment that the sender can
       //transmit
       socket->smss = MIN(socket->mss, TCP_DEFAULT_MSS);
+      //The SMSS may be restored up to this value when the PMTU increases
+      socket->peerMss = socket->smss;
 
       //The RMSS is the size of the largest segment the receiver is willing
       //to accept
@@ -224,6 +234,7 @@ error_t tcpConnect(Socket *socket, const IpAddr *remoteIpAddr,
       //Initialize TCP control block
       socket->sndUna = socket->iss;
       socket->sndNxt = socket->iss + 1;
+      socket->txBufferStart = socket->iss + 1;
       socket->rcvNxt = 0;
       socket->rcvUser = 0;
       socket->rcvWnd = socket->rxBufferSize;
@@ -388,6 +399,12 @@ Socket *tcpAccept(Socket *socket, IpAddr *clientIpAddr, uint16_t *clientPort)
          newSocket->txBufferSize = socket->txBufferSize;
          newSocket->rxBufferSize = socket->rxBufferSize;
 
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+         //Buffer sizes chosen by the application are not autotuned
+         newSocket->txBufferLocked = socket->txBufferLocked;
+         newSocket->rxBufferLocked = socket->rxBufferLocked;
+#endif
+
 #if (TCP_KEEP_ALIVE_SUPPORT == ENABLED)
          //Inherit keep-alive parameters from the listening socket
          newSocket->keepAliveEnabled = socket->keepAliveEnabled;
@@ -411,6 +428,13 @@ Socket *tcpAccept(Socket *socket, IpAddr *clientIpAddr, uint16_t *clientPort)
                newSocket->rxBufferSize);
          }
 
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+         //Charge the memory held by the buffers to the budget
+         netContext.socketContext->tcpBufferUsage +=
+            netBufferGetLength((NetBuffer *) &newSocket->txBuffer) +
+            netBufferGetLength((NetBuffer *) &newSocket->rxBuffer);
+#endif
+
          //Transmit and receive buffers successfully allocated?
          if(!error)
          {
@@ -428,6 +452,10 @@ Socket *tcpAccept(Socket *socket, IpAddr *clientIpAddr, uint16_t *clientPort)
             //The SMSS is the size of the largest segment that the sender can
             //transmit
             newSocket->smss = queueItem->mss;
+            //The SMSS may be restored up to this value when the PMTU increases
+            newSocket->peerMss = newSocket->smss;
+            //The SMSS must not exceed the PMTU estimate for the path
+            tcpUpdateSmss(newSocket);
 
             //The RMSS is the size of the largest segment the receiver is
             //willing to accept
@@ -443,6 +471,8 @@ Socket *tcpAccept(Socket *socket, IpAddr *clientIpAddr, uint16_t *clientPort)
             newSocket->sndUna = newSocket->iss;
             newSocket->sndNxt = newSocket->iss + 1;
             newSocket->rcvNxt = newSocket->irs + 1;
+            newSocket->txBufferStart = newSocket->iss + 1;
+            newSocket->rxBufferStart = newSocket->irs + 1;
             newSocket->rcvUser = 0;
             newSocket->rcvWnd = newSocket->rxBufferSize;
 
@@ -472,6 +502,12 @@ Socket *tcpAccept(Socket *socket, IpAddr *clientIpAddr, uint16_t *clientPort)
             //The connection state should be changed to SYN-RECEIVED
             tcpChangeState(newSocket, TCP_STATE_SYN_RECEIVED);
 
+#if (NET_STATS_SUPPORT == ENABLED)
+            //Time elapsed since the connection request was received
+            netStatsRecord(NET_STATS_ACCEPT, NET_STATS_GET_TIME_US() -
+               queueItem->timestamp);
+#endif
+
             //Number of times TCP connections have made a direct transition to
             //the SYN-RECEIVED state from the LISTEN state
             MIB2_TCP_INC_COUNTER32(tcpPassiveOpens, 1);
@@ -974,8 +1010,8 @@ error_t tcpAbort(Socket *socket)
       tcpChangeState(socket, TCP_STATE_CLOSED);
       //Delete TCB
       tcpDeleteControlBlock(socket);
-      //Mark the socket as closed
-      socket->type = SOCKET_TYPE_UNUSED;
+      //Release the socket
+      socketFree(socket);
       //Return status code
       return error;
 
@@ -992,8 +1028,8 @@ error_t tcpAbort(Socket *socket)
       tcpChangeState(socket, TCP_STATE_CLOSED);
       //Delete TCB
       tcpDeleteControlBlock(socket);
-      //Mark the socket as closed
-      socket->type = SOCKET_TYPE_UNUSED;
+      //Release the socket
+      socketFree(socket);
       //No error to report
       return NO_ERROR;
 #endif
@@ -1004,8 +1040,8 @@ error_t tcpAbort(Socket *socket)
       tcpChangeState(socket, TCP_STATE_CLOSED);
       //Delete TCB
       tcpDeleteControlBlock(socket);
-      //Mark the socket as closed
-      socket->type = SOCKET_TYPE_UNUSED;
+      //Release the socket
+      socketFree(socket);
       //No error to report
       return NO_ERROR;
    }
@@ -1036,15 +1072,98 @@ TcpState tcpGetState(Socket *socket)
 }
 
 
+/**
+ * @brief Retrieve per-connection telemetry
+ * @param[in] socket Handle referencing the socket
+ * @param[out] info Snapshot of the connection state and counters
+ * @return Error code
+ **/
+
+error_t tcpGetInfo(Socket *socket, TcpInfo *info)
+{
+#if (TCP_INFO_SUPPORT == ENABLED)
+   //Check parameters
+   if(socket == NULL || info == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Clear the structure
+   osMemset(info, 0, sizeof(TcpInfo));
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Account for the time spent in the current limit state
+   tcpUpdateLimit(socket, socket->limit);
+
+   //Connection state
+   info->state = (uint8_t) socket->state;
+#if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
+   info->congestState = (uint8_t) socket->congestState;
+#endif
+
+   //Round-trip time estimation
+   info->rto = (uint32_t) socket->rto;
+   info->srtt = (uint32_t) socket->srtt;
+   info->rttvar = (uint32_t) socket->rttvar;
+
+   //Segment sizes and windows
+   info->smss = socket->smss;
+   info->rmss = socket->rmss;
+#if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
+   info->cwnd = socket->cwnd;
+   info->ssthresh = socket->ssthresh;
+#endif
+   info->sndWnd = socket->sndWnd;
+   info->rcvWnd = socket->rcvWnd;
+
+   //Queue occupancy
+   info->unacked = socket->sndNxt - socket->sndUna;
+   info->sndBuffered = socket->sndUser;
+   info->rcvBuffered = socket->rcvUser;
+
+   //Loss recovery
+   info->retransmits = socket->retransmitCount;
+#if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
+   info->dupAcks = socket->dupAckCount;
+#endif
+
+   //Cumulative counters
+   info->segsOut = socket->segsOut;
+   info->segsIn = socket->segsIn;
+   info->totalRetrans = socket->totalRetrans;
+   info->bytesSent = socket->bytesSent;
+   info->bytesRetrans = socket->bytesRetrans;
+   info->bytesAcked = socket->bytesAcked;
+   info->bytesReceived = socket->bytesReceived;
+
+   //Time spent in each limit state
+   info->cwndLimited = (uint32_t) socket->cwndLimitedTime;
+   info->rwndLimited = (uint32_t) socket->rwndLimitedTime;
+   info->appLimited = (uint32_t) socket->appLimitedTime;
+
+   //Most recent delivery rate sample
+   info->deliveryRate = socket->deliveryRate;
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
 /**
  * @brief Kill the oldest socket in the TIME-WAIT state
- * @return Handle identifying the oldest TCP connection in the TIME-WAIT state.
- *   NULL is returned if no socket is currently in the TIME-WAIT state
+ * @return Error code. ERROR_NOT_FOUND is returned if no socket is currently
+ *   in the TIME-WAIT state
  **/
 
-Socket *tcpKillOldestConnection(void)
+error_t tcpKillOldestConnection(void)
 {
-   uint_t i;
    systime_t time;
    Socket *socket;
    Socket *oldestSocket;
@@ -1055,12 +1174,9 @@ Socket *tcpKillOldestConnection(void)
    //Keep track of the oldest socket in the TIME-WAIT state
    oldestSocket = NULL;
 
-   //Loop through socket descriptors
-   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   //Loop through active TCP sockets
+   for(socket = tcpSocketList; socket != NULL; socket = socket->next)
    {
-      //Point to the current socket descriptor
-      socket = &socketTable[i];
-
       //TCP connection found?
       if(socket->type == SOCKET_TYPE_STREAM)
       {
@@ -1090,13 +1206,13 @@ Socket *tcpKillOldestConnection(void)
       tcpChangeState(oldestSocket, TCP_STATE_CLOSED);
       //Delete TCB
       tcpDeleteControlBlock(oldestSocket);
-      //Mark the socket as closed
-      oldestSocket->type = SOCKET_TYPE_UNUSED;
+      //Release the socket
+      socketFree(oldestSocket);
    }
 
-   //The oldest connection in the TIME-WAIT state can be reused
-   //when the socket table runs out of space
-   return oldestSocket;
+   //The descriptor of the oldest connection in the TIME-WAIT state can be
+   //reused when the socket table runs out of space
+   return (oldestSocket != NULL) ? NO_ERROR : ERROR_NOT_FOUND;
 }
 
 #endif
@@ -91,6 +91,35 @@
    #error TCP_MAX_RX_BUFFER_SIZE parameter is not valid
 #endif
 
+//Send and receive buffer autotuning
+#ifndef TCP_AUTOTUNE_SUPPORT
+   #define TCP_AUTOTUNE_SUPPORT DISABLED
+#elif (TCP_AUTOTUNE_SUPPORT != ENABLED && TCP_AUTOTUNE_SUPPORT != DISABLED)
+   #error TCP_AUTOTUNE_SUPPORT parameter is not valid
+#endif
+
+//Minimum interval between receive buffer measurements (in milliseconds)
+#ifndef TCP_AUTOTUNE_MIN_INTERVAL
+   #define TCP_AUTOTUNE_MIN_INTERVAL 10
+#elif (TCP_AUTOTUNE_MIN_INTERVAL < 1)
+   #error TCP_AUTOTUNE_MIN_INTERVAL parameter is not valid
+#endif
+
+//Memory budget shared by the TCP send and receive buffers (in bytes, 0 means
+//that the budget is not enforced)
+#ifndef TCP_AUTOTUNE_MEM_BUDGET
+   #define TCP_AUTOTUNE_MEM_BUDGET 0
+#elif (TCP_AUTOTUNE_MEM_BUDGET < 0)
+   #error TCP_AUTOTUNE_MEM_BUDGET parameter is not valid
+#endif
+
+//Memory pool or budget occupancy above which buffers are shrunk (in percent)
+#ifndef TCP_AUTOTUNE_PRESSURE_THRESHOLD
+   #define TCP_AUTOTUNE_PRESSURE_THRESHOLD 75
+#elif (TCP_AUTOTUNE_PRESSURE_THRESHOLD < 1 || TCP_AUTOTUNE_PRESSURE_THRESHOLD > 100)
+   #error TCP_AUTOTUNE_PRESSURE_THRESHOLD parameter is not valid
+#endif
+
 //Default SYN queue size for listening sockets
 #ifndef TCP_DEFAULT_SYN_QUEUE_SIZE
    #define TCP_DEFAULT_SYN_QUEUE_SIZE 4
@@ -245,6 +274,13 @@
    #error TCP_MAX_SACK_BLOCKS parameter is not valid
 #endif
 
+//Per-connection telemetry (TCP_INFO)
+#ifndef TCP_INFO_SUPPORT
+   #define TCP_INFO_SUPPORT DISABLED
+#elif (TCP_INFO_SUPPORT != ENABLED && TCP_INFO_SUPPORT != DISABLED)
+   #error TCP_INFO_SUPPORT parameter is not valid
+#endif
+
 //Maximum TCP header length
 #define TCP_MAX_HEADER_LENGTH 60
 //Default maximum segment size
@@ -291,6 +327,19 @@ typedef enum
 } TcpCongestState;
 
 
+/**
+ * @brief Factor limiting the sender
+ **/
+
+typedef enum
+{
+   TCP_LIMIT_NONE = 0, ///<The sender is not limited
+   TCP_LIMIT_CWND = 1, ///<Limited by the congestion window
+   TCP_LIMIT_RWND = 2, ///<Limited by the receiver window
+   TCP_LIMIT_APP  = 3  ///<Limited by the application (no data to send)
+} TcpLimit;
+
+
 /**
  * @brief TCP control flags
  **/
@@ -408,9 +457,52 @@ typedef struct _TcpSynQueueItem
 #if (TCP_SACK_SUPPORT == ENABLED)
    bool_t sackPermitted;
 #endif
+#if (NET_STATS_SUPPORT == ENABLED)
+   uint32_t timestamp;
+#endif
 } TcpSynQueueItem;
 
 
+/**
+ * @brief Per-connection telemetry
+ *
+ * The layout of this structure is stable: new fields are only ever
+ * appended at the end
+ **/
+
+typedef struct
+{
+   uint8_t state;          ///<Current state of the TCP FSM
+   uint8_t congestState;   ///<Congestion state
+   uint16_t reserved;      ///<Reserved field
+   uint32_t rto;           ///<Retransmission timeout, in milliseconds
+   uint32_t srtt;          ///<Smoothed round-trip time, in milliseconds
+   uint32_t rttvar;        ///<Round-trip time variation, in milliseconds
+   uint32_t smss;          ///<Sender maximum segment size
+   uint32_t rmss;          ///<Receiver maximum segment size
+   uint32_t cwnd;          ///<Congestion window, in bytes
+   uint32_t ssthresh;      ///<Slow start threshold, in bytes
+   uint32_t sndWnd;        ///<Send window advertised by the peer, in bytes
+   uint32_t rcvWnd;        ///<Receive window, in bytes
+   uint32_t unacked;       ///<Data sent but not yet acknowledged, in bytes
+   uint32_t sndBuffered;   ///<Data buffered but not yet sent, in bytes
+   uint32_t rcvBuffered;   ///<Data received but not yet read, in bytes
+   uint32_t retransmits;   ///<Number of retransmissions of the oldest unacknowledged segment
+   uint32_t dupAcks;       ///<Number of consecutive duplicate ACKs
+   uint32_t segsOut;       ///<Number of segments sent, retransmissions included
+   uint32_t segsIn;        ///<Number of segments received
+   uint32_t totalRetrans;  ///<Number of segments retransmitted
+   uint64_t bytesSent;     ///<Data bytes sent, retransmissions included
+   uint64_t bytesRetrans;  ///<Data bytes retransmitted
+   uint64_t bytesAcked;    ///<Sequence space acknowledged by the peer
+   uint64_t bytesReceived; ///<Data bytes received in sequence
+   uint32_t cwndLimited;   ///<Time spent limited by the congestion window, in milliseconds
+   uint32_t rwndLimited;   ///<Time spent limited by the receiver window, in milliseconds
+   uint32_t appLimited;    ///<Time spent waiting for data from the application, in milliseconds
+   uint32_t deliveryRate;  ///<Most recent delivery rate sample, in bytes per second
+} TcpInfo;
+
+
 /**
  * @brief SACK block
  **/
@@ -446,9 +538,6 @@ typedef struct
 } TcpRxBuffer;
 
 
-//Tick counter to handle periodic operations
-extern systime_t tcpTickCounter;
-
 //TCP related functions
 error_t tcpInit(void);
 
@@ -472,8 +561,9 @@ error_t tcpShutdown(Socket *socket, uint_t how);
 error_t tcpAbort(Socket *socket);
 
 TcpState tcpGetState(Socket *socket);
+error_t tcpGetInfo(Socket *socket, TcpInfo *info);
 
-Socket *tcpKillOldestConnection(void);
+error_t tcpKillOldestConnection(void);
 
 //C++ guard
 #ifdef __cplusplus
@@ -74,7 +74,6 @@ void tcpProcessSegment(NetInterface *interface,
    const IpPseudoHeader *pseudoHeader, const NetBuffer *buffer, size_t offset,
    const NetRxAncillary *ancillary)
 {
-   uint_t i;
    size_t length;
    Socket *socket;
    Socket *passiveSocket;
@@ -152,9 +151,11 @@ void tcpProcessSegment(NetInterface *interface,
       return;
    }
 
-   //Verify TCP checksum
-   if(ipCalcUpperLayerChecksumEx(pseudoHeader->data,
-      pseudoHeader->length, buffer, offset, length) != 0x0000)
+   //Verify TCP checksum, unless it has already been validated (or omitted
+   //by the sender in the case of a looped back segment)
+   if(!ancillary->checksumValid &&
+      ipCalcUpperLayerChecksumEx(pseudoHeader->data, pseudoHeader->length,
+      buffer, offset, length) != 0x0000)
    {
       //Debug message
       TRACE_WARNING("Wrong TCP header checksum!\r\n");
@@ -170,12 +171,9 @@ void tcpProcessSegment(NetInterface *interface,
    //No matching socket in the LISTEN state for the moment
    passiveSocket = NULL;
 
-   //Look through opened sockets
-   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   //Loop through active TCP sockets
+   for(socket = tcpSocketList; socket != NULL; socket = socket->next)
    {
-      //Point to the current socket
-      socket = socketTable + i;
-
       //TCP socket found?
       if(socket->type != SOCKET_TYPE_STREAM)
          continue;
@@ -284,7 +282,7 @@ void tcpProcessSegment(NetInterface *interface,
 
    //If no matching socket has been found then try to use the first matching
    //socket in the LISTEN state
-   if(i >= SOCKET_MAX_COUNT)
+   if(socket == NULL)
    {
       socket = passiveSocket;
    }
@@ -330,6 +328,24 @@ void tcpProcessSegment(NetInterface *interface,
       return;
    }
 
+   //Tracepoint
+   NET_TRACE(NET_TRACE_EVENT_TCP_RX, socket->descriptor, segment->seqNum,
+      length, segment->flags);
+
+#if (TCP_INFO_SUPPORT == ENABLED)
+   //Number of segments received on this connection
+   socket->segsIn++;
+#endif
+
+#if (NET_STATS_SUPPORT == ENABLED)
+   //Time elapsed since the segment was received by the NIC driver
+   if(ancillary->statsTimestamp != 0)
+   {
+      netStatsRecord(NET_STATS_RX_DELIVERY, NET_STATS_GET_TIME_US() -
+         ancillary->statsTimestamp);
+   }
+#endif
+
    //Check current state
    switch(socket->state)
    {
@@ -590,6 +606,11 @@ void tcpStateListen(Socket *socket, NetInterface *interface,
       //Save the initial sequence number
       queueItem->isn = segment->seqNum;
 
+#if (NET_STATS_SUPPORT == ENABLED)
+      //Save the time at which the connection request was received
+      queueItem->timestamp = NET_STATS_GET_TIME_US();
+#endif
+
       //Get the Maximum Segment Size option
       option = tcpGetOption(segment, TCP_OPTION_MAX_SEGMENT_SIZE);
 
@@ -699,6 +720,8 @@ void tcpStateSynSent(Socket *socket, const TcpHeader *segment, size_t length)
       socket->irs = segment->seqNum;
       //Initialize RCV.NXT pointer
       socket->rcvNxt = segment->seqNum + 1;
+      //First data byte is stored at the start of the receive buffer
+      socket->rxBufferStart = segment->seqNum + 1;
 
       //If there is an ACK, SND.UNA should be advanced to equal SEG.ACK
       if((segment->flags & TCP_FLAG_ACK) != 0)
@@ -728,8 +751,14 @@ void tcpStateSynSent(Socket *socket, const TcpHeader *segment, size_t length)
          //Make sure that the MSS advertised by the peer is acceptable
          socket->smss = MIN(socket->smss, socket->mss);
          socket->smss = MAX(socket->smss, TCP_MIN_MSS);
+
+         //The SMSS may be restored up to this value when the PMTU increases
+         socket->peerMss = socket->smss;
       }
 
+      //The SMSS must not exceed the PMTU estimate for the path
+      tcpUpdateSmss(socket);
+
 #if (TCP_SACK_SUPPORT == ENABLED)
       //Get the SACK Permitted option
       option = tcpGetOption(segment, TCP_OPTION_SACK_PERMITTED);
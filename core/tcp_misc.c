@@ -34,11 +34,13 @@
 //Dependencies
 #include "core/net.h"
 #include "core/socket.h"
+#include "core/socket_misc.h"
 #include "core/tcp.h"
 #include "core/tcp_misc.h"
 #include "core/tcp_timer.h"
 #include "core/ip.h"
 #include "ipv4/ipv4.h"
+#include "ipv4/ipv4_pmtu.h"
 #include "ipv6/ipv6.h"
 #include "mibs/mib2_module.h"
 #include "mibs/tcp_mib_module.h"
@@ -77,6 +79,12 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    TcpQueueItem *queueItem;
    IpPseudoHeader pseudoHeader;
    NetTxAncillary ancillary;
+#if (NET_STATS_SUPPORT == ENABLED)
+   NetStatsCostProbe probe;
+#endif
+
+   //Start measuring the processing cost
+   NET_STATS_COST_BEGIN(probe);
 
    //Maximum segment size
    mss = HTONS(socket->rmss);
@@ -85,7 +93,12 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    buffer = ipAllocBuffer(TCP_MAX_HEADER_LENGTH, &offset);
    //Failed to allocate memory?
    if(buffer == NULL)
+   {
+      //Account for the processing cost of the call
+      NET_STATS_COST_END(probe, NET_STATS_TCP_TX_COST);
+      //Report an error
       return ERROR_OUT_OF_MEMORY;
+   }
 
    //Point to the beginning of the TCP segment
    segment = netBufferAt(buffer, offset);
@@ -164,6 +177,8 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
       {
          //Clean up side effects
          netBufferFree(buffer);
+         //Account for the processing cost of the call
+         NET_STATS_COST_END(probe, NET_STATS_TCP_TX_COST);
          //Exit immediately
          return error;
       }
@@ -185,8 +200,11 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
       pseudoHeader.ipv4Data.length = htons(totalLength);
 
       //Calculate TCP header checksum
-      segment->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv4Data,
-         sizeof(Ipv4PseudoHeader), buffer, offset, totalLength);
+      if(!ipIsChecksumBypassed(&socket->remoteIpAddr))
+      {
+         segment->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv4Data,
+            sizeof(Ipv4PseudoHeader), buffer, offset, totalLength);
+      }
    }
    else
 #endif
@@ -205,8 +223,11 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
       pseudoHeader.ipv6Data.nextHeader = IPV6_TCP_HEADER;
 
       //Calculate TCP header checksum
-      segment->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv6Data,
-         sizeof(Ipv6PseudoHeader), buffer, offset, totalLength);
+      if(!ipIsChecksumBypassed(&socket->remoteIpAddr))
+      {
+         segment->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv6Data,
+            sizeof(Ipv6PseudoHeader), buffer, offset, totalLength);
+      }
    }
    else
 #endif
@@ -214,6 +235,8 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    {
       //Free previously allocated memory
       netBufferFree(buffer);
+      //Account for the processing cost of the call
+      NET_STATS_COST_END(probe, NET_STATS_TCP_TX_COST);
       //This should never occur...
       return ERROR_INVALID_ADDRESS;
    }
@@ -251,6 +274,8 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
       {
          //Free previously allocated memory
          netBufferFree(buffer);
+         //Account for the processing cost of the call
+         NET_STATS_COST_END(probe, NET_STATS_TCP_TX_COST);
          //Return status
          return ERROR_OUT_OF_MEMORY;
       }
@@ -275,6 +300,11 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
          //Wait for an acknowledgment that covers that sequence number...
          socket->rttBusy = TRUE;
 
+#if (TCP_INFO_SUPPORT == ENABLED)
+         //Delivery rate is sampled over the same round-trip
+         socket->rttBytesAcked = socket->bytesAcked;
+#endif
+
 #if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
          //Reset the byte counter
          socket->n = 0;
@@ -315,6 +345,12 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    TCP_MIB_INC_COUNTER32(tcpOutSegs, 1);
    TCP_MIB_INC_COUNTER64(tcpHCOutSegs, 1);
 
+#if (TCP_INFO_SUPPORT == ENABLED)
+   //Update per-connection counters
+   socket->segsOut++;
+   socket->bytesSent += length;
+#endif
+
    //RST flag set?
    if((flags & TCP_FLAG_RST) != 0)
    {
@@ -330,6 +366,9 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    //Dump TCP header contents for debugging purpose
    tcpDumpHeader(segment, length, socket->iss, socket->irs);
 
+   //Tracepoint
+   NET_TRACE(NET_TRACE_EVENT_TCP_TX, socket->descriptor, seqNum, length, flags);
+
    //Additional options can be passed to the stack along with the packet
    ancillary = NET_DEFAULT_TX_ANCILLARY;
    //Set the TTL value to be used
@@ -337,6 +376,15 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    //Set ToS field
    ancillary.tos = socket->tos;
 
+#if (IPV4_SUPPORT == ENABLED && IPV4_PMTU_SUPPORT == ENABLED)
+   //Path MTU discovery requires the DF bit to be set in all IPv4 datagrams
+   //(refer to RFC 1191, section 3)
+   if(pseudoHeader.length == sizeof(Ipv4PseudoHeader))
+   {
+      ancillary.dontFrag = TRUE;
+   }
+#endif
+
 #if (ETH_VLAN_SUPPORT == ENABLED)
    //Set VLAN PCP and DEI fields
    ancillary.vlanPcp = socket->vlanPcp;
@@ -356,6 +404,9 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    //Free previously allocated memory
    netBufferFree(buffer);
 
+   //Account for the processing cost of the segment
+   NET_STATS_COST_END(probe, NET_STATS_TCP_TX_COST);
+
    //Successful processing
    return NO_ERROR;
 }
@@ -904,6 +955,10 @@ error_t tcpCheckAck(Socket *socket, const TcpHeader *segment, size_t length)
 
       //Total number of bytes acknowledged during the whole round-trip
       socket->n += n;
+#endif
+#if (TCP_INFO_SUPPORT == ENABLED)
+      //Total sequence space acknowledged by the peer
+      socket->bytesAcked += segment->ackNum - socket->sndUna;
 #endif
       //Update SND.UNA pointer
       socket->sndUna = segment->ackNum;
@@ -916,6 +971,11 @@ error_t tcpCheckAck(Socket *socket, const TcpHeader *segment, size_t length)
       //acknowledged are removed
       tcpUpdateRetransmitQueue(socket);
 
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+      //Adjust the size of the send buffer
+      tcpAutotuneTxBuffer(socket);
+#endif
+
 #if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
       //Check congestion state
       if(socket->congestState == TCP_CONGEST_STATE_RECOVERY)
@@ -956,6 +1016,10 @@ error_t tcpCheckAck(Socket *socket, const TcpHeader *segment, size_t length)
 
       //Limit the size of the congestion window
       socket->cwnd = MIN(socket->cwnd, socket->txBufferSize);
+
+      //Tracepoint
+      NET_TRACE(NET_TRACE_EVENT_TCP_CWND, socket->descriptor, socket->cwnd,
+         socket->ssthresh, socket->congestState);
 #endif
    }
    //The incoming ACK segment does not acknowledge new data?
@@ -1036,6 +1100,10 @@ error_t tcpCheckAck(Socket *socket, const TcpHeader *segment, size_t length)
 
       //Limit the size of the congestion window
       socket->cwnd = MIN(socket->cwnd, socket->txBufferSize);
+
+      //Tracepoint
+      NET_TRACE(NET_TRACE_EVENT_TCP_CWND, socket->descriptor, socket->cwnd,
+         socket->ssthresh, socket->congestState);
 #endif
    }
 
@@ -1202,6 +1270,10 @@ void tcpFastRetransmit(Socket *socket)
 
    //Enter the fast recovery procedure
    socket->congestState = TCP_CONGEST_STATE_RECOVERY;
+
+   //Tracepoint
+   NET_TRACE(NET_TRACE_EVENT_TCP_CWND, socket->descriptor, socket->cwnd,
+      socket->ssthresh, socket->congestState);
 #endif
 }
 
@@ -1353,6 +1425,11 @@ void tcpProcessSegmentData(Socket *socket, const TcpHeader *segment,
       //Update the receive window
       socket->rcvWnd -= length;
 
+#if (TCP_INFO_SUPPORT == ENABLED)
+      //Data bytes received in sequence
+      socket->bytesReceived += length;
+#endif
+
       //Acknowledge the received data (delayed ACK not supported)
       tcpSendSegment(socket, TCP_FLAG_ACK, socket->sndNxt, socket->rcvNxt, 0,
          FALSE);
@@ -1376,6 +1453,13 @@ void tcpDeleteControlBlock(Socket *socket)
    //Delete SYN queue
    tcpFlushSynQueue(socket);
 
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   //Give the memory held by the buffers back to the budget
+   netContext.socketContext->tcpBufferUsage -=
+      netBufferGetLength((NetBuffer *) &socket->txBuffer) +
+      netBufferGetLength((NetBuffer *) &socket->rxBuffer);
+#endif
+
    //Release transmit buffer
    netBufferSetLength((NetBuffer *) &socket->txBuffer, 0);
 
@@ -1495,6 +1579,88 @@ void tcpFlushRetransmitQueue(Socket *socket)
 }
 
 
+/**
+ * @brief Split retransmission queue items that exceed the SMSS
+ *
+ * When the SMSS is reduced, the segments that are already queued for
+ * retransmission are split so that none of them exceeds the new SMSS
+ *
+ * @param[in] socket Handle referencing the socket
+ * @return Error code
+ **/
+
+error_t tcpResizeRetransmitQueue(Socket *socket)
+{
+   TcpQueueItem *queueItem;
+   TcpQueueItem *newQueueItem;
+   TcpHeader *header;
+   TcpHeader *newHeader;
+
+   //Point to the first item of the retransmission queue
+   queueItem = socket->retransmitQueue;
+
+   //Loop through retransmission queue
+   while(queueItem != NULL)
+   {
+      //Check whether the current segment exceeds the SMSS
+      if(queueItem->length > socket->smss)
+      {
+         //Allocate a new item
+         newQueueItem = memPoolAlloc(sizeof(TcpQueueItem));
+         //Failed to allocate memory?
+         if(newQueueItem == NULL)
+            return ERROR_OUT_OF_MEMORY;
+
+         //The new item holds the remaining data of the original segment
+         osMemcpy(newQueueItem, queueItem, sizeof(TcpQueueItem));
+         newQueueItem->length = queueItem->length - socket->smss;
+
+         //Point to the TCP headers
+         header = (TcpHeader *) queueItem->header;
+         newHeader = (TcpHeader *) newQueueItem->header;
+
+         //Adjust the sequence number of the new segment
+         newHeader->seqNum = htonl(ntohl(header->seqNum) + socket->smss);
+
+         //The FIN and PSH flags only apply to the last segment
+         header->flags &= ~(TCP_FLAG_FIN | TCP_FLAG_PSH);
+         queueItem->length = socket->smss;
+
+#if (IPV4_SUPPORT == ENABLED)
+         //IPv4 pseudo header?
+         if(queueItem->pseudoHeader.length == sizeof(Ipv4PseudoHeader))
+         {
+            //Update the length fields of the pseudo headers
+            queueItem->pseudoHeader.ipv4Data.length = htons(header->dataOffset *
+               4 + queueItem->length);
+            newQueueItem->pseudoHeader.ipv4Data.length = htons(
+               newHeader->dataOffset * 4 + newQueueItem->length);
+         }
+#endif
+#if (IPV6_SUPPORT == ENABLED)
+         //IPv6 pseudo header?
+         if(queueItem->pseudoHeader.length == sizeof(Ipv6PseudoHeader))
+         {
+            //Update the length fields of the pseudo headers
+            queueItem->pseudoHeader.ipv6Data.length = htonl(header->dataOffset *
+               4 + queueItem->length);
+            newQueueItem->pseudoHeader.ipv6Data.length = htonl(
+               newHeader->dataOffset * 4 + newQueueItem->length);
+         }
+#endif
+         //Insert the new item right after the current one
+         queueItem->next = newQueueItem;
+      }
+
+      //Point to the next item
+      queueItem = queueItem->next;
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Flush SYN queue
  * @param[in] socket Handle referencing the socket
@@ -1635,16 +1801,35 @@ void tcpUpdateSendWindow(Socket *socket, const TcpHeader *segment)
 
 void tcpUpdateReceiveWindow(Socket *socket)
 {
+   size_t size;
    uint16_t reduction;
 
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   //Adjust the size of the receive buffer
+   tcpAutotuneRxBuffer(socket);
+#endif
+
+   //Size of the receive buffer
+   size = socket->rxBufferSize;
+
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   //The receive buffer is waiting to be shrunk?
+   if(socket->rxBufferTarget != 0 && socket->rxBufferTarget < size)
+   {
+      //Do not reopen the window beyond the target size. The window that has
+      //already been advertised cannot be withdrawn
+      size = MAX(socket->rxBufferTarget, socket->rcvUser + socket->rcvWnd);
+   }
+#endif
+
    //Space available but not yet advertised
-   reduction = socket->rxBufferSize - socket->rcvUser - socket->rcvWnd;
+   reduction = size - socket->rcvUser - socket->rcvWnd;
 
    //To avoid SWS, the receiver should not advertise small windows
-   if((socket->rcvWnd + reduction) >= MIN(socket->rmss, socket->rxBufferSize / 2))
+   if((socket->rcvWnd + reduction) >= MIN(socket->rmss, size / 2))
    {
       //Check whether a window update should be sent
-      if(socket->rcvWnd < MIN(socket->rmss, socket->rxBufferSize / 2))
+      if(socket->rcvWnd < MIN(socket->rmss, size / 2))
       {
          //Debug message
          TRACE_INFO("%s: TCP sending window update...\r\n",
@@ -1666,6 +1851,248 @@ void tcpUpdateReceiveWindow(Socket *socket)
 }
 
 
+/**
+ * @brief Dynamic right-sizing of the send buffer
+ *
+ * The send buffer is doubled whenever it is the factor limiting the sender,
+ * i.e. it is full while both the congestion window and the peer's window
+ * would allow more data in flight. It falls back to its default size when
+ * the memory pool runs short
+ *
+ * @param[in] socket Handle referencing the socket
+ **/
+
+void tcpAutotuneTxBuffer(Socket *socket)
+{
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   error_t error;
+   size_t size;
+
+   //The application has chosen the size of the buffer?
+   if(socket->txBufferLocked)
+      return;
+
+   //The buffer is only resized while the connection is established
+   if(socket->state != TCP_STATE_ESTABLISHED)
+      return;
+
+   //Default size of the send buffer
+   size = MIN(TCP_DEFAULT_TX_BUFFER_SIZE, TCP_MAX_TX_BUFFER_SIZE);
+
+   //Check whether the memory pool or the memory budget is running short
+   if(tcpAutotuneCheckPressure())
+   {
+      //Shrink the send buffer back to its default size
+      if(socket->txBufferSize > size)
+      {
+         socket->txBufferTarget = size;
+      }
+      else
+      {
+         socket->txBufferTarget = 0;
+      }
+   }
+   //The send buffer is full?
+   else if((socket->sndNxt - socket->sndUna + socket->sndUser) >=
+      socket->txBufferSize)
+   {
+#if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
+      //The congestion window is clamped to the size of the send buffer
+      if(socket->cwnd >= socket->txBufferSize &&
+         socket->maxSndWnd > socket->txBufferSize)
+#else
+      //The peer is able to accept more data than can be buffered
+      if(socket->maxSndWnd > socket->txBufferSize)
+#endif
+      {
+         //Double the size of the send buffer
+         size = MIN(socket->txBufferSize * 2, TCP_MAX_TX_BUFFER_SIZE);
+
+         //Check whether the buffer can grow any further
+         if(size > socket->txBufferSize &&
+            tcpAutotuneCheckBudget(size - socket->txBufferSize))
+         {
+            socket->txBufferTarget = MAX(socket->txBufferTarget, size);
+         }
+      }
+   }
+
+   //Any pending resize operation?
+   if(socket->txBufferTarget != 0)
+   {
+      //Resize the send buffer
+      error = tcpResizeTxBuffer(socket, socket->txBufferTarget);
+
+      //The operation is deferred until the buffered data fit in the new size
+      if(error != ERROR_WOULD_BLOCK)
+      {
+         socket->txBufferTarget = 0;
+      }
+
+#if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
+      //Limit the size of the congestion window
+      socket->cwnd = MIN(socket->cwnd, socket->txBufferSize);
+#endif
+   }
+#endif
+}
+
+
+/**
+ * @brief Dynamic right-sizing of the receive buffer
+ *
+ * The amount of data received in sequence is measured over each round-trip.
+ * The receive buffer is sized to hold twice that amount, so that the window
+ * never limits the sender, and falls back to its default size when the
+ * memory pool runs short
+ *
+ * @param[in] socket Handle referencing the socket
+ **/
+
+void tcpAutotuneRxBuffer(Socket *socket)
+{
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   error_t error;
+   size_t size;
+   uint32_t n;
+   systime_t time;
+   systime_t interval;
+
+   //The application has chosen the size of the buffer?
+   if(socket->rxBufferLocked)
+      return;
+
+   //The buffer is only resized while the connection is established
+   if(socket->state != TCP_STATE_ESTABLISHED)
+      return;
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //Default size of the receive buffer
+   size = MIN(TCP_DEFAULT_RX_BUFFER_SIZE, TCP_MAX_RX_BUFFER_SIZE);
+
+   //Check whether the memory pool or the memory budget is running short
+   if(tcpAutotuneCheckPressure())
+   {
+      //Shrink the receive buffer back to its default size
+      if(socket->rxBufferSize > size)
+      {
+         socket->rxBufferTarget = size;
+      }
+      else
+      {
+         socket->rxBufferTarget = 0;
+      }
+
+      //Restart the measurement once the pressure is relieved
+      socket->rxAutotuneTimestamp = 0;
+   }
+   //First measurement?
+   else if(socket->rxAutotuneTimestamp == 0)
+   {
+      //Start a new measurement interval
+      socket->rxAutotuneTimestamp = time;
+      socket->rxAutotuneSeqNum = socket->rcvNxt;
+   }
+   else
+   {
+      //The measurement spans at least one round-trip
+      interval = MAX(socket->srtt, TCP_AUTOTUNE_MIN_INTERVAL);
+
+      //Check whether the measurement interval has elapsed
+      if(timeCompare(time, socket->rxAutotuneTimestamp + interval) >= 0)
+      {
+         //Number of bytes received in sequence during the interval
+         n = socket->rcvNxt - socket->rxAutotuneSeqNum;
+         //Scale the measurement down to a single round-trip
+         n = (uint32_t) (((uint64_t) n * interval) /
+            (time - socket->rxAutotuneTimestamp));
+
+         //The buffer should be able to hold twice the amount of data
+         //delivered per round-trip
+         size = MIN(n * 2, TCP_MAX_RX_BUFFER_SIZE);
+
+         //Grow the receive buffer if necessary
+         if(size > socket->rxBufferSize &&
+            tcpAutotuneCheckBudget(size - socket->rxBufferSize))
+         {
+            socket->rxBufferTarget = MAX(socket->rxBufferTarget, size);
+         }
+
+         //Start a new measurement interval
+         socket->rxAutotuneTimestamp = time;
+         socket->rxAutotuneSeqNum = socket->rcvNxt;
+      }
+   }
+
+   //Any pending resize operation?
+   if(socket->rxBufferTarget != 0)
+   {
+      //Resize the receive buffer
+      error = tcpResizeRxBuffer(socket, socket->rxBufferTarget);
+
+      //The operation is deferred until the buffered data fit in the new size
+      if(error != ERROR_WOULD_BLOCK)
+      {
+         socket->rxBufferTarget = 0;
+      }
+   }
+#endif
+}
+
+
+/**
+ * @brief Check whether the TCP buffers should give memory back
+ * @return TRUE if the memory pool or the memory budget is running short,
+ *   else FALSE
+ **/
+
+bool_t tcpAutotuneCheckPressure(void)
+{
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+   //Check the occupancy of the memory pool
+   if(memPoolGetPressure() >= TCP_AUTOTUNE_PRESSURE_THRESHOLD)
+      return TRUE;
+
+#if (TCP_AUTOTUNE_MEM_BUDGET > 0)
+   //The memory pool is not used when the buffers are allocated from the
+   //heap, hence the need for a budget of its own
+   if(((uint64_t) netContext.socketContext->tcpBufferUsage * 100) >=
+      ((uint64_t) TCP_AUTOTUNE_MEM_BUDGET * TCP_AUTOTUNE_PRESSURE_THRESHOLD))
+   {
+      return TRUE;
+   }
+#endif
+#endif
+
+   //The buffers are allowed to grow
+   return FALSE;
+}
+
+
+/**
+ * @brief Check whether a TCP buffer can grow within the memory budget
+ * @param[in] growth Number of additional bytes required
+ * @return TRUE if the buffer can grow, else FALSE
+ **/
+
+bool_t tcpAutotuneCheckBudget(size_t growth)
+{
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED && TCP_AUTOTUNE_MEM_BUDGET > 0)
+   //The TCP buffers must not exceed the memory budget
+   if((netContext.socketContext->tcpBufferUsage + growth) >
+      (size_t) TCP_AUTOTUNE_MEM_BUDGET)
+   {
+      return FALSE;
+   }
+#endif
+
+   //The buffer can grow
+   return TRUE;
+}
+
+
 /**
  * @brief Compute retransmission timeout
  * @param[in] socket Handle referencing the socket
@@ -1723,6 +2150,23 @@ bool_t tcpComputeRto(Socket *socket)
          TRACE_DEBUG("R=%" PRIu32 ", SRTT=%" PRIu32 ", RTTVAR=%" PRIu32 ", RTO=%" PRIu32 "\r\n",
             r, socket->srtt, socket->rttvar, socket->rto);
 
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Update RTT distribution of the underlying interface
+         if(socket->interface != NULL)
+         {
+            netHistogramRecord(&socket->interface->statsHistograms[NET_STATS_IF_RTT],
+               r * 1000);
+            netHistogramRecord(&socket->interface->statsHistograms[NET_STATS_IF_SRTT],
+               socket->srtt * 1000);
+         }
+#endif
+
+#if (TCP_INFO_SUPPORT == ENABLED)
+         //Estimate the delivery rate over the round-trip
+         socket->deliveryRate = (uint32_t) ((socket->bytesAcked -
+            socket->rttBytesAcked) * 1000 / MAX(r, 1));
+#endif
+
          //RTT measurement is complete
          socket->rttBusy = FALSE;
          //Set flag
@@ -1816,9 +2260,12 @@ error_t tcpRetransmitSegment(Socket *socket)
          if(queueItem->pseudoHeader.length == sizeof(Ipv4PseudoHeader))
          {
             //Calculate TCP header checksum
-            segment->checksum = ipCalcUpperLayerChecksumEx(
-               &queueItem->pseudoHeader.ipv4Data, sizeof(Ipv4PseudoHeader),
-               buffer, offset, segment->dataOffset * 4 + queueItem->length);
+            if(!ipIsChecksumBypassed(&socket->remoteIpAddr))
+            {
+               segment->checksum = ipCalcUpperLayerChecksumEx(
+                  &queueItem->pseudoHeader.ipv4Data, sizeof(Ipv4PseudoHeader),
+                  buffer, offset, segment->dataOffset * 4 + queueItem->length);
+            }
          }
          else
 #endif
@@ -1827,9 +2274,12 @@ error_t tcpRetransmitSegment(Socket *socket)
          if(queueItem->pseudoHeader.length == sizeof(Ipv6PseudoHeader))
          {
             //Calculate TCP header checksum
-            segment->checksum = ipCalcUpperLayerChecksumEx(
-               &queueItem->pseudoHeader.ipv6Data, sizeof(Ipv6PseudoHeader),
-               buffer, offset, segment->dataOffset * 4 + queueItem->length);
+            if(!ipIsChecksumBypassed(&socket->remoteIpAddr))
+            {
+               segment->checksum = ipCalcUpperLayerChecksumEx(
+                  &queueItem->pseudoHeader.ipv6Data, sizeof(Ipv6PseudoHeader),
+                  buffer, offset, segment->dataOffset * 4 + queueItem->length);
+            }
          }
          else
 #endif
@@ -1844,14 +2294,34 @@ error_t tcpRetransmitSegment(Socket *socket)
          MIB2_TCP_INC_COUNTER32(tcpRetransSegs, 1);
          TCP_MIB_INC_COUNTER32(tcpRetransSegs, 1);
 
+#if (TCP_INFO_SUPPORT == ENABLED)
+         //Update per-connection counters
+         socket->segsOut++;
+         socket->totalRetrans++;
+         socket->bytesSent += queueItem->length;
+         socket->bytesRetrans += queueItem->length;
+#endif
+
          //Dump TCP header contents for debugging purpose
          tcpDumpHeader(segment, queueItem->length, socket->iss, socket->irs);
 
+         //Tracepoint
+         NET_TRACE(NET_TRACE_EVENT_TCP_RETRANSMIT, socket->descriptor,
+            ntohl(segment->seqNum), queueItem->length, socket->retransmitCount);
+
          //Additional options can be passed to the stack along with the packet
          ancillary = NET_DEFAULT_TX_ANCILLARY;
          //Set the TTL value to be used
          ancillary.ttl = socket->ttl;
 
+#if (IPV4_SUPPORT == ENABLED && IPV4_PMTU_SUPPORT == ENABLED)
+         //Path MTU discovery requires the DF bit to be set
+         if(queueItem->pseudoHeader.length == sizeof(Ipv4PseudoHeader))
+         {
+            ancillary.dontFrag = TRUE;
+         }
+#endif
+
 #if (ETH_VLAN_SUPPORT == ENABLED)
          //Set VLAN PCP and DEI fields
          ancillary.vlanPcp = socket->vlanPcp;
@@ -1890,6 +2360,209 @@ error_t tcpRetransmitSegment(Socket *socket)
 }
 
 
+/**
+ * @brief Update the SMSS according to the PMTU estimate
+ *
+ * If the retransmission queue cannot be re-packetized for lack of memory,
+ * the previous SMSS is kept so that every queued segment remains eligible
+ * for retransmission. The SMSS is raised again, up to the value negotiated
+ * with the peer, once a lower PMTU estimate has expired
+ *
+ * @param[in] socket Handle referencing the socket
+ * @return Error code
+ **/
+
+error_t tcpUpdateSmss(Socket *socket)
+{
+   error_t error;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+#if (IPV4_SUPPORT == ENABLED && IPV4_PMTU_SUPPORT == ENABLED)
+   //IPv4 connection?
+   if(socket->interface != NULL &&
+      socket->remoteIpAddr.length == sizeof(Ipv4Addr))
+   {
+      size_t pathMtu;
+      uint16_t smss;
+      uint16_t prevSmss;
+
+      //Retrieve the PMTU for the specified destination address
+      pathMtu = ipv4GetPathMtu(socket->interface,
+         socket->remoteIpAddr.ipv4Addr);
+
+      //The SMSS is the PMTU minus the size of the IP and TCP headers
+      if(pathMtu > (sizeof(Ipv4Header) + sizeof(TcpHeader) + TCP_MIN_MSS))
+      {
+         smss = pathMtu - sizeof(Ipv4Header) - sizeof(TcpHeader);
+      }
+      else
+      {
+         smss = TCP_MIN_MSS;
+      }
+
+      //The SMSS cannot exceed the value negotiated with the peer
+      smss = MIN(smss, socket->peerMss);
+
+      //Check whether the PMTU estimate has decreased
+      if(smss < socket->smss)
+      {
+         //Save the current SMSS
+         prevSmss = socket->smss;
+         //Update the SMSS
+         socket->smss = smss;
+
+         //Segments that have already been sent are re-packetized so that they
+         //fit the new PMTU when they are retransmitted
+         error = tcpResizeRetransmitQueue(socket);
+
+         //Check status code
+         if(!error)
+         {
+            //Debug message
+            TRACE_INFO("TCP SMSS reduced from %" PRIu16 " to %" PRIu16 " bytes\r\n",
+               prevSmss, smss);
+         }
+         else
+         {
+            //Segments that were split so far still fit the previous SMSS
+            socket->smss = prevSmss;
+         }
+      }
+      else if(smss > socket->smss)
+      {
+         //Debug message
+         TRACE_INFO("TCP SMSS raised from %" PRIu16 " to %" PRIu16 " bytes\r\n",
+            socket->smss, smss);
+
+         //Queued segments are smaller than the new SMSS and need not be
+         //re-packetized
+         socket->smss = smss;
+      }
+   }
+#endif
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Check whether an ICMP error quotes a segment of a live connection
+ *
+ * The quoted source and destination ports must match a synchronized
+ * connection and the quoted sequence number must lie between SND.UNA and
+ * SND.NXT, so that off-path attackers cannot blindly reduce the PMTU
+ *
+ * @param[in] interface Underlying network interface
+ * @param[in] srcAddr Source address of the quoted datagram
+ * @param[in] destAddr Destination address of the quoted datagram
+ * @param[in] srcPort Source port of the quoted segment
+ * @param[in] destPort Destination port of the quoted segment
+ * @param[in] seqNum Sequence number of the quoted segment
+ * @return TRUE if the quoted segment belongs to a live connection, else FALSE
+ **/
+
+bool_t tcpCheckQuotedSegment(NetInterface *interface, Ipv4Addr srcAddr,
+   Ipv4Addr destAddr, uint16_t srcPort, uint16_t destPort, uint32_t seqNum)
+{
+#if (IPV4_SUPPORT == ENABLED)
+   Socket *socket;
+
+   //Loop through active TCP sockets
+   for(socket = tcpSocketList; socket != NULL; socket = socket->next)
+   {
+      //Only synchronized connections are considered
+      if(socket->state == TCP_STATE_CLOSED ||
+         socket->state == TCP_STATE_LISTEN ||
+         socket->state == TCP_STATE_SYN_SENT)
+      {
+         continue;
+      }
+
+      //Check the connection 4-tuple
+      if(socket->interface != interface)
+         continue;
+      if(socket->localIpAddr.length != sizeof(Ipv4Addr) ||
+         socket->localIpAddr.ipv4Addr != srcAddr)
+         continue;
+      if(socket->remoteIpAddr.length != sizeof(Ipv4Addr) ||
+         socket->remoteIpAddr.ipv4Addr != destAddr)
+         continue;
+      if(socket->localPort != srcPort || socket->remotePort != destPort)
+         continue;
+
+      //The quoted sequence number must lie in SND.UNA =< SEG.SEQ =< SND.NXT
+      return (TCP_CMP_SEQ(seqNum, socket->sndUna) >= 0 &&
+         TCP_CMP_SEQ(seqNum, socket->sndNxt) <= 0) ? TRUE : FALSE;
+   }
+#endif
+
+   //No matching connection
+   return FALSE;
+}
+
+
+/**
+ * @brief Update the SMSS of the connections affected by a PMTU change
+ * @param[in] interface Underlying network interface
+ * @param[in] destAddr Destination IPv4 address
+ **/
+
+void tcpUpdatePathMtu(NetInterface *interface, Ipv4Addr destAddr)
+{
+#if (IPV4_SUPPORT == ENABLED && IPV4_PMTU_SUPPORT == ENABLED)
+   error_t error;
+   uint16_t smss;
+   Socket *socket;
+
+   //Loop through active TCP sockets
+   for(socket = tcpSocketList; socket != NULL; socket = socket->next)
+   {
+      //TCP socket?
+      if(socket->type != SOCKET_TYPE_STREAM)
+         continue;
+
+      //Only synchronized connections are affected by the PMTU change
+      if(socket->state == TCP_STATE_CLOSED ||
+         socket->state == TCP_STATE_LISTEN)
+      {
+         continue;
+      }
+
+      //Check whether the connection uses the specified path
+      if(socket->interface == interface &&
+         socket->remoteIpAddr.length == sizeof(Ipv4Addr) &&
+         socket->remoteIpAddr.ipv4Addr == destAddr)
+      {
+         //Save the current SMSS
+         smss = socket->smss;
+
+         //Update the SMSS according to the new PMTU estimate
+         error = tcpUpdateSmss(socket);
+
+         //Check whether the SMSS has been reduced
+         if(!error && socket->smss < smss)
+         {
+            //The datagram that elicited the Datagram Too Big message has been
+            //dropped, so retransmit it promptly (refer to RFC 1191, section 6.4)
+            if(socket->retransmitQueue != NULL)
+            {
+               tcpRetransmitSegment(socket);
+            }
+         }
+         else if(error)
+         {
+            //Debug message
+            TRACE_WARNING("TCP SMSS update failed (insufficient memory)\r\n");
+         }
+      }
+   }
+#endif
+}
+
+
 /**
  * @brief Nagle algorithm implementation
  * @param[in] socket Handle referencing the socket
@@ -2004,6 +2677,28 @@ error_t tcpNagleAlgo(Socket *socket, uint_t flags)
       }
    }
 
+#if (TCP_INFO_SUPPORT == ENABLED)
+   //Determine which factor is now limiting the sender
+   if(socket->sndUser == 0)
+   {
+      tcpUpdateLimit(socket, TCP_LIMIT_APP);
+   }
+#if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
+   else if((socket->sndNxt - socket->sndUna) >= socket->cwnd)
+   {
+      tcpUpdateLimit(socket, TCP_LIMIT_CWND);
+   }
+#endif
+   else if((socket->sndNxt - socket->sndUna) >= socket->sndWnd)
+   {
+      tcpUpdateLimit(socket, TCP_LIMIT_RWND);
+   }
+   else
+   {
+      tcpUpdateLimit(socket, TCP_LIMIT_NONE);
+   }
+#endif
+
    //Check whether the transmitter can accept more data
    tcpUpdateEvents(socket);
 
@@ -2012,6 +2707,48 @@ error_t tcpNagleAlgo(Socket *socket, uint_t flags)
 }
 
 
+/**
+ * @brief Track the time spent in each sender limit state
+ * @param[in] socket Handle referencing the socket
+ * @param[in] limit Factor currently limiting the sender
+ **/
+
+void tcpUpdateLimit(Socket *socket, TcpLimit limit)
+{
+#if (TCP_INFO_SUPPORT == ENABLED)
+   systime_t time;
+   systime_t delta;
+
+   //Get current time
+   time = osGetSystemTime();
+   //Time spent in the previous state
+   delta = time - socket->limitTimestamp;
+
+   //Account for the time spent in the previous state
+   if(socket->limit == TCP_LIMIT_CWND)
+   {
+      socket->cwndLimitedTime += delta;
+   }
+   else if(socket->limit == TCP_LIMIT_RWND)
+   {
+      socket->rwndLimitedTime += delta;
+   }
+   else if(socket->limit == TCP_LIMIT_APP)
+   {
+      socket->appLimitedTime += delta;
+   }
+   else
+   {
+      //The sender is not limited
+   }
+
+   //Enter the new state
+   socket->limit = limit;
+   socket->limitTimestamp = time;
+#endif
+}
+
+
 /**
  * @brief Update TCP FSM current state
  * @param[in] socket Handle referencing the socket
@@ -2020,6 +2757,10 @@ error_t tcpNagleAlgo(Socket *socket, uint_t flags)
 
 void tcpChangeState(Socket *socket, TcpState newState)
 {
+   //Tracepoint
+   NET_TRACE(NET_TRACE_EVENT_TCP_STATE, socket->descriptor, socket->state,
+      newState, 0);
+
    //Enter CLOSED state?
    if(newState == TCP_STATE_CLOSED)
    {
@@ -2171,6 +2912,9 @@ void tcpUpdateEvents(Socket *socket)
       }
    }
 
+   //Notify the ready list the socket is attached to, if any
+   socketReadyListUpdate(socket);
+
    //Mask unused events
    socket->eventFlags &= socket->eventMask;
 
@@ -2208,6 +2952,12 @@ uint_t tcpWaitForEvents(Socket *socket, uint_t eventMask, systime_t timeout)
    //Update TCP related events
    tcpUpdateEvents(socket);
 
+   //Busy-poll the network interfaces before blocking, if enabled
+   if(socket->eventFlags == 0)
+   {
+      timeout = socketBusyPoll(socket, timeout);
+   }
+
    //No event is signaled?
    if(socket->eventFlags == 0)
    {
@@ -2239,7 +2989,7 @@ void tcpWriteTxBuffer(Socket *socket, uint32_t seqNum,
    const uint8_t *data, size_t length)
 {
    //Offset of the first byte to write in the circular buffer
-   size_t offset = (seqNum - socket->iss - 1) % socket->txBufferSize;
+   size_t offset = (seqNum - socket->txBufferStart) % socket->txBufferSize;
 
    //Check whether the specified data crosses buffer boundaries
    if((offset + length) <= socket->txBufferSize)
@@ -2277,7 +3027,7 @@ error_t tcpReadTxBuffer(Socket *socket, uint32_t seqNum,
    error_t error;
 
    //Offset of the first byte to read in the circular buffer
-   size_t offset = (seqNum - socket->iss - 1) % socket->txBufferSize;
+   size_t offset = (seqNum - socket->txBufferStart) % socket->txBufferSize;
 
    //Check whether the specified data crosses buffer boundaries
    if((offset + length) <= socket->txBufferSize)
@@ -2319,7 +3069,7 @@ void tcpWriteRxBuffer(Socket *socket, uint32_t seqNum,
    const NetBuffer *data, size_t dataOffset, size_t length)
 {
    //Offset of the first byte to write in the circular buffer
-   size_t offset = (seqNum - socket->irs - 1) % socket->rxBufferSize;
+   size_t offset = (seqNum - socket->rxBufferStart) % socket->rxBufferSize;
 
    //Check whether the specified data crosses buffer boundaries
    if((offset + length) <= socket->rxBufferSize)
@@ -2354,7 +3104,7 @@ void tcpReadRxBuffer(Socket *socket, uint32_t seqNum, uint8_t *data,
    size_t length)
 {
    //Offset of the first byte to read in the circular buffer
-   size_t offset = (seqNum - socket->irs - 1) % socket->rxBufferSize;
+   size_t offset = (seqNum - socket->rxBufferStart) % socket->rxBufferSize;
 
    //Check whether the specified data crosses buffer boundaries
    if((offset + length) <= socket->rxBufferSize)
@@ -2377,6 +3127,229 @@ void tcpReadRxBuffer(Socket *socket, uint32_t seqNum, uint8_t *data,
 }
 
 
+/**
+ * @brief Resize the send buffer
+ *
+ * The data held by the buffer keep their offset whenever possible. The
+ * operation is deferred if the data do not fit in the new size
+ *
+ * @param[in] socket Handle referencing the socket
+ * @param[in] size Desired size of the send buffer
+ * @return Error code
+ **/
+
+error_t tcpResizeTxBuffer(Socket *socket, size_t size)
+{
+   error_t error;
+   size_t offset;
+   size_t length;
+
+   //Check the requested size
+   if(size == 0 || size > TCP_MAX_TX_BUFFER_SIZE)
+      return ERROR_INVALID_PARAMETER;
+
+   //Nothing to do?
+   if(size == socket->txBufferSize)
+      return NO_ERROR;
+
+   //Data that have been sent but not yet acknowledged, followed by data
+   //buffered but not yet sent
+   length = socket->sndNxt - socket->sndUna + socket->sndUser;
+   //Offset of the oldest byte in the circular buffer
+   offset = (socket->sndUna - socket->txBufferStart) % socket->txBufferSize;
+
+   //Move the data to the new layout
+   error = tcpResizeCircularBuffer((NetBuffer *) &socket->txBuffer,
+      socket->txBufferSize, size, &offset, length);
+
+   //Check status code
+   if(!error)
+   {
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+      //Update the amount of memory held by the TCP buffers
+      netContext.socketContext->tcpBufferUsage += size - socket->txBufferSize;
+#endif
+
+      //Rebase the circular buffer
+      socket->txBufferStart = socket->sndUna - offset;
+      socket->txBufferSize = size;
+
+      //Debug message
+      TRACE_INFO("TCP send buffer resized to %" PRIuSIZE " bytes\r\n", size);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Resize the receive buffer
+ *
+ * The data held by the buffer keep their offset whenever possible. The
+ * operation is deferred if the new size cannot hold the window already
+ * advertised
+ *
+ * @param[in] socket Handle referencing the socket
+ * @param[in] size Desired size of the receive buffer
+ * @return Error code
+ **/
+
+error_t tcpResizeRxBuffer(Socket *socket, size_t size)
+{
+   error_t error;
+   uint_t i;
+   size_t offset;
+   size_t length;
+   uint32_t start;
+
+   //Check the requested size
+   if(size == 0 || size > TCP_MAX_RX_BUFFER_SIZE)
+      return ERROR_INVALID_PARAMETER;
+
+   //Nothing to do?
+   if(size == socket->rxBufferSize)
+      return NO_ERROR;
+
+   //The advertised window cannot be withdrawn
+   if((socket->rcvUser + socket->rcvWnd) > size)
+      return ERROR_WOULD_BLOCK;
+
+   //Sequence number of the oldest byte not yet consumed
+   start = socket->rcvNxt - socket->rcvUser;
+   //Number of contiguous bytes that have been received
+   length = socket->rcvUser;
+
+   //Out-of-order data are stored beyond RCV.NXT
+   for(i = 0; i < socket->sackBlockCount; i++)
+   {
+      //Extend the range of data held by the buffer
+      if(TCP_CMP_SEQ(socket->sackBlock[i].rightEdge, start + length) > 0)
+      {
+         length = socket->sackBlock[i].rightEdge - start;
+      }
+   }
+
+   //Offset of the oldest byte in the circular buffer
+   offset = (start - socket->rxBufferStart) % socket->rxBufferSize;
+
+   //Move the data to the new layout
+   error = tcpResizeCircularBuffer((NetBuffer *) &socket->rxBuffer,
+      socket->rxBufferSize, size, &offset, length);
+
+   //Check status code
+   if(!error)
+   {
+#if (TCP_AUTOTUNE_SUPPORT == ENABLED)
+      //Update the amount of memory held by the TCP buffers
+      netContext.socketContext->tcpBufferUsage += size - socket->rxBufferSize;
+#endif
+
+      //Rebase the circular buffer
+      socket->rxBufferStart = start - offset;
+      socket->rxBufferSize = size;
+
+      //Debug message
+      TRACE_INFO("TCP receive buffer resized to %" PRIuSIZE " bytes\r\n", size);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Resize a circular buffer while preserving the data it holds
+ *
+ * The data are moved within the buffer itself, so that no memory is needed
+ * beyond the new size. The operation is deferred when the data cannot be
+ * moved without overwriting themselves (e.g. when the buffer is shrunk while
+ * the data wrap around its end)
+ *
+ * @param[in] buffer Multi-part buffer that backs the circular buffer
+ * @param[in] size Current size of the circular buffer
+ * @param[in] newSize Desired size of the circular buffer
+ * @param[in,out] offset Offset of the oldest byte in the circular buffer
+ * @param[in] length Number of bytes held by the circular buffer
+ * @return Error code
+ **/
+
+error_t tcpResizeCircularBuffer(NetBuffer *buffer, size_t size,
+   size_t newSize, size_t *offset, size_t length)
+{
+   error_t error;
+   size_t n;
+
+   //The data must fit in the new size
+   if(length > newSize)
+      return ERROR_WOULD_BLOCK;
+
+   //An empty buffer can be rebased freely
+   if(length == 0)
+   {
+      *offset = 0;
+   }
+
+   //Number of bytes that wrap around to the beginning of the buffer
+   n = (*offset + length > size) ? (*offset + length - size) : 0;
+
+   //Check whether the data can be left in place
+   if(newSize < size)
+   {
+      //The data must be contiguous
+      if(n > 0)
+         return ERROR_WOULD_BLOCK;
+
+      //The data lie beyond the new size?
+      if((*offset + length) > newSize)
+      {
+         //The data cannot be moved over themselves
+         if(length > *offset)
+            return ERROR_WOULD_BLOCK;
+
+         //Move the data to the beginning of the buffer
+         error = netBufferCopy(buffer, 0, buffer, *offset, length);
+         //Any error to report?
+         if(error)
+            return error;
+
+         //The oldest byte is now at the beginning of the buffer
+         *offset = 0;
+      }
+
+      //Release the chunks beyond the new size
+      error = netBufferSetLength(buffer, newSize);
+   }
+   else
+   {
+      //The data that wrap around must fit in the space being added
+      if(n > (newSize - size))
+         return ERROR_WOULD_BLOCK;
+
+      //Adjust the size of the multi-part buffer
+      error = netBufferSetLength(buffer, newSize);
+
+      //Check status code
+      if(!error)
+      {
+         //Append the data that wrap around to the end of the buffer
+         if(n > 0)
+         {
+            error = netBufferCopy(buffer, size, buffer, 0, n);
+         }
+      }
+      else
+      {
+         //Release the chunks that may have been allocated
+         netBufferSetLength(buffer, size);
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
+
 /**
  * @brief Dump TCP header for debugging purpose
  * @param[in] segment Pointer to the TCP header
@@ -77,16 +77,30 @@ void tcpDeleteControlBlock(Socket *socket);
 
 void tcpUpdateRetransmitQueue(Socket *socket);
 void tcpFlushRetransmitQueue(Socket *socket);
+error_t tcpResizeRetransmitQueue(Socket *socket);
 
 void tcpFlushSynQueue(Socket *socket);
 
 void tcpUpdateSackBlocks(Socket *socket, uint32_t *leftEdge, uint32_t *rightEdge);
 void tcpUpdateSendWindow(Socket *socket, const TcpHeader *segment);
 void tcpUpdateReceiveWindow(Socket *socket);
+void tcpAutotuneTxBuffer(Socket *socket);
+void tcpAutotuneRxBuffer(Socket *socket);
+bool_t tcpAutotuneCheckPressure(void);
+bool_t tcpAutotuneCheckBudget(size_t growth);
 
 bool_t tcpComputeRto(Socket *socket);
 error_t tcpRetransmitSegment(Socket *socket);
+
+error_t tcpUpdateSmss(Socket *socket);
+
+bool_t tcpCheckQuotedSegment(NetInterface *interface, Ipv4Addr srcAddr,
+   Ipv4Addr destAddr, uint16_t srcPort, uint16_t destPort, uint32_t seqNum);
+
+void tcpUpdatePathMtu(NetInterface *interface, Ipv4Addr destAddr);
+
 error_t tcpNagleAlgo(Socket *socket, uint_t flags);
+void tcpUpdateLimit(Socket *socket, TcpLimit limit);
 
 void tcpChangeState(Socket *socket, TcpState newState);
 
@@ -105,6 +119,12 @@ void tcpWriteRxBuffer(Socket *socket, uint32_t seqNum,
 void tcpReadRxBuffer(Socket *socket, uint32_t seqNum, uint8_t *data,
    size_t length);
 
+error_t tcpResizeTxBuffer(Socket *socket, size_t size);
+error_t tcpResizeRxBuffer(Socket *socket, size_t size);
+
+error_t tcpResizeCircularBuffer(NetBuffer *buffer, size_t size,
+   size_t newSize, size_t *offset, size_t length);
+
 void tcpDumpHeader(const TcpHeader *segment, size_t length, uint32_t iss,
    uint32_t irs);
 
@@ -34,9 +34,11 @@
 //Dependencies
 #include "core/net.h"
 #include "core/socket.h"
+#include "core/socket_misc.h"
 #include "core/tcp.h"
 #include "core/tcp_misc.h"
 #include "core/tcp_timer.h"
+#include "ipv4/ipv4_pmtu.h"
 #include "date_time.h"
 #include "debug.h"
 
@@ -55,14 +57,14 @@
 
 void tcpTick(void)
 {
-   uint_t i;
    Socket *socket;
+   Socket *next;
 
-   //Loop through opened sockets
-   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   //Loop through active TCP sockets
+   for(socket = tcpSocketList; socket != NULL; socket = next)
    {
-      //Point to the current socket
-      socket = &socketTable[i];
+      //The 2MSL timer may release the current socket
+      next = socket->next;
 
       //TCP socket?
       if(socket->type == SOCKET_TYPE_STREAM)
@@ -78,6 +80,8 @@ void tcpTick(void)
             tcpCheckKeepAliveTimer(socket);
             //Check override timer
             tcpCheckOverrideTimer(socket);
+            //Check whether a lower PMTU estimate has expired
+            tcpCheckPathMtu(socket);
             //Check FIN-WAIT-2 timer
             tcpCheckFinWait2Timer(socket);
             //Check 2MSL timer
@@ -129,11 +133,39 @@ void tcpCheckRetransmitTimer(Socket *socket)
 
             //Enter the fast loss recovery procedure
             socket->congestState = TCP_CONGEST_STATE_LOSS_RECOVERY;
+
+            //Tracepoint
+            NET_TRACE(NET_TRACE_EVENT_TCP_CWND, socket->descriptor,
+               socket->cwnd, socket->ssthresh, socket->congestState);
 #endif
             //Make sure the maximum number of retransmissions has not been
             //reached
             if(socket->retransmitCount < TCP_MAX_RETRIES)
             {
+#if (IPV4_SUPPORT == ENABLED && IPV4_PMTU_SUPPORT == ENABLED && \
+   IPV4_PMTU_BLACK_HOLE_THRESHOLD > 0)
+               //When full-sized segments are repeatedly lost, the path may
+               //be a PMTU black hole that silently discards large datagrams
+               //instead of returning Datagram Too Big messages. Segments
+               //that would fit the default IPv4 MTU anyway do not qualify
+               if(socket->retransmitCount >= IPV4_PMTU_BLACK_HOLE_THRESHOLD &&
+                  socket->remoteIpAddr.length == sizeof(Ipv4Addr) &&
+                  socket->smss > TCP_DEFAULT_MSS &&
+                  socket->retransmitQueue->length > TCP_DEFAULT_MSS)
+               {
+                  //Fall back to the default IPv4 MTU
+                  ipv4UpdatePathMtu(socket->interface,
+                     socket->remoteIpAddr.ipv4Addr, IPV4_DEFAULT_MTU);
+
+                  //Re-packetize the data so that it fits the new PMTU
+                  if(tcpUpdateSmss(socket))
+                  {
+                     //The SMSS is kept and the fallback is attempted again
+                     //at the next retransmission timeout
+                     TRACE_WARNING("TCP SMSS update failed (insufficient memory)\r\n");
+                  }
+               }
+#endif
                //Debug message
                TRACE_INFO("%s: TCP segment retransmission #%u (%u data bytes)...\r\n",
                   formatSystemTime(osGetSystemTime(), NULL),
@@ -434,11 +466,37 @@ void tcpCheckTimeWaitTimer(Socket *socket)
          {
             //Delete the TCB
             tcpDeleteControlBlock(socket);
-            //Mark the socket as closed
-            socket->type = SOCKET_TYPE_UNUSED;
+            //Release the socket
+            socketFree(socket);
          }
       }
    }
 }
 
+
+/**
+ * @brief Restore the SMSS once a lower PMTU estimate has expired
+ *
+ * PMTU estimates are discarded after a while in order to detect increases
+ * in the PMTU (refer to RFC 1191, section 6.3). The SMSS of a connection
+ * that has been reduced by a Datagram Too Big message or by the black-hole
+ * heuristic is raised again accordingly
+ *
+ * @param[in] socket Handle referencing the socket
+ **/
+
+void tcpCheckPathMtu(Socket *socket)
+{
+#if (IPV4_SUPPORT == ENABLED && IPV4_PMTU_SUPPORT == ENABLED)
+   //Check whether the SMSS has been reduced below the negotiated value
+   if(socket->smss < socket->peerMss &&
+      socket->state != TCP_STATE_LISTEN &&
+      socket->state != TCP_STATE_TIME_WAIT)
+   {
+      //Update the SMSS according to the current PMTU estimate
+      tcpUpdateSmss(socket);
+   }
+#endif
+}
+
 #endif
@@ -45,6 +45,7 @@ void tcpCheckKeepAliveTimer(Socket *socket);
 void tcpCheckOverrideTimer(Socket *socket);
 void tcpCheckFinWait2Timer(Socket *socket);
 void tcpCheckTimeWaitTimer(Socket *socket);
+void tcpCheckPathMtu(Socket *socket);
 
 //C++ guard
 #ifdef __cplusplus
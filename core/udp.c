@@ -36,6 +36,7 @@
 #include "core/ip.h"
 #include "core/udp.h"
 #include "core/socket.h"
+#include "core/socket_misc.h"
 #include "ipv4/ipv4.h"
 #include "ipv4/ipv4_misc.h"
 #include "ipv6/ipv6.h"
@@ -48,10 +49,10 @@
 //Check TCP/IP stack configuration
 #if (UDP_SUPPORT == ENABLED)
 
-//Ephemeral ports are used for dynamic port assignment
-static uint16_t udpDynamicPort;
-//Table that holds the registered user callbacks
-UdpRxCallbackEntry udpCallbackTable[UDP_CALLBACK_TABLE_SIZE];
+#if (NET_MULTI_INSTANCE_SUPPORT == DISABLED)
+//UDP layer state (ephemeral port and registered user callbacks)
+static UdpContext udpContext;
+#endif
 
 
 /**
@@ -61,11 +62,24 @@ UdpRxCallbackEntry udpCallbackTable[UDP_CALLBACK_TABLE_SIZE];
 
 error_t udpInit(void)
 {
-   //Reset ephemeral port number
-   udpDynamicPort = 0;
+   UdpContext *context;
+
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Each stack instance owns its UDP layer state
+   context = osAllocMem(sizeof(UdpContext));
+   //Failed to allocate memory?
+   if(context == NULL)
+      return ERROR_OUT_OF_MEMORY;
+#else
+   //Point to the UDP layer state
+   context = &udpContext;
+#endif
 
-   //Initialize callback table
-   osMemset(udpCallbackTable, 0, sizeof(udpCallbackTable));
+   //Reset ephemeral port number and initialize callback table
+   osMemset(context, 0, sizeof(UdpContext));
+
+   //Attach the UDP layer state to the current stack instance
+   netContext.udpContext = context;
 
    //Successful initialization
    return NO_ERROR;
@@ -82,7 +96,7 @@ uint16_t udpGetDynamicPort(void)
    uint_t port;
 
    //Retrieve current port number
-   port = udpDynamicPort;
+   port = netContext.udpContext->dynamicPort;
 
    //Invalid port number?
    if(port < SOCKET_EPHEMERAL_PORT_MIN || port > SOCKET_EPHEMERAL_PORT_MAX)
@@ -96,12 +110,12 @@ uint16_t udpGetDynamicPort(void)
    if(port < SOCKET_EPHEMERAL_PORT_MAX)
    {
       //Increment port number
-      udpDynamicPort = port + 1;
+      netContext.udpContext->dynamicPort = port + 1;
    }
    else
    {
       //Wrap around if necessary
-      udpDynamicPort = SOCKET_EPHEMERAL_PORT_MIN;
+      netContext.udpContext->dynamicPort = SOCKET_EPHEMERAL_PORT_MIN;
    }
 
    //Return an ephemeral port number
@@ -175,7 +189,12 @@ error_t udpProcessDatagram(NetInterface *interface,
    length = ntohs(header->length);
 
    //When UDP runs over IPv6, the checksum is mandatory
-   if(header->checksum != 0x0000 ||
+   if(ancillary->checksumValid)
+   {
+      //The checksum has already been validated (or omitted by the sender
+      //in the case of a looped back datagram)
+   }
+   else if(header->checksum != 0x0000 ||
       pseudoHeader->length == sizeof(Ipv6PseudoHeader))
    {
       //Verify UDP checksum
@@ -195,12 +214,9 @@ error_t udpProcessDatagram(NetInterface *interface,
       }
    }
 
-   //Loop through opened sockets
-   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   //Loop through active UDP sockets
+   for(socket = udpSocketList; socket != NULL; socket = socket->next)
    {
-      //Point to the current socket
-      socket = socketTable + i;
-
       //UDP socket found?
       if(socket->type != SOCKET_TYPE_DGRAM)
          continue;
@@ -342,7 +358,7 @@ error_t udpProcessDatagram(NetInterface *interface,
    length -= sizeof(UdpHeader);
 
    //No matching socket found?
-   if(i >= SOCKET_MAX_COUNT)
+   if(socket == NULL)
    {
       //Invoke user callback, if any
       error = udpInvokeRxCallback(interface, pseudoHeader, header, buffer,
@@ -468,6 +484,15 @@ error_t udpProcessDatagram(NetInterface *interface,
    //Additional options can be passed to the stack along with the packet
    queueItem->ancillary = *ancillary;
 
+#if (NET_STATS_SUPPORT == ENABLED)
+   //Time elapsed since the datagram was received by the NIC driver
+   if(ancillary->statsTimestamp != 0)
+   {
+      netStatsRecord(NET_STATS_RX_DELIVERY, NET_STATS_GET_TIME_US() -
+         ancillary->statsTimestamp);
+   }
+#endif
+
    //Notify user that data is available
    udpUpdateEvents(socket);
 
@@ -490,13 +515,56 @@ error_t udpProcessDatagram(NetInterface *interface,
  **/
 
 error_t udpSendDatagram(Socket *socket, const SocketMsg *message, uint_t flags)
+{
+   //Send the datagram without route caching
+   return udpSendDatagramEx(socket, message, flags, NULL);
+}
+
+
+/**
+ * @brief Send a UDP datagram, reusing the route of the previous datagram
+ *
+ * Consecutive datagrams of a batch that are sent to the same destination
+ * share the result of the source address selection and of the address
+ * resolution, which are performed only once
+ *
+ * @param[in] socket Handle referencing the socket
+ * @param[in] message Pointer to the structure describing the datagram
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @param[in,out] cache Route cache shared by the datagrams of the batch
+ *   (optional parameter)
+ * @return Error code
+ **/
+
+error_t udpSendDatagramEx(Socket *socket, const SocketMsg *message,
+   uint_t flags, UdpRouteCache *cache)
 {
    error_t error;
    size_t offset;
+   size_t segmentSize;
+   bool_t cached;
    NetBuffer *buffer;
    NetInterface *interface;
+   const IpAddr *srcIpAddr;
    NetTxAncillary ancillary;
 
+   //The segment size can be specified per message or per socket
+   if(message->segmentSize != 0)
+   {
+      segmentSize = message->segmentSize;
+   }
+   else
+   {
+      segmentSize = socket->segmentSize;
+   }
+
+   //Large send that must be split into a train of datagrams?
+   if(segmentSize != 0 && message->length > segmentSize)
+   {
+      return udpSendSegmentedDatagram(socket, message, flags, segmentSize,
+         cache);
+   }
+
    //Select the relevant network interface
    if(message->interface != NULL)
    {
@@ -507,6 +575,53 @@ error_t udpSendDatagram(Socket *socket, const SocketMsg *message, uint_t flags)
       interface = socket->interface;
    }
 
+   //Source address specified by the application
+   srcIpAddr = &message->srcIpAddr;
+   //The route cache is not used by default
+   cached = FALSE;
+
+   //The route cache only applies when the stack selects the source address
+   if(cache != NULL && message->srcIpAddr.length == 0)
+   {
+      //Same destination as the previous datagram?
+      if(cache->valid && cache->interface == interface &&
+         ipCompAddr(&cache->destIpAddr, &message->destIpAddr))
+      {
+         //Reuse the route of the previous datagram
+         cached = TRUE;
+      }
+      else
+      {
+         //Invalidate the route cache
+         cache->valid = FALSE;
+         cache->interface = interface;
+         cache->destIpAddr = message->destIpAddr;
+         cache->outInterface = interface;
+#if (ETH_SUPPORT == ENABLED)
+         cache->destMacAddr = MAC_UNSPECIFIED_ADDR;
+#endif
+
+         //Select the source address and the relevant network interface
+         error = ipSelectSourceAddr(&cache->outInterface, &message->destIpAddr,
+            &cache->srcIpAddr);
+
+         //Valid route (broadcast destinations are left to the stack)?
+         if(!error && cache->outInterface != NULL)
+         {
+            //Save the route for subsequent datagrams
+            cache->valid = TRUE;
+            cached = TRUE;
+         }
+      }
+
+      //Valid route?
+      if(cached)
+      {
+         interface = cache->outInterface;
+         srcIpAddr = &cache->srcIpAddr;
+      }
+   }
+
    //Allocate a memory buffer to hold the UDP datagram
    buffer = udpAllocBuffer(0, &offset);
    //Failed to allocate buffer?
@@ -573,6 +688,12 @@ error_t udpSendDatagram(Socket *socket, const SocketMsg *message, uint_t flags)
       //Set source and destination MAC addresses
       ancillary.srcMacAddr = message->srcMacAddr;
       ancillary.destMacAddr = message->destMacAddr;
+
+      //The destination address may already be resolved
+      if(cached && macCompAddr(&ancillary.destMacAddr, &MAC_UNSPECIFIED_ADDR))
+      {
+         ancillary.destMacAddr = cache->destMacAddr;
+      }
 #endif
 
 #if (ETH_VLAN_SUPPORT == ENABLED)
@@ -598,8 +719,17 @@ error_t udpSendDatagram(Socket *socket, const SocketMsg *message, uint_t flags)
 #endif
 
       //Send UDP datagram
-      error = udpSendBuffer(interface, &message->srcIpAddr, socket->localPort,
+      error = udpSendBuffer(interface, srcIpAddr, socket->localPort,
          &message->destIpAddr, message->destPort, buffer, offset, &ancillary);
+
+#if (ETH_SUPPORT == ENABLED)
+      //Save the resolved link-layer address for subsequent datagrams
+      if(!error && cached &&
+         macCompAddr(&message->destMacAddr, &MAC_UNSPECIFIED_ADDR))
+      {
+         cache->destMacAddr = ancillary.destMacAddr;
+      }
+#endif
    }
 
    //Free previously allocated memory
@@ -610,6 +740,71 @@ error_t udpSendDatagram(Socket *socket, const SocketMsg *message, uint_t flags)
 }
 
 
+/**
+ * @brief Split a large send into a train of UDP datagrams
+ *
+ * The payload is sent as consecutive datagrams of segmentSize bytes (the
+ * last one may be shorter) that share the same destination, so that the
+ * source address selection and the address resolution are performed once
+ *
+ * @param[in] socket Handle referencing the socket
+ * @param[in] message Pointer to the structure describing the payload
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @param[in] segmentSize Size of the payload of each datagram, in bytes
+ * @param[in,out] cache Route cache shared by the datagrams (optional parameter)
+ * @return Error code
+ **/
+
+error_t udpSendSegmentedDatagram(Socket *socket, const SocketMsg *message,
+   uint_t flags, size_t segmentSize, UdpRouteCache *cache)
+{
+   error_t error;
+   size_t n;
+   size_t length;
+   SocketMsg segment;
+   UdpRouteCache localCache;
+
+   //Check parameters
+   if(segmentSize == 0 || segmentSize > UINT16_MAX)
+      return ERROR_INVALID_PARAMETER;
+
+   //Limit the number of datagrams that can be generated by a single send
+   if(((message->length + segmentSize - 1) / segmentSize) > UDP_MAX_SEGMENTS)
+      return ERROR_MESSAGE_TOO_LONG;
+
+   //The datagrams of the train share the same route
+   if(cache == NULL)
+   {
+      osMemset(&localCache, 0, sizeof(UdpRouteCache));
+      cache = &localCache;
+   }
+
+   //All the datagrams inherit the options of the original message
+   segment = *message;
+   segment.segmentSize = segmentSize;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Send the payload one segment at a time
+   for(n = 0; n < message->length && !error; n += length)
+   {
+      //The last datagram may be shorter than the segment size
+      length = MIN(message->length - n, segmentSize);
+
+      //Point to the payload of the current datagram
+      segment.data = (uint8_t *) message->data + n;
+      segment.length = length;
+
+      //Send UDP datagram
+      error = udpSendDatagramEx(socket, &segment, flags, cache);
+   }
+
+   //Return status code
+   return error;
+}
+
+
 /**
  * @brief Send a UDP datagram
  * @param[in] interface Underlying network interface
@@ -710,8 +905,11 @@ error_t udpSendBuffer(NetInterface *interface, const IpAddr *srcIpAddr,
       pseudoHeader.ipv4Data.length = htons(length);
 
       //Calculate UDP header checksum
-      header->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv4Data,
-         sizeof(Ipv4PseudoHeader), buffer, offset, length);
+      if(!ipIsChecksumBypassed(destIpAddr))
+      {
+         header->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv4Data,
+            sizeof(Ipv4PseudoHeader), buffer, offset, length);
+      }
    }
    else
 #endif
@@ -752,8 +950,11 @@ error_t udpSendBuffer(NetInterface *interface, const IpAddr *srcIpAddr,
       pseudoHeader.ipv6Data.nextHeader = IPV6_UDP_HEADER;
 
       //Calculate UDP header checksum
-      header->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv6Data,
-         sizeof(Ipv6PseudoHeader), buffer, offset, length);
+      if(!ipIsChecksumBypassed(destIpAddr))
+      {
+         header->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv6Data,
+            sizeof(Ipv6PseudoHeader), buffer, offset, length);
+      }
    }
    else
 #endif
@@ -766,7 +967,7 @@ error_t udpSendBuffer(NetInterface *interface, const IpAddr *srcIpAddr,
    //If the computed checksum is zero, it is transmitted as all ones. An all
    //zero transmitted checksum value means that the transmitter generated no
    //checksum
-   if(header->checksum == 0x0000)
+   if(header->checksum == 0x0000 && !ipIsChecksumBypassed(destIpAddr))
    {
       header->checksum = 0xFFFF;
    }
@@ -801,23 +1002,34 @@ error_t udpReceiveDatagram(Socket *socket, SocketMsg *message, uint_t flags)
 {
    error_t error;
    SocketQueueItem *queueItem;
+   systime_t timeout;
 
    //The SOCKET_FLAG_DONT_WAIT enables non-blocking operation
    if((flags & SOCKET_FLAG_DONT_WAIT) == 0)
    {
+      //Maximum time to wait for incoming data
+      timeout = socket->timeout;
+
       //Check whether the receive queue is empty
       if(socket->receiveQueue == NULL)
       {
          //Set the events the application is interested in
          socket->eventMask = SOCKET_EVENT_RX_READY;
 
+         //Busy-poll the network interfaces before blocking, if enabled
+         timeout = socketBusyPoll(socket, timeout);
+      }
+
+      //Check whether the receive queue is still empty
+      if(socket->receiveQueue == NULL)
+      {
          //Reset the event object
          osResetEvent(&socket->event);
 
          //Release exclusive access
          osReleaseMutex(&netMutex);
          //Wait until an event is triggered
-         osWaitForEvent(&socket->event, socket->timeout);
+         osWaitForEvent(&socket->event, timeout);
          //Get exclusive access
          osAcquireMutex(&netMutex);
       }
@@ -948,6 +1160,9 @@ void udpUpdateEvents(Socket *socket)
       }
    }
 
+   //Notify the ready list the socket is attached to, if any
+   socketReadyListUpdate(socket);
+
    //Mask unused events
    socket->eventFlags &= socket->eventMask;
 
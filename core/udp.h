@@ -57,6 +57,13 @@
    #error UDP_RX_QUEUE_SIZE parameter is not valid
 #endif
 
+//Maximum number of datagrams a single send can be split into
+#ifndef UDP_MAX_SEGMENTS
+   #define UDP_MAX_SEGMENTS 64
+#elif (UDP_MAX_SEGMENTS < 1)
+   #error UDP_MAX_SEGMENTS parameter is not valid
+#endif
+
 //C++ guard
 #ifdef __cplusplus
 extern "C" {
@@ -116,8 +123,36 @@ typedef struct
 } UdpRxCallbackEntry;
 
 
-//Global variables
-extern UdpRxCallbackEntry udpCallbackTable[UDP_CALLBACK_TABLE_SIZE];
+/**
+ * @brief Route cache shared by consecutive datagrams of a batch
+ **/
+
+typedef struct
+{
+   bool_t valid;
+   NetInterface *interface;
+   IpAddr destIpAddr;
+   NetInterface *outInterface;
+   IpAddr srcIpAddr;
+#if (ETH_SUPPORT == ENABLED)
+   MacAddr destMacAddr;
+#endif
+} UdpRouteCache;
+
+
+/**
+ * @brief UDP layer state
+ **/
+
+typedef struct _UdpContext
+{
+   uint16_t dynamicPort;                                      ///<Next ephemeral port
+   UdpRxCallbackEntry callbackTable[UDP_CALLBACK_TABLE_SIZE]; ///<Registered user callbacks
+} UdpContext;
+
+
+//Per-instance UDP layer state
+#define udpCallbackTable (netContext.udpContext->callbackTable)
 
 //UDP related functions
 error_t udpInit(void);
@@ -129,6 +164,12 @@ error_t udpProcessDatagram(NetInterface *interface,
 
 error_t udpSendDatagram(Socket *socket, const SocketMsg *message, uint_t flags);
 
+error_t udpSendDatagramEx(Socket *socket, const SocketMsg *message,
+   uint_t flags, UdpRouteCache *cache);
+
+error_t udpSendSegmentedDatagram(Socket *socket, const SocketMsg *message,
+   uint_t flags, size_t segmentSize, UdpRouteCache *cache);
+
 error_t udpSendBuffer(NetInterface *interface, const IpAddr *srcIpAddr,
    uint16_t srcPort, const IpAddr *destIpAddr, uint16_t destPort,
    NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary);
@@ -45,9 +45,6 @@
 //Check TCP/IP stack configuration
 #if (IPV4_SUPPORT == ENABLED && DHCP_CLIENT_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t dhcpClientTickCounter;
-
 //Requested DHCP options
 const uint8_t dhcpOptionList[] =
 {
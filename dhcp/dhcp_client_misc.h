@@ -40,9 +40,6 @@
 extern "C" {
 #endif
 
-//Tick counter to handle periodic operations
-extern systime_t dhcpClientTickCounter;
-
 //DHCP client related functions
 void dhcpClientTick(DhcpClientContext *context);
 void dhcpClientLinkChangeEvent(DhcpClientContext *context);
@@ -43,9 +43,6 @@
 //Check TCP/IP stack configuration
 #if (IPV4_SUPPORT == ENABLED && DHCP_SERVER_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t dhcpServerTickCounter;
-
 
 /**
  * @brief DHCP server timer handler
@@ -40,9 +40,6 @@
 extern "C" {
 #endif
 
-//Tick counter to handle periodic operations
-extern systime_t dhcpServerTickCounter;
-
 //DHCP server related functions
 void dhcpServerTick(DhcpServerContext *context);
 
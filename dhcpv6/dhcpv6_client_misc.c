@@ -48,9 +48,6 @@
 //Check TCP/IP stack configuration
 #if (IPV6_SUPPORT == ENABLED && DHCPV6_CLIENT_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t dhcpv6ClientTickCounter;
-
 //Requested DHCPv6 options
 static const uint16_t dhcpv6OptionList[] =
 {
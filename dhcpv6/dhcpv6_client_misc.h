@@ -40,9 +40,6 @@
 extern "C" {
 #endif
 
-//Tick counter to handle periodic operations
-extern systime_t dhcpv6ClientTickCounter;
-
 //DHCPv6 client related functions
 void dhcpv6ClientTick(Dhcpv6ClientContext *context);
 void dhcpv6ClientLinkChangeEvent(Dhcpv6ClientContext *context);
@@ -46,10 +46,10 @@
 #if (DNS_CLIENT_SUPPORT == ENABLED || MDNS_CLIENT_SUPPORT == ENABLED || \
    NBNS_CLIENT_SUPPORT == ENABLED || LLMNR_CLIENT_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t dnsTickCounter;
+#if (NET_MULTI_INSTANCE_SUPPORT == DISABLED)
 //DNS cache
-DnsCacheEntry dnsCache[DNS_CACHE_SIZE];
+static DnsCacheContext dnsCacheContext;
+#endif
 
 
 /**
@@ -59,8 +59,24 @@ DnsCacheEntry dnsCache[DNS_CACHE_SIZE];
 
 error_t dnsInit(void)
 {
+   DnsCacheContext *context;
+
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Each stack instance owns its DNS cache
+   context = osAllocMem(sizeof(DnsCacheContext));
+   //Failed to allocate memory?
+   if(context == NULL)
+      return ERROR_OUT_OF_MEMORY;
+#else
+   //Point to the DNS cache
+   context = &dnsCacheContext;
+#endif
+
    //Initialize DNS cache
-   osMemset(dnsCache, 0, sizeof(dnsCache));
+   osMemset(context, 0, sizeof(DnsCacheContext));
+
+   //Attach the DNS cache to the current stack instance
+   netContext.dnsCacheContext = context;
 
    //Successful initialization
    return NO_ERROR;
@@ -111,9 +111,18 @@ typedef struct
 } DnsCacheEntry;
 
 
-//Global variables
-extern systime_t dnsTickCounter;
-extern DnsCacheEntry dnsCache[DNS_CACHE_SIZE];
+/**
+ * @brief DNS cache
+ **/
+
+typedef struct _DnsCacheContext
+{
+   DnsCacheEntry entries[DNS_CACHE_SIZE]; ///<DNS cache entries
+} DnsCacheContext;
+
+
+//Per-instance DNS cache
+#define dnsCache (netContext.dnsCacheContext->entries)
 
 //DNS related functions
 error_t dnsInit(void);
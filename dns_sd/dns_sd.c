@@ -50,9 +50,6 @@
 //Check TCP/IP stack configuration
 #if (DNS_SD_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t dnsSdTickCounter;
-
 
 /**
  * @brief Initialize settings with default values
@@ -150,9 +150,6 @@ struct _DnsSdContext
 };
 
 
-//Tick counter to handle periodic operations
-extern systime_t dnsSdTickCounter;
-
 //DNS-SD related functions
 void dnsSdGetDefaultSettings(DnsSdSettings *settings);
 error_t dnsSdInit(DnsSdContext *context, const DnsSdSettings *settings);
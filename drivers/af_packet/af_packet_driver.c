@@ -0,0 +1,1007 @@
+/**
+ * @file af_packet_driver.c
+ * @brief Linux AF_PACKET (TPACKET_V3) driver
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include <stdlib.h>
+#include "core/net.h"
+#include "drivers/af_packet/af_packet_driver.h"
+#include "debug.h"
+
+//Undefine conflicting definitions
+#undef Socket
+#undef htons
+#undef htonl
+#undef ntohs
+#undef ntohl
+
+//Linux dependencies
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/if_tun.h>
+
+//Undefine conflicting definitions
+#undef interface
+
+//Number of frames in the transmit ring
+#define AF_PACKET_DRIVER_TX_FRAME_COUNT (AF_PACKET_DRIVER_TX_BLOCK_COUNT * \
+   (AF_PACKET_DRIVER_BLOCK_SIZE / AF_PACKET_DRIVER_FRAME_SIZE))
+
+//Offset to the frame data in a transmit ring slot
+#define AF_PACKET_DRIVER_TX_DATA_OFFSET (TPACKET3_HDRLEN - \
+   sizeof(struct sockaddr_ll))
+
+
+/**
+ * @brief AF_PACKET driver context
+ **/
+
+typedef struct
+{
+   char_t deviceName[IF_NAMESIZE]; ///<Name of the host network interface
+   int fd;                  ///<Packet socket or TAP device descriptor
+   bool_t tap;              ///<The TAP device fallback is in use
+   int ifIndex;             ///<Index of the host network interface
+   uint8_t *ring;           ///<Memory-mapped RX and TX rings
+   size_t ringSize;         ///<Total size of the mapped rings
+   uint_t rxBlockIndex;     ///<Index of the next RX block to process
+   uint_t rxFrameIndex;     ///<Index of the next frame to process within the current RX block
+   size_t rxFrameOffset;    ///<Offset of the next frame to process within the current RX block
+   uint_t txFrameIndex;     ///<Index of the next TX frame to use
+   uint_t txPending;        ///<Number of TX frames queued since the last kick
+   OsEvent rxEvent;         ///<RX processing completed
+   uint8_t buffer[AF_PACKET_DRIVER_MAX_PACKET_SIZE + 4]; ///<Bounce buffer
+} AfPacketDriverContext;
+
+
+/**
+ * @brief AF_PACKET driver
+ **/
+
+const NicDriver afPacketDriver =
+{
+   NIC_TYPE_ETHERNET,
+   ETH_MTU,
+   afPacketDriverInit,
+   afPacketDriverTick,
+   afPacketDriverEnableIrq,
+   afPacketDriverDisableIrq,
+   afPacketDriverEventHandler,
+   afPacketDriverSendPacket,
+   afPacketDriverUpdateMacAddrFilter,
+   NULL,
+   NULL,
+   NULL,
+   TRUE,
+   TRUE,
+   TRUE,
+   TRUE
+};
+
+
+/**
+ * @brief Open a packet socket with memory-mapped TPACKET_V3 rings
+ * @param[in] context Pointer to the driver context
+ * @param[in] name Name of the host network interface
+ * @return Error code
+ **/
+
+static error_t afPacketDriverOpenSocket(AfPacketDriverContext *context,
+   const char_t *name)
+{
+   int ret;
+   int version;
+   struct tpacket_req3 req;
+   struct sockaddr_ll addr;
+   struct packet_mreq mreq;
+
+   //Retrieve the index of the host network interface
+   context->ifIndex = if_nametoindex(name);
+   //Unknown interface?
+   if(context->ifIndex == 0)
+      return ERROR_INVALID_INTERFACE;
+
+   //Open a raw packet socket
+   context->fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+   //Failed to open socket?
+   if(context->fd < 0)
+      return ERROR_OPEN_FAILED;
+
+   //Start of exception handling block
+   do
+   {
+      //Select the TPACKET_V3 frame format
+      version = TPACKET_V3;
+      ret = setsockopt(context->fd, SOL_PACKET, PACKET_VERSION, &version,
+         sizeof(version));
+      //Any error to report?
+      if(ret < 0)
+         break;
+
+      //Set up the receive ring. Frames are delivered to the application a
+      //whole block at a time
+      osMemset(&req, 0, sizeof(req));
+      req.tp_block_size = AF_PACKET_DRIVER_BLOCK_SIZE;
+      req.tp_block_nr = AF_PACKET_DRIVER_RX_BLOCK_COUNT;
+      req.tp_frame_size = AF_PACKET_DRIVER_FRAME_SIZE;
+      req.tp_frame_nr = AF_PACKET_DRIVER_RX_BLOCK_COUNT *
+         (AF_PACKET_DRIVER_BLOCK_SIZE / AF_PACKET_DRIVER_FRAME_SIZE);
+      req.tp_retire_blk_tov = AF_PACKET_DRIVER_BLOCK_TIMEOUT;
+
+      ret = setsockopt(context->fd, SOL_PACKET, PACKET_RX_RING, &req,
+         sizeof(req));
+      //Any error to report?
+      if(ret < 0)
+         break;
+
+      //Set up the transmit ring
+      osMemset(&req, 0, sizeof(req));
+      req.tp_block_size = AF_PACKET_DRIVER_BLOCK_SIZE;
+      req.tp_block_nr = AF_PACKET_DRIVER_TX_BLOCK_COUNT;
+      req.tp_frame_size = AF_PACKET_DRIVER_FRAME_SIZE;
+      req.tp_frame_nr = AF_PACKET_DRIVER_TX_FRAME_COUNT;
+
+      ret = setsockopt(context->fd, SOL_PACKET, PACKET_TX_RING, &req,
+         sizeof(req));
+      //Any error to report?
+      if(ret < 0)
+         break;
+
+      //The RX ring is immediately followed by the TX ring
+      context->ringSize = (AF_PACKET_DRIVER_RX_BLOCK_COUNT +
+         AF_PACKET_DRIVER_TX_BLOCK_COUNT) * AF_PACKET_DRIVER_BLOCK_SIZE;
+
+      //Map both rings into the address space of the process
+      context->ring = mmap(NULL, context->ringSize, PROT_READ | PROT_WRITE,
+         MAP_SHARED | MAP_LOCKED, context->fd, 0);
+
+      //Failed to map the rings?
+      if(context->ring == MAP_FAILED)
+      {
+         context->ring = NULL;
+         ret = -1;
+         break;
+      }
+
+      //Bind the socket to the host network interface
+      osMemset(&addr, 0, sizeof(addr));
+      addr.sll_family = AF_PACKET;
+      addr.sll_protocol = htons(ETH_P_ALL);
+      addr.sll_ifindex = context->ifIndex;
+
+      ret = bind(context->fd, (struct sockaddr *) &addr, sizeof(addr));
+      //Any error to report?
+      if(ret < 0)
+         break;
+
+      //The stack uses its own MAC address, so the host interface must be
+      //placed in promiscuous mode
+      osMemset(&mreq, 0, sizeof(mreq));
+      mreq.mr_ifindex = context->ifIndex;
+      mreq.mr_type = PACKET_MR_PROMISC;
+
+      ret = setsockopt(context->fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq,
+         sizeof(mreq));
+
+      //End of exception handling block
+   } while(0);
+
+   //Any error to report?
+   if(ret < 0)
+   {
+      //Clean up side effects
+      if(context->ring != NULL)
+      {
+         munmap(context->ring, context->ringSize);
+         context->ring = NULL;
+      }
+
+      close(context->fd);
+      context->fd = -1;
+
+      //Report an error
+      return ERROR_OPEN_FAILED;
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+#if (AF_PACKET_DRIVER_TAP_SUPPORT == ENABLED)
+
+/**
+ * @brief Open a TAP device
+ * @param[in] context Pointer to the driver context
+ * @param[in] name Name of the TAP device
+ * @return Error code
+ **/
+
+static error_t afPacketDriverOpenTap(AfPacketDriverContext *context,
+   const char_t *name)
+{
+   int ret;
+   struct ifreq ifr;
+
+   //Open the clone device
+   context->fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+   //Failed to open device?
+   if(context->fd < 0)
+      return ERROR_OPEN_FAILED;
+
+   //Frames are exchanged without the packet information header
+   osMemset(&ifr, 0, sizeof(ifr));
+   ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+   strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+
+   //Attach to the TAP device
+   ret = ioctl(context->fd, TUNSETIFF, &ifr);
+
+   //Any error to report?
+   if(ret < 0)
+   {
+      //Clean up side effects
+      close(context->fd);
+      context->fd = -1;
+
+      //Report an error
+      return ERROR_OPEN_FAILED;
+   }
+
+   //The TAP device is now in use
+   context->tap = TRUE;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+#endif
+
+
+/**
+ * @brief Ask the kernel to transmit the pending frames of the TX ring
+ * @param[in] context Pointer to the AF_PACKET driver context
+ * @return Error code
+ **/
+
+static error_t afPacketDriverKickTx(AfPacketDriverContext *context)
+{
+   error_t error;
+
+   //Flush the pending frames without blocking
+   if(send(context->fd, NULL, 0, MSG_DONTWAIT) < 0 && errno != EAGAIN)
+   {
+      error = ERROR_FAILURE;
+   }
+   else
+   {
+      error = NO_ERROR;
+   }
+
+   //No more frames are waiting for a kick
+   context->txPending = 0;
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Allocate the AF_PACKET driver context of an interface
+ * @param[in] interface Underlying network interface
+ * @return Pointer to the driver context, or NULL if there is insufficient
+ *   memory available
+ **/
+
+static AfPacketDriverContext *afPacketDriverAllocContext(
+   NetInterface *interface)
+{
+   AfPacketDriverContext *context;
+
+   //Point to the driver context attached to the interface, if any
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+   //The context is allocated on first use
+   if(context == NULL)
+   {
+      //Allocate AF_PACKET driver context
+      context = (AfPacketDriverContext *) osAllocMem(
+         sizeof(AfPacketDriverContext));
+
+      //Successful memory allocation?
+      if(context != NULL)
+      {
+         //Clear AF_PACKET driver context
+         osMemset(context, 0, sizeof(AfPacketDriverContext));
+         context->fd = -1;
+
+         //Attach the AF_PACKET driver context to the network interface
+         *((AfPacketDriverContext **) interface->nicContext) = context;
+      }
+   }
+
+   //Return a pointer to the driver context
+   return context;
+}
+
+
+/**
+ * @brief Select the host network interface
+ *
+ * This function must be called before the interface is configured. The
+ * AF_PACKET_DRIVER_DEVICE_NAME interface is used by default
+ *
+ * @param[in] interface Underlying network interface
+ * @param[in] name Name of the host network interface
+ * @return Error code
+ **/
+
+error_t afPacketDriverSetDeviceName(NetInterface *interface,
+   const char_t *name)
+{
+   AfPacketDriverContext *context;
+
+   //Check parameters
+   if(interface == NULL || name == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Make sure the name is not too long
+   if(osStrlen(name) >= IF_NAMESIZE)
+      return ERROR_INVALID_LENGTH;
+
+   //Retrieve the driver context
+   context = afPacketDriverAllocContext(interface);
+   //Failed to allocate memory?
+   if(context == NULL)
+      return ERROR_OUT_OF_MEMORY;
+
+   //The interface is already initialized?
+   if(context->fd >= 0)
+      return ERROR_WRONG_STATE;
+
+   //Save the name of the host interface
+   osStrcpy(context->deviceName, name);
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief AF_PACKET driver initialization
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t afPacketDriverInit(NetInterface *interface)
+{
+   error_t error;
+   AfPacketDriverContext *context;
+#if (NET_RTOS_SUPPORT == ENABLED)
+   OsTaskId taskId;
+#endif
+
+   //Debug message
+   TRACE_INFO("Initializing AF_PACKET driver...\r\n");
+
+   //Retrieve the AF_PACKET driver context
+   context = afPacketDriverAllocContext(interface);
+
+   //Failed to allocate memory?
+   if(context == NULL)
+   {
+      //Debug message
+      printf("Failed to allocate context!\r\n");
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //Use the default host interface unless another one has been selected
+   if(context->deviceName[0] == '\0')
+   {
+      strncpy(context->deviceName, AF_PACKET_DRIVER_DEVICE_NAME,
+         IF_NAMESIZE - 1);
+   }
+
+   //Open a packet socket bound to the host interface
+   error = afPacketDriverOpenSocket(context, context->deviceName);
+
+#if (AF_PACKET_DRIVER_TAP_SUPPORT == ENABLED)
+   //Opening a packet socket requires the CAP_NET_RAW capability. Fall back
+   //to a TAP device if it is not available
+   if(error)
+   {
+      //Debug message
+      printf("Failed to open packet socket on %s, trying %s...\r\n",
+         context->deviceName, AF_PACKET_DRIVER_TAP_NAME);
+
+      //Open the TAP device
+      error = afPacketDriverOpenTap(context, AF_PACKET_DRIVER_TAP_NAME);
+   }
+#endif
+
+   //Failed to open device?
+   if(error)
+   {
+      //Debug message
+      printf("Failed to open device!\r\n");
+
+      //Clean up side effects
+      *((AfPacketDriverContext **) interface->nicContext) = NULL;
+      osFreeMem(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //Create an event object to synchronize with the receive task
+   if(!osCreateEvent(&context->rxEvent))
+   {
+      //Debug message
+      printf("Failed to create event!\r\n");
+
+      //Clean up side effects
+      if(context->ring != NULL)
+      {
+         munmap(context->ring, context->ringSize);
+      }
+
+      close(context->fd);
+      *((AfPacketDriverContext **) interface->nicContext) = NULL;
+      osFreeMem(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+   //Create the receive task
+   taskId = osCreateTask("AF_PACKET", (OsTaskCode) afPacketDriverTask,
+      interface, NULL);
+
+   //Failed to create the task?
+   if(taskId == OS_INVALID_TASK_ID)
+   {
+      //Debug message
+      printf("Failed to create task!\r\n");
+
+      //Clean up side effects
+      if(context->ring != NULL)
+      {
+         munmap(context->ring, context->ringSize);
+      }
+
+      osDeleteEvent(&context->rxEvent);
+      close(context->fd);
+      *((AfPacketDriverContext **) interface->nicContext) = NULL;
+      osFreeMem(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+#endif
+
+   //Force the TCP/IP stack to poll the link state at startup
+   interface->nicEvent = TRUE;
+   osSetEvent(&interface->context->event);
+
+   //Accept any packets from the upper layer
+   osSetEvent(&interface->nicTxEvent);
+
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief AF_PACKET timer handler
+ *
+ * This routine is periodically called by the TCP/IP stack to handle periodic
+ * operations such as polling the link state
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverTick(NetInterface *interface)
+{
+   bool_t linkState;
+   struct ifreq ifr;
+   AfPacketDriverContext *context;
+
+   //Point to the AF_PACKET driver context
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+   //The link of a TAP device is always up
+   if(context->tap)
+   {
+      linkState = TRUE;
+   }
+   else
+   {
+      //Retrieve the flags of the host interface
+      osMemset(&ifr, 0, sizeof(ifr));
+      if_indextoname(context->ifIndex, ifr.ifr_name);
+
+      //Check whether the host interface is operational
+      if(ioctl(context->fd, SIOCGIFFLAGS, &ifr) == 0)
+      {
+         linkState = (ifr.ifr_flags & IFF_RUNNING) ? TRUE : FALSE;
+      }
+      else
+      {
+         linkState = interface->linkState;
+      }
+   }
+
+   //Link state change detected?
+   if(linkState != interface->linkState)
+   {
+      //Update link state
+      interface->linkState = linkState;
+      //Process link state change event
+      nicNotifyLinkChange(interface);
+   }
+}
+
+
+/**
+ * @brief Enable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverEnableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Disable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverDisableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Pass a frame from the receive ring to the upper layer
+ * @param[in] interface Underlying network interface
+ * @param[in] header Pointer to the TPACKET_V3 frame header
+ **/
+
+static void afPacketDriverProcessFrame(NetInterface *interface,
+   struct tpacket3_hdr *header)
+{
+   size_t length;
+   uint8_t *frame;
+   struct sockaddr_ll *addr;
+   AfPacketDriverContext *context;
+   NetRxAncillary ancillary;
+
+   //Point to the AF_PACKET driver context
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+   //Point to the link-layer address information
+   addr = (struct sockaddr_ll *) ((uint8_t *) header +
+      TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+   //Discard the frames that have been sent by the stack itself
+   if(addr->sll_pkttype == PACKET_OUTGOING)
+      return;
+
+   //Point to the Ethernet frame
+   frame = (uint8_t *) header + header->tp_mac;
+   length = header->tp_snaplen;
+
+   //Check the length of the received frame
+   if(length < sizeof(EthHeader) || length > AF_PACKET_DRIVER_MAX_PACKET_SIZE)
+      return;
+
+   //The kernel strips the 802.1Q tag when VLAN offloading is enabled
+   if((header->tp_status & TP_STATUS_VLAN_VALID) != 0)
+   {
+      uint16_t tpid;
+
+      //Retrieve the tag protocol identifier
+      if((header->tp_status & TP_STATUS_VLAN_TPID_VALID) != 0)
+      {
+         tpid = header->hv1.tp_vlan_tpid;
+      }
+      else
+      {
+         tpid = ETH_TYPE_VLAN;
+      }
+
+      //The tag must be re-inserted before passing the frame to the stack,
+      //which requires a copy
+      osMemcpy(context->buffer, frame, 2 * sizeof(MacAddr));
+      STORE16BE(tpid, context->buffer + 12);
+      STORE16BE(header->hv1.tp_vlan_tci, context->buffer + 14);
+      osMemcpy(context->buffer + 16, frame + 12, length - 12);
+
+      //Point to the rebuilt frame
+      frame = context->buffer;
+      length += 4;
+   }
+
+   //Additional options can be passed to the stack along with the packet
+   ancillary = NET_DEFAULT_RX_ANCILLARY;
+
+   //The frame is processed in place, directly from the receive ring
+   nicProcessPacket(interface, frame, length, &ancillary);
+}
+
+
+/**
+ * @brief AF_PACKET event handler
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverEventHandler(NetInterface *interface)
+{
+   uint_t i;
+   uint_t n;
+   struct tpacket_block_desc *block;
+   struct tpacket3_hdr *header;
+   AfPacketDriverContext *context;
+
+   //Point to the AF_PACKET driver context
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+   //Link up event is pending?
+   if(!interface->linkState)
+   {
+      //Poll the link state of the host interface
+      afPacketDriverTick(interface);
+   }
+
+#if (AF_PACKET_DRIVER_TAP_SUPPORT == ENABLED)
+   //TAP device?
+   if(context->tap)
+   {
+      ssize_t ret;
+      NetRxAncillary ancillary;
+
+      //Process pending packets until the RX budget is exhausted
+      while(nicRxBudgetAvailable(interface))
+      {
+         //Read the next frame from the TAP device
+         ret = read(context->fd, context->buffer,
+            AF_PACKET_DRIVER_MAX_PACKET_SIZE);
+
+         //No more frames?
+         if(ret <= 0)
+            break;
+
+         //Additional options can be passed to the stack along with the packet
+         ancillary = NET_DEFAULT_RX_ANCILLARY;
+
+         //Pass the packet to the upper layer
+         nicProcessPacket(interface, context->buffer, ret, &ancillary);
+      }
+   }
+   else
+#endif
+   {
+      //Process the blocks that have been handed over by the kernel
+      for(i = 0; i < AF_PACKET_DRIVER_RX_BLOCK_COUNT &&
+         nicRxBudgetAvailable(interface); i++)
+      {
+         //Point to the current block
+         block = (struct tpacket_block_desc *) (context->ring +
+            context->rxBlockIndex * AF_PACKET_DRIVER_BLOCK_SIZE);
+
+         //The block is still owned by the kernel?
+         if((block->hdr.bh1.block_status & TP_STATUS_USER) == 0)
+            break;
+
+         //Resume where the previous round stopped
+         if(context->rxFrameIndex == 0)
+         {
+            context->rxFrameOffset = block->hdr.bh1.offset_to_first_pkt;
+         }
+
+         //Point to the next frame of the block
+         header = (struct tpacket3_hdr *) ((uint8_t *) block +
+            context->rxFrameOffset);
+
+         //Deliver the frames of the block until the RX budget is exhausted
+         for(n = context->rxFrameIndex; n < block->hdr.bh1.num_pkts &&
+            nicRxBudgetAvailable(interface); n++)
+         {
+            //Pass the frame to the upper layer
+            afPacketDriverProcessFrame(interface, header);
+
+            //Point to the next frame
+            header = (struct tpacket3_hdr *) ((uint8_t *) header +
+               header->tp_next_offset);
+         }
+
+         //The RX budget has been exhausted before the end of the block?
+         if(n < block->hdr.bh1.num_pkts)
+         {
+            //The block is not returned to the kernel, so that the next round
+            //resumes with the first frame that has not been processed
+            context->rxFrameIndex = n;
+            context->rxFrameOffset = (uint8_t *) header - (uint8_t *) block;
+            break;
+         }
+
+         //Make sure all accesses to the block are complete before the block
+         //is returned to the kernel
+         __sync_synchronize();
+         block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+
+         //Point to the next block
+         context->rxBlockIndex = (context->rxBlockIndex + 1) %
+            AF_PACKET_DRIVER_RX_BLOCK_COUNT;
+         context->rxFrameIndex = 0;
+      }
+   }
+
+   //Flush the frames that have been queued during this round, including
+   //the ones sent in response to the received packets
+   if(context->txPending > 0)
+   {
+      afPacketDriverKickTx(context);
+   }
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+   //Resume the receive task
+   osSetEvent(&context->rxEvent);
+#endif
+}
+
+
+/**
+ * @brief Send a packet
+ * @param[in] interface Underlying network interface
+ * @param[in] buffer Multi-part buffer containing the data to send
+ * @param[in] offset Offset to the first data byte
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @return Error code
+ **/
+
+error_t afPacketDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary)
+{
+   error_t error;
+   size_t length;
+   struct tpacket3_hdr *header;
+   AfPacketDriverContext *context;
+
+   //Point to the AF_PACKET driver context
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+   //Retrieve the length of the packet
+   length = netBufferGetLength(buffer) - offset;
+
+   //Check the frame length
+   if(length > AF_PACKET_DRIVER_MAX_PACKET_SIZE)
+   {
+      //The transmitter can accept another packet
+      osSetEvent(&interface->nicTxEvent);
+      //Report an error
+      return ERROR_INVALID_LENGTH;
+   }
+
+#if (AF_PACKET_DRIVER_TAP_SUPPORT == ENABLED)
+   //TAP device?
+   if(context->tap)
+   {
+      //Copy the packet to the bounce buffer
+      netBufferRead(context->buffer, buffer, offset, length);
+
+      //Send packet
+      if(write(context->fd, context->buffer, length) < 0)
+      {
+         error = ERROR_FAILURE;
+      }
+      else
+      {
+         error = NO_ERROR;
+      }
+   }
+   else
+#endif
+   {
+      //Point to the current frame of the transmit ring
+      header = (struct tpacket3_hdr *) (context->ring +
+         AF_PACKET_DRIVER_RX_BLOCK_COUNT * AF_PACKET_DRIVER_BLOCK_SIZE +
+         context->txFrameIndex * AF_PACKET_DRIVER_FRAME_SIZE);
+
+      //Make sure the frame is available
+      if(header->tp_status == TP_STATUS_AVAILABLE ||
+         header->tp_status == TP_STATUS_WRONG_FORMAT)
+      {
+         //Copy the packet directly to the transmit ring
+         netBufferRead((uint8_t *) header + AF_PACKET_DRIVER_TX_DATA_OFFSET,
+            buffer, offset, length);
+
+         //Format the frame header
+         header->tp_len = length;
+         header->tp_snaplen = length;
+         header->tp_next_offset = 0;
+
+         //Hand the frame over to the kernel
+         __sync_synchronize();
+         header->tp_status = TP_STATUS_SEND_REQUEST;
+
+         //Point to the next frame
+         context->txFrameIndex = (context->txFrameIndex + 1) %
+            AF_PACKET_DRIVER_TX_FRAME_COUNT;
+
+         //One more frame is waiting for the kernel
+         context->txPending++;
+
+         //Enough frames have been queued?
+         if(context->txPending >= AF_PACKET_DRIVER_TX_KICK_THRESHOLD)
+         {
+            //Ask the kernel to transmit the whole batch
+            error = afPacketDriverKickTx(context);
+         }
+         else
+         {
+            //The first frame of a batch schedules a kick at the end of the
+            //current round of the TCP/IP stack
+            if(context->txPending == 1)
+            {
+               interface->nicEvent = TRUE;
+               osSetEvent(&interface->context->event);
+            }
+
+            //The frame will be transmitted later
+            error = NO_ERROR;
+         }
+      }
+      else
+      {
+         //Kick the transmitter so that it releases some frames
+         afPacketDriverKickTx(context);
+         //The transmit ring is full
+         error = ERROR_FAILURE;
+      }
+   }
+
+   //The transmitter can accept another packet
+   osSetEvent(&interface->nicTxEvent);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Configure MAC address filtering
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t afPacketDriverUpdateMacAddrFilter(NetInterface *interface)
+{
+   //The host interface operates in promiscuous mode and the Ethernet layer
+   //filters the incoming frames
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief AF_PACKET receive task
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverTask(NetInterface *interface)
+{
+   int ret;
+   struct pollfd fds;
+   AfPacketDriverContext *context;
+
+   //Point to the AF_PACKET driver context
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+   //Bind the task to the stack instance that owns the interface
+   netSetCurrentContext(interface->context);
+
+   //Process events
+   while(1)
+   {
+#if (NET_RTOS_SUPPORT == ENABLED)
+      //Incoming frames are discarded by the stack while the link is down,
+      //so there is no point in polling the descriptor
+      if(!interface->linkState)
+      {
+         //The link state is refreshed by the periodic tick
+         osDelayTask(AF_PACKET_DRIVER_LINK_POLL_INTERVAL);
+         continue;
+      }
+#else
+      //The link is down?
+      if(!interface->linkState)
+         break;
+#endif
+
+      //Wait for the kernel to hand over a block (or a frame, in the case of
+      //a TAP device)
+      fds.fd = context->fd;
+      fds.events = POLLIN | POLLERR;
+      fds.revents = 0;
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+      //Block until data are available. The timeout only bounds the time it
+      //takes to notice that the link went down
+      ret = poll(&fds, 1, AF_PACKET_DRIVER_LINK_POLL_INTERVAL);
+#else
+      //Check for data without blocking the main loop
+      ret = poll(&fds, 1, 0);
+#endif
+
+      //Any data available?
+      if(ret > 0)
+      {
+         //Set event flag
+         interface->nicEvent = TRUE;
+         //Notify the TCP/IP stack of the event
+         osSetEvent(&interface->context->event);
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+         //Wait for the TCP/IP stack to process the receive ring before polling
+         //the descriptor again (the ring may take several rounds to drain
+         //when the RX budget is exhausted)
+         osWaitForEvent(&context->rxEvent, INFINITE_DELAY);
+#else
+         //The frames are processed by the next iteration of the main loop
+         break;
+#endif
+      }
+      else
+      {
+#if (NET_RTOS_SUPPORT == DISABLED)
+         //No packet has been received
+         break;
+#endif
+      }
+   }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file af_packet_driver.h
+ * @brief Linux AF_PACKET (TPACKET_V3) driver
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _AF_PACKET_DRIVER_H
+#define _AF_PACKET_DRIVER_H
+
+//Dependencies
+#include "core/nic.h"
+
+//Name of the host network interface
+#ifndef AF_PACKET_DRIVER_DEVICE_NAME
+   #define AF_PACKET_DRIVER_DEVICE_NAME "eth0"
+#endif
+
+//Size of the ring blocks
+#ifndef AF_PACKET_DRIVER_BLOCK_SIZE
+   #define AF_PACKET_DRIVER_BLOCK_SIZE 65536
+#elif (AF_PACKET_DRIVER_BLOCK_SIZE < 4096)
+   #error AF_PACKET_DRIVER_BLOCK_SIZE parameter is not valid
+#endif
+
+//Number of blocks in the receive ring
+#ifndef AF_PACKET_DRIVER_RX_BLOCK_COUNT
+   #define AF_PACKET_DRIVER_RX_BLOCK_COUNT 32
+#elif (AF_PACKET_DRIVER_RX_BLOCK_COUNT < 1)
+   #error AF_PACKET_DRIVER_RX_BLOCK_COUNT parameter is not valid
+#endif
+
+//Number of blocks in the transmit ring
+#ifndef AF_PACKET_DRIVER_TX_BLOCK_COUNT
+   #define AF_PACKET_DRIVER_TX_BLOCK_COUNT 8
+#elif (AF_PACKET_DRIVER_TX_BLOCK_COUNT < 1)
+   #error AF_PACKET_DRIVER_TX_BLOCK_COUNT parameter is not valid
+#endif
+
+//Size of the ring frames
+#ifndef AF_PACKET_DRIVER_FRAME_SIZE
+   #define AF_PACKET_DRIVER_FRAME_SIZE 2048
+#elif (AF_PACKET_DRIVER_FRAME_SIZE < 1536)
+   #error AF_PACKET_DRIVER_FRAME_SIZE parameter is not valid
+#endif
+
+//Timeout after which a partially filled block is handed over (in ms)
+#ifndef AF_PACKET_DRIVER_BLOCK_TIMEOUT
+   #define AF_PACKET_DRIVER_BLOCK_TIMEOUT 1
+#elif (AF_PACKET_DRIVER_BLOCK_TIMEOUT < 1)
+   #error AF_PACKET_DRIVER_BLOCK_TIMEOUT parameter is not valid
+#endif
+
+//Number of queued TX frames after which the kernel is kicked without
+//waiting for the end of the current batch
+#ifndef AF_PACKET_DRIVER_TX_KICK_THRESHOLD
+   #define AF_PACKET_DRIVER_TX_KICK_THRESHOLD 32
+#elif (AF_PACKET_DRIVER_TX_KICK_THRESHOLD < 1)
+   #error AF_PACKET_DRIVER_TX_KICK_THRESHOLD parameter is not valid
+#endif
+
+//Link state polling interval while the link is down (in ms)
+#ifndef AF_PACKET_DRIVER_LINK_POLL_INTERVAL
+   #define AF_PACKET_DRIVER_LINK_POLL_INTERVAL 100
+#elif (AF_PACKET_DRIVER_LINK_POLL_INTERVAL < 1)
+   #error AF_PACKET_DRIVER_LINK_POLL_INTERVAL parameter is not valid
+#endif
+
+//Maximum packet size
+#ifndef AF_PACKET_DRIVER_MAX_PACKET_SIZE
+   #define AF_PACKET_DRIVER_MAX_PACKET_SIZE 1536
+#elif (AF_PACKET_DRIVER_MAX_PACKET_SIZE < 1)
+   #error AF_PACKET_DRIVER_MAX_PACKET_SIZE parameter is not valid
+#endif
+
+//TAP device fallback
+#ifndef AF_PACKET_DRIVER_TAP_SUPPORT
+   #define AF_PACKET_DRIVER_TAP_SUPPORT ENABLED
+#elif (AF_PACKET_DRIVER_TAP_SUPPORT != ENABLED && AF_PACKET_DRIVER_TAP_SUPPORT != DISABLED)
+   #error AF_PACKET_DRIVER_TAP_SUPPORT parameter is not valid
+#endif
+
+//Name of the TAP device
+#ifndef AF_PACKET_DRIVER_TAP_NAME
+   #define AF_PACKET_DRIVER_TAP_NAME "tap0"
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//AF_PACKET driver
+extern const NicDriver afPacketDriver;
+
+//AF_PACKET related functions
+error_t afPacketDriverSetDeviceName(NetInterface *interface,
+   const char_t *name);
+
+error_t afPacketDriverInit(NetInterface *interface);
+
+void afPacketDriverTick(NetInterface *interface);
+
+void afPacketDriverEnableIrq(NetInterface *interface);
+void afPacketDriverDisableIrq(NetInterface *interface);
+
+void afPacketDriverEventHandler(NetInterface *interface);
+
+error_t afPacketDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary);
+
+error_t afPacketDriverUpdateMacAddrFilter(NetInterface *interface);
+
+void afPacketDriverTask(NetInterface *interface);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
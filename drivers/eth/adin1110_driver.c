@@ -200,7 +200,7 @@ error_t adin1110Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -303,7 +303,7 @@ bool_t adin1110IrqHandler(NetInterface *interface)
    interface->nicEvent = TRUE;
 
    //Notify the TCP/IP stack of the event
-   return osSetEventFromIsr(&netEvent);
+   return osSetEventFromIsr(&interface->context->event);
 #else
    bool_t flag;
    size_t n;
@@ -330,7 +330,7 @@ bool_t adin1110IrqHandler(NetInterface *interface)
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&interface->context->event);
    }
 
    //Packet transmission complete?
@@ -360,7 +360,7 @@ bool_t adin1110IrqHandler(NetInterface *interface)
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&interface->context->event);
    }
 
    //Re-enable interrupts once the interrupt has been serviced
@@ -558,7 +558,7 @@ error_t adin1110SendPacket(NetInterface *interface,
             //Some data chunks are available for reading
             interface->nicEvent = TRUE;
             //Notify the TCP/IP stack of the event
-            osSetEvent(&netEvent);
+            osSetEvent(&interface->context->event);
          }
       }
    }
@@ -188,7 +188,7 @@ error_t dm9000Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -278,7 +278,7 @@ bool_t dm9000IrqHandler(NetInterface *interface)
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&interface->context->event);
    }
 
    //Packet transmission complete?
@@ -312,7 +312,7 @@ bool_t dm9000IrqHandler(NetInterface *interface)
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&interface->context->event);
    }
 
    //A higher priority task must be woken?
@@ -225,7 +225,7 @@ error_t enc28j60Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -311,7 +311,7 @@ bool_t enc28j60IrqHandler(NetInterface *interface)
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&interface->context->event);
    }
 
    //Packet received?
@@ -323,7 +323,7 @@ bool_t enc28j60IrqHandler(NetInterface *interface)
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&interface->context->event);
    }
 
    //Packet transmission complete?
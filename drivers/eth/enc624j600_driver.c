@@ -178,7 +178,7 @@ error_t enc624j600Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -264,7 +264,7 @@ bool_t enc624j600IrqHandler(NetInterface *interface)
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&interface->context->event);
    }
 
    //Packet received?
@@ -276,7 +276,7 @@ bool_t enc624j600IrqHandler(NetInterface *interface)
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&interface->context->event);
    }
 
    //Packet transmission complete?
@@ -164,7 +164,7 @@ error_t lan8650Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the status at startup
    interface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -368,7 +368,7 @@ bool_t lan8650IrqHandler(NetInterface *interface)
    interface->nicEvent = TRUE;
 
    //Notify the TCP/IP stack of the event
-   return osSetEventFromIsr(&netEvent);
+   return osSetEventFromIsr(&interface->context->event);
 }
 
 
@@ -501,7 +501,7 @@ error_t lan8650SendPacket(NetInterface *interface,
             //Some data chunks are available for reading
             interface->nicEvent = TRUE;
             //Notify the TCP/IP stack of the event
-            osSetEvent(&netEvent);
+            osSetEvent(&interface->context->event);
          }
       }
    }
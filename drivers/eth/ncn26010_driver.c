@@ -185,7 +185,7 @@ error_t ncn26010Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the status at startup
    interface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -301,7 +301,7 @@ bool_t ncn26010IrqHandler(NetInterface *interface)
    interface->nicEvent = TRUE;
 
    //Notify the TCP/IP stack of the event
-   return osSetEventFromIsr(&netEvent);
+   return osSetEventFromIsr(&interface->context->event);
 }
 
 
@@ -435,7 +435,7 @@ error_t ncn26010SendPacket(NetInterface *interface,
             //Some data chunks are available for reading
             interface->nicEvent = TRUE;
             //Notify the TCP/IP stack of the event
-            osSetEvent(&netEvent);
+            osSetEvent(&interface->context->event);
          }
       }
    }
@@ -144,7 +144,7 @@ error_t w3150aInit(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -255,7 +255,7 @@ bool_t w3150aIrqHandler(NetInterface *interface)
          //Set event flag
          interface->nicEvent = TRUE;
          //Notify the TCP/IP stack of the event
-         flag |= osSetEventFromIsr(&netEvent);
+         flag |= osSetEventFromIsr(&interface->context->event);
       }
 
       //Clear interrupt flags
@@ -286,8 +286,8 @@ void w3150aEventHandler(NetInterface *interface)
       //Read incoming packet
       error = w3150aReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 }
 
 
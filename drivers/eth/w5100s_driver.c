@@ -166,7 +166,7 @@ error_t w5100sInit(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -316,7 +316,7 @@ bool_t w5100sIrqHandler(NetInterface *interface)
          //Set event flag
          interface->nicEvent = TRUE;
          //Notify the TCP/IP stack of the event
-         flag |= osSetEventFromIsr(&netEvent);
+         flag |= osSetEventFromIsr(&interface->context->event);
       }
 
       //Clear interrupt flags
@@ -347,8 +347,8 @@ void w5100sEventHandler(NetInterface *interface)
       //Read incoming packet
       error = w5100sReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 }
 
 
@@ -168,7 +168,7 @@ error_t w5500Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -318,7 +318,7 @@ bool_t w5500IrqHandler(NetInterface *interface)
          //Set event flag
          interface->nicEvent = TRUE;
          //Notify the TCP/IP stack of the event
-         flag |= osSetEventFromIsr(&netEvent);
+         flag |= osSetEventFromIsr(&interface->context->event);
       }
 
       //Clear interrupt flags
@@ -350,8 +350,8 @@ void w5500EventHandler(NetInterface *interface)
       //Read incoming packet
       error = w5500ReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 }
 
 
@@ -36,13 +36,6 @@
 #include "loopback_driver.h"
 #include "debug.h"
 
-//Loopback interface queue
-static LoopbackDriverQueueEntry queue[LOOPBACK_DRIVER_QUEUE_SIZE];
-
-static uint_t queueLength;
-static uint_t queueTxIndex;
-static uint_t queueRxIndex;
-
 
 /**
  * @brief Loopback interface driver
@@ -51,7 +44,7 @@ static uint_t queueRxIndex;
 const NicDriver loopbackDriver =
 {
    NIC_TYPE_LOOPBACK,
-   ETH_MTU,
+   LOOPBACK_DRIVER_MTU,
    loopbackDriverInit,
    loopbackDriverTick,
    loopbackDriverEnableIrq,
@@ -77,17 +70,39 @@ const NicDriver loopbackDriver =
 
 error_t loopbackDriverInit(NetInterface *interface)
 {
+   LoopbackDriverContext *context;
+
    //Debug message
    TRACE_INFO("Initializing loopback interface...\r\n");
 
-   //Initialize variables
-   queueLength = 0;
-   queueTxIndex = 0;
-   queueRxIndex = 0;
+   //Point to the driver context attached to the interface, if any
+   context = *((LoopbackDriverContext **) interface->nicContext);
+
+   //The context is allocated on first initialization
+   if(context == NULL)
+   {
+      //Allocate loopback driver context
+      context = (LoopbackDriverContext *) osAllocMem(
+         sizeof(LoopbackDriverContext));
+      //Failed to allocate memory?
+      if(context == NULL)
+         return ERROR_OUT_OF_MEMORY;
+
+      //Clear loopback driver context
+      osMemset(context, 0, sizeof(LoopbackDriverContext));
+
+      //Attach the context to the network interface
+      *((LoopbackDriverContext **) interface->nicContext) = context;
+   }
+   else
+   {
+      //Release any packet left over from a previous initialization
+      loopbackDriverFlushQueue(context);
+   }
 
    //Force the TCP/IP stack to poll the link state at startup
    interface->nicEvent = TRUE;
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //The loopback interface is now ready to send
    osSetEvent(&interface->nicTxEvent);
@@ -97,6 +112,41 @@ error_t loopbackDriverInit(NetInterface *interface)
 }
 
 
+/**
+ * @brief Release the resources held by the loopback interface
+ *
+ * The interface must have been stopped with netStopInterface() beforehand
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void loopbackDriverDeinit(NetInterface *interface)
+{
+   LoopbackDriverContext *context;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Point to the loopback driver context
+   context = *((LoopbackDriverContext **) interface->nicContext);
+
+   //Valid context?
+   if(context != NULL)
+   {
+      //Release the packets that have not been processed
+      loopbackDriverFlushQueue(context);
+
+      //Detach the context from the network interface
+      *((LoopbackDriverContext **) interface->nicContext) = NULL;
+      //Release loopback driver context
+      osFreeMem(context);
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+}
+
+
 /**
  * @brief Loopback interface timer handler
  *
@@ -141,6 +191,12 @@ void loopbackDriverDisableIrq(NetInterface *interface)
 
 void loopbackDriverEventHandler(NetInterface *interface)
 {
+   uint_t n;
+   LoopbackDriverContext *context;
+
+   //Point to the loopback driver context
+   context = *((LoopbackDriverContext **) interface->nicContext);
+
    //Link up event is pending?
    if(!interface->linkState)
    {
@@ -150,22 +206,35 @@ void loopbackDriverEventHandler(NetInterface *interface)
       nicNotifyLinkChange(interface);
    }
 
-   //Read incoming packet
-   loopbackDriverReceivePacket(interface);
+   //Process the packets that are pending in the queue. Packets that are
+   //looped back while processing the current batch are left for the next
+   //event, so that a busy connection cannot starve the other interfaces
+   for(n = context->queueLength; n > 0 && nicRxBudgetAvailable(interface); n--)
+   {
+      //Read incoming packet
+      loopbackDriverReceivePacket(interface);
+   }
 
    //Check whether another packet is pending in the queue
-   if(queueLength > 0)
+   if(context->queueLength > 0)
    {
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      osSetEvent(&netEvent);
+      osSetEvent(&interface->context->event);
    }
 }
 
 
 /**
  * @brief Send a packet
+ *
+ * The sender releases its buffer as soon as this function returns, so the
+ * packet is flattened once into a block that fits the packet exactly. The
+ * block is then handed over by reference to the receiving side, which
+ * processes it in place. The queue is bounded by the amount of memory held
+ * by the pending packets rather than by a number of entries
+ *
  * @param[in] interface Underlying network interface
  * @param[in] buffer Multi-part buffer containing the data to send
  * @param[in] offset Offset to the first data byte
@@ -179,39 +248,59 @@ error_t loopbackDriverSendPacket(NetInterface *interface,
 {
    error_t error;
    size_t length;
+   size_t size;
+   LoopbackDriverContext *context;
+   LoopbackDriverPacket *packet;
+
+   //Point to the loopback driver context
+   context = *((LoopbackDriverContext **) interface->nicContext);
 
    //Initialize status code
    error = NO_ERROR;
 
    //Retrieve the length of the packet
    length = netBufferGetLength(buffer) - offset;
+   //Size of the memory block that holds the packet
+   size = sizeof(LoopbackDriverPacket) + length;
 
    //Valid packet length?
-   if(length <= ETH_MTU)
+   if(length <= LOOPBACK_DRIVER_MTU)
    {
-      //Check whether the queue is full
-      if(queueLength < LOOPBACK_DRIVER_QUEUE_SIZE)
+      //Make sure the memory budget of the queue is not exceeded
+      if((context->queueMemUsage + size) <= LOOPBACK_DRIVER_MEM_BUDGET)
       {
-         //Retrieve the length of the packet
-         queue[queueTxIndex].length = netBufferGetLength(buffer) - offset;
+         //Allocate a memory block that fits the packet exactly
+         packet = osAllocMem(size);
 
-         //Copy data to the queue
-         netBufferRead(queue[queueTxIndex].data, buffer,
-            offset, queue[queueTxIndex].length);
-
-         //Increment index and wrap around if necessary
-         if(++queueTxIndex >= LOOPBACK_DRIVER_QUEUE_SIZE)
+         //Successful memory allocation?
+         if(packet != NULL)
          {
-            queueTxIndex = 0;
+            //Flatten the packet
+            packet->next = NULL;
+            packet->length = length;
+            netBufferRead(packet->data, buffer, offset, length);
+
+            //Append the packet to the queue
+            if(context->queueTail != NULL)
+            {
+               context->queueTail->next = packet;
+            }
+            else
+            {
+               context->queueHead = packet;
+            }
+
+            context->queueTail = packet;
+
+            //Update the length of the queue
+            context->queueLength++;
+            context->queueMemUsage += size;
+
+            //Set event flag
+            interface->nicEvent = TRUE;
+            //Notify the TCP/IP stack of the event
+            osSetEvent(&interface->context->event);
          }
-
-         //Update the length of the queue
-         queueLength++;
-
-         //Set event flag
-         interface->nicEvent = TRUE;
-         //Notify the TCP/IP stack of the event
-         osSetEvent(&netEvent);
       }
    }
    else
@@ -238,25 +327,44 @@ error_t loopbackDriverReceivePacket(NetInterface *interface)
 {
    error_t error;
    NetRxAncillary ancillary;
+   LoopbackDriverContext *context;
+   LoopbackDriverPacket *packet;
+
+   //Point to the loopback driver context
+   context = *((LoopbackDriverContext **) interface->nicContext);
 
    //Check whether a packet is pending in the queue
-   if(queueLength > 0)
+   if(context->queueHead != NULL)
    {
-      //Additional options can be passed to the stack along with the packet
-      ancillary = NET_DEFAULT_RX_ANCILLARY;
+      //Remove the first packet from the queue
+      packet = context->queueHead;
+      context->queueHead = packet->next;
 
-      //Pass the packet to the upper layer
-      nicProcessPacket(interface, queue[queueRxIndex].data,
-         queue[queueRxIndex].length, &ancillary);
-
-      //Increment index and wrap around if necessary
-      if(++queueRxIndex >= LOOPBACK_DRIVER_QUEUE_SIZE)
+      //The queue is now empty?
+      if(context->queueHead == NULL)
       {
-         queueRxIndex = 0;
+         context->queueTail = NULL;
       }
 
       //Update the length of the queue
-      queueLength--;
+      context->queueLength--;
+      context->queueMemUsage -= sizeof(LoopbackDriverPacket) + packet->length;
+
+      //Additional options can be passed to the stack along with the packet
+      ancillary = NET_DEFAULT_RX_ANCILLARY;
+
+#if (NET_LOOPBACK_IF_CHECKSUM_BYPASS == ENABLED)
+      //Looped back packets cannot be corrupted in transit, so the upper-layer
+      //checksum has not been calculated by the sender
+      ancillary.checksumValid = TRUE;
+#endif
+
+      //Pass the packet to the upper layer. The IP layer processes the packet
+      //in place
+      nicProcessPacket(interface, packet->data, packet->length, &ancillary);
+
+      //Release the packet
+      osFreeMem(packet);
 
       //Packet successfully received
       error = NO_ERROR;
@@ -283,3 +391,30 @@ error_t loopbackDriverUpdateMacAddrFilter(NetInterface *interface)
    //Not implemented
    return NO_ERROR;
 }
+
+
+/**
+ * @brief Release all the packets pending in the queue
+ * @param[in] context Pointer to the loopback driver context
+ **/
+
+void loopbackDriverFlushQueue(LoopbackDriverContext *context)
+{
+   LoopbackDriverPacket *packet;
+
+   //Loop through the queue
+   while(context->queueHead != NULL)
+   {
+      //Remove the first packet from the queue
+      packet = context->queueHead;
+      context->queueHead = packet->next;
+
+      //Release the packet
+      osFreeMem(packet);
+   }
+
+   //The queue is now empty
+   context->queueTail = NULL;
+   context->queueLength = 0;
+   context->queueMemUsage = 0;
+}
@@ -34,23 +34,44 @@
 //Dependencies
 #include "core/nic.h"
 
-//Queue size
-#ifndef LOOPBACK_DRIVER_QUEUE_SIZE
-   #define LOOPBACK_DRIVER_QUEUE_SIZE 6
-#elif (LOOPBACK_DRIVER_QUEUE_SIZE < 1)
-   #error LOOPBACK_DRIVER_QUEUE_SIZE parameter is not valid
+//Maximum transmission unit
+#ifndef LOOPBACK_DRIVER_MTU
+   #define LOOPBACK_DRIVER_MTU ETH_MTU
+#elif (LOOPBACK_DRIVER_MTU < 1280 || LOOPBACK_DRIVER_MTU > 65535)
+   #error LOOPBACK_DRIVER_MTU parameter is not valid
+#endif
+
+//Maximum amount of memory that can be held by the queue, in bytes
+#ifndef LOOPBACK_DRIVER_MEM_BUDGET
+   #define LOOPBACK_DRIVER_MEM_BUDGET 65536
+#elif (LOOPBACK_DRIVER_MEM_BUDGET < LOOPBACK_DRIVER_MTU)
+   #error LOOPBACK_DRIVER_MEM_BUDGET parameter is not valid
 #endif
 
 
 /**
- * @brief Loopback interface queue entry
+ * @brief Loopback interface packet
+ **/
+
+typedef struct _LoopbackDriverPacket
+{
+   struct _LoopbackDriverPacket *next; ///<Next packet in the queue
+   size_t length;                      ///<Length of the packet
+   uint8_t data[];                     ///<Packet contents
+} LoopbackDriverPacket;
+
+
+/**
+ * @brief Loopback interface driver context
  **/
 
 typedef struct
 {
-   size_t length;
-   uint8_t data[ETH_MTU];
-} LoopbackDriverQueueEntry;
+   LoopbackDriverPacket *queueHead; ///<First packet in the queue
+   LoopbackDriverPacket *queueTail; ///<Last packet in the queue
+   uint_t queueLength;              ///<Number of packets in the queue
+   size_t queueMemUsage;            ///<Number of bytes held by the queue
+} LoopbackDriverContext;
 
 
 //Loopback interface driver
@@ -58,6 +79,7 @@ extern const NicDriver loopbackDriver;
 
 //Loopback interface related functions
 error_t loopbackDriverInit(NetInterface *interface);
+void loopbackDriverDeinit(NetInterface *interface);
 
 void loopbackDriverTick(NetInterface *interface);
 
@@ -72,4 +94,6 @@ error_t loopbackDriverReceivePacket(NetInterface *interface);
 
 error_t loopbackDriverUpdateMacAddrFilter(NetInterface *interface);
 
+void loopbackDriverFlushQueue(LoopbackDriverContext *context);
+
 #endif
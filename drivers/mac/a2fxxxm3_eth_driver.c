@@ -366,7 +366,7 @@ void EthernetMAC_IRQHandler(void)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //Clear NIS interrupt flag
@@ -392,8 +392,8 @@ void a2fxxxm3EthEventHandler(NetInterface *interface)
       //Read incoming packet
       error = a2fxxxm3EthReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 }
 
 
@@ -1042,18 +1042,17 @@ void am335xEthRxIrqHandler(void)
       //Disable RX interrupts
       CPSW_WR_C_RX_EN_R(CPSW_CORE0) &= ~(1 << CPSW_CH0);
 
-      //Set event flag
+      //Set event flag and notify the TCP/IP stack of the event
       if(nicDriverInterface1 != NULL)
       {
          nicDriverInterface1->nicEvent = TRUE;
+         flag |= osSetEventFromIsr(&nicDriverInterface1->context->event);
       }
       else if(nicDriverInterface2 != NULL)
       {
          nicDriverInterface2->nicEvent = TRUE;
+         flag |= osSetEventFromIsr(&nicDriverInterface2->context->event);
       }
-
-      //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
    }
 
    //Write the DMA end of interrupt vector
@@ -744,7 +744,7 @@ void am64xEthRxIrqHandler(void *arg)
    //Set event flag
    nicDriverInterface1->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   flag = osSetEventFromIsr(&netEvent);
+   flag = osSetEventFromIsr(&nicDriverInterface1->context->event);
 
    //Interrupt service routine epilogue
    osExitIsr(flag);
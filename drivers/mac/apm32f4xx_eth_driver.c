@@ -480,7 +480,7 @@ void ETH_IRQHandler(void)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //Clear NIS interrupt flag
@@ -506,8 +506,8 @@ void apm32f4xxEthEventHandler(NetInterface *interface)
       //Read incoming packet
       error = apm32f4xxEthReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 }
 
 
@@ -381,7 +381,7 @@ void aps3EthRxIrqHandler(void)
    //Set event flag
    nicDriverInterface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   flag = osSetEventFromIsr(&netEvent);
+   flag = osSetEventFromIsr(&nicDriverInterface->context->event);
 
    //Interrupt service routine epilogue
    osExitIsr(flag);
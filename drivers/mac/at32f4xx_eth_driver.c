@@ -599,7 +599,7 @@ void EMAC_IRQHandler(void)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //Clear NIS interrupt flag
@@ -625,8 +625,8 @@ void at32f4xxEthEventHandler(NetInterface *interface)
       //Read incoming packet
       error = at32f4xxEthReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 }
 
 
@@ -435,7 +435,7 @@ bool_t avr32EthIrqHandler(void)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //A higher priority task must be woken?
@@ -518,7 +518,7 @@ void IRAM_ATTR esp32EthIrqHandler(void *arg)
       //Set event flag
       interface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&interface->context->event);
    }
 
    //Clear NIS interrupt flag
@@ -544,8 +544,8 @@ void esp32EthEventHandler(NetInterface *interface)
       //Read incoming packet
       error = esp32EthReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 }
 
 
@@ -621,7 +621,7 @@ void ENET1_DriverIRQHandler(uint32_t giccIar, void *userParam)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag = osSetEventFromIsr(&netEvent);
+      flag = osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //System bus error?
@@ -633,7 +633,7 @@ void ENET1_DriverIRQHandler(uint32_t giccIar, void *userParam)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //Interrupt service routine epilogue
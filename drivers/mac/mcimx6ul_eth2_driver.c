@@ -584,7 +584,7 @@ void ENET2_DriverIRQHandler(uint32_t giccIar, void *userParam)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag = osSetEventFromIsr(&netEvent);
+      flag = osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //System bus error?
@@ -596,7 +596,7 @@ void ENET2_DriverIRQHandler(uint32_t giccIar, void *userParam)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //Interrupt service routine epilogue
@@ -637,7 +637,7 @@ void omapl138EthRxIrqHandler(void)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //Write the DMA end of interrupt vector
@@ -663,8 +663,8 @@ void omapl138EthEventHandler(NetInterface *interface)
       //Read incoming packet
       error = omapl138EthReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 
    //Re-enable RX interrupts
    EMAC_CTRL_CnRXEN_R(EMAC_CORE0) |= (1 << EMAC_CH0);
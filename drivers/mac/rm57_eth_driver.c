@@ -603,7 +603,7 @@ void rm57EthRxIrqHandler(void)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //Write the DMA end of interrupt vector
@@ -629,8 +629,8 @@ void rm57EthEventHandler(NetInterface *interface)
       //Read incoming packet
       error = rm57EthReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 
    //Re-enable RX interrupts
    EMAC_CTRL_CnRXEN_R(EMAC_CORE0) |= (1 << EMAC_CH0);
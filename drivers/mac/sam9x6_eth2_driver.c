@@ -417,7 +417,7 @@ void sam9x6Eth2IrqHandler(void)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
 #if (NET_RTOS_SUPPORT == DISABLED)
@@ -621,7 +621,7 @@ void tms570EthRxIrqHandler(void)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //Write the DMA end of interrupt vector
@@ -647,8 +647,8 @@ void tms570EthEventHandler(NetInterface *interface)
       //Read incoming packet
       error = tms570EthReceivePacket(interface);
 
-      //No more data in the receive buffer?
-   } while(error != ERROR_BUFFER_EMPTY);
+      //No more data in the receive buffer or RX budget exhausted?
+   } while(error != ERROR_BUFFER_EMPTY && nicRxBudgetAvailable(interface));
 
    //Re-enable RX interrupts
    EMAC_CTRL_CnRXEN_R(EMAC_CORE0) |= (1 << EMAC_CH0);
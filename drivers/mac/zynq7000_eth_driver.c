@@ -427,7 +427,7 @@ void zynq7000EthIrqHandler(NetInterface *interface)
       //Set event flag
       nicDriverInterface->nicEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      flag |= osSetEventFromIsr(&netEvent);
+      flag |= osSetEventFromIsr(&nicDriverInterface->context->event);
    }
 
    //Flush packet if the receive buffer not available
@@ -485,6 +485,9 @@ void pcapDriverTask(NetInterface *interface)
    //Point to the PCAP driver context
    context = *((PcapDriverContext **) interface->nicContext);
 
+   //Bind the task to the stack instance that owns the interface
+   netSetCurrentContext(interface->context);
+
    //Process events
    while(1)
    {
@@ -520,7 +523,7 @@ void pcapDriverTask(NetInterface *interface)
                   //Set event flag
                   interface->nicEvent = TRUE;
                   //Notify the TCP/IP stack of the event
-                  osSetEvent(&netEvent);
+                  osSetEvent(&interface->context->event);
                }
             }
          }
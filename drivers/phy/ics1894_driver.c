@@ -110,7 +110,7 @@ error_t ics1894Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->phyEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -148,7 +148,7 @@ void ics1894Tick(NetInterface *interface)
       //Set event flag
       interface->phyEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      osSetEvent(&netEvent);
+      osSetEvent(&interface->context->event);
    }
    //Link down event?
    else if(!linkState && interface->linkState)
@@ -156,7 +156,7 @@ void ics1894Tick(NetInterface *interface)
       //Set event flag
       interface->phyEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      osSetEvent(&netEvent);
+      osSetEvent(&interface->context->event);
    }
 }
 
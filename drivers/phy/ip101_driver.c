@@ -92,7 +92,7 @@ error_t ip101Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->phyEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -130,7 +130,7 @@ void ip101Tick(NetInterface *interface)
       //Set event flag
       interface->phyEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      osSetEvent(&netEvent);
+      osSetEvent(&interface->context->event);
    }
    //Link down event?
    else if(!linkState && interface->linkState)
@@ -138,7 +138,7 @@ void ip101Tick(NetInterface *interface)
       //Set event flag
       interface->phyEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      osSetEvent(&netEvent);
+      osSetEvent(&interface->context->event);
    }
 }
 
@@ -94,7 +94,7 @@ error_t mv88e1112Init(NetInterface *interface)
    //Force the TCP/IP stack to poll the link state at startup
    interface->phyEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
@@ -132,7 +132,7 @@ void mv88e1112Tick(NetInterface *interface)
       //Set event flag
       interface->phyEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      osSetEvent(&netEvent);
+      osSetEvent(&interface->context->event);
    }
    //Link down event?
    else if(!linkState && interface->linkState)
@@ -140,7 +140,7 @@ void mv88e1112Tick(NetInterface *interface)
       //Set event flag
       interface->phyEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      osSetEvent(&netEvent);
+      osSetEvent(&interface->context->event);
    }
 }
 
@@ -109,7 +109,7 @@ error_t sja1105Init(NetInterface *interface)
       //Force the TCP/IP stack to poll the link state at startup
       interface->phyEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      osSetEvent(&netEvent);
+      osSetEvent(&interface->context->event);
    }
 
    //Return status code
@@ -545,7 +545,7 @@ void sja1105Tick(NetInterface *interface)
       //Set event flag
       interface->phyEvent = TRUE;
       //Notify the TCP/IP stack of the event
-      osSetEvent(&netEvent);
+      osSetEvent(&interface->context->event);
    }
 }
 
@@ -723,7 +723,7 @@ void rndisChangeState(RndisState newState)
       {
          //Notify the user that the link state has changed
          rndisDriverInterface->nicEvent = TRUE;
-         osSetEventFromIsr(&netEvent);
+         osSetEventFromIsr(&rndisDriverInterface->context->event);
       }
    }
    else if(rndisContext.state != RNDIS_STATE_UNINITIALIZED &&
@@ -738,7 +738,7 @@ void rndisChangeState(RndisState newState)
       {
          //Notify the user that the link state has changed
          rndisDriverInterface->nicEvent = TRUE;
-         osSetEventFromIsr(&netEvent);
+         osSetEventFromIsr(&rndisDriverInterface->context->event);
       }
    }
 
@@ -109,7 +109,7 @@ error_t rndisDriverInit(NetInterface *interface)
    //Force the TCP/IP stack to check the link state
    rndisContext.linkEvent = TRUE;
    interface->nicEvent = TRUE;
-   osSetEvent(&netEvent);
+   osSetEvent(&interface->context->event);
 
    //Successful initialization
    return NO_ERROR;
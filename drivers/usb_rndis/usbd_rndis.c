@@ -385,7 +385,7 @@ uint8_t usbdRndisDataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
             //Set event flag
             rndisDriverInterface->nicEvent = TRUE;
             //Notify the TCP/IP stack of the event
-            osSetEventFromIsr(&netEvent);
+            osSetEventFromIsr(&rndisDriverInterface->context->event);
 
             //Flush RX buffer
             rndisContext.rxBufferLen = 0;
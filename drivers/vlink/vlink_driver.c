@@ -0,0 +1,911 @@
+/**
+ * @file vlink_driver.c
+ * @brief Virtual link network emulator
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The virtual link connects two network interfaces of the same process
+ * through an emulated Ethernet link. Each direction can be configured with
+ * a one-way delay, jitter, packet loss, duplication, reordering and a rate
+ * limit. Packets are delivered either on the system time or on a virtual
+ * clock that is advanced explicitly by the application. A virtual clock
+ * can be shared by several links. The timers of the TCP/IP stack follow
+ * the same clock when NET_SYSTEM_TIME_HOOK refers to a function that
+ * returns vlinkDriverGetClockTime() / 1000
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "drivers/vlink/vlink_driver.h"
+#include "debug.h"
+
+
+/**
+ * @brief Virtual link driver
+ **/
+
+const NicDriver vlinkDriver =
+{
+   NIC_TYPE_ETHERNET,
+   ETH_MTU,
+   vlinkDriverInit,
+   vlinkDriverTick,
+   vlinkDriverEnableIrq,
+   vlinkDriverDisableIrq,
+   vlinkDriverEventHandler,
+   vlinkDriverSendPacket,
+   vlinkDriverUpdateMacAddrFilter,
+   NULL,
+   NULL,
+   NULL,
+   TRUE,
+   TRUE,
+   TRUE,
+   TRUE
+};
+
+
+/**
+ * @brief Generate a pseudo-random number
+ * @param[in] context Pointer to the virtual link driver context
+ * @return 32-bit pseudo-random value
+ **/
+
+static uint32_t vlinkDriverRand(VlinkDriverContext *context)
+{
+   uint32_t x;
+
+   //Xorshift generator. Each direction of the link has its own generator so
+   //that a scenario produces the same sequence of impairments on every run
+   x = context->prngState;
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   context->prngState = x;
+
+   //Return pseudo-random value
+   return x;
+}
+
+
+/**
+ * @brief Draw an event with a given probability
+ * @param[in] context Pointer to the virtual link driver context
+ * @param[in] rate Probability of the event, in parts per million
+ * @return TRUE if the event occurs, else FALSE
+ **/
+
+static bool_t vlinkDriverDraw(VlinkDriverContext *context, uint32_t rate)
+{
+   //Zero probability?
+   if(rate == 0)
+      return FALSE;
+
+   //Draw a random number in the range 0 to 999999
+   return ((vlinkDriverRand(context) % 1000000) < rate) ? TRUE : FALSE;
+}
+
+
+/**
+ * @brief Check whether packets are ready to be delivered to an interface
+ * @param[in] interface Receiving network interface
+ * @return TRUE if at least one packet is due, else FALSE
+ **/
+
+static bool_t vlinkDriverIsPacketDue(NetInterface *interface)
+{
+   bool_t due;
+   uint64_t time;
+   VlinkDriverContext *context;
+   VlinkDriverContext *peerContext;
+
+   //Point to the virtual link driver context
+   context = *((VlinkDriverContext **) interface->nicContext);
+
+   //Initialize flag
+   due = FALSE;
+
+   //Make sure the interface is connected
+   if(context != NULL && context->peer != NULL)
+   {
+      //Incoming packets are queued by the interface at the other end
+      peerContext = *((VlinkDriverContext **) context->peer->nicContext);
+
+      //Get current time. The clock is read before the queue is locked
+      time = vlinkDriverGetTime(interface);
+
+      //Acquire exclusive access to the queue
+      osAcquireMutex(&peerContext->mutex);
+
+      //Check the delivery time of the first packet
+      if(peerContext->queue != NULL && peerContext->queue->dueTime <= time)
+      {
+         due = TRUE;
+      }
+
+      //Release exclusive access to the queue
+      osReleaseMutex(&peerContext->mutex);
+   }
+
+   //Return TRUE if at least one packet is due
+   return due;
+}
+
+
+/**
+ * @brief Virtual link driver initialization
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t vlinkDriverInit(NetInterface *interface)
+{
+   VlinkDriverContext *context;
+#if (NET_RTOS_SUPPORT == ENABLED)
+   OsTaskId taskId;
+#endif
+
+   //Debug message
+   TRACE_INFO("Initializing virtual link driver...\r\n");
+
+   //Allocate virtual link driver context
+   context = (VlinkDriverContext *) osAllocMem(sizeof(VlinkDriverContext));
+   //Failed to allocate memory?
+   if(context == NULL)
+      return ERROR_OUT_OF_MEMORY;
+
+   //Clear virtual link driver context
+   osMemset(context, 0, sizeof(VlinkDriverContext));
+
+   //Create a mutex to protect the queue
+   if(!osCreateMutex(&context->mutex))
+   {
+      //Clean up side effects
+      osFreeMem(context);
+      //Report an error
+      return ERROR_OUT_OF_RESOURCES;
+   }
+
+   //Attach the context to the network interface
+   context->interface = interface;
+   *((VlinkDriverContext **) interface->nicContext) = context;
+
+   //The link is not impaired by default
+   vlinkDriverGetDefaultParams(&context->params);
+   context->prngState = context->params.seed;
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+   //Create the task that releases packets when their delivery time is reached
+   taskId = osCreateTask("Virtual Link", (OsTaskCode) vlinkDriverTask,
+      interface, NULL);
+
+   //Failed to create the task?
+   if(taskId == OS_INVALID_TASK_ID)
+   {
+      //Debug message
+      TRACE_ERROR("Failed to create task!\r\n");
+
+      //Clean up side effects
+      *((VlinkDriverContext **) interface->nicContext) = NULL;
+      osDeleteMutex(&context->mutex);
+      osFreeMem(context);
+
+      //Report an error
+      return ERROR_OUT_OF_RESOURCES;
+   }
+#endif
+
+   //Force the TCP/IP stack to poll the link state at startup
+   interface->nicEvent = TRUE;
+   osSetEvent(&interface->context->event);
+
+   //The transmitter is always ready to accept packets
+   osSetEvent(&interface->nicTxEvent);
+
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Virtual link timer handler
+ *
+ * This routine is periodically called by the TCP/IP stack to handle periodic
+ * operations such as polling the link state
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void vlinkDriverTick(NetInterface *interface)
+{
+   //Any packet ready to be delivered? This is needed when no delivery task
+   //is running
+   if(vlinkDriverIsPacketDue(interface))
+   {
+      //Set event flag
+      interface->nicEvent = TRUE;
+      //Notify the stack instance that owns the interface
+      osSetEvent(&interface->context->event);
+   }
+}
+
+
+/**
+ * @brief Enable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void vlinkDriverEnableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Disable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void vlinkDriverDisableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Virtual link event handler
+ * @param[in] interface Underlying network interface
+ **/
+
+void vlinkDriverEventHandler(NetInterface *interface)
+{
+   bool_t linkState;
+   uint64_t time;
+   VlinkDriverPacket *packet;
+   VlinkDriverContext *context;
+   VlinkDriverContext *peerContext;
+   NetRxAncillary ancillary;
+
+   //Point to the virtual link driver context
+   context = *((VlinkDriverContext **) interface->nicContext);
+
+   //The link is up as soon as both ends are connected
+   linkState = (context->peer != NULL) ? TRUE : FALSE;
+
+   //Link state change detected?
+   if(linkState != interface->linkState)
+   {
+      //Update link state
+      interface->linkState = linkState;
+      //Process link state change event
+      nicNotifyLinkChange(interface);
+   }
+
+   //Not connected?
+   if(context->peer == NULL)
+      return;
+
+   //Incoming packets are queued by the interface at the other end
+   peerContext = *((VlinkDriverContext **) context->peer->nicContext);
+
+   //Get current time
+   time = vlinkDriverGetTime(interface);
+
+   //Deliver the packets whose delivery time has been reached, as long as
+   //the receive budget of the current round is not exhausted. Remaining
+   //packets are left in the queue for the next round
+   while(nicRxBudgetAvailable(interface))
+   {
+      //Acquire exclusive access to the queue
+      osAcquireMutex(&peerContext->mutex);
+
+      //The queue is sorted by delivery time
+      packet = peerContext->queue;
+
+      //Check whether the first packet is due
+      if(packet != NULL && packet->dueTime <= time)
+      {
+         //Detach the packet from the queue
+         peerContext->queue = packet->next;
+         peerContext->queueSize -= packet->length;
+         peerContext->stats.rxPackets++;
+      }
+      else
+      {
+         //No more packets to deliver in this round
+         packet = NULL;
+      }
+
+      //Release exclusive access to the queue
+      osReleaseMutex(&peerContext->mutex);
+
+      //Any packet due?
+      if(packet == NULL)
+         break;
+
+      //Additional options can be passed to the stack along with the packet
+      ancillary = NET_DEFAULT_RX_ANCILLARY;
+
+      //Pass the packet to the upper layer. The mutex is not held, as the
+      //upper layers may send packets in the reverse direction
+      nicProcessPacket(interface, packet->data, packet->length, &ancillary);
+
+      //Release the packet
+      osFreeMem(packet);
+   }
+
+#if (NET_RTOS_SUPPORT == DISABLED)
+   //Without a delivery task, the packets still in flight are delivered by
+   //the next iterations of the main loop rather than by the periodic tick
+   if(peerContext->queue != NULL)
+   {
+      //Set event flag
+      interface->nicEvent = TRUE;
+      //Notify the TCP/IP stack of the event
+      osSetEvent(&interface->context->event);
+   }
+#endif
+}
+
+
+/**
+ * @brief Send a packet
+ * @param[in] interface Underlying network interface
+ * @param[in] buffer Multi-part buffer containing the data to send
+ * @param[in] offset Offset to the first data byte
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @return Error code
+ **/
+
+error_t vlinkDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary)
+{
+   uint_t i;
+   uint_t n;
+   size_t length;
+   uint64_t time;
+   uint64_t departTime;
+   uint64_t dueTime;
+   uint32_t jitter;
+   bool_t due;
+   VlinkDriverPacket *packet;
+   VlinkDriverPacket **p;
+   VlinkDriverContext *context;
+
+   //Point to the virtual link driver context
+   context = *((VlinkDriverContext **) interface->nicContext);
+
+   //Retrieve the length of the packet
+   length = netBufferGetLength(buffer) - offset;
+
+   //Check the frame length
+   if(length > VLINK_DRIVER_MAX_PACKET_SIZE)
+   {
+      //The transmitter can accept another packet
+      osSetEvent(&interface->nicTxEvent);
+      //Report an error
+      return ERROR_INVALID_LENGTH;
+   }
+
+   //Get current time
+   time = vlinkDriverGetTime(interface);
+   //No packet is due yet
+   due = FALSE;
+
+   //Acquire exclusive access to the queue
+   osAcquireMutex(&context->mutex);
+
+   //Total number of packets sent
+   context->stats.txPackets++;
+
+   //Packets sent while the link is down are lost
+   if(context->peer == NULL)
+   {
+      n = 0;
+   }
+   //Apply the loss model
+   else if(vlinkDriverDraw(context, context->params.lossRate))
+   {
+      //The packet is dropped
+      context->stats.lostPackets++;
+      n = 0;
+   }
+   //Apply the duplication model
+   else if(vlinkDriverDraw(context, context->params.duplicateRate))
+   {
+      //The packet is sent twice
+      context->stats.duplicatePackets++;
+      n = 2;
+   }
+   else
+   {
+      //The packet is sent once
+      n = 1;
+   }
+
+   //Queue the copies of the packet
+   for(i = 0; i < n; i++)
+   {
+      //Tail drop when the amount of data in flight exceeds the limit
+      if((context->queueSize + length) > context->params.queueLimit)
+      {
+         context->stats.overflowPackets++;
+         continue;
+      }
+
+      //Allocate a memory block to hold the packet
+      packet = osAllocMem(sizeof(VlinkDriverPacket) + length);
+
+      //Failed to allocate memory?
+      if(packet == NULL)
+      {
+         context->stats.overflowPackets++;
+         continue;
+      }
+
+      //Copy the packet
+      packet->length = length;
+      netBufferRead(packet->data, buffer, offset, length);
+
+      //Rate-limited link?
+      if(context->params.bandwidth != 0)
+      {
+         //Packets are serialized one after the other
+         departTime = MAX(time, context->txFreeTime);
+         departTime += ((uint64_t) length * 8 * 1000000) /
+            context->params.bandwidth;
+
+         //The transmitter is busy until the last bit has been sent
+         context->txFreeTime = departTime;
+      }
+      else
+      {
+         //The packet leaves immediately
+         departTime = time;
+      }
+
+      //Apply the propagation delay
+      dueTime = departTime + context->params.delay;
+
+      //Apply jitter, uniformly distributed within +/- the configured value
+      if(context->params.jitter != 0)
+      {
+         jitter = vlinkDriverRand(context) % (2 * context->params.jitter + 1);
+
+         //Positive or negative variation?
+         if(jitter >= context->params.jitter)
+         {
+            dueTime += jitter - context->params.jitter;
+         }
+         else if((context->params.jitter - jitter) <= (dueTime - departTime))
+         {
+            dueTime -= context->params.jitter - jitter;
+         }
+         else
+         {
+            dueTime = departTime;
+         }
+      }
+
+      //Apply the reordering model
+      if(vlinkDriverDraw(context, context->params.reorderRate))
+      {
+         //The packet skips the propagation delay and overtakes the packets
+         //that are already in flight
+         dueTime = departTime;
+         context->stats.reorderedPackets++;
+      }
+      else
+      {
+         //Jitter alone does not reorder packets
+         dueTime = MAX(dueTime, context->lastDueTime);
+         context->lastDueTime = dueTime;
+      }
+
+      //Save delivery time
+      packet->dueTime = dueTime;
+
+      //Keep the queue sorted by delivery time. Packets with the same
+      //delivery time are delivered in the order they were sent
+      for(p = &context->queue; *p != NULL; p = &(*p)->next)
+      {
+         if((*p)->dueTime > dueTime)
+            break;
+      }
+
+      //Insert the packet
+      packet->next = *p;
+      *p = packet;
+
+      //Update the amount of data in flight
+      context->queueSize += length;
+
+      //The packet can be delivered immediately?
+      if(dueTime <= time)
+      {
+         due = TRUE;
+      }
+   }
+
+   //Release exclusive access to the queue
+   osReleaseMutex(&context->mutex);
+
+   //Notify the receiving interface without waiting for the next poll
+   if(due)
+   {
+      //Set event flag
+      context->peer->nicEvent = TRUE;
+      //Notify the stack instance that owns the receiving interface
+      osSetEvent(&context->peer->context->event);
+   }
+
+   //The transmitter can accept another packet
+   osSetEvent(&interface->nicTxEvent);
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Configure MAC address filtering
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t vlinkDriverUpdateMacAddrFilter(NetInterface *interface)
+{
+   //The Ethernet layer filters the incoming frames
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Connect two interfaces through a virtual link
+ * @param[in] interface1 First network interface
+ * @param[in] interface2 Second network interface
+ * @param[in] clock Virtual clock that paces the link (NULL to deliver
+ *   packets on the system time)
+ * @return Error code
+ **/
+
+error_t vlinkDriverConnect(NetInterface *interface1,
+   NetInterface *interface2, VlinkDriverClock *clock)
+{
+   VlinkDriverContext *context1;
+   VlinkDriverContext *context2;
+
+   //Check parameters
+   if(interface1 == NULL || interface2 == NULL || interface1 == interface2)
+      return ERROR_INVALID_PARAMETER;
+
+   //Both interfaces must be driven by the virtual link driver
+   if(interface1->nicDriver != &vlinkDriver ||
+      interface2->nicDriver != &vlinkDriver)
+   {
+      return ERROR_INVALID_INTERFACE;
+   }
+
+   //Point to the driver contexts
+   context1 = *((VlinkDriverContext **) interface1->nicContext);
+   context2 = *((VlinkDriverContext **) interface2->nicContext);
+
+   //The interfaces must have been initialized
+   if(context1 == NULL || context2 == NULL)
+      return ERROR_WRONG_STATE;
+
+   //An interface can only be connected once
+   if(context1->peer != NULL || context2->peer != NULL)
+      return ERROR_ALREADY_CONNECTED;
+
+   //Virtual time?
+   if(clock != NULL)
+   {
+      //Acquire exclusive access to the clock
+      osAcquireMutex(&clock->mutex);
+
+      //The clock notifies both ends of the link when it is advanced
+      context1->nextLink = context2;
+      context2->nextLink = clock->links;
+      clock->links = context1;
+
+      //Release exclusive access to the clock
+      osReleaseMutex(&clock->mutex);
+   }
+
+   //Each interface is updated under the lock of the stack instance that
+   //owns it. The locks are not nested, as both interfaces may belong to
+   //the same instance
+   osAcquireMutex(&interface1->context->mutex);
+   context1->clock = clock;
+   context1->peer = interface2;
+   interface1->nicEvent = TRUE;
+   osReleaseMutex(&interface1->context->mutex);
+
+   osAcquireMutex(&interface2->context->mutex);
+   context2->clock = clock;
+   context2->peer = interface1;
+   interface2->nicEvent = TRUE;
+   osReleaseMutex(&interface2->context->mutex);
+
+   //Report the link up event to the stack instances that own the interfaces
+   osSetEvent(&interface1->context->event);
+   osSetEvent(&interface2->context->event);
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Configure the impairments of the outgoing direction
+ * @param[in] interface Underlying network interface
+ * @param[in] params Link impairments
+ * @return Error code
+ **/
+
+error_t vlinkDriverSetParams(NetInterface *interface,
+   const VlinkDriverParams *params)
+{
+   VlinkDriverContext *context;
+
+   //Check parameters
+   if(interface == NULL || params == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Make sure the interface is driven by the virtual link driver
+   if(interface->nicDriver != &vlinkDriver)
+      return ERROR_INVALID_INTERFACE;
+
+   //Check the validity of the probabilities
+   if(params->lossRate > 1000000 || params->duplicateRate > 1000000 ||
+      params->reorderRate > 1000000 || params->queueLimit == 0)
+   {
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //Point to the virtual link driver context
+   context = *((VlinkDriverContext **) interface->nicContext);
+
+   //Acquire exclusive access to the queue
+   osAcquireMutex(&context->mutex);
+
+   //Save parameters
+   context->params = *params;
+
+   //Restart the pseudo-random sequence. The state of a xorshift generator
+   //must not be zero
+   context->prngState = (params->seed != 0) ? params->seed : 1;
+
+   //Release exclusive access to the queue
+   osReleaseMutex(&context->mutex);
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Retrieve the statistics of the outgoing direction
+ * @param[in] interface Underlying network interface
+ * @param[out] stats Link statistics
+ * @return Error code
+ **/
+
+error_t vlinkDriverGetStats(NetInterface *interface, VlinkDriverStats *stats)
+{
+   VlinkDriverContext *context;
+
+   //Check parameters
+   if(interface == NULL || stats == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Make sure the interface is driven by the virtual link driver
+   if(interface->nicDriver != &vlinkDriver)
+      return ERROR_INVALID_INTERFACE;
+
+   //Point to the virtual link driver context
+   context = *((VlinkDriverContext **) interface->nicContext);
+
+   //Acquire exclusive access to the queue
+   osAcquireMutex(&context->mutex);
+   //Copy statistics
+   *stats = context->stats;
+   //Release exclusive access to the queue
+   osReleaseMutex(&context->mutex);
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Initialize link impairments with default values
+ * @param[out] params Link impairments
+ **/
+
+void vlinkDriverGetDefaultParams(VlinkDriverParams *params)
+{
+   //Ideal link
+   params->delay = 0;
+   params->jitter = 0;
+   params->lossRate = 0;
+   params->duplicateRate = 0;
+   params->reorderRate = 0;
+   params->bandwidth = 0;
+   params->queueLimit = VLINK_DRIVER_DEFAULT_QUEUE_LIMIT;
+   params->seed = 1;
+}
+
+
+/**
+ * @brief Initialize a virtual clock
+ * @param[in] clock Pointer to the virtual clock
+ * @return Error code
+ **/
+
+error_t vlinkDriverInitClock(VlinkDriverClock *clock)
+{
+   //Check parameters
+   if(clock == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Clear the virtual clock
+   osMemset(clock, 0, sizeof(VlinkDriverClock));
+
+   //Create a mutex to protect the clock
+   if(!osCreateMutex(&clock->mutex))
+      return ERROR_OUT_OF_RESOURCES;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Advance a virtual clock
+ *
+ * The links paced by the clock only deliver packets when the application
+ * advances it. Both ends of each link are notified, so that the stack
+ * instances that own them deliver the packets that are due and, when the
+ * clock also drives their timers, handle the timers that have expired
+ *
+ * @param[in] clock Pointer to the virtual clock
+ * @param[in] delta Time increment, in microseconds
+ **/
+
+void vlinkDriverAdvanceTime(VlinkDriverClock *clock, uint64_t delta)
+{
+   VlinkDriverContext *context;
+
+   //Check parameters
+   if(clock == NULL)
+      return;
+
+   //Acquire exclusive access to the clock
+   osAcquireMutex(&clock->mutex);
+
+   //Advance the virtual clock
+   clock->time += delta;
+
+   //Loop through the interfaces paced by the clock
+   for(context = clock->links; context != NULL; context = context->nextLink)
+   {
+      //Set event flag
+      context->interface->nicEvent = TRUE;
+      //Notify the stack instance that owns the interface
+      osSetEvent(&context->interface->context->event);
+   }
+
+   //Release exclusive access to the clock
+   osReleaseMutex(&clock->mutex);
+}
+
+
+/**
+ * @brief Read a virtual clock
+ * @param[in] clock Pointer to the virtual clock
+ * @return Current time, in microseconds
+ **/
+
+uint64_t vlinkDriverGetClockTime(VlinkDriverClock *clock)
+{
+   uint64_t time;
+
+   //Acquire exclusive access to the clock
+   osAcquireMutex(&clock->mutex);
+   //Read the current time
+   time = clock->time;
+   //Release exclusive access to the clock
+   osReleaseMutex(&clock->mutex);
+
+   //Return the current time
+   return time;
+}
+
+
+/**
+ * @brief Get the current time of the link an interface is connected to
+ * @param[in] interface Underlying network interface
+ * @return Current time, in microseconds
+ **/
+
+uint64_t vlinkDriverGetTime(NetInterface *interface)
+{
+   VlinkDriverContext *context;
+
+   //Point to the virtual link driver context
+   context = *((VlinkDriverContext **) interface->nicContext);
+
+   //Check whether the link is paced by a virtual clock
+   if(context != NULL && context->clock != NULL)
+   {
+      return vlinkDriverGetClockTime(context->clock);
+   }
+   else
+   {
+      return netGetTimeUs();
+   }
+}
+
+
+/**
+ * @brief Virtual link delivery task
+ * @param[in] interface Underlying network interface
+ **/
+
+void vlinkDriverTask(NetInterface *interface)
+{
+   //Bind the task to the stack instance that owns the interface
+   netSetCurrentContext(interface->context);
+
+   //Process events
+   while(1)
+   {
+      //Any packet ready to be delivered?
+      if(vlinkDriverIsPacketDue(interface))
+      {
+         //Set event flag
+         interface->nicEvent = TRUE;
+         //Notify the stack instance that owns the interface
+         osSetEvent(&interface->context->event);
+      }
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+      //Wait for the next poll
+      osDelayTask(VLINK_DRIVER_TICK_INTERVAL);
+#else
+      //The task is called from the main loop
+      break;
+#endif
+   }
+}
@@ -0,0 +1,182 @@
+/**
+ * @file vlink_driver.h
+ * @brief Virtual link network emulator
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _VLINK_DRIVER_H
+#define _VLINK_DRIVER_H
+
+//Dependencies
+#include "core/nic.h"
+
+//Maximum packet size
+#ifndef VLINK_DRIVER_MAX_PACKET_SIZE
+   #define VLINK_DRIVER_MAX_PACKET_SIZE 1536
+#elif (VLINK_DRIVER_MAX_PACKET_SIZE < 1)
+   #error VLINK_DRIVER_MAX_PACKET_SIZE parameter is not valid
+#endif
+
+//Default queue limit, in bytes
+#ifndef VLINK_DRIVER_DEFAULT_QUEUE_LIMIT
+   #define VLINK_DRIVER_DEFAULT_QUEUE_LIMIT 65536
+#elif (VLINK_DRIVER_DEFAULT_QUEUE_LIMIT < VLINK_DRIVER_MAX_PACKET_SIZE)
+   #error VLINK_DRIVER_DEFAULT_QUEUE_LIMIT parameter is not valid
+#endif
+
+//Polling interval of the delivery task, in milliseconds (real-time mode)
+#ifndef VLINK_DRIVER_TICK_INTERVAL
+   #define VLINK_DRIVER_TICK_INTERVAL 1
+#elif (VLINK_DRIVER_TICK_INTERVAL < 1)
+   #error VLINK_DRIVER_TICK_INTERVAL parameter is not valid
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Link impairments (one direction)
+ **/
+
+typedef struct
+{
+   uint32_t delay;         ///<One-way delay, in microseconds
+   uint32_t jitter;        ///<Delay variation, in microseconds
+   uint32_t lossRate;      ///<Packet loss probability, in parts per million
+   uint32_t duplicateRate; ///<Packet duplication probability, in parts per million
+   uint32_t reorderRate;   ///<Packet reordering probability, in parts per million
+   uint32_t bandwidth;     ///<Link rate, in bits per second (0 means unlimited)
+   size_t queueLimit;      ///<Maximum amount of data in flight, in bytes
+   uint32_t seed;          ///<Seed of the pseudo-random number generator
+} VlinkDriverParams;
+
+
+/**
+ * @brief Link statistics (one direction)
+ **/
+
+typedef struct
+{
+   uint32_t txPackets;        ///<Number of packets sent
+   uint32_t rxPackets;        ///<Number of packets delivered to the peer
+   uint32_t lostPackets;      ///<Number of packets dropped by the loss model
+   uint32_t overflowPackets;  ///<Number of packets dropped by the queue
+   uint32_t duplicatePackets; ///<Number of duplicated packets
+   uint32_t reorderedPackets; ///<Number of reordered packets
+} VlinkDriverStats;
+
+
+/**
+ * @brief Packet in flight
+ **/
+
+typedef struct _VlinkDriverPacket
+{
+   struct _VlinkDriverPacket *next; ///<Next packet in the queue
+   uint64_t dueTime;                ///<Delivery time, in microseconds
+   size_t length;                   ///<Length of the packet
+   uint8_t data[];                  ///<Packet contents
+} VlinkDriverPacket;
+
+
+/**
+ * @brief Virtual clock
+ **/
+
+typedef struct
+{
+   OsMutex mutex;                      ///<Mutex protecting the clock
+   uint64_t time;                      ///<Current time, in microseconds
+   struct _VlinkDriverContext *links;  ///<Interfaces paced by the clock
+} VlinkDriverClock;
+
+
+/**
+ * @brief Virtual link driver context
+ **/
+
+typedef struct _VlinkDriverContext
+{
+   NetInterface *interface;   ///<Underlying network interface
+   NetInterface *peer;        ///<Interface at the other end of the link
+   VlinkDriverClock *clock;   ///<Virtual clock (NULL for real time)
+   struct _VlinkDriverContext *nextLink; ///<Next interface paced by the clock
+   OsMutex mutex;             ///<Mutex protecting the queue
+   VlinkDriverParams params;  ///<Impairments applied to outgoing packets
+   VlinkDriverStats stats;    ///<Statistics of outgoing packets
+   uint32_t prngState;        ///<State of the pseudo-random number generator
+   VlinkDriverPacket *queue;  ///<Outgoing packets, sorted by delivery time
+   size_t queueSize;          ///<Amount of data in flight, in bytes
+   uint64_t txFreeTime;       ///<Time at which the transmitter becomes idle
+   uint64_t lastDueTime;      ///<Delivery time of the last queued packet
+} VlinkDriverContext;
+
+
+//Virtual link driver
+extern const NicDriver vlinkDriver;
+
+//Virtual link related functions
+error_t vlinkDriverInit(NetInterface *interface);
+
+void vlinkDriverTick(NetInterface *interface);
+
+void vlinkDriverEnableIrq(NetInterface *interface);
+void vlinkDriverDisableIrq(NetInterface *interface);
+
+void vlinkDriverEventHandler(NetInterface *interface);
+
+error_t vlinkDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary);
+
+error_t vlinkDriverUpdateMacAddrFilter(NetInterface *interface);
+
+error_t vlinkDriverConnect(NetInterface *interface1,
+   NetInterface *interface2, VlinkDriverClock *clock);
+
+error_t vlinkDriverSetParams(NetInterface *interface,
+   const VlinkDriverParams *params);
+
+error_t vlinkDriverGetStats(NetInterface *interface, VlinkDriverStats *stats);
+
+void vlinkDriverGetDefaultParams(VlinkDriverParams *params);
+
+error_t vlinkDriverInitClock(VlinkDriverClock *clock);
+void vlinkDriverAdvanceTime(VlinkDriverClock *clock, uint64_t delta);
+uint64_t vlinkDriverGetClockTime(VlinkDriverClock *clock);
+uint64_t vlinkDriverGetTime(NetInterface *interface);
+
+void vlinkDriverTask(NetInterface *interface);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -267,16 +267,19 @@ bool_t bcm43362IrqHandler(void)
    //STA and/or AP mode?
    if(bcm43362StaInterface != NULL)
    {
+      //Set event flag
       bcm43362StaInterface->nicEvent = TRUE;
+      //Notify the TCP/IP stack of the event
+      flag = osSetEventFromIsr(&bcm43362StaInterface->context->event);
    }
    else if(bcm43362ApInterface != NULL)
    {
+      //Set event flag
       bcm43362ApInterface->nicEvent = TRUE;
+      //Notify the TCP/IP stack of the event
+      flag = osSetEventFromIsr(&bcm43362ApInterface->context->event);
    }
 
-   //Notify the TCP/IP stack of the event
-   flag = osSetEventFromIsr(&netEvent);
-
    //A higher priority task must be woken?
    return flag;
 }
@@ -336,16 +336,19 @@ bool_t wilc1000IrqHandler(void)
    //STA and/or AP mode?
    if(wilc1000StaInterface != NULL)
    {
+      //Set event flag
       wilc1000StaInterface->nicEvent = TRUE;
+      //Notify the TCP/IP stack of the event
+      flag = osSetEventFromIsr(&wilc1000StaInterface->context->event);
    }
    else if(wilc1000ApInterface != NULL)
    {
+      //Set event flag
       wilc1000ApInterface->nicEvent = TRUE;
+      //Notify the TCP/IP stack of the event
+      flag = osSetEventFromIsr(&wilc1000ApInterface->context->event);
    }
 
-   //Notify the TCP/IP stack of the event
-   flag = osSetEventFromIsr(&netEvent);
-
    //A higher priority task must be woken?
    return flag;
 }
@@ -219,7 +219,7 @@ bool_t winc1500IrqHandler(void)
    //Set event flag
    nicDriverInterface->nicEvent = TRUE;
    //Notify the TCP/IP stack of the event
-   flag = osSetEventFromIsr(&netEvent);
+   flag = osSetEventFromIsr(&nicDriverInterface->context->event);
 
    //A higher priority task must be woken?
    return flag;
@@ -46,9 +46,6 @@
 #if (IPV4_SUPPORT == ENABLED && (IGMP_HOST_SUPPORT == ENABLED || \
    IGMP_ROUTER_SUPPORT == ENABLED || IGMP_SNOOPING_SUPPORT == ENABLED))
 
-//Tick counter to handle periodic operations
-systime_t igmpTickCounter;
-
 
 /**
  * @brief IGMP initialization
@@ -179,9 +179,6 @@ typedef __packed_struct
    #pragma pack(pop)
 #endif
 
-//Tick counter to handle periodic operations
-extern systime_t igmpTickCounter;
-
 //IGMP related functions
 error_t igmpInit(NetInterface *interface);
 void igmpTick(NetInterface *interface);
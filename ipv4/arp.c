@@ -47,9 +47,6 @@
 //Check TCP/IP stack configuration
 #if (IPV4_SUPPORT == ENABLED && ETH_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t arpTickCounter;
-
 
 /**
  * @brief ARP cache initialization
@@ -198,9 +198,6 @@ typedef struct
 } ArpCacheEntry;
 
 
-//Tick counter to handle periodic operations
-extern systime_t arpTickCounter;
-
 //ARP related functions
 error_t arpInit(NetInterface *interface);
 error_t arpEnable(NetInterface *interface, bool_t enable);
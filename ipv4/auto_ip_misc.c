@@ -43,9 +43,6 @@
 //Check TCP/IP stack configuration
 #if (IPV4_SUPPORT == ENABLED && AUTO_IP_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t autoIpTickCounter;
-
 
 /**
  * @brief Auto-IP timer handler
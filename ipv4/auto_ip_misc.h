@@ -40,9 +40,6 @@
 extern "C" {
 #endif
 
-//Tick counter to handle periodic operations
-extern systime_t autoIpTickCounter;
-
 //Auto-IP related functions
 void autoIpTick(AutoIpContext *context);
 void autoIpLinkChangeEvent(AutoIpContext *context);
@@ -36,7 +36,9 @@
 #include "core/ip.h"
 #include "ipv4/ipv4.h"
 #include "ipv4/ipv4_misc.h"
+#include "ipv4/ipv4_pmtu.h"
 #include "ipv4/icmp.h"
+#include "core/tcp_misc.h"
 #include "mibs/mib2_module.h"
 #include "mibs/ip_mib_module.h"
 #include "debug.h"
@@ -172,6 +174,13 @@ void icmpProcessMessage(NetInterface *interface,
       icmpProcessEchoRequest(interface, requestPseudoHeader, buffer, offset);
       break;
 
+   //Destination Unreachable message?
+   case ICMP_TYPE_DEST_UNREACHABLE:
+      //Process Destination Unreachable message
+      icmpProcessDestUnreachable(interface, requestPseudoHeader, buffer,
+         offset);
+      break;
+
    //Unknown type?
    default:
       //Debug message
@@ -324,6 +333,198 @@ void icmpProcessEchoRequest(NetInterface *interface,
 }
 
 
+/**
+ * @brief Destination Unreachable message processing
+ * @param[in] interface Underlying network interface
+ * @param[in] pseudoHeader IPv4 pseudo header
+ * @param[in] buffer Multi-part buffer containing the incoming ICMP message
+ * @param[in] offset Offset to the first byte of the ICMP message
+ **/
+
+void icmpProcessDestUnreachable(NetInterface *interface,
+   const Ipv4PseudoHeader *pseudoHeader, const NetBuffer *buffer,
+   size_t offset)
+{
+   size_t length;
+   IcmpDestUnreachableMessage *icmpHeader;
+
+#if (IPV4_PMTU_SUPPORT == ENABLED)
+   size_t tentativePathMtu;
+   Ipv4Header *ipHeader;
+#endif
+
+   //Retrieve the length of the Destination Unreachable message
+   length = netBufferGetLength(buffer) - offset;
+
+   //Ensure the packet length is correct
+   if(length < sizeof(IcmpDestUnreachableMessage))
+      return;
+
+   //Point to the ICMP header
+   icmpHeader = netBufferAt(buffer, offset);
+   //Sanity check
+   if(icmpHeader == NULL)
+      return;
+
+   //Debug message
+   TRACE_INFO("ICMP Destination Unreachable message received (%" PRIuSIZE " bytes)...\r\n", length);
+   //Dump message contents for debugging purpose
+   icmpDumpDestUnreachableMessage(icmpHeader);
+
+#if (IPV4_PMTU_SUPPORT == ENABLED)
+   //A router that cannot forward a datagram because it exceeds the MTU of
+   //the next-hop network and its DF bit is set sends a Datagram Too Big
+   //message (refer to RFC 1191, section 4)
+   if(icmpHeader->code != ICMP_CODE_FRAG_NEEDED_AND_DF_SET)
+      return;
+
+   //Move to the beginning of the original IPv4 datagram
+   offset += sizeof(IcmpDestUnreachableMessage);
+   length -= sizeof(IcmpDestUnreachableMessage);
+
+   //Ensure the packet length is correct
+   if(length < sizeof(Ipv4Header))
+      return;
+
+   //Point to the original IPv4 header
+   ipHeader = netBufferAt(buffer, offset);
+   //Sanity check
+   if(ipHeader == NULL)
+      return;
+
+   //Make sure the original datagram was sent by this host
+   if(ipv4CheckDestAddr(interface, ipHeader->srcAddr))
+      return;
+
+   //The quoted datagram must belong to a flow this host is actually using,
+   //otherwise anyone could blindly reduce the PMTU of a destination
+   if(!icmpCheckQuotedDatagram(interface, buffer, offset, length))
+   {
+      //Debug message
+      TRACE_WARNING("ICMP Datagram Too Big message does not match any flow!\r\n");
+      return;
+   }
+
+   //The Next-Hop MTU field contains the MTU of the constricting hop
+   tentativePathMtu = ntohs(icmpHeader->nextHopMtu);
+
+   //Routers that do not implement RFC 1191 set the field to zero
+   if(tentativePathMtu == 0)
+   {
+      //The host must then estimate the PMTU from the total length field of
+      //the datagram that could not be forwarded
+      tentativePathMtu = ipv4GetPlateauMtu(ntohs(ipHeader->totalLength));
+   }
+
+   //Update the PMTU for the specified destination address
+   ipv4UpdatePathMtu(interface, ipHeader->destAddr, tentativePathMtu);
+
+#if (TCP_SUPPORT == ENABLED)
+   //Notify TCP of the new PMTU estimate
+   tcpUpdatePathMtu(interface, ipHeader->destAddr);
+#endif
+#endif
+}
+
+
+/**
+ * @brief Validate the datagram quoted by an ICMP error message
+ *
+ * An ICMP error message carries the IPv4 header of the original datagram
+ * followed by at least the first 64 bits of its payload (refer to RFC 792),
+ * which is enough to identify the transport ports and, for TCP, the
+ * sequence number
+ *
+ * @param[in] interface Underlying network interface
+ * @param[in] buffer Multi-part buffer containing the ICMP message
+ * @param[in] offset Offset to the quoted IPv4 header
+ * @param[in] length Length of the quoted datagram
+ * @return TRUE if the quoted datagram belongs to an existing socket, else FALSE
+ **/
+
+bool_t icmpCheckQuotedDatagram(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, size_t length)
+{
+   bool_t valid;
+   size_t headerLength;
+   uint8_t *p;
+   Ipv4Header *ipHeader;
+
+   //Initialize flag
+   valid = FALSE;
+
+   //Point to the quoted IPv4 header
+   ipHeader = netBufferAt(buffer, offset);
+   //Sanity check
+   if(ipHeader == NULL)
+      return FALSE;
+
+   //Retrieve the length of the quoted IPv4 header
+   headerLength = ipHeader->headerLength * 4;
+
+   //Malformed header?
+   if(headerLength < sizeof(Ipv4Header))
+      return FALSE;
+
+   //The first 8 bytes of the transport header must be present
+   if(length < (headerLength + 8))
+      return FALSE;
+
+   //Only the first fragment carries the transport header
+   if((ntohs(ipHeader->fragmentOffset) & IPV4_OFFSET_MASK) != 0)
+      return FALSE;
+
+   //Point to the quoted transport header
+   p = netBufferAt(buffer, offset + headerLength);
+   //Sanity check
+   if(p == NULL)
+      return FALSE;
+
+#if (TCP_SUPPORT == ENABLED)
+   //TCP segment?
+   if(ipHeader->protocol == IPV4_PROTOCOL_TCP)
+   {
+      //The quoted sequence number must belong to a live connection
+      valid = tcpCheckQuotedSegment(interface, ipHeader->srcAddr,
+         ipHeader->destAddr, LOAD16BE(p), LOAD16BE(p + 2), LOAD32BE(p + 4));
+   }
+   else
+#endif
+#if (UDP_SUPPORT == ENABLED)
+   //UDP datagram?
+   if(ipHeader->protocol == IPV4_PROTOCOL_UDP)
+   {
+      Socket *socket;
+
+      //Loop through active UDP sockets
+      for(socket = udpSocketList; socket != NULL; socket = socket->next)
+      {
+         //The socket must be bound to the quoted source port
+         if(socket->localPort != LOAD16BE(p))
+            continue;
+
+         //Connected sockets must also match the quoted destination port
+         if(socket->remotePort != 0 && socket->remotePort != LOAD16BE(p + 2))
+            continue;
+
+         //A matching socket has been found
+         valid = TRUE;
+         break;
+      }
+   }
+   else
+#endif
+   //Other protocols?
+   {
+      //Other protocols do not maintain a PMTU estimate
+      valid = FALSE;
+   }
+
+   //Return TRUE if the quoted datagram belongs to an existing socket
+   return valid;
+}
+
+
 /**
  * @brief Send an ICMP Error message
  * @param[in] interface Underlying network interface
@@ -617,6 +818,21 @@ void icmpDumpEchoMessage(const IcmpEchoMessage *message)
 }
 
 
+/**
+ * @brief Dump ICMP Destination Unreachable message
+ * @param[in] message Pointer to the ICMP message
+ **/
+
+void icmpDumpDestUnreachableMessage(const IcmpDestUnreachableMessage *message)
+{
+   //Dump ICMP message
+   TRACE_DEBUG("  Type = %" PRIu8 "\r\n", message->type);
+   TRACE_DEBUG("  Code = %" PRIu8 "\r\n", message->code);
+   TRACE_DEBUG("  Checksum = 0x%04" PRIX16 "\r\n", ntohs(message->checksum));
+   TRACE_DEBUG("  Next-Hop MTU = %" PRIu16 "\r\n", ntohs(message->nextHopMtu));
+}
+
+
 /**
  * @brief Dump generic ICMP Error message
  * @param[in] message Pointer to the ICMP message
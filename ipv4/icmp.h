@@ -134,11 +134,12 @@ typedef __packed_struct
 
 typedef __packed_struct
 {
-   uint8_t type;      //0
-   uint8_t code;      //1
-   uint16_t checksum; //2-3
-   uint32_t unused;   //4-7
-   uint8_t data[];    //8
+   uint8_t type;        //0
+   uint8_t code;        //1
+   uint16_t checksum;   //2-3
+   uint16_t unused;     //4-5
+   uint16_t nextHopMtu; //6-7
+   uint8_t data[];      //8
 } IcmpDestUnreachableMessage;
 
 
@@ -207,6 +208,13 @@ void icmpProcessEchoRequest(NetInterface *interface,
    const Ipv4PseudoHeader *requestPseudoHeader, const NetBuffer *request,
    size_t requestOffset);
 
+bool_t icmpCheckQuotedDatagram(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, size_t length);
+
+void icmpProcessDestUnreachable(NetInterface *interface,
+   const Ipv4PseudoHeader *pseudoHeader, const NetBuffer *buffer,
+   size_t offset);
+
 error_t icmpSendErrorMessage(NetInterface *interface, uint8_t type,
    uint8_t code, uint8_t parameter, const NetBuffer *ipPacket,
    size_t ipPacketOffset);
@@ -216,6 +224,7 @@ void icmpUpdateOutStats(uint8_t type);
 
 void icmpDumpMessage(const IcmpHeader *message);
 void icmpDumpEchoMessage(const IcmpEchoMessage *message);
+void icmpDumpDestUnreachableMessage(const IcmpDestUnreachableMessage *message);
 void icmpDumpErrorMessage(const IcmpErrorMessage *message);
 
 //C++ guard
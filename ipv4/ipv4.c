@@ -47,6 +47,7 @@
 #include "ipv4/arp_cache.h"
 #include "ipv4/ipv4.h"
 #include "ipv4/ipv4_misc.h"
+#include "ipv4/ipv4_pmtu.h"
 #include "ipv4/ipv4_routing.h"
 #include "ipv4/icmp.h"
 #include "ipv4/auto_ip_misc.h"
@@ -572,6 +573,11 @@ void ipv4LinkChangeEvent(NetInterface *interface)
    ipv4FlushFragQueue(interface);
 #endif
 
+#if (IPV4_PMTU_SUPPORT == ENABLED)
+   //Flush PMTU cache
+   ipv4FlushPathMtuCache(interface);
+#endif
+
 #if (IGMP_HOST_SUPPORT == ENABLED || IGMP_ROUTER_SUPPORT == ENABLED || \
    IGMP_SNOOPING_SUPPORT == ENABLED)
    //Notify IGMP of link state changes
@@ -636,6 +642,10 @@ void ipv4ProcessPacket(NetInterface *interface, Ipv4Header *packet,
       //Dump IP header contents for debugging purpose
       ipv4DumpHeader(packet);
 
+      //Tracepoint
+      NET_TRACE(NET_TRACE_EVENT_IPV4_RX, interface->index, length,
+         packet->protocol, ntohl(packet->srcAddr));
+
       //A packet whose version number is not 4 must be silently discarded
       if(packet->version != IPV4_VERSION)
       {
@@ -823,6 +833,9 @@ void ipv4ProcessDatagram(NetInterface *interface, const NetBuffer *buffer,
    size_t length;
    Ipv4Header *header;
    IpPseudoHeader pseudoHeader;
+#if (NET_STATS_SUPPORT == ENABLED && TCP_SUPPORT == ENABLED)
+   NetStatsCostProbe probe;
+#endif
 
    //Retrieve the length of the IPv4 datagram
    length = netBufferGetLength(buffer) - offset;
@@ -909,8 +922,12 @@ void ipv4ProcessDatagram(NetInterface *interface, const NetBuffer *buffer,
 #if (TCP_SUPPORT == ENABLED)
    //TCP protocol?
    case IPV4_PROTOCOL_TCP:
+      //Start measuring the processing cost
+      NET_STATS_COST_BEGIN(probe);
       //Process incoming TCP segment
       tcpProcessSegment(interface, &pseudoHeader, buffer, offset, ancillary);
+      //Account for the processing cost of the segment
+      NET_STATS_COST_END(probe, NET_STATS_TCP_RX_COST);
       //Continue processing
       break;
 #endif
@@ -1009,6 +1026,7 @@ error_t ipv4SendDatagram(NetInterface *interface,
    uint16_t id;
 #if (IPV4_IPSEC_SUPPORT == DISABLED)
    size_t length;
+   size_t pathMtu;
 #endif
 
    //Total number of IP datagrams which local IP user-protocols supplied to IP
@@ -1038,11 +1056,19 @@ error_t ipv4SendDatagram(NetInterface *interface,
    //Retrieve the length of payload
    length = netBufferGetLength(buffer) - offset;
 
+#if (IPV4_PMTU_SUPPORT == ENABLED)
+   //Retrieve the PMTU for the specified destination address
+   pathMtu = ipv4GetPathMtu(interface, pseudoHeader->destAddr);
+#else
+   //The PMTU value for the path is assumed to be the MTU of the first-hop link
+   pathMtu = interface->ipv4Context.linkMtu;
+#endif
+
    //Check the length of the payload
-   if((length + sizeof(Ipv4Header)) <= interface->ipv4Context.linkMtu)
+   if((length + sizeof(Ipv4Header)) <= pathMtu)
    {
-      //If the payload length is smaller than the network interface MTU
-      //then no fragmentation is needed
+      //If the payload length is smaller than the PMTU then no fragmentation
+      //is needed
       error = ipv4SendPacket(interface, pseudoHeader, id, 0, buffer,
          offset, ancillary);
    }
@@ -1054,10 +1080,10 @@ error_t ipv4SendDatagram(NetInterface *interface,
       //RFC791, section 2.3)
       if(!ancillary->dontFrag)
       {
-         //If the payload length exceeds the network interface MTU then the
-         //device must fragment the data
+         //If the payload length exceeds the PMTU then the device must
+         //fragment the data
          error = ipv4FragmentDatagram(interface, pseudoHeader, id, buffer,
-            offset, ancillary);
+            offset, pathMtu, ancillary);
       }
       else
 #endif
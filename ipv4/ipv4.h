@@ -85,6 +85,20 @@ struct _Ipv4PseudoHeader;
    #error IPV4_MULTICAST_FILTER_SIZE parameter is not valid
 #endif
 
+//Path MTU discovery support
+#ifndef IPV4_PMTU_SUPPORT
+   #define IPV4_PMTU_SUPPORT DISABLED
+#elif (IPV4_PMTU_SUPPORT != ENABLED && IPV4_PMTU_SUPPORT != DISABLED)
+   #error IPV4_PMTU_SUPPORT parameter is not valid
+#endif
+
+//Size of the PMTU cache
+#ifndef IPV4_PMTU_CACHE_SIZE
+   #define IPV4_PMTU_CACHE_SIZE 8
+#elif (IPV4_PMTU_CACHE_SIZE < 1)
+   #error IPV4_PMTU_CACHE_SIZE parameter is not valid
+#endif
+
 //Version number for IPv4
 #define IPV4_VERSION 4
 //Minimum MTU
@@ -363,6 +377,18 @@ typedef struct
 } Ipv4FilterEntry;
 
 
+/**
+ * @brief PMTU cache entry
+ **/
+
+typedef struct
+{
+   Ipv4Addr destAddr;   ///<Destination IPv4 address
+   size_t pathMtu;      ///<Path MTU
+   systime_t timestamp; ///<Time stamp to manage entry lifetime
+} Ipv4PmtuCacheEntry;
+
+
 /**
  * @brief IPv4 context
  **/
@@ -381,6 +407,9 @@ typedef struct
 #if (IPV4_FRAG_SUPPORT == ENABLED)
    Ipv4FragDesc fragQueue[IPV4_MAX_FRAG_DATAGRAMS];             ///<IPv4 fragment reassembly queue
 #endif
+#if (IPV4_PMTU_SUPPORT == ENABLED)
+   Ipv4PmtuCacheEntry pmtuCache[IPV4_PMTU_CACHE_SIZE];          ///<PMTU cache
+#endif
 } Ipv4Context;
 
 
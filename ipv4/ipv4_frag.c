@@ -53,9 +53,6 @@
 //Check TCP/IP stack configuration
 #if (IPV4_SUPPORT == ENABLED && IPV4_FRAG_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t ipv4FragTickCounter;
-
 
 /**
  * @brief Fragment an IPv4 datagram into smaller packets
@@ -64,6 +61,7 @@ systime_t ipv4FragTickCounter;
  * @param[in] id Fragment identification
  * @param[in] payload Multi-part buffer containing the payload
  * @param[in] payloadOffset Offset to the first payload byte
+ * @param[in] pathMtu PMTU value
  * @param[in] ancillary Additional options passed to the stack along with
  *   the packet
  * @return Error code
@@ -71,7 +69,7 @@ systime_t ipv4FragTickCounter;
 
 error_t ipv4FragmentDatagram(NetInterface *interface,
    const Ipv4PseudoHeader *pseudoHeader, uint16_t id, const NetBuffer *payload,
-   size_t payloadOffset, NetTxAncillary *ancillary)
+   size_t payloadOffset, size_t pathMtu, NetTxAncillary *ancillary)
 {
    error_t error;
    size_t offset;
@@ -96,7 +94,7 @@ error_t ipv4FragmentDatagram(NetInterface *interface,
       return ERROR_OUT_OF_MEMORY;
 
    //Determine the maximum payload size for fragmented packets
-   maxFragmentSize = interface->ipv4Context.linkMtu - sizeof(Ipv4Header);
+   maxFragmentSize = pathMtu - sizeof(Ipv4Header);
    //The size shall be a multiple of 8-byte blocks
    maxFragmentSize -= (maxFragmentSize % 8);
 
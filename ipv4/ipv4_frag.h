@@ -141,13 +141,10 @@ typedef struct
 } Ipv4FragDesc;
 
 
-//Tick counter to handle periodic operations
-extern systime_t ipv4FragTickCounter;
-
 //IPv4 datagram fragmentation and reassembly
 error_t ipv4FragmentDatagram(NetInterface *interface,
    const Ipv4PseudoHeader *pseudoHeader, uint16_t id, const NetBuffer *payload,
-   size_t payloadOffset, NetTxAncillary *ancillary);
+   size_t payloadOffset, size_t pathMtu, NetTxAncillary *ancillary);
 
 void ipv4ReassembleDatagram(NetInterface *interface, const Ipv4Header *packet,
    size_t length, NetRxAncillary *ancillary);
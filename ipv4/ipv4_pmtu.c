@@ -0,0 +1,258 @@
+/**
+ * @file ipv4_pmtu.c
+ * @brief Path MTU Discovery for IPv4
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL IPV4_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "ipv4/ipv4.h"
+#include "ipv4/ipv4_pmtu.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (IPV4_SUPPORT == ENABLED && IPV4_PMTU_SUPPORT == ENABLED)
+
+//Table of MTU plateaus (refer to RFC 1191, section 7)
+static const uint16_t ipv4MtuPlateaus[] =
+{
+   32000, 17914, 8166, 4352, 2002, 1492, 1006, 508, 296, 68
+};
+
+
+/**
+ * @brief Retrieve the PMTU for the specified path
+ * @param[in] interface Underlying network interface
+ * @param[in] destAddr Destination IPv4 address
+ * @return PMTU value
+ **/
+
+size_t ipv4GetPathMtu(NetInterface *interface, Ipv4Addr destAddr)
+{
+   size_t pathMtu;
+   Ipv4PmtuCacheEntry *entry;
+
+   //Search the PMTU cache for the specified IPv4 address
+   entry = ipv4FindPathMtuEntry(interface, destAddr);
+
+   //Check whether a matching entry has been found in the PMTU cache
+   if(entry != NULL)
+   {
+      //Use the existing PMTU estimate
+      pathMtu = entry->pathMtu;
+   }
+   else
+   {
+      //When a host first sends a datagram, the PMTU value for the path is
+      //assumed to be the MTU of the first-hop link
+      pathMtu = interface->ipv4Context.linkMtu;
+   }
+
+   //The PMTU should not exceed the MTU of the first-hop link
+   pathMtu = MIN(pathMtu, interface->ipv4Context.linkMtu);
+
+   //Return the PMTU value
+   return pathMtu;
+}
+
+
+/**
+ * @brief Update the PMTU for the specified path
+ * @param[in] interface Underlying network interface
+ * @param[in] destAddr Destination IPv4 address
+ * @param[in] tentativePathMtu Tentative PMTU value
+ **/
+
+void ipv4UpdatePathMtu(NetInterface *interface, Ipv4Addr destAddr,
+   size_t tentativePathMtu)
+{
+   uint_t i;
+   systime_t time;
+   Ipv4PmtuCacheEntry *entry;
+   Ipv4PmtuCacheEntry *oldestEntry;
+
+   //A host must never reduce its estimate of the PMTU below 68 octets (refer
+   //to RFC 1191, section 3). A higher floor limits the damage done by forged
+   //Datagram Too Big messages
+   tentativePathMtu = MAX(tentativePathMtu, IPV4_PMTU_MIN_MTU);
+
+   //The PMTU cannot exceed the MTU of the first-hop link
+   if(tentativePathMtu >= interface->ipv4Context.linkMtu)
+      return;
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //The destination address from the original datagram is used to determine
+   //which path the message applies to
+   entry = ipv4FindPathMtuEntry(interface, destAddr);
+
+   //Check whether a matching entry has been found in the PMTU cache
+   if(entry != NULL)
+   {
+      //If the tentative PMTU is less than the existing PMTU estimate, the
+      //tentative PMTU replaces the existing PMTU
+      if(tentativePathMtu < entry->pathMtu)
+      {
+         entry->pathMtu = tentativePathMtu;
+         entry->timestamp = time;
+      }
+   }
+   else
+   {
+      //Keep track of the oldest entry
+      oldestEntry = NULL;
+
+      //Loop through PMTU cache entries
+      for(i = 0; i < IPV4_PMTU_CACHE_SIZE; i++)
+      {
+         //Point to the current entry
+         entry = &interface->ipv4Context.pmtuCache[i];
+
+         //Check whether the entry is currently in use
+         if(entry->pathMtu != 0)
+         {
+            //Keep track of the oldest entry in the cache
+            if(oldestEntry == NULL ||
+               timeCompare(entry->timestamp, oldestEntry->timestamp) < 0)
+            {
+               oldestEntry = entry;
+            }
+         }
+         else
+         {
+            //An unused entry has been found
+            oldestEntry = entry;
+            break;
+         }
+      }
+
+      //Create a new entry (the oldest entry is recycled if the cache is full)
+      oldestEntry->destAddr = destAddr;
+      oldestEntry->pathMtu = tentativePathMtu;
+      oldestEntry->timestamp = time;
+   }
+
+   //Debug message
+   TRACE_INFO("PMTU for %s updated to %" PRIuSIZE " bytes\r\n",
+      ipv4AddrToString(destAddr, NULL), tentativePathMtu);
+}
+
+
+/**
+ * @brief Search the PMTU cache for a given destination address
+ * @param[in] interface Underlying network interface
+ * @param[in] destAddr Destination IPv4 address
+ * @return A pointer to the matching entry is returned. NULL is returned if
+ *   the specified IPv4 address could not be found in the PMTU cache
+ **/
+
+Ipv4PmtuCacheEntry *ipv4FindPathMtuEntry(NetInterface *interface,
+   Ipv4Addr destAddr)
+{
+   uint_t i;
+   systime_t time;
+   Ipv4PmtuCacheEntry *entry;
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //Loop through PMTU cache entries
+   for(i = 0; i < IPV4_PMTU_CACHE_SIZE; i++)
+   {
+      //Point to the current entry
+      entry = &interface->ipv4Context.pmtuCache[i];
+
+      //Check whether the entry is currently in use
+      if(entry->pathMtu != 0 && entry->destAddr == destAddr)
+      {
+         //A PMTU estimate should be discarded after a while in order to
+         //detect increases in the PMTU (refer to RFC 1191, section 6.3)
+         if(timeCompare(time, entry->timestamp + IPV4_PMTU_TIMEOUT) >= 0)
+         {
+            //The PMTU is reset to the MTU of the first-hop link
+            entry->pathMtu = 0;
+            //Stop immediately
+            break;
+         }
+
+         //A matching entry has been found
+         return entry;
+      }
+   }
+
+   //The specified IPv4 address does not exist in the PMTU cache
+   return NULL;
+}
+
+
+/**
+ * @brief Flush PMTU cache
+ * @param[in] interface Underlying network interface
+ **/
+
+void ipv4FlushPathMtuCache(NetInterface *interface)
+{
+   //Clear the PMTU cache
+   osMemset(interface->ipv4Context.pmtuCache, 0,
+      sizeof(interface->ipv4Context.pmtuCache));
+}
+
+
+/**
+ * @brief Estimate the PMTU when the router does not report the next-hop MTU
+ *
+ * When a router that does not implement RFC 1191 returns a Datagram Too Big
+ * message, the host searches the table of MTU plateaus for the largest value
+ * that is less than the total length of the original datagram
+ *
+ * @param[in] length Total length of the datagram that could not be forwarded
+ * @return Tentative PMTU value
+ **/
+
+size_t ipv4GetPlateauMtu(size_t length)
+{
+   uint_t i;
+
+   //Loop through the table of MTU plateaus
+   for(i = 0; i < arraysize(ipv4MtuPlateaus); i++)
+   {
+      //Search for the greatest plateau that is less than the length
+      if(ipv4MtuPlateaus[i] < length)
+      {
+         return ipv4MtuPlateaus[i];
+      }
+   }
+
+   //Use the lowest acceptable PMTU
+   return IPV4_PMTU_MIN_MTU;
+}
+
+#endif
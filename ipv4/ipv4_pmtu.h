@@ -0,0 +1,81 @@
+/**
+ * @file ipv4_pmtu.h
+ * @brief Path MTU Discovery for IPv4
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2024 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.4.2
+ **/
+
+#ifndef _IPV4_PMTU_H
+#define _IPV4_PMTU_H
+
+//Dependencies
+#include "core/net.h"
+
+//Lifetime of PMTU estimates
+#ifndef IPV4_PMTU_TIMEOUT
+   #define IPV4_PMTU_TIMEOUT 600000
+#elif (IPV4_PMTU_TIMEOUT < 1000)
+   #error IPV4_PMTU_TIMEOUT parameter is not valid
+#endif
+
+//Lowest PMTU estimate accepted from Datagram Too Big messages
+#ifndef IPV4_PMTU_MIN_MTU
+   #define IPV4_PMTU_MIN_MTU 552
+#elif (IPV4_PMTU_MIN_MTU < 68 || IPV4_PMTU_MIN_MTU > 576)
+   #error IPV4_PMTU_MIN_MTU parameter is not valid
+#endif
+
+//Number of retransmissions before a PMTU black hole is assumed
+#ifndef IPV4_PMTU_BLACK_HOLE_THRESHOLD
+   #define IPV4_PMTU_BLACK_HOLE_THRESHOLD 2
+#elif (IPV4_PMTU_BLACK_HOLE_THRESHOLD < 0)
+   #error IPV4_PMTU_BLACK_HOLE_THRESHOLD parameter is not valid
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Path MTU discovery related functions
+size_t ipv4GetPathMtu(NetInterface *interface, Ipv4Addr destAddr);
+
+void ipv4UpdatePathMtu(NetInterface *interface, Ipv4Addr destAddr,
+   size_t tentativePathMtu);
+
+Ipv4PmtuCacheEntry *ipv4FindPathMtuEntry(NetInterface *interface,
+   Ipv4Addr destAddr);
+
+void ipv4FlushPathMtuCache(NetInterface *interface);
+
+size_t ipv4GetPlateauMtu(size_t length);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -975,6 +975,9 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
    uint8_t *type;
    Ipv6Header *ipHeader;
    IpPseudoHeader pseudoHeader;
+#if (NET_STATS_SUPPORT == ENABLED && TCP_SUPPORT == ENABLED)
+   NetStatsCostProbe probe;
+#endif
 
    //Total number of input datagrams received, including those received in error
    IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsInReceives, 1);
@@ -1189,8 +1192,12 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
          //Packets addressed to the tentative address should be silently discarded
          if(!ipv6IsTentativeAddr(interface, &ipHeader->destAddr))
          {
+            //Start measuring the processing cost
+            NET_STATS_COST_BEGIN(probe);
             //Process incoming TCP segment
             tcpProcessSegment(interface, &pseudoHeader, ipPacket, i, ancillary);
+            //Account for the processing cost of the segment
+            NET_STATS_COST_END(probe, NET_STATS_TCP_RX_COST);
          }
          else
          {
@@ -43,9 +43,6 @@
 //Check TCP/IP stack configuration
 #if (IPV6_SUPPORT == ENABLED && IPV6_FRAG_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t ipv6FragTickCounter;
-
 
 /**
  * @brief Fragment IPv6 datagram into smaller packets
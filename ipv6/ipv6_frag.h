@@ -142,9 +142,6 @@ typedef struct
 } Ipv6FragDesc;
 
 
-//Tick counter to handle periodic operations
-extern systime_t ipv6FragTickCounter;
-
 //IPv6 datagram fragmentation and reassembly
 error_t ipv6FragmentDatagram(NetInterface *interface,
    const Ipv6PseudoHeader *pseudoHeader, const NetBuffer *payload,
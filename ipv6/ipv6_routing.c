@@ -45,8 +45,10 @@
 //Check TCP/IP stack configuration
 #if (IPV6_SUPPORT == ENABLED && IPV6_ROUTING_SUPPORT == ENABLED)
 
-//IPv6 routing table
-static Ipv6RoutingTableEntry ipv6RoutingTable[IPV6_ROUTING_TABLE_SIZE];
+#if (NET_MULTI_INSTANCE_SUPPORT == DISABLED)
+//IPv6 routing state
+static Ipv6RoutingContext ipv6RoutingContext;
+#endif
 
 
 /**
@@ -56,8 +58,24 @@ static Ipv6RoutingTableEntry ipv6RoutingTable[IPV6_ROUTING_TABLE_SIZE];
 
 error_t ipv6InitRouting(void)
 {
+   Ipv6RoutingContext *context;
+
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Each stack instance owns its routing table
+   context = osAllocMem(sizeof(Ipv6RoutingContext));
+   //Failed to allocate memory?
+   if(context == NULL)
+      return ERROR_OUT_OF_MEMORY;
+#else
+   //Point to the IPv6 routing state
+   context = &ipv6RoutingContext;
+#endif
+
    //Clear the routing table
-   osMemset(ipv6RoutingTable, 0, sizeof(ipv6RoutingTable));
+   osMemset(context, 0, sizeof(Ipv6RoutingContext));
+
+   //Attach the routing table to the current stack instance
+   netContext.ipv6RoutingContext = context;
 
    //Successful initialization
    return NO_ERROR;
@@ -70,6 +70,19 @@ typedef struct
 } Ipv6RoutingTableEntry;
 
 
+/**
+ * @brief IPv6 routing state
+ **/
+
+typedef struct _Ipv6RoutingContext
+{
+   Ipv6RoutingTableEntry table[IPV6_ROUTING_TABLE_SIZE]; ///<Routing table
+} Ipv6RoutingContext;
+
+
+//Per-instance IPv6 routing table
+#define ipv6RoutingTable (netContext.ipv6RoutingContext->table)
+
 //IPv6 routing related functions
 error_t ipv6InitRouting(void);
 error_t ipv6EnableRouting(NetInterface *interface, bool_t enable);
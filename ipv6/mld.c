@@ -52,9 +52,6 @@
 //Check TCP/IP stack configuration
 #if (IPV6_SUPPORT == ENABLED && MLD_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t mldTickCounter;
-
 
 /**
  * @brief MLD initialization
@@ -106,9 +106,6 @@ typedef __packed_struct
    #pragma pack(pop)
 #endif
 
-//Tick counter to handle periodic operations
-extern systime_t mldTickCounter;
-
 //MLD related functions
 error_t mldInit(NetInterface *interface);
 error_t mldStartListening(NetInterface *interface, Ipv6FilterEntry *entry);
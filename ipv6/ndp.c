@@ -55,9 +55,6 @@
 //Check TCP/IP stack configuration
 #if (IPV6_SUPPORT == ENABLED && NDP_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t ndpTickCounter;
-
 
 /**
  * @brief Neighbor cache initialization
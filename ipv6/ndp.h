@@ -595,9 +595,6 @@ typedef struct
 } NdpContext;
 
 
-//Tick counter to handle periodic operations
-extern systime_t ndpTickCounter;
-
 //NDP related functions
 error_t ndpInit(NetInterface *interface);
 error_t ndpEnable(NetInterface *interface, bool_t enable);
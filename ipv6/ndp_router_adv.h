@@ -158,9 +158,6 @@ struct _NdpRouterAdvContext
 };
 
 
-//Tick counter to handle periodic operations
-extern systime_t ndpRouterAdvTickCounter;
-
 //RA service related functions
 void ndpRouterAdvGetDefaultSettings(NdpRouterAdvSettings *settings);
 
@@ -47,9 +47,6 @@
 //Check TCP/IP stack configuration
 #if (IPV6_SUPPORT == ENABLED && NDP_ROUTER_ADV_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t ndpRouterAdvTickCounter;
-
 
 /**
  * @brief RA service timer handler
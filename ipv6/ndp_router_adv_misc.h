@@ -40,9 +40,6 @@
 extern "C" {
 #endif
 
-//Tick counter to handle periodic operations
-extern systime_t ndpRouterAdvTickCounter;
-
 //RA service related functions
 void ndpRouterAdvTick(NdpRouterAdvContext *context);
 void ndpRouterAdvLinkChangeEvent(NdpRouterAdvContext *context);
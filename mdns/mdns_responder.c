@@ -43,9 +43,6 @@
 //Check TCP/IP stack configuration
 #if (MDNS_RESPONDER_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t mdnsResponderTickCounter;
-
 
 /**
  * @brief Initialize settings with default values
@@ -218,9 +218,6 @@ struct _MdnsResponderContext
 };
 
 
-//Tick counter to handle periodic operations
-extern systime_t mdnsResponderTickCounter;
-
 //mDNS related functions
 void mdnsResponderGetDefaultSettings(MdnsResponderSettings *settings);
 
@@ -69,10 +69,10 @@ error_t mib2GetTcpCurrEstab(const MibObject *object, const uint8_t *oid,
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      socket = &socketTable[i];
+      socket = socketTable[i];
 
       //TCP socket?
-      if(socket->type == SOCKET_TYPE_STREAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_STREAM)
       {
          //Filter out IPv6 connections
          if(socket->localIpAddr.length != sizeof(Ipv6Addr) &&
@@ -172,10 +172,10 @@ error_t mib2GetTcpConnEntry(const MibObject *object, const uint8_t *oid,
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      socket = &socketTable[i];
+      socket = socketTable[i];
 
       //TCP socket?
-      if(socket->type == SOCKET_TYPE_STREAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_STREAM)
       {
          //Check local IP address
          if(socket->localIpAddr.length == sizeof(Ipv6Addr))
@@ -323,10 +323,10 @@ error_t mib2GetNextTcpConnEntry(const MibObject *object, const uint8_t *oid,
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      socket = &socketTable[i];
+      socket = socketTable[i];
 
       //TCP socket?
-      if(socket->type == SOCKET_TYPE_STREAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_STREAM)
       {
          //Filter out IPv6 connections
          if(socket->localIpAddr.length != sizeof(Ipv6Addr) &&
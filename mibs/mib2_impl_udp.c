@@ -88,10 +88,10 @@ error_t mib2GetUdpEntry(const MibObject *object, const uint8_t *oid,
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      Socket *socket = &socketTable[i];
+      Socket *socket = socketTable[i];
 
       //UDP socket?
-      if(socket->type == SOCKET_TYPE_DGRAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_DGRAM)
       {
          //Check local IP address
          if(socket->localIpAddr.length == sizeof(Ipv6Addr))
@@ -189,10 +189,10 @@ error_t mib2GetNextUdpEntry(const MibObject *object, const uint8_t *oid,
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      Socket *socket = &socketTable[i];
+      Socket *socket = socketTable[i];
 
       //UDP socket?
-      if(socket->type == SOCKET_TYPE_DGRAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_DGRAM)
       {
          //Filter out IPv6 connections
          if(socket->localIpAddr.length != sizeof(Ipv6Addr) &&
@@ -95,10 +95,10 @@ error_t tcpMibGetTcpCurrEstab(const MibObject *object, const uint8_t *oid,
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      socket = &socketTable[i];
+      socket = socketTable[i];
 
       //TCP socket?
-      if(socket->type == SOCKET_TYPE_STREAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_STREAM)
       {
          //Check current state
          if(socket->state == TCP_STATE_ESTABLISHED ||
@@ -195,10 +195,10 @@ error_t tcpMibGetTcpConnectionEntry(const MibObject *object, const uint8_t *oid,
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      socket = &socketTable[i];
+      socket = socketTable[i];
 
       //TCP socket?
-      if(socket->type == SOCKET_TYPE_STREAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_STREAM)
       {
          //Check local IP address
          if(!ipCompAddr(&socket->localIpAddr, &localIpAddr))
@@ -327,10 +327,10 @@ error_t tcpMibGetNextTcpConnectionEntry(const MibObject *object, const uint8_t *
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      socket = &socketTable[i];
+      socket = socketTable[i];
 
       //TCP socket?
-      if(socket->type == SOCKET_TYPE_STREAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_STREAM)
       {
          //Check current state
          if(socket->state != TCP_STATE_LISTEN)
@@ -505,10 +505,10 @@ error_t tcpMibGetTcpListenerEntry(const MibObject *object, const uint8_t *oid,
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      socket = &socketTable[i];
+      socket = socketTable[i];
 
       //TCP socket?
-      if(socket->type == SOCKET_TYPE_STREAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_STREAM)
       {
          //Check local IP address
          if(!ipCompAddr(&socket->localIpAddr, &localIpAddr))
@@ -583,10 +583,10 @@ error_t tcpMibGetNextTcpListenerEntry(const MibObject *object, const uint8_t *oi
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      socket = &socketTable[i];
+      socket = socketTable[i];
 
       //TCP socket?
-      if(socket->type == SOCKET_TYPE_STREAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_STREAM)
       {
          //Check current state
          if(socket->state == TCP_STATE_LISTEN)
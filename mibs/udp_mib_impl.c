@@ -128,10 +128,10 @@ error_t udpMibGetUdpEndpointEntry(const MibObject *object, const uint8_t *oid,
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      Socket *socket = &socketTable[i];
+      Socket *socket = socketTable[i];
 
       //UDP socket?
-      if(socket->type == SOCKET_TYPE_DGRAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_DGRAM)
       {
          //Check local IP address
          if(!ipCompAddr(&socket->localIpAddr, &localIpAddr))
@@ -233,10 +233,10 @@ error_t udpMibGetNextUdpEndpointEntry(const MibObject *object, const uint8_t *oi
    for(i = 0; i < SOCKET_MAX_COUNT; i++)
    {
       //Point to current socket
-      Socket *socket = &socketTable[i];
+      Socket *socket = socketTable[i];
 
       //UDP socket?
-      if(socket->type == SOCKET_TYPE_DGRAM)
+      if(socket != NULL && socket->type == SOCKET_TYPE_DGRAM)
       {
          //Append the instance identifier to the OID prefix
          n = object->oidLen;
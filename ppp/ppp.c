@@ -49,9 +49,6 @@
 //Check TCP/IP stack configuration
 #if (PPP_SUPPORT == ENABLED)
 
-//Tick counter to handle periodic operations
-systime_t pppTickCounter;
-
 //FCS lookup table
 static const uint16_t fcsTable[256] =
 {
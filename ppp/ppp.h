@@ -491,9 +491,6 @@ struct _PppContext
 };
 
 
-//Tick counter to handle periodic operations
-extern systime_t pppTickCounter;
-
 //PPP related functions
 void pppGetDefaultSettings(PppSettings *settings);
 error_t pppInit(PppContext *context, const PppSettings *settings);